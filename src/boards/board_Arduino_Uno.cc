@@ -292,9 +292,9 @@ void cboard_Arduino_Uno::Reset(void) {
     if (PICSimLab.GetStatusBar()) {
         // verify serial port state and refresh status bar
 #ifndef _WIN_
-        if (serialfd > 0)
+        if (serial.serialfd > 0)
 #else
-        if (serialfd != INVALID_HANDLE_VALUE)
+        if (serial.serialfd != INVALID_HANDLE_VALUE)
 #endif
             PICSimLab.GetStatusBar()->SetField(
                 2, lxT("Serial: ") + lxString::FromAscii(SERIALDEVICE) + lxT(":") + itoa(serialbaud[0]) + lxT("(") +
@@ -327,9 +327,9 @@ void cboard_Arduino_Uno::RegisterRemoteControl(void) {
 void cboard_Arduino_Uno::RefreshStatus(void) {
     // verify serial port state and refresh status bar
 #ifndef _WIN_
-    if (serialfd > 0)
+    if (serial.serialfd > 0)
 #else
-    if (serialfd != INVALID_HANDLE_VALUE)
+    if (serial.serialfd != INVALID_HANDLE_VALUE)
 #endif
         PICSimLab.GetStatusBar()->SetField(
             2,
@@ -542,21 +542,75 @@ void cboard_Arduino_Uno::Draw(CDraw* draw) {
     gauge6->SetValue((pins[PWM_pins[5]].oavalue - 55) / 2);
 }
 
+// BATCH runs the steps with MStepUntil and fast-forward the idle core, OSCOPE and SPARE enable the oscilloscope and
+// spare parts processing. The backend methods are called without virtual dispatch.
+template <int BATCH, int OSCOPE, int SPARE>
+void cboard_Arduino_Uno::Run_CPU_loop(unsigned int* alm, const picpin* pins, const int pinc, const long int NSTEP) {
+    unsigned char pi = 0;
+    unsigned char values[100];  // pins values before the batch
+    long long unsigned int cycle_start;
+
+    for (long int i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
+    {
+        uint32_t steps = 1;
+        const uint32_t batch = BATCH ? StepBatch(NSTEP - i) : 1;
+        if ((batch > 1) && (!mplabxd_testbp())) {
+            // run until an IO change, a breakpoint or the next timer deadline
+            MeanValueSave(values, pins, pinc);
+            PROF_STAGE(PROF_CPU, steps = bsim_simavr::MStepUntil(batch));
+        } else if (avr_debug_type || (!mplabxd_testbp())) {
+            // verify if a breakpoint is reached if not run one instruction
+            if (twostep) {
+                twostep = 0;  // NOP
+            } else {
+                cycle_start = avr->cycle;
+                PROF_STAGE(PROF_CPU, avr_run(avr));
+                if ((avr->cycle - cycle_start) > 1) {
+                    twostep = 1;
+                }
+            }
+        }
+
+        InstCounterAdd(steps);
+        bsim_simavr::UpdateHardware();
+
+        if (OSCOPE)
+            Oscilloscope.SetSample();
+        if (SPARE)
+            SpareParts.Process();
+        ioupdated = 0;
+
+        // increment mean value counter if pin is high
+        if (steps == 1) {
+            alm[pi] += pins[pi].value;
+            pi++;
+            if (pi == pinc)
+                pi = 0;
+        } else {
+            MeanValueBatch(alm, values, pins, pinc, &pi, steps);
+            i += steps - 1;
+        }
+
+        if (BATCH) {
+            // fast-forward the sleeping or waiting microcontroller up to the next event
+            const uint32_t skip = IdleFastForward(NSTEP - i - 1);
+            if (skip) {
+                MeanValueSteps(alm, pins, pinc, &pi, skip);
+                i += skip;
+            }
+        }
+    }
+}
+
 void cboard_Arduino_Uno::Run_CPU(void) {
-    int i;
-    // int j;
     unsigned char pi;
     const picpin* pins;
     unsigned int alm[100];
 
-    // int JUMPSTEPS = Window1.GetJUMPSTEPS ()*4.0; //number of steps skipped
     const int pinc = MGetPinCount();
     const long int NSTEP = 4.0 * PICSimLab.GetNSTEP();  // number of steps in 100ms
     const float RNSTEP = 200.0 * pinc / NSTEP;
 
-    long long unsigned int cycle_start;
-    int twostep = 0;
-
     // reset mean value
 
     memset(alm, 0, pinc * sizeof(unsigned int));
@@ -568,51 +622,32 @@ void cboard_Arduino_Uno::Run_CPU(void) {
     if (use_spare)
         SpareParts.PreProcess();
 
-    // j = JUMPSTEPS; //step counter
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())       // if powered
-        for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-        {
-            // verify if a breakpoint is reached if not run one instruction
-            if (avr_debug_type || (!mplabxd_testbp())) {
-                if (twostep) {
-                    twostep = 0;  // NOP
-                } else {
-                    cycle_start = avr->cycle;
-                    avr_run(avr);
-                    if ((avr->cycle - cycle_start) > 1) {
-                        twostep = 1;
-                    }
-                }
-            }
-
-            InstCounterInc();
-            UpdateHardware();
-
-            // avr->sleep_usec=0;
-            if (use_oscope)
-                Oscilloscope.SetSample();
+    if (PICSimLab.GetMcuPwr()) {  // if powered
+        // the loop is specialized for the enabled features
+        if (StepBatchEnabled()) {
             if (use_spare)
-                SpareParts.Process();
-            ioupdated = 0;
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
-            /*
-                if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
-                 {
-                  //set analog pin 2 (AN0) with value from scroll
-                  //pic_set_apin(2,((5.0*(scroll1->GetPosition()))/
-                  //  (scroll1->GetRange()-1)));
-
-                  j = -1; //reset counter
-                 }
-                j++; //counter increment
-             */
+                Run_CPU_loop<1, 0, 1>(alm, pins, pinc, NSTEP);
+            else
+                Run_CPU_loop<1, 0, 0>(alm, pins, pinc, NSTEP);
+        } else {
+            // the single step loops don't run the idle detection
+            bsim_simavr::MIdleReset();
+            switch ((use_oscope ? 2 : 0) | (use_spare ? 1 : 0)) {
+                case 0:
+                    Run_CPU_loop<0, 0, 0>(alm, pins, pinc, NSTEP);
+                    break;
+                case 1:
+                    Run_CPU_loop<0, 0, 1>(alm, pins, pinc, NSTEP);
+                    break;
+                case 2:
+                    Run_CPU_loop<0, 1, 0>(alm, pins, pinc, NSTEP);
+                    break;
+                case 3:
+                    Run_CPU_loop<0, 1, 1>(alm, pins, pinc, NSTEP);
+                    break;
+            }
         }
+    }
 
     // calculate mean value
     for (pi = 0; pi < MGetPinCount(); pi++) {
@@ -56,6 +56,9 @@ protected:
     int LED_pin;
     int PWM_pins[6];
 
+    template <int BATCH, int OSCOPE, int SPARE>
+    void Run_CPU_loop(unsigned int* alm, const picpin* pins, const int pinc, const long int NSTEP);
+
 public:
     lxString GetName(void) override { return lxT(BOARD_Arduino_Uno_Name); };
     lxString GetAboutInfo(void) override { return lxT("L.C. Gamboa \n <lcgamboa@yahoo.com>"); };
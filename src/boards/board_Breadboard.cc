@@ -129,9 +129,9 @@ void cboard_Breadboard::Reset(void) {
             if (PICSimLab.GetStatusBar()) {
                 // verify serial port state and refresh status bar
 #ifndef _WIN_
-                if (serialfd > 0)
+                if (serial.serialfd > 0)
 #else
-                if (serialfd != INVALID_HANDLE_VALUE)
+                if (serial.serialfd != INVALID_HANDLE_VALUE)
 #endif
                     PICSimLab.GetStatusBar()->SetField(
                         2, lxT("Serial: ") + lxString::FromAscii(SERIALDEVICE) + lxT(":") + itoa(serialbaud[0]) +
@@ -183,9 +183,9 @@ void cboard_Breadboard::RefreshStatus(void) {
         case _AVR:
             // verify serial port state and refresh status bar
 #ifndef _WIN_
-            if (serialfd > 0)
+            if (serial.serialfd > 0)
 #else
-            if (serialfd != INVALID_HANDLE_VALUE)
+            if (serial.serialfd != INVALID_HANDLE_VALUE)
 #endif
                 PICSimLab.GetStatusBar()->SetField(
                     2, lxT("Serial: ") + lxString::FromAscii(SERIALDEVICE) + lxT(":") + itoa(serialbaud[0]) + lxT("(") +
@@ -434,61 +434,161 @@ void cboard_Breadboard::Draw(CDraw* draw) {
     }
 }
 
+// BATCH runs the steps with MStepUntil, OSCOPE and SPARE enable the oscilloscope and spare parts processing. The
+// backend methods are called without virtual dispatch.
+template <int BATCH, int OSCOPE, int SPARE>
+void cboard_Breadboard::Run_CPU_PIC(unsigned int* alm, const picpin* pins, const long int NSTEP) {
+    const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();  // number of steps skipped
+    int j = JUMPSTEPS;                                // step counter
+    unsigned char pi = 0;
+    unsigned char values[100];  // pins values before the batch
+
+    for (long int i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
+    {
+        if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
+        {
+            pic_set_pin(&pic, pic.mclr, p_RST);
+        }
+
+        uint32_t steps = 1;
+        const uint32_t batch = BATCH ? StepBatch(NSTEP - i) : 1;
+        if ((batch > 1) && (!mplabxd_testbp())) {
+            // run until an IO change, a breakpoint or the next timer deadline
+            MeanValueSave(values, pins, pic.PINCOUNT);
+            PROF_STAGE(PROF_CPU, steps = bsim_picsim::MStepUntil(batch));
+        } else if (!mplabxd_testbp()) {
+            // verify if a breakpoint is reached if not run one instruction
+            PROF_STAGE(PROF_CPU, pic_step(&pic));
+        }
+        ioupdated = pic.ioupdated;
+        InstCounterAdd(steps);
+
+        if (OSCOPE)
+            Oscilloscope.SetSample();
+        if (SPARE)
+            SpareParts.Process();
+
+        // increment mean value counter if pin is high
+        if (steps == 1) {
+            alm[pi] += pins[pi].value;
+            pi++;
+            if (pi == pic.PINCOUNT)
+                pi = 0;
+        } else {
+            MeanValueBatch(alm, values, pins, pic.PINCOUNT, &pi, steps);
+            i += steps - 1;
+        }
+
+        if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
+        {
+            j = -1;  // reset counter
+        }
+        j += steps;  // counter increment
+        pic.ioupdated = 0;
+    }
+}
+
+// BATCH runs the steps with MStepUntil and fast-forward the idle core, OSCOPE and SPARE enable the oscilloscope and
+// spare parts processing. The backend methods are called without virtual dispatch.
+template <int BATCH, int OSCOPE, int SPARE>
+void cboard_Breadboard::Run_CPU_AVR(unsigned int* alm, const picpin* pins, const int pinc, const long int NSTEP) {
+    unsigned char pi = 0;
+    unsigned char values[100];  // pins values before the batch
+    long long unsigned int cycle_start;
+
+    for (long int i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
+    {
+        uint32_t steps = 1;
+        const uint32_t batch = BATCH ? StepBatch(NSTEP - i) : 1;
+        if ((batch > 1) && (!mplabxd_testbp())) {
+            // run until an IO change, a breakpoint or the next timer deadline
+            MeanValueSave(values, pins, pinc);
+            PROF_STAGE(PROF_CPU, steps = bsim_simavr::MStepUntil(batch));
+        } else if (avr_debug_type || (!mplabxd_testbp())) {
+            // verify if a breakpoint is reached if not run one instruction
+            if (twostep) {
+                twostep = 0;  // NOP
+            } else {
+                cycle_start = avr->cycle;
+                PROF_STAGE(PROF_CPU, avr_run(avr));
+                if ((avr->cycle - cycle_start) > 1) {
+                    twostep = 1;
+                }
+            }
+        }
+        InstCounterAdd(steps);
+        bsim_simavr::UpdateHardware();
+
+        if (OSCOPE)
+            Oscilloscope.SetSample();
+        if (SPARE)
+            SpareParts.Process();
+        ioupdated = 0;
+
+        // increment mean value counter if pin is high
+        if (steps == 1) {
+            alm[pi] += pins[pi].value;
+            pi++;
+            if (pi == pinc)
+                pi = 0;
+        } else {
+            MeanValueBatch(alm, values, pins, pinc, &pi, steps);
+            i += steps - 1;
+        }
+
+        if (BATCH) {
+            // fast-forward the sleeping or waiting microcontroller up to the next event
+            const uint32_t skip = IdleFastForward(NSTEP - i - 1);
+            if (skip) {
+                MeanValueSteps(alm, pins, pinc, &pi, skip);
+                i += skip;
+            }
+        }
+    }
+}
+
 void cboard_Breadboard::Run_CPU(void) {
-    int i;
-    int j;
     unsigned char pi;
     const picpin* pins;
     unsigned int alm[100];
 
     switch (ptype) {
         case _PIC: {
-            const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();  // number of steps skipped
-            const long int NSTEP = PICSimLab.GetNSTEP();     // number of steps in 100ms
+            const long int NSTEP = PICSimLab.GetNSTEP();  // number of steps in 100ms
             const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
 
             // reset mean value
             memset(alm, 0, 100 * sizeof(unsigned int));
 
             // read pic.pins to a local variable to speed up
-            pins = MGetPinsValues();
+            pins = bsim_picsim::MGetPinsValues();
             if (use_spare)
                 SpareParts.PreProcess();
 
-            j = JUMPSTEPS;  // step counter
-            pi = 0;
-            if (PICSimLab.GetMcuPwr())       // if powered
-                for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-                {
-                    if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
-                    {
-                        pic_set_pin(&pic, pic.mclr, p_RST);
-                    }
-
-                    // verify if a breakpoint is reached if not run one instruction
-                    if (!mplabxd_testbp())
-                        pic_step(&pic);
-                    ioupdated = pic.ioupdated;
-                    InstCounterInc();
-
-                    if (use_oscope)
-                        Oscilloscope.SetSample();
+            if (PICSimLab.GetMcuPwr()) {  // if powered
+                // the loop is specialized for the enabled features
+                if (StepBatchEnabled()) {
                     if (use_spare)
-                        SpareParts.Process();
-
-                    // increment mean value counter if pin is high
-                    alm[pi] += pins[pi].value;
-                    pi++;
-                    if (pi == pic.PINCOUNT)
-                        pi = 0;
-
-                    if (j >= JUMPSTEPS)  // if number of step is bigger than steps to skip
-                    {
-                        j = -1;  // reset counter
+                        Run_CPU_PIC<1, 0, 1>(alm, pins, NSTEP);
+                    else
+                        Run_CPU_PIC<1, 0, 0>(alm, pins, NSTEP);
+                } else {
+                    switch ((use_oscope ? 2 : 0) | (use_spare ? 1 : 0)) {
+                        case 0:
+                            Run_CPU_PIC<0, 0, 0>(alm, pins, NSTEP);
+                            break;
+                        case 1:
+                            Run_CPU_PIC<0, 0, 1>(alm, pins, NSTEP);
+                            break;
+                        case 2:
+                            Run_CPU_PIC<0, 1, 0>(alm, pins, NSTEP);
+                            break;
+                        case 3:
+                            Run_CPU_PIC<0, 1, 1>(alm, pins, NSTEP);
+                            break;
                     }
-                    j++;  // counter increment
-                    pic.ioupdated = 0;
                 }
+            }
             // calculate mean value
             for (pi = 0; pi < MGetPinCount(); pi++) {
                 bsim_picsim::pic.pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
@@ -499,14 +599,9 @@ void cboard_Breadboard::Run_CPU(void) {
         }
         case _AVR: {
             const int pinc = bsim_simavr::MGetPinCount();
-            // const int JUMPSTEPS = Window1.GetJUMPSTEPS ()*4.0; //number of steps
-            // skipped
             const long int NSTEP = 4.0 * PICSimLab.GetNSTEP();  // number of steps in 100ms
             const float RNSTEP = 200.0 * pinc / NSTEP;
 
-            long long unsigned int cycle_start;
-            int twostep = 0;
-
             // reset mean value
 
             memset(alm, 0, pinc * sizeof(unsigned int));
@@ -518,50 +613,32 @@ void cboard_Breadboard::Run_CPU(void) {
             if (use_spare)
                 SpareParts.PreProcess();
 
-            // j = JUMPSTEPS; //step counter
-            pi = 0;
-            if (PICSimLab.GetMcuPwr())       // if powered
-                for (i = 0; i < NSTEP; i++)  // repeat for number of steps in 100ms
-                {
-                    // verify if a breakpoint is reached if not run one instruction
-                    if (avr_debug_type || (!mplabxd_testbp())) {
-                        if (twostep) {
-                            twostep = 0;  // NOP
-                        } else {
-                            cycle_start = avr->cycle;
-                            avr_run(avr);
-                            if ((avr->cycle - cycle_start) > 1) {
-                                twostep = 1;
-                            }
-                        }
-                    }
-                    InstCounterInc();
-                    bsim_simavr::UpdateHardware();
-
-                    // avr->sleep_usec=0;
-                    if (use_oscope)
-                        Oscilloscope.SetSample();
+            if (PICSimLab.GetMcuPwr()) {  // if powered
+                // the loop is specialized for the enabled features
+                if (StepBatchEnabled()) {
                     if (use_spare)
-                        SpareParts.Process();
-                    ioupdated = 0;
-
-                    // increment mean value counter if pin is high
-                    alm[pi] += pins[pi].value;
-                    pi++;
-                    if (pi == pinc)
-                        pi = 0;
-                    /*
-                    if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
-                     {
-                      //set analog pin 2 (AN0) with value from scroll
-                      //pic_set_apin(2,((5.0*(scroll1->GetPosition()))/
-                      //  (scroll1->GetRange()-1)));
-
-                      j = -1; //reset counter
-                     }
-                    j++; //counter increment
-                     */
+                        Run_CPU_AVR<1, 0, 1>(alm, pins, pinc, NSTEP);
+                    else
+                        Run_CPU_AVR<1, 0, 0>(alm, pins, pinc, NSTEP);
+                } else {
+                    // the single step loops don't run the idle detection
+                    bsim_simavr::MIdleReset();
+                    switch ((use_oscope ? 2 : 0) | (use_spare ? 1 : 0)) {
+                        case 0:
+                            Run_CPU_AVR<0, 0, 0>(alm, pins, pinc, NSTEP);
+                            break;
+                        case 1:
+                            Run_CPU_AVR<0, 0, 1>(alm, pins, pinc, NSTEP);
+                            break;
+                        case 2:
+                            Run_CPU_AVR<0, 1, 0>(alm, pins, pinc, NSTEP);
+                            break;
+                        case 3:
+                            Run_CPU_AVR<0, 1, 1>(alm, pins, pinc, NSTEP);
+                            break;
+                    }
                 }
+            }
             // calculate mean value
             for (pi = 0; pi < MGetPinCount(); pi++) {
                 bsim_simavr::pins[pi].oavalue = (int)((alm[pi] * RNSTEP) + 55);
@@ -864,6 +941,18 @@ void cboard_Breadboard::MStep(void) {
     }
 }
 
+uint32_t cboard_Breadboard::MStepUntil(const uint32_t max) {
+    switch (ptype) {
+        case _PIC:
+            return bsim_picsim::MStepUntil(max);
+            break;
+        case _AVR:
+            return bsim_simavr::MStepUntil(max);
+            break;
+    }
+    return 1;
+}
+
 void cboard_Breadboard::MStepResume(void) {
     switch (ptype) {
         case _PIC:
@@ -886,6 +975,61 @@ void cboard_Breadboard::MReset(int flags) {
     }
 }
 
+int cboard_Breadboard::MSnapshot(snapshot_t* sn) {
+    switch (ptype) {
+        case _PIC:
+            return bsim_picsim::MSnapshot(sn);
+            break;
+        case _AVR:
+            return bsim_simavr::MSnapshot(sn);
+            break;
+    }
+    return -1;
+}
+
+uint32_t cboard_Breadboard::MGetIdleSteps(void) {
+    switch (ptype) {
+        case _PIC:
+            return bsim_picsim::MGetIdleSteps();
+            break;
+        case _AVR:
+            return bsim_simavr::MGetIdleSteps();
+            break;
+    }
+    return 0;
+}
+
+void cboard_Breadboard::MIdleSkip(const uint32_t steps) {
+    switch (ptype) {
+        case _PIC:
+            return bsim_picsim::MIdleSkip(steps);
+            break;
+        case _AVR:
+            return bsim_simavr::MIdleSkip(steps);
+            break;
+    }
+}
+
+void cboard_Breadboard::MIdleReset(void) {
+    switch (ptype) {
+        case _PIC:
+            return bsim_picsim::MIdleReset();
+            break;
+        case _AVR:
+            return bsim_simavr::MIdleReset();
+            break;
+    }
+}
+
+bitbang_uart_t* cboard_Breadboard::MGetUARTLink(const unsigned char rx_pin, const unsigned char tx_pin) {
+    switch (ptype) {
+        case _AVR:
+            return bsim_simavr::MGetUARTLink(rx_pin, tx_pin);
+            break;
+    }
+    return NULL;
+}
+
 unsigned short* cboard_Breadboard::DBGGetProcID_p(void) {
     switch (ptype) {
         case _PIC:
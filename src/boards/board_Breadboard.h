@@ -43,6 +43,12 @@ private:
     lxBitmap* micbmp;
     lxFont font;
     unsigned char jmp[1];  // jumper
+
+    template <int BATCH, int OSCOPE, int SPARE>
+    void Run_CPU_PIC(unsigned int* alm, const picpin* pins, const long int NSTEP);
+    template <int BATCH, int OSCOPE, int SPARE>
+    void Run_CPU_AVR(unsigned int* alm, const picpin* pins, const int pinc, const long int NSTEP);
+
 public:
     void SetScale(double scale) override;
     // Return the board name
@@ -71,8 +77,14 @@ public:
     unsigned char MGetPin(int pin) override;
     const picpin* MGetPinsValues(void) override;
     void MStep(void) override;
+    uint32_t MStepUntil(const uint32_t max) override;
     void MStepResume(void) override;
     void MReset(int flags) override;
+    int MSnapshot(snapshot_t* sn) override;
+    uint32_t MGetIdleSteps(void) override;
+    void MIdleSkip(const uint32_t steps) override;
+    void MIdleReset(void) override;
+    bitbang_uart_t* MGetUARTLink(const unsigned char rx_pin, const unsigned char tx_pin) override;
     unsigned short* DBGGetProcID_p(void) override;
     unsigned int DBGGetPC(void) override;
     void DBGSetPC(unsigned int pc) override;
@@ -594,7 +594,7 @@ void cboard_DevKitC::Run_CPU_ns(uint64_t time) {
              }
              */
             // verify if a breakpoint is reached if not run one instruction
-            MStep();
+            PROF_STAGE(PROF_CPU, MStep());
             InstCounterInc();
             // Oscilloscope window process
             if (use_oscope)
@@ -386,7 +386,6 @@ void cboard_Franzininho_DIY::Run_CPU(void) {
     const float RNSTEP = 200.0 * pinc / NSTEP;
 
     long long unsigned int cycle_start;
-    int twostep = 0;
 
     // reset mean value
 
@@ -409,14 +408,14 @@ void cboard_Franzininho_DIY::Run_CPU(void) {
                     twostep = 0;  // NOP
                 } else {
                     cycle_start = avr->cycle;
-                    avr_run(avr);
+                    PROF_STAGE(PROF_CPU, avr_run(avr));
                     if ((avr->cycle - cycle_start) > 1) {
                         twostep = 1;
                     }
                     // TinyDebug support
                     if (avr->data[TDDR]) {
                         printf("%c", avr->data[TDDR]);
-                        serial_port_send(serialfd, avr->data[TDDR]);
+                        serial_stream_send(&serial, avr->data[TDDR]);
                         avr->data[TDDR] = 0;
                     }
                 }
@@ -435,6 +434,13 @@ void cboard_Franzininho_DIY::Run_CPU(void) {
             pi++;
             if (pi == pinc)
                 pi = 0;
+
+            // fast-forward the sleeping or waiting microcontroller up to the next event
+            const uint32_t skip = IdleFastForward(NSTEP - i - 1);
+            if (skip) {
+                MeanValueSteps(alm, pins, pinc, &pi, skip);
+                i += skip;
+            }
         }
 
     // calculate mean value
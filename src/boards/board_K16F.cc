@@ -86,6 +86,9 @@ cboard_K16F::cboard_K16F(void) : font(10, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NOR
     lcd_init(&lcd, 16, 2);
     mi2c_init(&mi2c, 512);
     rtc_pfc8563_init(&rtc);
+    bus_i2c_init(&i2c_bus);
+    bus_i2c_attach(&i2c_bus, &mi2c.bb_i2c, mi2c_process, &mi2c);
+    bus_i2c_attach(&i2c_bus, &rtc.bb_i2c, rtc_pfc8563_I2C_process, &rtc);
     ReadMaps();
 
     snprintf(mi2c_tmp_name, 200, "%s/picsimlab-XXXXXX", (const char*)lxGetTempDir("PICSimLab").c_str());
@@ -355,7 +358,7 @@ void cboard_K16F::Run_CPU(void) {
             }
 
             if (!mplabxd_testbp())
-                pic_step(&pic);
+                PROF_STAGE(PROF_CPU, pic_step(&pic));
             ioupdated = pic.ioupdated;
             InstCounterInc();
             if (use_oscope)
@@ -408,7 +411,7 @@ void cboard_K16F::Run_CPU(void) {
                 } else {
                     sck = pins[1].value;
                 }
-                pic_set_pin(&pic, 3, mi2c_io(&mi2c, sck, sda) & rtc_pfc8563_I2C_io(&rtc, sck, sda));
+                pic_set_pin(&pic, 3, bus_i2c_io(&i2c_bus, sck, sda));
             }
             pic.ioupdated = 0;
         }
@@ -449,6 +452,7 @@ void cboard_K16F::Reset(void) {
     lcd_rst(&lcd);
     mi2c_rst(&mi2c);
     rtc_pfc8563_rst(&rtc);
+    bus_i2c_rst(&i2c_bus);
     pic_set_pin_DOV(&pic, 18, 0);
     pic_set_pin_DOV(&pic, 1, 0);
     pic_set_pin_DOV(&pic, 15, 0);
@@ -940,6 +944,24 @@ void cboard_K16F::ReadPreferences(char* name, char* value) {
     }
 }
 
+void cboard_K16F::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, p_KEY);
+    SNAPSHOT_VAR(sn, lcd);
+    snapshot_check(sn, &mi2c.SIZE, sizeof(mi2c.SIZE), "EEPROM size");
+    unsigned char* mi2c_data = mi2c.data;  // the memory can be reallocated after the save
+    SNAPSHOT_VAR(sn, mi2c);
+    mi2c.data = mi2c_data;
+    snapshot_data(sn, mi2c.data, mi2c.SIZE);
+    SNAPSHOT_VAR(sn, rtc);
+    SNAPSHOT_VAR(sn, i2c_bus.bb);
+    SNAPSHOT_VAR(sn, i2c_bus.active);
+    SNAPSHOT_VAR(sn, lcde);
+    SNAPSHOT_VAR(sn, clko);
+    SNAPSHOT_VAR(sn, d);
+    SNAPSHOT_VAR(sn, sda);
+    SNAPSHOT_VAR(sn, sck);
+}
+
 void cboard_K16F::RefreshStatus(void) {
 #ifndef _WIN_
     if (pic.serial[0].serialfd > 0)
@@ -28,6 +28,7 @@
 
 #include "bsim_picsim.h"
 
+#include "../devices/bus_i2c.h"
 #include "../devices/lcd_hd44780.h"
 #include "../devices/mi2c_24CXXX.h"
 #include "../devices/rtc_pfc8563.h"
@@ -42,6 +43,7 @@ private:
 
     mi2c_t mi2c;
     rtc_pfc8563_t rtc;
+    bus_i2c_t i2c_bus;
 
     int lcde;
 
@@ -75,6 +77,7 @@ public:
     void RefreshStatus(void) override;
     void WritePreferences(void) override;
     void ReadPreferences(char* name, char* value) override;
+    void Snapshot(snapshot_t* sn) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
 };
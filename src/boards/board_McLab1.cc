@@ -458,7 +458,7 @@ void cboard_McLab1::Run_CPU(void) {
             }
 
             if (!mplabxd_testbp())
-                pic_step(&pic);
+                PROF_STAGE(PROF_CPU, pic_step(&pic));
             ioupdated = pic.ioupdated;
             InstCounterInc();
             if (use_oscope)
@@ -956,4 +956,10 @@ void cboard_McLab1::ReadPreferences(char* name, char* value) {
     }
 }
 
+void cboard_McLab1::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, p_BT);
+    SNAPSHOT_VAR(sn, lm1);
+    SNAPSHOT_VAR(sn, lm2);
+}
+
 board_init(BOARD_McLab1_Name, cboard_McLab1);
@@ -63,6 +63,7 @@ public:
     void EvKeyRelease(uint key, uint mask) override;
     void WritePreferences(void) override;
     void ReadPreferences(char* name, char* value) override;
+    void Snapshot(snapshot_t* sn) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
     int GetDefaultClock(void) override { return 4; };
@@ -732,7 +732,7 @@ void cboard_McLab2::Run_CPU(void) {
             }
 
             if (!mplabxd_testbp())
-                pic_step(&pic);
+                PROF_STAGE(PROF_CPU, pic_step(&pic));
             ioupdated = pic.ioupdated;
             InstCounterInc();
             if (use_oscope)
@@ -1451,4 +1451,31 @@ void cboard_McLab2::ReadPreferences(char* name, char* value) {
     }
 }
 
+void cboard_McLab2::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, p_BT);
+    SNAPSHOT_VAR(sn, pot1);
+    SNAPSHOT_VAR(sn, lcd);
+    snapshot_check(sn, &mi2c.SIZE, sizeof(mi2c.SIZE), "EEPROM size");
+    unsigned char* mi2c_data = mi2c.data;  // the memory can be reallocated after the save
+    SNAPSHOT_VAR(sn, mi2c);
+    mi2c.data = mi2c_data;
+    snapshot_data(sn, mi2c.data, mi2c.SIZE);
+    SNAPSHOT_VAR(sn, vtc);
+    SNAPSHOT_VAR(sn, vt);
+    SNAPSHOT_VAR(sn, lcde);
+    SNAPSHOT_VAR(sn, vp2in);
+    SNAPSHOT_VAR(sn, vp2);
+    SNAPSHOT_VAR(sn, temp);
+    SNAPSHOT_VAR(sn, ref);
+    SNAPSHOT_VAR(sn, rpmstp);
+    SNAPSHOT_VAR(sn, rpmc);
+    SNAPSHOT_VAR(sn, d);
+    SNAPSHOT_VAR(sn, sda);
+    SNAPSHOT_VAR(sn, sck);
+    SNAPSHOT_VAR(sn, lm1);
+    SNAPSHOT_VAR(sn, lm2);
+    SNAPSHOT_VAR(sn, lm3);
+    SNAPSHOT_VAR(sn, lm4);
+}
+
 board_init(BOARD_McLab2_Name, cboard_McLab2);
@@ -112,6 +112,7 @@ public:
     void RefreshStatus(void) override;
     void WritePreferences(void) override;
     void ReadPreferences(char* name, char* value) override;
+    void Snapshot(snapshot_t* sn) override;
     void SetScale(double scale) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
@@ -238,6 +238,9 @@ cboard_PICGenios::cboard_PICGenios(void) : font(10, lxFONTFAMILY_TELETYPE, lxFON
     lcd_init(&lcd, 16, 2);
     mi2c_init(&mi2c, 4);
     rtc_ds1307_init(&rtc2);
+    bus_i2c_init(&i2c_bus);
+    bus_i2c_attach(&i2c_bus, &mi2c.bb_i2c, mi2c_process, &mi2c);
+    bus_i2c_attach(&i2c_bus, &rtc2.bb_i2c, rtc_ds1307_I2C_process, &rtc2);
 
     ReadMaps();
 
@@ -941,13 +944,247 @@ void cboard_PICGenios::Draw(CDraw* draw) {
     // pic_set_apin(pic,5,2.5);
 }
 
+// OSCOPE and SPARE enable the oscilloscope and spare parts processing, BOUNCE enable the switches bounce
+// simulation.
+template <int OSCOPE, int SPARE, int BOUNCE>
+void cboard_PICGenios::Run_CPU_loop(unsigned int* alm, unsigned int* alm1, unsigned int* alm2, unsigned int* alm3,
+                                    unsigned int* alm4, const unsigned char* p_BT_) {
+    unsigned char pi, pj;
+    unsigned char pinv;
+    int bret;
+
+    const picpin* pins = pic.pins;
+    const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
+    const long int NSTEP = PICSimLab.GetNSTEP();
+
+    int j = JUMPSTEPS;
+    pi = 0;
+    for (long int i = 0; i < NSTEP; i++) {
+        if (j >= JUMPSTEPS) {
+            pic_set_pin(&pic, pic.mclr, p_RST);
+
+            if (!BOUNCE || !bounce.do_bounce) {
+                pic_set_pin(&pic, 33, p_BT_[0]);
+                pic_set_pin(&pic, 34, p_BT_[1]);
+                pic_set_pin(&pic, 35, p_BT_[2]);
+                pic_set_pin(&pic, 36, p_BT_[3]);
+                pic_set_pin(&pic, 37, p_BT_[4]);
+                pic_set_pin(&pic, 38, p_BT_[5]);
+                pic_set_pin(&pic, 7, p_BT_[6]);
+            }
+
+            /*
+                pic_set_pin(&pic, 39, 1);
+                pic_set_pin(&pic, 40, 1);
+                pic_set_pin(&pic, 19,1);
+                pic_set_pin(&pic, 20,1);
+                pic_set_pin(&pic, 21,1);
+                pic_set_pin(&pic, 22,1);
+                pic_set_pin(&pic, 27,1);
+                pic_set_pin(&pic, 28,1);
+                pic_set_pin(&pic, 29,1);
+                pic_set_pin(&pic, 30,1);
+                 */
+
+            // keyboard
+
+            if (p_KEY[0]) {
+                pic_set_pin(&pic, 22, pic_get_pin(&pic, 33));
+                pic_set_pin(&pic, 33, pic_get_pin(&pic, 22));
+            }
+
+            if (p_KEY[1]) {
+                pic_set_pin(&pic, 22, pic_get_pin(&pic, 34));
+                pic_set_pin(&pic, 34, pic_get_pin(&pic, 22));
+            }
+
+            if (p_KEY[2]) {
+                pic_set_pin(&pic, 22, pic_get_pin(&pic, 35));
+                pic_set_pin(&pic, 35, pic_get_pin(&pic, 22));
+            }
+
+            if (p_KEY[3]) {
+                pic_set_pin(&pic, 21, pic_get_pin(&pic, 33));
+                pic_set_pin(&pic, 33, pic_get_pin(&pic, 21));
+            }
+
+            if (p_KEY[4]) {
+                pic_set_pin(&pic, 21, pic_get_pin(&pic, 34));
+                pic_set_pin(&pic, 34, pic_get_pin(&pic, 21));
+            }
+
+            if (p_KEY[5]) {
+                pic_set_pin(&pic, 21, pic_get_pin(&pic, 35));
+                pic_set_pin(&pic, 35, pic_get_pin(&pic, 21));
+            }
+
+            if (p_KEY[6]) {
+                pic_set_pin(&pic, 20, pic_get_pin(&pic, 33));
+                pic_set_pin(&pic, 33, pic_get_pin(&pic, 20));
+            }
+
+            if (p_KEY[7]) {
+                pic_set_pin(&pic, 20, pic_get_pin(&pic, 34));
+                pic_set_pin(&pic, 34, pic_get_pin(&pic, 20));
+            }
+
+            if (p_KEY[8]) {
+                pic_set_pin(&pic, 20, pic_get_pin(&pic, 35));
+                pic_set_pin(&pic, 35, pic_get_pin(&pic, 20));
+            }
+
+            if (p_KEY[9]) {
+                pic_set_pin(&pic, 19, pic_get_pin(&pic, 33));
+                pic_set_pin(&pic, 33, pic_get_pin(&pic, 19));
+            }
+
+            if (p_KEY[10]) {
+                pic_set_pin(&pic, 19, pic_get_pin(&pic, 34));
+                pic_set_pin(&pic, 34, pic_get_pin(&pic, 19));
+            }
+
+            if (p_KEY[11]) {
+                pic_set_pin(&pic, 19, pic_get_pin(&pic, 35));
+                pic_set_pin(&pic, 35, pic_get_pin(&pic, 19));
+            }
+
+            if (dip[14]) {
+                if (cooler_pwr > 55) {
+                    rpmc++;
+                    if (rpmc > rpmstp) {
+                        rpmc = 0;
+                        pic_set_pin(&pic, 15, !pins[14].value);
+                    }
+                } else
+                    pic_set_pin(&pic, 15, 0);
+            }
+        }
+
+        if (BOUNCE && bounce.do_bounce) {
+            bret = SWBounce_process(&bounce);
+            if (bret) {
+                for (int pl = 0; pl < 6; pl++) {
+                    if (bounce.bounce[pl]) {
+                        if (bret == 1) {
+                            pic_set_pin(&pic, 33 + pl, !pins[33 + pl - 1].value);
+                        } else {
+                            pic_set_pin(&pic, 33 + pl, p_BT_[pl]);
+                        }
+                    }
+                }
+                if (bounce.bounce[6]) {
+                    if (bret == 1) {
+                        pic_set_pin(&pic, 7, !pins[7 - 1].value);
+                    } else {
+                        pic_set_pin(&pic, 7, p_BT_[6]);
+                    }
+                }
+            }
+        }
+
+        if (!mplabxd_testbp())
+            PROF_STAGE(PROF_CPU, pic_step(&pic));
+        ioupdated = pic.ioupdated;
+        InstCounterInc();
+        if (OSCOPE)
+            Oscilloscope.SetSample();
+        if (SPARE)
+            SpareParts.Process();
+
+        // increment mean value counter if pin is high
+        alm[pi] += pins[pi].value;
+        pi++;
+        if (pi == pic.PINCOUNT)
+            pi = 0;
+
+        if (j >= JUMPSTEPS) {
+            for (pj = 18; pj < 30; pj++) {
+                pinv = pins[pj].value;
+                if ((pinv) && (pins[3].value) && (dip[10]))
+                    alm1[pj]++;
+                if ((pinv) && (pins[4].value) && (dip[11]))
+                    alm2[pj]++;
+                if ((pinv) && (pins[5].value) && (dip[12]))
+                    alm3[pj]++;
+                if ((pinv) && (pins[6].value) && (dip[13]))
+                    alm4[pj]++;
+            }
+
+            if (dip[7])
+                alm[32] = 0;
+
+            // potenciometro p1 e p2
+            if (dip[18])
+                pic_set_apin(&pic, 2, vp1in);
+            if (dip[19])
+                pic_set_apin(&pic, 3, vp2in);
+
+            j = -1;
+        }
+        j++;
+
+        if (ioupdated) {
+            // lcd dipins[2].display code
+
+            if ((!pins[8].dir) && (!pins[8].value)) {
+                if (!lcde) {
+                    d = 0;
+                    if (pins[29].value)
+                        d |= 0x80;
+                    if (pins[28].value)
+                        d |= 0x40;
+                    if (pins[27].value)
+                        d |= 0x20;
+                    if (pins[26].value)
+                        d |= 0x10;
+                    if (pins[21].value)
+                        d |= 0x08;
+                    if (pins[20].value)
+                        d |= 0x04;
+                    if (pins[19].value)
+                        d |= 0x02;
+                    if (pins[18].value)
+                        d |= 0x01;
+
+                    if ((!pins[9].dir) && (!pins[9].value)) {
+                        lcd_cmd(&lcd, d);
+                    } else if ((!pins[9].dir) && (pins[9].value)) {
+                        lcd_data(&lcd, d);
+                    }
+                    lcde = 1;
+                }
+            } else {
+                lcde = 0;
+            }
+            // end display code
+
+            // i2c code
+            if (pins[22].dir) {
+                sda = 1;
+            } else {
+                sda = pins[22].value;
+            }
+
+            if (pins[17].dir) {
+                sck = 1;
+                if (dip[5]) {
+                    pic_set_pin(&pic, 18, 1);
+                }
+            } else {
+                sck = pins[17].value;
+            }
+            if (dip[6]) {
+                pic_set_pin(&pic, 23, bus_i2c_io(&i2c_bus, sck, sda));
+            }
+        }
+        pic.ioupdated = 0;
+    }
+}
+
 void cboard_PICGenios::Run_CPU(void) {
     int i;
     int j;
-    unsigned char pi, pj;
-    unsigned char pinv;
     const picpin* pins;
-    int bret;
 
     unsigned int alm[40];   // luminosidade media
     unsigned int alm1[40];  // luminosidade media display
@@ -955,7 +1192,6 @@ void cboard_PICGenios::Run_CPU(void) {
     unsigned int alm3[40];  // luminosidade media display
     unsigned int alm4[40];  // luminosidade media display
 
-    const int JUMPSTEPS = PICSimLab.GetJUMPSTEPS();
     const long int NSTEPJ = PICSimLab.GetNSTEPJ();
     const long int NSTEP = PICSimLab.GetNSTEP();
     const float RNSTEP = 200.0 * pic.PINCOUNT / NSTEP;
@@ -1003,229 +1239,35 @@ void cboard_PICGenios::Run_CPU(void) {
         SWBounce_bounce(&bounce, 6);
     }
 
-    j = JUMPSTEPS;
-    pi = 0;
-    if (PICSimLab.GetMcuPwr())
-        for (i = 0; i < NSTEP; i++) {
-            if (j >= JUMPSTEPS) {
-                pic_set_pin(&pic, pic.mclr, p_RST);
-
-                if (!bounce.do_bounce) {
-                    pic_set_pin(&pic, 33, p_BT_[0]);
-                    pic_set_pin(&pic, 34, p_BT_[1]);
-                    pic_set_pin(&pic, 35, p_BT_[2]);
-                    pic_set_pin(&pic, 36, p_BT_[3]);
-                    pic_set_pin(&pic, 37, p_BT_[4]);
-                    pic_set_pin(&pic, 38, p_BT_[5]);
-                    pic_set_pin(&pic, 7, p_BT_[6]);
-                }
-
-                /*
-                    pic_set_pin(&pic, 39, 1);
-                    pic_set_pin(&pic, 40, 1);
-                    pic_set_pin(&pic, 19,1);
-                    pic_set_pin(&pic, 20,1);
-                    pic_set_pin(&pic, 21,1);
-                    pic_set_pin(&pic, 22,1);
-                    pic_set_pin(&pic, 27,1);
-                    pic_set_pin(&pic, 28,1);
-                    pic_set_pin(&pic, 29,1);
-                    pic_set_pin(&pic, 30,1);
-                     */
-
-                // keyboard
-
-                if (p_KEY[0]) {
-                    pic_set_pin(&pic, 22, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 22));
-                }
-
-                if (p_KEY[1]) {
-                    pic_set_pin(&pic, 22, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 22));
-                }
-
-                if (p_KEY[2]) {
-                    pic_set_pin(&pic, 22, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 22));
-                }
-
-                if (p_KEY[3]) {
-                    pic_set_pin(&pic, 21, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 21));
-                }
-
-                if (p_KEY[4]) {
-                    pic_set_pin(&pic, 21, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 21));
-                }
-
-                if (p_KEY[5]) {
-                    pic_set_pin(&pic, 21, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 21));
-                }
-
-                if (p_KEY[6]) {
-                    pic_set_pin(&pic, 20, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 20));
-                }
-
-                if (p_KEY[7]) {
-                    pic_set_pin(&pic, 20, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 20));
-                }
-
-                if (p_KEY[8]) {
-                    pic_set_pin(&pic, 20, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 20));
-                }
-
-                if (p_KEY[9]) {
-                    pic_set_pin(&pic, 19, pic_get_pin(&pic, 33));
-                    pic_set_pin(&pic, 33, pic_get_pin(&pic, 19));
-                }
-
-                if (p_KEY[10]) {
-                    pic_set_pin(&pic, 19, pic_get_pin(&pic, 34));
-                    pic_set_pin(&pic, 34, pic_get_pin(&pic, 19));
-                }
-
-                if (p_KEY[11]) {
-                    pic_set_pin(&pic, 19, pic_get_pin(&pic, 35));
-                    pic_set_pin(&pic, 35, pic_get_pin(&pic, 19));
-                }
-
-                if (dip[14]) {
-                    if (cooler_pwr > 55) {
-                        rpmc++;
-                        if (rpmc > rpmstp) {
-                            rpmc = 0;
-                            pic_set_pin(&pic, 15, !pins[14].value);
-                        }
-                    } else
-                        pic_set_pin(&pic, 15, 0);
-                }
-            }
-
-            if (bounce.do_bounce) {
-                bret = SWBounce_process(&bounce);
-                if (bret) {
-                    for (int pl = 0; pl < 6; pl++) {
-                        if (bounce.bounce[pl]) {
-                            if (bret == 1) {
-                                pic_set_pin(&pic, 33 + pl, !pins[33 + pl - 1].value);
-                            } else {
-                                pic_set_pin(&pic, 33 + pl, p_BT_[pl]);
-                            }
-                        }
-                    }
-                    if (bounce.bounce[6]) {
-                        if (bret == 1) {
-                            pic_set_pin(&pic, 7, !pins[7 - 1].value);
-                        } else {
-                            pic_set_pin(&pic, 7, p_BT_[6]);
-                        }
-                    }
-                }
-            }
-
-            if (!mplabxd_testbp())
-                pic_step(&pic);
-            ioupdated = pic.ioupdated;
-            InstCounterInc();
-            if (use_oscope)
-                Oscilloscope.SetSample();
-            if (use_spare)
-                SpareParts.Process();
-
-            // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pic.PINCOUNT)
-                pi = 0;
-
-            if (j >= JUMPSTEPS) {
-                for (pj = 18; pj < 30; pj++) {
-                    pinv = pins[pj].value;
-                    if ((pinv) && (pins[3].value) && (dip[10]))
-                        alm1[pj]++;
-                    if ((pinv) && (pins[4].value) && (dip[11]))
-                        alm2[pj]++;
-                    if ((pinv) && (pins[5].value) && (dip[12]))
-                        alm3[pj]++;
-                    if ((pinv) && (pins[6].value) && (dip[13]))
-                        alm4[pj]++;
-                }
-
-                if (dip[7])
-                    alm[32] = 0;
-
-                // potenciometro p1 e p2
-                if (dip[18])
-                    pic_set_apin(&pic, 2, vp1in);
-                if (dip[19])
-                    pic_set_apin(&pic, 3, vp2in);
-
-                j = -1;
-            }
-            j++;
-
-            if (ioupdated) {
-                // lcd dipins[2].display code
-
-                if ((!pins[8].dir) && (!pins[8].value)) {
-                    if (!lcde) {
-                        d = 0;
-                        if (pins[29].value)
-                            d |= 0x80;
-                        if (pins[28].value)
-                            d |= 0x40;
-                        if (pins[27].value)
-                            d |= 0x20;
-                        if (pins[26].value)
-                            d |= 0x10;
-                        if (pins[21].value)
-                            d |= 0x08;
-                        if (pins[20].value)
-                            d |= 0x04;
-                        if (pins[19].value)
-                            d |= 0x02;
-                        if (pins[18].value)
-                            d |= 0x01;
-
-                        if ((!pins[9].dir) && (!pins[9].value)) {
-                            lcd_cmd(&lcd, d);
-                        } else if ((!pins[9].dir) && (pins[9].value)) {
-                            lcd_data(&lcd, d);
-                        }
-                        lcde = 1;
-                    }
-                } else {
-                    lcde = 0;
-                }
-                // end display code
-
-                // i2c code
-                if (pins[22].dir) {
-                    sda = 1;
-                } else {
-                    sda = pins[22].value;
-                }
-
-                if (pins[17].dir) {
-                    sck = 1;
-                    if (dip[5]) {
-                        pic_set_pin(&pic, 18, 1);
-                    }
-                } else {
-                    sck = pins[17].value;
-                }
-                if (dip[6]) {
-                    pic_set_pin(&pic, 23, mi2c_io(&mi2c, sck, sda) & rtc_ds1307_I2C_io(&rtc2, sck, sda));
-                }
-            }
-            pic.ioupdated = 0;
+    if (PICSimLab.GetMcuPwr()) {
+        // the loop is specialized for the enabled features
+        switch ((use_oscope ? 4 : 0) | (use_spare ? 2 : 0) | (bounce.do_bounce ? 1 : 0)) {
+            case 0:
+                Run_CPU_loop<0, 0, 0>(alm, alm1, alm2, alm3, alm4, p_BT_);
+                break;
+            case 1:
+                Run_CPU_loop<0, 0, 1>(alm, alm1, alm2, alm3, alm4, p_BT_);
+                break;
+            case 2:
+                Run_CPU_loop<0, 1, 0>(alm, alm1, alm2, alm3, alm4, p_BT_);
+                break;
+            case 3:
+                Run_CPU_loop<0, 1, 1>(alm, alm1, alm2, alm3, alm4, p_BT_);
+                break;
+            case 4:
+                Run_CPU_loop<1, 0, 0>(alm, alm1, alm2, alm3, alm4, p_BT_);
+                break;
+            case 5:
+                Run_CPU_loop<1, 0, 1>(alm, alm1, alm2, alm3, alm4, p_BT_);
+                break;
+            case 6:
+                Run_CPU_loop<1, 1, 0>(alm, alm1, alm2, alm3, alm4, p_BT_);
+                break;
+            case 7:
+                Run_CPU_loop<1, 1, 1>(alm, alm1, alm2, alm3, alm4, p_BT_);
+                break;
         }
+    }
 
     // fim STEP
 
@@ -1308,6 +1350,7 @@ void cboard_PICGenios::Reset(void) {
     lcd_rst(&lcd);
     mi2c_rst(&mi2c);
     rtc_ds1307_rst(&rtc2);
+    bus_i2c_rst(&i2c_bus);
 
     p_BT[0] = 1;
     p_BT[1] = 1;
@@ -2477,6 +2520,40 @@ void cboard_PICGenios::ReadPreferences(char* name, char* value) {
     }
 }
 
+void cboard_PICGenios::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, p_BT);
+    SNAPSHOT_VAR(sn, p_KEY);
+    SNAPSHOT_VAR(sn, pot);
+    SNAPSHOT_VAR(sn, vtc);
+    SNAPSHOT_VAR(sn, vt);
+    SNAPSHOT_VAR(sn, lcd);
+    snapshot_check(sn, &mi2c.SIZE, sizeof(mi2c.SIZE), "EEPROM size");
+    unsigned char* mi2c_data = mi2c.data;  // the memory can be reallocated after the save
+    SNAPSHOT_VAR(sn, mi2c);
+    mi2c.data = mi2c_data;
+    snapshot_data(sn, mi2c.data, mi2c.SIZE);
+    SNAPSHOT_VAR(sn, rtc2);
+    SNAPSHOT_VAR(sn, i2c_bus.bb);
+    SNAPSHOT_VAR(sn, i2c_bus.active);
+    SNAPSHOT_VAR(sn, lcde);
+    SNAPSHOT_VAR(sn, vp1in);
+    SNAPSHOT_VAR(sn, vp2in);
+    SNAPSHOT_VAR(sn, vp2);
+    SNAPSHOT_VAR(sn, temp);
+    SNAPSHOT_VAR(sn, ref);
+    SNAPSHOT_VAR(sn, rpmstp);
+    SNAPSHOT_VAR(sn, rpmc);
+    SNAPSHOT_VAR(sn, d);
+    SNAPSHOT_VAR(sn, sda);
+    SNAPSHOT_VAR(sn, sck);
+    SNAPSHOT_VAR(sn, lm1);
+    SNAPSHOT_VAR(sn, lm2);
+    SNAPSHOT_VAR(sn, lm3);
+    SNAPSHOT_VAR(sn, lm4);
+    SNAPSHOT_VAR(sn, heater_pwr);
+    SNAPSHOT_VAR(sn, cooler_pwr);
+}
+
 // Change lcd
 
 void cboard_PICGenios::board_Event(CControl* control) {
@@ -26,6 +26,7 @@
 #ifndef BOARD_PICGenios_H
 #define BOARD_PICGenios_H
 
+#include "../devices/bus_i2c.h"
 #include "../devices/lcd_hd44780.h"
 #include "../devices/mi2c_24CXXX.h"
 #include "../devices/rtc_ds1307.h"
@@ -50,6 +51,7 @@ private:
 
     mi2c_t mi2c;
     rtc_ds1307_t rtc2;
+    bus_i2c_t i2c_bus;
 
     int lcde;
 
@@ -97,6 +99,10 @@ private:
     lxFont font;
     SWBounce_t bounce;
 
+    template <int OSCOPE, int SPARE, int BOUNCE>
+    void Run_CPU_loop(unsigned int* alm, unsigned int* alm1, unsigned int* alm2, unsigned int* alm3,
+                      unsigned int* alm4, const unsigned char* p_BT_);
+
     int heater_pwr;
     int cooler_pwr;
 
@@ -125,6 +131,7 @@ public:
     void RefreshStatus(void) override;
     void WritePreferences(void) override;
     void ReadPreferences(char* name, char* value) override;
+    void Snapshot(snapshot_t* sn) override;
     unsigned short GetInputId(char* name) override;
     unsigned short GetOutputId(char* name) override;
     void board_Event(CControl* control) override;
@@ -624,7 +624,7 @@ void cboard_PQDB::Run_CPU(void) {
             }
 
             if (!mplabxd_testbp())
-                pic_step(&pic);
+                PROF_STAGE(PROF_CPU, pic_step(&pic));
             ioupdated = pic.ioupdated;
             InstCounterInc();
             if (use_oscope)
@@ -1487,6 +1487,31 @@ void cboard_PQDB::ReadPreferences(char* name, char* value) {
     }
 }
 
+void cboard_PQDB::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, p_KEY);
+    SNAPSHOT_VAR(sn, pot);
+    SNAPSHOT_VAR(sn, vtc);
+    SNAPSHOT_VAR(sn, vt);
+    SNAPSHOT_VAR(sn, lcd);
+    SNAPSHOT_VAR(sn, d);
+    SNAPSHOT_VAR(sn, rtc2);
+    SNAPSHOT_VAR(sn, sda);
+    SNAPSHOT_VAR(sn, sck);
+    SNAPSHOT_VAR(sn, shiftReg);
+    SNAPSHOT_VAR(sn, srDATA);
+    SNAPSHOT_VAR(sn, srCLK);
+    SNAPSHOT_VAR(sn, srLAT);
+    SNAPSHOT_VAR(sn, shiftReg_alm);
+    SNAPSHOT_VAR(sn, _srret);
+    SNAPSHOT_VAR(sn, lcde);
+    SNAPSHOT_VAR(sn, vp2);
+    SNAPSHOT_VAR(sn, temp);
+    SNAPSHOT_VAR(sn, ref);
+    SNAPSHOT_VAR(sn, rpmstp);
+    SNAPSHOT_VAR(sn, rpmc);
+    SNAPSHOT_VAR(sn, lm7seg);
+}
+
 lxString cboard_PQDB::MGetPinName(int pin) {
     if (pin <= bsim_picsim::MGetPinCount()) {
         lxString pname = bsim_picsim::MGetPinName(pin);
@@ -306,7 +306,7 @@ void cboard_gpboard::Run_CPU(void) {
              }
              */
             // verify if a breakpoint is reached if not run one instruction
-            MStep();
+            PROF_STAGE(PROF_CPU, MStep());
             InstCounterInc();
             // Oscilloscope window process
             if (use_oscope)
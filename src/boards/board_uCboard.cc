@@ -296,6 +296,7 @@ void cboard_uCboard::Run_CPU(void) {
     // int j;
     unsigned char pi;
     unsigned int alm[64];
+    unsigned char values[64];  // pins values before the batch
     const int pinc = MGetPinCount();
 
     // const int JUMPSTEPS = Window1.GetJUMPSTEPS (); //number of steps skipped
@@ -320,9 +321,17 @@ void cboard_uCboard::Run_CPU(void) {
              {
              }
              */
-            // verify if a breakpoint is reached if not run one instruction
-            MStep();
-            InstCounterInc();
+            uint32_t steps = 1;
+            const uint32_t batch = StepBatch(NSTEP - i);
+            if (batch > 1) {
+                // run until an IO change or the next timer deadline
+                MeanValueSave(values, pins, pinc);
+                PROF_STAGE(PROF_CPU, steps = MStepUntil(batch));
+            } else {
+                // verify if a breakpoint is reached if not run one instruction
+                PROF_STAGE(PROF_CPU, MStep());
+            }
+            InstCounterAdd(steps);
             // Oscilloscope window process
             if (use_oscope)
                 Oscilloscope.SetSample();
@@ -331,10 +340,15 @@ void cboard_uCboard::Run_CPU(void) {
                 SpareParts.Process();
 
             // increment mean value counter if pin is high
-            alm[pi] += pins[pi].value;
-            pi++;
-            if (pi == pinc)
-                pi = 0;
+            if (steps == 1) {
+                alm[pi] += pins[pi].value;
+                pi++;
+                if (pi == pinc)
+                    pi = 0;
+            } else {
+                MeanValueBatch(alm, values, pins, pinc, &pi, steps);
+                i += steps - 1;
+            }
             /*
             if (j >= JUMPSTEPS)//if number of step is bigger than steps to skip
              {
@@ -299,6 +299,12 @@ void cboard_x::ReadPreferences(char* name, char* value) {
     }
 }
 
+void cboard_x::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, p_BT1);
+    SNAPSHOT_VAR(sn, p_BT2);
+    SNAPSHOT_VAR(sn, pot1);
+}
+
 // Event on the board
 
 void cboard_x::EvKeyPress(uint key, uint mask) {
@@ -651,7 +657,7 @@ void cboard_x::Run_CPU(void) {
 
             // verify if a breakpoint is reached if not run one instruction
             if (!mplabxd_testbp())
-                pic_step(&pic);
+                PROF_STAGE(PROF_CPU, pic_step(&pic));
             ioupdated = pic.ioupdated;
             InstCounterInc();
             // Oscilloscope window process
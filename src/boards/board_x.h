@@ -90,6 +90,7 @@ public:
     void WritePreferences(void) override;
     // Called whe configuration file load  preferences
     void ReadPreferences(char* name, char* value) override;
+    void Snapshot(snapshot_t* sn) override;
     // return the input ids numbers of names used in input map
     unsigned short GetInputId(char* name) override;
     // return the output ids numbers of names used in output map
@@ -32,6 +32,7 @@ bsim_picsim::bsim_picsim(void) {
 }
 
 void bsim_picsim::MSetSerial(const char* port) {
+    // TODO picsim: the port is opened, read and written inside pic_step, it can't be served by the serial streams
     pic_set_serial(&pic, 0, port, 0, 0, 0);
     pic_set_serial(&pic, 1, "", 0, 0, 0);
 }
@@ -182,6 +183,21 @@ void bsim_picsim::MStep(void) {
         pic_step(&pic);
 }
 
+uint32_t bsim_picsim::MStepUntil(const uint32_t max) {
+    uint32_t i = 0;
+    const int bp = mplabxd_bp_count();
+
+    while (i < max) {
+        pic_step(&pic);
+        i++;
+        // stop at a breakpoint before the next instruction
+        if (pic.ioupdated || (bp && mplabxd_testbp())) {
+            break;
+        }
+    }
+    return i;
+}
+
 void bsim_picsim::MStepResume(void) {
     if (pic.s2 == 1)
         pic_step(&pic);
@@ -191,6 +207,33 @@ void bsim_picsim::MReset(int flags) {
     pic_reset(&pic, flags);
 }
 
+int bsim_picsim::MSnapshot(snapshot_t* sn) {
+    if (sn->load) {
+        const _pic* saved = (const _pic*)snapshot_peek(sn, sizeof(_pic));
+        if ((!saved) || (saved->ram != pic.ram) || (saved->prog != pic.prog) || (saved->eeprom != pic.eeprom) ||
+            (saved->pins != pic.pins) || (saved->RAMSIZE != pic.RAMSIZE) || (saved->ROMSIZE != pic.ROMSIZE)) {
+            snapshot_set_error(sn, "microcontroller memory don't match");
+            return -1;
+        }
+        // the serial port can be reopened after the save
+        serialfd_t serialfd[2] = {pic.serial[0].serialfd, pic.serial[1].serialfd};
+        SNAPSHOT_VAR(sn, pic);
+        pic.serial[0].serialfd = serialfd[0];
+        pic.serial[1].serialfd = serialfd[1];
+    } else {
+        SNAPSHOT_VAR(sn, pic);
+    }
+
+    snapshot_data(sn, pic.ram, pic.RAMSIZE);
+    snapshot_data(sn, pic.prog, pic.ROMSIZE * 2);
+    snapshot_data(sn, pic.eeprom, pic.EEPROMSIZE);
+    snapshot_data(sn, pic.config, pic.CONFIGSIZE * 2);
+    snapshot_data(sn, pic.id, pic.IDSIZE * 2);
+    snapshot_data(sn, pic.pins, sizeof(picpin) * 256);
+
+    return sn->error ? -1 : 0;
+}
+
 unsigned short* bsim_picsim::DBGGetProcID_p(void) {
     return (unsigned short*)&pic.processor;
 }
@@ -56,8 +56,11 @@ public:
     unsigned char MGetPin(int pin) override;
     const picpin* MGetPinsValues(void) override;
     void MStep(void) override;
+    uint32_t MStepUntil(const uint32_t max) override;
     void MStepResume(void) override;
     void MReset(int flags) override;
+    int MSnapshot(snapshot_t* sn) override;
+    // TODO picsim: MGetIdleSteps, the WDT and timers run in pic_step during the sleep and there is no next event API
     unsigned short* DBGGetProcID_p(void) override;
     unsigned int DBGGetPC(void) override;
     void DBGSetPC(unsigned int pc) override;
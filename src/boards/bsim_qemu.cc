@@ -30,6 +30,7 @@
 
 #include "../lib/picsimlab.h"
 #include "../lib/serial_port.h"
+#include "../lib/spareparts.h"
 #include "bsim_qemu.h"
 
 #define dprintf \
@@ -91,10 +92,13 @@ static int64_t GotoNow(void) {
 
 static void picsimlab_write_pin(int pin, int value) {
     // printf("================> IO    <====================== %ji\n", now - g_board->timer.last);
-    ioupdated = 1;
+    g_board->SetIOUpdated(1);
     g_board->Run_CPU_ns(GotoNow());
 
-    g_pins[pin - 1].value = value;
+    if (g_pins[pin - 1].value != value) {
+        g_pins[pin - 1].value = value;
+        SpareParts.UpdateSPILinkCS();  // chip select of the linked SPI devices
+    }
     // printf("pin[%i]=%i\n", pin, value);
 }
 
@@ -102,11 +106,11 @@ static void picsimlab_dir_pins(int pin, int dir) {
     // printf("================> IO    <====================== %ji\n", now - g_board->timer.last);
 
     if (pin > 0) {  // normal io
-        ioupdated = 1;
+        g_board->SetIOUpdated(1);
         g_board->Run_CPU_ns(GotoNow());
         g_pins[pin - 1].dir = !dir;
     } else if (dir == -1) {  // sync input
-        ioupdated = 1;
+        g_board->SetIOUpdated(1);
         g_board->Run_CPU_ns(GotoNow());
     } else {  // especial pin cfg
         g_board->PinsExtraConfig(-dir);
@@ -114,29 +118,50 @@ static void picsimlab_dir_pins(int pin, int dir) {
     // printf("pin[%i]=%s\n", pin, (!dir == PD_IN) ? "PD_IN" : "PD_OUT");
 }
 
+// with a spare parts bus link the transactions are delivered to the addressed device without driving the pins,
+// the simulated time advances as in the pins transfer
 static int picsimlab_i2c_event(const uint8_t id, const uint8_t addr, const uint16_t event) {
+    unsigned char data;
+
     g_board->Run_CPU_ns(GotoNow());
 
     switch (event & 0xFF) {
         case I2C_START_RECV:
         case I2C_START_SEND:
+            g_board->i2c_link[id] =
+                SpareParts.GetI2CLink(g_board->master_i2c[id].scl_pin, g_board->master_i2c[id].sda_pin);
 
-            bitbang_i2c_ctrl_start(&g_board->master_i2c[id]);
+            if (!g_board->i2c_link[id]) {
+                bitbang_i2c_ctrl_start(&g_board->master_i2c[id]);
+            }
             g_board->timer.last += 8000;
             g_board->Run_CPU_ns(8000);
 
             if (event == I2C_START_RECV) {
-                bitbang_i2c_ctrl_write(&g_board->master_i2c[id], (addr << 1) | 0x01);
+                if (g_board->i2c_link[id]) {
+                    bus_i2c_start(g_board->i2c_link[id], (addr << 1) | 0x01);
+                } else {
+                    bitbang_i2c_ctrl_write(&g_board->master_i2c[id], (addr << 1) | 0x01);
+                }
                 dprintf(">>> start recv =0x%02x\n", addr);
             } else {
-                bitbang_i2c_ctrl_write(&g_board->master_i2c[id], addr << 1);
+                if (g_board->i2c_link[id]) {
+                    bus_i2c_start(g_board->i2c_link[id], addr << 1);
+                } else {
+                    bitbang_i2c_ctrl_write(&g_board->master_i2c[id], addr << 1);
+                }
                 dprintf(">>> start send =0x%02x\n", addr);
             }
             g_board->timer.last += 72000;
             g_board->Run_CPU_ns(72000);
             break;
         case I2C_FINISH:
-            bitbang_i2c_ctrl_stop(&g_board->master_i2c[id]);
+            if (g_board->i2c_link[id]) {
+                bus_i2c_stop(g_board->i2c_link[id]);
+                g_board->i2c_link[id] = NULL;
+            } else {
+                bitbang_i2c_ctrl_stop(&g_board->master_i2c[id]);
+            }
             g_board->timer.last += 8000;
             g_board->Run_CPU_ns(8000);
             dprintf("<<< stop =0x%02x\n", addr);
@@ -145,36 +170,59 @@ static int picsimlab_i2c_event(const uint8_t id, const uint8_t addr, const uint1
             break;
         case I2C_WRITE:
             dprintf("==> send addr=0x%02x value=0x%02x\n", addr, event >> 8);
-            bitbang_i2c_ctrl_write(&g_board->master_i2c[id], event >> 8);  // TODO verify ACK
+            if (g_board->i2c_link[id]) {
+                bus_i2c_write(g_board->i2c_link[id], event >> 8);
+            } else {
+                bitbang_i2c_ctrl_write(&g_board->master_i2c[id], event >> 8);  // TODO verify ACK
+            }
             g_board->timer.last += 72000;
             g_board->Run_CPU_ns(72000);
             return 1;
             break;
         case I2C_READ:
-            bitbang_i2c_ctrl_read(&g_board->master_i2c[id]);  // TODO verify ACK
+            if (g_board->i2c_link[id]) {
+                data = bus_i2c_read(g_board->i2c_link[id]);
+            } else {
+                bitbang_i2c_ctrl_read(&g_board->master_i2c[id]);  // TODO verify ACK
+            }
             g_board->timer.last += 72000;
             g_board->Run_CPU_ns(72000);
-            dprintf("<== recv addr=0x%02x value=0x%02x\n", addr, g_board->master_i2c[id].datar);
-            return g_board->master_i2c[id].datar;
+            if (!g_board->i2c_link[id]) {
+                data = g_board->master_i2c[id].datar;
+            }
+            dprintf("<== recv addr=0x%02x value=0x%02x\n", addr, data);
+            return data;
             break;
     }
     return 0;
 }
 
+// with a spare parts bus link the byte is transferred to the selected devices without driving the pins
 static uint8_t picsimlab_spi_event(const uint8_t id, const uint16_t event) {
     g_board->Run_CPU_ns(GotoNow());
     uint64_t cycle_ns = g_board->TimerGet_ns(g_board->master_spi[id].TimerID);
+    bus_spi_t* link;
+    uint8_t data;
 
     switch (event & 0xFF) {
         case 0:  // tranfer
             // printf("SPI MASTER SEND 0x%02X\n", event >> 8);
-            bitbang_spi_ctrl_write(&g_board->master_spi[id], event >> 8);
+            link = SpareParts.GetSPILink(g_board->master_spi[id].sck_pin, g_board->master_spi[id].copi_pin,
+                                         g_board->master_spi[id].cipo_pin);
+            if (link) {
+                data = bus_spi_transfer(link, event >> 8);
+            } else {
+                bitbang_spi_ctrl_write(&g_board->master_spi[id], event >> 8);
+            }
             g_board->timer.last += cycle_ns * 36;
             g_board->Run_CPU_ns(cycle_ns * 36);
-            return g_board->master_spi[id].data8;
+            if (!link) {
+                data = g_board->master_spi[id].data8;
+            }
+            return data;
             break;
         case 1:  // CS
-            ioupdated = 1;
+            g_board->SetIOUpdated(1);
             // printf("SPI MASTER CS 0x%02X\n", event >> 8);
             switch (event >> 9) {
                 case 0:
@@ -296,6 +344,8 @@ bsim_qemu::bsim_qemu(void) {
 
     bitbang_i2c_ctrl_init(&master_i2c[0], this);
     bitbang_i2c_ctrl_init(&master_i2c[1], this);
+    i2c_link[0] = NULL;
+    i2c_link[1] = NULL;
     bitbang_spi_ctrl_init(&master_spi[0], this);
     bitbang_spi_ctrl_init(&master_spi[1], this);
     bitbang_uart_init(&master_uart[0], this, picsimlab_uart_rx_event, (void*)&id[0]);
@@ -375,7 +425,7 @@ static void user_timeout_cb(void* opaque) {
     int64_t now = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
     timer_mod_ns(board->timer.qtimer, now + board->timer.timeout);
     if (PICSimLab.GetSimulationRun()) {
-        ioupdated = 0;
+        board->SetIOUpdated(0);
         board->Run_CPU_ns(GotoNow());
     }
     board->timer.last = now;
@@ -562,7 +612,8 @@ void bsim_qemu::EvThreadRun(CThread& thread) {
     // verify if serial port exists
     if (resp) {
         if (strstr(resp, SERIALDEVICE)) {
-            // try open
+            // the qemu chardev opens the port, the emulated uart speed is not known here and the chardev feeds
+            // the uart whenever its receive register is free
             serialfd_t serialfd;
             if (serial_port_open(&serialfd, SERIALDEVICE)) {
                 serial_port_close(serialfd);
@@ -884,6 +935,8 @@ void bsim_qemu::MReset(int flags) {
     }
     bitbang_i2c_rst(&master_i2c[0]);
     bitbang_i2c_rst(&master_i2c[1]);
+    i2c_link[0] = NULL;
+    i2c_link[1] = NULL;
     bitbang_spi_rst(&master_spi[0]);
     bitbang_spi_rst(&master_spi[1]);
     bitbang_uart_rst(&master_uart[0]);
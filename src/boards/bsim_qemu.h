@@ -29,6 +29,7 @@
 #include "../devices/bitbang_i2c.h"
 #include "../devices/bitbang_spi.h"
 #include "../devices/bitbang_uart.h"
+#include "../devices/bus_i2c.h"
 #include "../lib/board.h"
 #include "qemu.h"
 
@@ -68,6 +69,7 @@ public:
     user_timer_t timer;
     virtual void Run_CPU_ns(uint64_t time) = 0;
     bitbang_i2c_t master_i2c[2];
+    bus_i2c_t* i2c_link[2];  // spare parts bus served by transactions, NULL to drive the pins
     bitbang_spi_t master_spi[2];
     bitbang_uart_t master_uart[3];
 
@@ -27,10 +27,16 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../lib/breakpoints.h"
 #include "../lib/picsimlab.h"
 #include "bsim_simavr.h"
+#include "simavr/avr_acomp.h"
 #include "simavr/avr_eeprom.h"
 #include "simavr/avr_extint.h"
+#include "simavr/avr_flash.h"
+#include "simavr/avr_spi.h"
+#include "simavr/avr_timer.h"
+#include "simavr/avr_watchdog.h"
 
 #define dprintf \
     if (1) {    \
@@ -62,11 +68,61 @@ typedef struct avr_gdb_t {
 
 void gdb_send_quick_status(avr_gdb_t* g, uint8_t signal);
 int gdb_network_handler(avr_gdb_t* g, uint32_t dosleep);
-int gdb_watch_find(const avr_gdb_watchpoints_t* w, uint32_t addr);
 };
 
+// gdb breakpoints bitmap, only changed by the simulation thread
+static breakpoints_t gdb_bps;
+static avr_gdb_watchpoints_t gdb_bps_list;
+static volatile int gdb_bps_dirty = 0;
+
+// rebuild the bitmap if the gdb breakpoints list changed
+static void gdb_bps_sync(avr_gdb_t* g) {
+    gdb_bps_dirty = 0;
+    if (memcmp(&gdb_bps_list, &g->breakpoints, sizeof(avr_gdb_watchpoints_t))) {
+        memcpy(&gdb_bps_list, &g->breakpoints, sizeof(avr_gdb_watchpoints_t));
+        breakpoints_clear(&gdb_bps, BP_CODE);
+        for (uint32_t i = 0; (i < gdb_bps_list.len) && (i < WATCH_LIMIT); i++) {
+            breakpoints_set(&gdb_bps, BP_CODE, gdb_bps_list.points[i].addr);
+        }
+    }
+}
+
+// size of the core struct allocated by avr_make_mcu_by_name, the avr_t is its first member followed by the io
+// modules, each one starting with its avr_io_t. simavr don't store it, so it is the end of the last registered io
+// module, 0 if a module kind is not known
+static unsigned int avr_core_size(const avr_t* avr) {
+    static const struct {
+        const char* kind;
+        unsigned int size;
+    } modules[] = {
+        {"port", sizeof(avr_ioport_t)},   {"uart", sizeof(avr_uart_t)},     {"adc", sizeof(avr_adc_t)},
+        {"timer", sizeof(avr_timer_t)},   {"spi", sizeof(avr_spi_t)},       {"twi", sizeof(avr_twi_t)},
+        {"eeprom", sizeof(avr_eeprom_t)}, {"flash", sizeof(avr_flash_t)},   {"watchdog", sizeof(avr_watchdog_t)},
+        {"extint", sizeof(avr_extint_t)}, {"ac", sizeof(avr_acomp_t)},
+    };
+    const char* end = (const char*)(avr + 1);
+
+    for (avr_io_t* io = avr->io_port; io; io = io->next) {
+        unsigned int m;
+        for (m = 0; m < sizeof(modules) / sizeof(modules[0]); m++) {
+            if (!strcmp(io->kind, modules[m].kind)) {
+                break;
+            }
+        }
+        if (m == sizeof(modules) / sizeof(modules[0])) {
+            printf("PICSimLab: simavr io module %s unknown, snapshot disabled\n", io->kind);
+            return 0;
+        }
+        if (((const char*)io + modules[m].size) > end) {
+            end = (const char*)io + modules[m].size;
+        }
+    }
+    return end - (const char*)avr;
+}
+
 bsim_simavr::bsim_simavr(void) {
     avr = NULL;
+    avr_size = 0;
     for (int i = 0; i < MAX_UART_COUNT; i++) {
         serial_irq[i] = NULL;
     }
@@ -74,8 +130,25 @@ bsim_simavr::bsim_simavr(void) {
     eeprom = NULL;
     usart_count = 0;
     pkg = PDIP;
+    memset(adc_irq, 0, sizeof(adc_irq));
+    uart_poll = 0;
+    uart_poll_max = 1000;
+    dsr_reset = 1;
+    serial_stream_init(&serial);
+    twostep = 0;
+    idle_pc = 0;
+    idle_head = 0;
+    idle_tail = 0;
+    idle_state = 0;
 }
 
+// ADC channel to pin maps
+static const unsigned char adc_pins_atmega2560[16] = {97, 96, 95, 94, 93, 92, 91, 90,
+                                                      89, 88, 87, 86, 85, 84, 83, 82};
+static const unsigned char adc_pins_attiny85[4] = {5, 7, 3, 2};
+static const unsigned char adc_pins_atmega328_PDIP[6] = {23, 24, 25, 26, 27, 28};
+static const unsigned char adc_pins_atmega328_QFN[8] = {23, 24, 25, 26, 27, 28, 19, 22};
+
 // uart stuff
 
 void bsim_simavr::MSetSerial(const char* port) {}
@@ -297,6 +370,9 @@ int bsim_simavr::MInit(const char* processor, const char* fname, float freq) {
 
     avr_init(avr);
 
+    // the io modules are registered by avr_init
+    avr_size = avr_core_size(avr);
+
     avr->sleep = avr_callback_sleep_raw_;
 
     // using ee =0 ioctl return the pointer to internal eeprom data instead load
@@ -376,12 +452,15 @@ int bsim_simavr::MInit(const char* processor, const char* fname, float freq) {
             pins[p].port = (unsigned char*)&AVR_PORTS[pname[1] - 'A'];
             pins[p].pord = pname[2] - '0';
 
+            pins_hook[p].pboard = this;
+            pins_hook[p].pin = &pins[p];
+
             avr_irq_t* stateIrq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(*pins[p].port), pins[p].pord);
-            avr_irq_register_notify(stateIrq, out_hook, &pins[p]);
+            avr_irq_register_notify(stateIrq, out_hook, &pins_hook[p]);
 
             avr_irq_t* directionIrq =
                 avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(*pins[p].port), IOPORT_IRQ_DIRECTION_ALL);
-            avr_irq_register_notify(directionIrq, ddr_hook, &pins[p]);
+            avr_irq_register_notify(directionIrq, ddr_hook, &pins_hook[p]);
 
             const char* name[1];
             name[0] = pname;
@@ -397,6 +476,27 @@ int bsim_simavr::MInit(const char* processor, const char* fname, float freq) {
         }
     }
 
+    // ADC input irq by pin
+    const unsigned char* adc_pins;
+    int adc_count;
+    if (lxString(avr->mmcu).compare(lxT("atmega2560")) == 0) {
+        adc_pins = adc_pins_atmega2560;
+        adc_count = 16;
+    } else if (lxString(avr->mmcu).compare(lxT("attiny85")) == 0) {
+        adc_pins = adc_pins_attiny85;
+        adc_count = 4;
+    } else if (pkg == PDIP) {  // atmega328
+        adc_pins = adc_pins_atmega328_PDIP;
+        adc_count = 6;
+    } else {
+        adc_pins = adc_pins_atmega328_QFN;
+        adc_count = 8;
+    }
+    memset(adc_irq, 0, sizeof(adc_irq));
+    for (int c = 0; c < adc_count; c++) {
+        adc_irq[adc_pins[c] - 1] = avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, c);
+    }
+
     // UART
     if (usart_count) {
         // disable the uart stdio
@@ -419,10 +519,10 @@ int bsim_simavr::MInit(const char* processor, const char* fname, float freq) {
         }
     }
 
-    serial_port_open(&serialfd, SERIALDEVICE);
+    serial_stream_open(&serial, SERIALDEVICE);
 
     serialexbaud[0] = 9600;
-    serialbaud[0] = serial_port_cfg(serialfd, serialexbaud[0]);
+    serialbaud[0] = serial_stream_cfg(&serial, serialexbaud[0]);
 
     if (usart_count) {
         for (int i = 0; i < usart_count; i++) {
@@ -468,11 +568,14 @@ int bsim_simavr::MInit(const char* processor, const char* fname, float freq) {
 void bsim_simavr::MEnd(void) {
     if (avr_debug_type) {
         avr_deinit_gdb(avr);
+        breakpoints_free(&gdb_bps);
     } else {
         mplabxd_end();
     }
 
-    serial_port_close(serialfd);
+    serial_stream_close(&serial);
+
+    memset(adc_irq, 0, sizeof(adc_irq));
 
     avr_terminate(avr);
 
@@ -515,6 +618,7 @@ void bsim_simavr::MEnd(void) {
 
     free(avr);
     avr = NULL;
+    avr_size = 0;
 }
 
 int bsim_simavr::MGetArchitecture(void) {
@@ -558,7 +662,11 @@ void bsim_simavr::MDumpMemory(const char* fname) {
 void avr_callback_run_gdb_(avr_t* avr) {
     avr_gdb_t* g = avr->gdb;
 
-    if (avr->state == cpu_Running && gdb_watch_find(&g->breakpoints, avr->pc) != -1) {
+    if (gdb_bps_dirty) {
+        gdb_bps_sync(g);
+    }
+
+    if (avr->state == cpu_Running && gdb_bps.armed && breakpoints_test(&gdb_bps, BP_CODE, avr->pc)) {
         gdb_send_quick_status(g, 0);
         avr->state = cpu_Stopped;
     } else if (avr->state == cpu_StepDone) {
@@ -571,6 +679,7 @@ void avr_callback_run_gdb_(avr_t* avr) {
 
     if (avr->state == cpu_Stopped) {
         gdb_network_handler(g, 0);
+        gdb_bps_dirty = 1;
         return;
     }
 
@@ -595,6 +704,10 @@ int bsim_simavr::DebugInit(int dtyppe) {
             PICSimLab.RegisterError("Error starting GDB debugger support !");
             return -1;
         } else {
+            breakpoints_free(&gdb_bps);
+            breakpoints_init(&gdb_bps, avr->flashend + 1, 0);
+            memset(&gdb_bps_list, 0, sizeof(avr_gdb_watchpoints_t));
+            gdb_bps_dirty = 1;
             avr->run = avr_callback_run_gdb_;
             avr->sleep = avr_callback_sleep_raw_;
             return 1;
@@ -622,6 +735,7 @@ void bsim_simavr::DebugLoop(void) {
         if ((avr_debug_type) && (avr->gdb)) {
             // this also sleeps for a bit
             gdb_network_handler(avr->gdb, 0);
+            gdb_bps_dirty = 1;
         } else {
             mplabxd_loop();
         }
@@ -1194,6 +1308,10 @@ void bsim_simavr::MSetPin(int pin, unsigned char value) {
     if (Write_stat_irq[pin - 1] == NULL)
         return;
     avr_raise_irq(Write_stat_irq[pin - 1], value);
+    // the wait loop can read the pin
+    if (idle_state) {
+        idle_state = 1;
+    }
 }
 
 void bsim_simavr::MSetPinDOV(int pin, unsigned char ovalue) {
@@ -1221,157 +1339,9 @@ void bsim_simavr::MSetAPin(int pin, float value) {
     if (avr == NULL)
         return;
 
-    if (lxString(avr->mmcu).compare(lxT("atmega2560")) == 0) {
-        switch (pin) {
-            case 82:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 15), (int)(value * 1000));
-                break;
-            case 83:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 14), (int)(value * 1000));
-                break;
-            case 84:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 13), (int)(value * 1000));
-                break;
-            case 85:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 12), (int)(value * 1000));
-                break;
-            case 86:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 11), (int)(value * 1000));
-                break;
-            case 87:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 10), (int)(value * 1000));
-                break;
-            case 88:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 9), (int)(value * 1000));
-                break;
-            case 89:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 8), (int)(value * 1000));
-                break;
-            case 90:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 7), (int)(value * 1000));
-                break;
-            case 91:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 6), (int)(value * 1000));
-                break;
-            case 92:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 5), (int)(value * 1000));
-                break;
-            case 93:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 4), (int)(value * 1000));
-                break;
-            case 94:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 3), (int)(value * 1000));
-                break;
-            case 95:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 2), (int)(value * 1000));
-                break;
-            case 96:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 1), (int)(value * 1000));
-                break;
-            case 97:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 0), (int)(value * 1000));
-                break;
-        }
-    } else if (lxString(avr->mmcu).compare(lxT("attiny85")) == 0) {
-        switch (pin) {
-            case 5:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 0), (int)(value * 1000));
-                break;
-            case 7:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 1), (int)(value * 1000));
-                break;
-            case 3:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 2), (int)(value * 1000));
-                break;
-            case 2:
-                pins[pin - 1].ptype = PT_ANALOG;
-                avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 3), (int)(value * 1000));
-                break;
-        }
-    } else  // atmega328
-    {
-        if (pkg == PDIP) {
-            switch (pin) {
-                case 23:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 0), (int)(value * 1000));
-                    break;
-                case 24:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 1), (int)(value * 1000));
-                    break;
-                case 25:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 2), (int)(value * 1000));
-                    break;
-                case 26:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 3), (int)(value * 1000));
-                    break;
-                case 27:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 4), (int)(value * 1000));
-                    break;
-                case 28:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 5), (int)(value * 1000));
-                    break;
-            }
-        } else {  // QFN
-            switch (pin) {
-                case 23:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 0), (int)(value * 1000));
-                    break;
-                case 24:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 1), (int)(value * 1000));
-                    break;
-                case 25:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 2), (int)(value * 1000));
-                    break;
-                case 26:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 3), (int)(value * 1000));
-                    break;
-                case 27:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 4), (int)(value * 1000));
-                    break;
-                case 28:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 5), (int)(value * 1000));
-                    break;
-                case 19:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 6), (int)(value * 1000));
-                    break;
-                case 22:
-                    pins[pin - 1].ptype = PT_ANALOG;
-                    avr_raise_irq(avr_io_getirq(avr, AVR_IOCTL_ADC_GETIRQ, 7), (int)(value * 1000));
-                    break;
-            }
-        }
+    if (adc_irq[pin - 1]) {
+        pins[pin - 1].ptype = PT_ANALOG;
+        avr_raise_irq(adc_irq[pin - 1], (int)(value * 1000));
     }
 }
 
@@ -1388,7 +1358,7 @@ const picpin* bsim_simavr::MGetPinsValues(void) {
 
 void bsim_simavr::SerialSend(bitbang_uart_t* _bb_uart, const unsigned char value) {
     if (_bb_uart == &bb_uart[0]) {  // send only serial 0
-        serial_port_send(serialfd, value);
+        serial_stream_send(&serial, value);
     }
     if (usart_count) {
         bitbang_uart_send(_bb_uart, value);
@@ -1401,32 +1371,30 @@ void bsim_simavr::SerialSend(bitbang_uart_t* _bb_uart, const unsigned char value
 static void uart_in_hook(struct avr_irq_t* irq, uint32_t value, void* param) {
     bitbang_uart_t* bb_uart = ((bitbang_uart_t*)param);
     (dynamic_cast<bsim_simavr*>(bb_uart->pboard))->SerialSend(bb_uart, value);
-    ioupdated = 1;
+    bb_uart->pboard->SetIOUpdated(1);
 }
 
 void bsim_simavr::UpdateHardware(void) {
     if (usart_count) {
-        static int cont = 0;
-        static int aux = 1;
         unsigned char c;
-        cont++;
+        uart_poll++;
 
-        if (cont > 1000) {
-            cont = 0;
+        if (uart_poll > uart_poll_max) {
+            uart_poll = 0;
 
-            if (PICSimLab.GetUseDSRReset() && serial_port_get_dsr(serialfd)) {
-                if (aux) {
+            if (PICSimLab.GetUseDSRReset() && serial_stream_get_dsr(&serial)) {
+                if (dsr_reset) {
                     MReset(0);
-                    aux = 0;
+                    dsr_reset = 0;
                 }
             } else {
-                aux = 1;
+                dsr_reset = 1;
             }
 
             for (int i = 0; i < usart_count; i++) {
                 if (avr->data[UCSR_base[i] + 1] & 0x10) {  // RXEN
 
-                    if ((!i) && (serial_port_rec(serialfd, &c))) {
+                    if ((!i) && (serial_stream_rec(&serial, &c))) {
                         avr_raise_irq(serial_irq[0] + IRQ_UART_BYTE_OUT, c);
                     }
 
@@ -1455,7 +1423,14 @@ void bsim_simavr::UpdateHardware(void) {
                     }
 
                     if (!i) {
-                        serialbaud[i] = serial_port_cfg(serialfd, serialexbaud[i]);
+                        serialbaud[i] = serial_stream_cfg(&serial, serialexbaud[i]);
+                        // poll the host serial port once per byte time, up to 1000 steps
+                        uart_poll_max = (10.0 * avr->frequency) / serialexbaud[i];
+                        if (uart_poll_max > 1000) {
+                            uart_poll_max = 1000;
+                        } else if (uart_poll_max < 16) {
+                            uart_poll_max = 16;
+                        }
                     } else {
                         serialbaud[i] = serialexbaud[i];
                     }
@@ -1483,14 +1458,14 @@ void bsim_simavr::UpdateHardware(void) {
             if (!uart_config[0]) {
                 uart_config[0] = 1;
                 serialbaud[0] = 115200;
-                serialbaud[0] = serial_port_cfg(serialfd, serialexbaud[0]);
+                serialbaud[0] = serial_stream_cfg(&serial, serialexbaud[0]);
             }
             /*
              if (cont > 1000)
               {
                cont = 0;
 
-               if (serial_port_rec (serialfd, &c))
+               if (serial_stream_rec (&serial, &c))
                 {
                  avr->data[TDDR] = c;
                  avr->data[TDCR] |= (1 << 4);
@@ -1527,10 +1502,46 @@ void bsim_simavr::MStep(void) {
     avr_run(avr);
 }
 
+uint32_t bsim_simavr::MStepUntil(const uint32_t max) {
+    uint32_t count = max;
+    uint32_t i = 0;
+    const int bp = mplabxd_bp_count();
+
+    // keep the host serial port poll rate of UpdateHardware
+    if (usart_count && (count > (uint32_t)(uart_poll_max + 1 - uart_poll))) {
+        count = uart_poll_max + 1 - uart_poll;
+    }
+
+    while (i < count) {
+        i++;
+        if (twostep) {
+            twostep = 0;  // NOP
+            continue;
+        }
+        const avr_cycle_count_t cycle_start = avr->cycle;
+        avr_run(avr);
+        if ((avr->cycle - cycle_start) > 1) {
+            twostep = 1;
+        }
+        // IO changes, sleep, wait loops and reached breakpoints are handled by the board glue
+        const uint32_t pc = avr->pc;
+        if (ioupdated || (avr->state != cpu_Running) || IdleLoop(pc) || (bp && mplabxd_testbp())) {
+            break;
+        }
+        idle_pc = pc;
+    }
+
+    if (usart_count) {
+        uart_poll += i - 1;  // the board glue calls UpdateHardware once
+    }
+    return i;
+}
+
 void bsim_simavr::MStepResume(void) {}
 
 void bsim_simavr::MReset(int flags) {
     avr_reset(avr);
+    bsim_simavr::MIdleReset();
     if (usart_count) {
         for (int i = 0; i < usart_count; i++) {
             avr->data[UCSR_base[i] + 1] = 0x00;  // FIX the simavr reset TX enabled
@@ -1548,6 +1559,198 @@ void bsim_simavr::MReset(int flags) {
     avr_extint_set_strict_lvl_trig(avr, 7, 0);
 }
 
+int bsim_simavr::MSnapshot(snapshot_t* sn) {
+    // the core struct holds the registers, io modules, cycle timers and interrupts state
+    unsigned int size = avr_size;
+
+    if (!size) {
+        snapshot_set_error(sn, "snapshot not supported by the simulator backend");
+        return -1;
+    }
+
+    snapshot_check(sn, &size, sizeof(size), "microcontroller");
+    if (sn->error) {
+        return -1;
+    }
+
+    if (sn->load) {
+        const avr_t* saved = (const avr_t*)snapshot_peek(sn, size);
+        if ((!saved) || (saved->data != avr->data) || (saved->flash != avr->flash) || (saved->ramend != avr->ramend) ||
+            (saved->flashend != avr->flashend)) {
+            snapshot_set_error(sn, "microcontroller memory don't match");
+            return -1;
+        }
+    }
+
+    snapshot_data(sn, avr, size);
+    bsim_simavr::MIdleReset();
+    snapshot_data(sn, avr->data, avr->ramend + 1);
+    snapshot_data(sn, avr->flash, avr->flashend + 1);
+    if (eeprom) {
+        snapshot_data(sn, eeprom, avr->e2end + 1);
+    }
+
+    // the irqs are allocated apart from the core, their last value filters repeated raises and must agree with pins
+    // after a load. The pool holds the irqs of the io modules (ioport, uart, adc ...) and the board ones.
+    int irq_count = avr->irq_pool.count;
+    snapshot_check(sn, &irq_count, sizeof(irq_count), "microcontroller irqs");
+    if (sn->error) {
+        return -1;
+    }
+    for (int i = 0; i < irq_count; i++) {
+        avr_irq_t* irq = avr->irq_pool.irq[i];
+        uint32_t value = irq ? irq->value : 0;
+        unsigned int flags = irq ? irq->flags : 0;
+        SNAPSHOT_VAR(sn, value);
+        SNAPSHOT_VAR(sn, flags);
+        if (sn->load && irq) {
+            irq->value = value;
+            irq->flags = flags;
+        }
+    }
+
+    SNAPSHOT_VAR(sn, pins);
+    SNAPSHOT_VAR(sn, USI);
+    SNAPSHOT_VAR(sn, bb_uart);
+    SNAPSHOT_VAR(sn, serialbaud);
+    SNAPSHOT_VAR(sn, serialexbaud);
+
+    return sn->error ? -1 : 0;
+}
+
+// A loop is a wait loop when its body only reads SRAM and registers, writes only registers and is entered two times
+// in sequence with the same registers and SREG: the next iterations will be equal until an interrupt, that can only
+// be raised by a cycle timer or by an input pin change.
+int bsim_simavr::IdleLoopBody(const uint32_t head, const uint32_t tail) {
+    uint32_t addr = head;
+
+    if ((tail - head) > 64) {
+        return 0;
+    }
+
+    while (addr <= tail) {
+        const unsigned short op = avr->flash[addr] | (avr->flash[addr + 1] << 8);
+
+        if ((op & 0xFE0F) == 0x9000) {  // lds Rd, k
+            const unsigned short k = avr->flash[addr + 2] | (avr->flash[addr + 3] << 8);
+            if (k <= avr->ioend) {  // io registers read can have side effects
+                return 0;
+            }
+            addr += 4;
+            continue;
+        }
+
+        if (!((op == 0x0000) ||                                             // nop
+              ((op & 0xFC00) == 0x0400) || ((op & 0xF800) == 0x0800) ||     // cpc, sbc, add
+              ((op & 0xF000) == 0x1000) || ((op & 0xF000) == 0x2000) ||     // cpse, cp, sub, adc, and, eor, or, mov
+              (((op & 0xF000) >= 0x3000) && ((op & 0xF000) <= 0x7000)) ||  // cpi, sbci, subi, ori, andi
+              ((op & 0xF000) == 0xE000) ||                                  // ldi
+              ((op & 0xF000) == 0xC000) ||                                  // rjmp
+              ((op & 0xF800) == 0xF000) ||                                  // brbs, brbc
+              ((op & 0xFC08) == 0xFC00) ||                                  // sbrc, sbrs
+              ((op & 0xFD00) == 0x9900) ||                                  // sbic, sbis
+              ((op & 0xFE00) == 0x9600))) {                                 // adiw, sbiw
+            return 0;
+        }
+        addr += 2;
+    }
+    return 1;
+}
+
+int bsim_simavr::IdleLoop(const uint32_t pc) {
+    if (pc >= idle_pc) {
+        // the registers are only valid while the execution stays in the loop body
+        if ((idle_state == 2) && ((pc < idle_head) || (pc > idle_tail))) {
+            idle_state = 1;
+        }
+        return 0;
+    }
+
+    // backward jump
+    if ((pc == idle_head) && (idle_pc == idle_tail)) {
+        if (!idle_state) {
+            return 0;
+        }
+        if ((idle_state == 2) && (!memcmp(idle_regs, avr->data, 32)) && (!memcmp(idle_regs + 32, avr->sreg, 8))) {
+            return 1;
+        }
+    } else {
+        idle_head = pc;
+        idle_tail = idle_pc;
+        if (!IdleLoopBody(idle_head, idle_tail)) {
+            idle_state = 0;
+            return 0;
+        }
+    }
+    memcpy(idle_regs, avr->data, 32);
+    memcpy(idle_regs + 32, avr->sreg, 8);
+    idle_state = 2;
+    return 0;
+}
+
+void bsim_simavr::MIdleReset(void) {
+    // a backward jump can't match the cleared loop candidate
+    idle_head = 0;
+    idle_tail = 0;
+    idle_state = 0;
+}
+
+bitbang_uart_t* bsim_simavr::MGetUARTLink(const unsigned char rx_pin, const unsigned char tx_pin) {
+    // part rx wired to the uart tx and part tx wired to the uart rx
+    for (int i = 0; i < usart_count; i++) {
+        if (uart_config[i] && (bb_uart[i].tx_pin == rx_pin) && (bb_uart[i].rx_pin == tx_pin)) {
+            return &bb_uart[i];
+        }
+    }
+    return NULL;
+}
+
+uint32_t bsim_simavr::MGetIdleSteps(void) {
+    const uint32_t pc = avr->pc;
+    int idle = 0;
+
+    if (avr->state == cpu_Sleeping) {
+        idle = avr->sreg[S_I];
+    } else if (avr->state == cpu_Running) {
+        idle = IdleLoop(pc);
+    }
+    idle_pc = pc;
+
+    if ((!idle) || avr->gdb || avr_has_pending_interrupts(avr)) {
+        return 0;
+    }
+
+    // the next cycle timer is the next internal event
+    uint64_t steps = 0xFFFFFFFF;
+    if (avr->cycle_timers.timer) {
+        const avr_cycle_count_t when = avr->cycle_timers.timer->when;
+        if (when <= (avr->cycle + 1)) {
+            return 0;
+        }
+        if ((when - avr->cycle - 1) < steps) {
+            steps = when - avr->cycle - 1;
+        }
+    }
+
+    // keep the host serial port poll rate of UpdateHardware
+    if (usart_count) {
+        if (uart_poll >= uart_poll_max) {
+            return 0;
+        }
+        if ((uint64_t)(uart_poll_max - uart_poll) < steps) {
+            steps = uart_poll_max - uart_poll;
+        }
+    }
+    return steps;
+}
+
+void bsim_simavr::MIdleSkip(const uint32_t steps) {
+    avr->cycle += steps;
+    if (usart_count) {
+        uart_poll += steps;
+    }
+}
+
 unsigned short* bsim_simavr::DBGGetProcID_p(void) {
     return 0;
 }
@@ -53,6 +53,11 @@ typedef struct {
     unsigned char out;
 } usi_t;
 
+typedef struct {
+    board* pboard;
+    picpin* pin;
+} avr_pin_hook_t;
+
 class bsim_simavr : virtual public board {
 public:
     bsim_simavr(void);  // Called once on board creation
@@ -79,8 +84,14 @@ public:
     unsigned char MGetPin(int pin) override;
     const picpin* MGetPinsValues(void) override;
     void MStep(void) override;
+    uint32_t MStepUntil(const uint32_t max) override;
     void MStepResume(void) override;
     void MReset(int flags) override;
+    int MSnapshot(snapshot_t* sn) override;
+    uint32_t MGetIdleSteps(void) override;
+    void MIdleSkip(const uint32_t steps) override;
+    void MIdleReset(void) override;
+    bitbang_uart_t* MGetUARTLink(const unsigned char rx_pin, const unsigned char tx_pin) override;
     unsigned short* DBGGetProcID_p(void) override;
     unsigned int DBGGetPC(void) override;
     void DBGSetPC(unsigned int pc) override;
@@ -100,15 +111,15 @@ public:
     virtual void UpdateHardware(void);
 
     static void out_hook(struct avr_irq_t* irq, uint32_t value, void* param) {
-        picpin* p = (picpin*)param;
-        p->value = value;
-        ioupdated = 1;
+        avr_pin_hook_t* h = (avr_pin_hook_t*)param;
+        h->pin->value = value;
+        h->pboard->SetIOUpdated(1);
     }
 
     static void ddr_hook(struct avr_irq_t* irq, uint32_t value, void* param) {
-        picpin* p = (picpin*)param;
-        p->dir = !(value & (1 << p->pord));
-        ioupdated = 1;
+        avr_pin_hook_t* h = (avr_pin_hook_t*)param;
+        h->pin->dir = !(value & (1 << h->pin->pord));
+        h->pboard->SetIOUpdated(1);
     }
 
     void SerialSend(bitbang_uart_t* _bb_uart, const unsigned char value);
@@ -119,20 +130,35 @@ protected:
     avr_t* avr;
     avr_irq_t* serial_irq[MAX_UART_COUNT];
     picpin pins[256];
+    avr_pin_hook_t pins_hook[256];
     avr_irq_t* Write_stat_irq[100];
+    avr_irq_t* adc_irq[256];  // ADC channel input irq by pin, resolved in MInit
     unsigned int serialbaud[MAX_UART_COUNT];
     float serialexbaud[MAX_UART_COUNT];
     void pins_reset(void);
     int avr_debug_type;
-    serialfd_t serialfd;
+    serial_stream_t serial;
     bitbang_uart_t bb_uart[MAX_UART_COUNT];
     unsigned char* eeprom;
+    unsigned int avr_size;  ///< core struct size, 0 if unknown
     unsigned char uart_config[MAX_UART_COUNT];
     unsigned char usart_count;
     unsigned int UCSR_base[MAX_UART_COUNT];
+    int uart_poll;      ///< steps since the last host serial port poll
+    int uart_poll_max;  ///< steps between host serial port polls
+    int dsr_reset;      ///< the host serial port DSR was off since the last reset
+    int twostep;        ///< the next step is the second cycle of the last instruction
 
 private:
     int parse_hex(const char* line, int bytes);
+    // TODO simavr: IdleLoop, the Arduino delay() loop reads the changing timer 0 counter and is never a wait loop
+    int IdleLoop(const uint32_t pc);
+    int IdleLoopBody(const uint32_t head, const uint32_t tail);
+    uint32_t idle_pc;                 ///< pc of the previous step
+    uint32_t idle_head;               ///< wait loop candidate first instruction
+    uint32_t idle_tail;               ///< wait loop candidate backward jump instruction
+    int idle_state;                   ///< 0 no candidate, 1 loop body verified, 2 registers saved at loop head
+    unsigned char idle_regs[32 + 8];  ///< registers and SREG bits at loop head
     unsigned char checksum(char* str);
     int read_ihx_avr(const char* fname, int leeprom);
     int write_ihx_avr(const char* fname);
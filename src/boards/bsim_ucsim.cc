@@ -275,6 +275,25 @@ void bsim_ucsim::MSetSerial(const char* port) {
      }
  }
 
+ uint32_t bsim_ucsim::MStepUntil(const uint32_t max) {
+     uint32_t i = 0;
+
+     while (i < max) {
+         bsim_ucsim::MStep();
+         i++;
+         if (ioupdated) {
+             break;
+         }
+     }
+     return i;
+ }
+
  void bsim_ucsim::MStepResume(void) {
      // if (pic.s2 == 1)step ();
  }
+
+ int bsim_ucsim::MSnapshot(snapshot_t* sn) {
+     // the simulator state is held by the uCsim objects and is not exported by its interface
+     snapshot_set_error(sn, "snapshot not supported by uCsim, its state is not exported by the simulator library");
+     return -1;
+ }
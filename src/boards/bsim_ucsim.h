@@ -54,8 +54,10 @@ public:
     unsigned char MGetPin(int pin) override;
     const picpin* MGetPinsValues(void) override;
     void MStep(void) override;
+    uint32_t MStepUntil(const uint32_t max) override;
     void MStepResume(void) override;
     void MReset(int flags) override;
+    int MSnapshot(snapshot_t* sn) override;
 
 protected:
     void pins_reset(void);
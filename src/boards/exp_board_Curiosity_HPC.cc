@@ -698,7 +698,7 @@ void cboard_Curiosity_HPC::Run_CPU(void) {
 
             // verify if a breakpoint is reached if not run one instruction
             if (!mplabxd_testbp())
-                pic_step(&pic);
+                PROF_STAGE(PROF_CPU, pic_step(&pic));
             ioupdated = pic.ioupdated;
             InstCounterInc();
             if (use_oscope)
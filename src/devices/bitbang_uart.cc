@@ -26,6 +26,7 @@
 #include "bitbang_uart.h"
 
 #include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -46,9 +47,24 @@ void bitbang_uart_rst(bitbang_uart_t* bu) {
     bu->data_to_send = 0;
     bu->tx_value = 1;
     bu->ctrl_on = 0;
+    bu->tx_link = 0;
     dprintf("uart rst\n");
 }
 
+static void bitbang_uart_deliver(bitbang_uart_t* bu, const unsigned char data) {
+    if (bu->data_recv) {
+        dprintf("uart rx override error !!!!!!!\n");
+    }
+    bu->datar = data;
+    bu->data_recv = 1;
+    bu->pboard->SetIOUpdated(1);  // to check for new bytes
+    dprintf("uart rx 0x%02X (%c)\n", bu->datar, bu->datar);
+
+    if (bu->CallbackRX) {
+        (*bu->CallbackRX)(bu, bu->ArgRX);
+    }
+}
+
 static void bitbang_uart_rx_callback(void* arg) {
     bitbang_uart_t* bu = (bitbang_uart_t*)arg;
 
@@ -66,17 +82,7 @@ static void bitbang_uart_rx_callback(void* arg) {
 
     if (bu->bcr > 9)  // start+eight bits+ stop
     {
-        if (bu->data_recv) {
-            dprintf("uart rx override error !!!!!!!\n");
-        }
-        bu->datar = bu->insr >> 8;
-        bu->data_recv = 1;
-        ioupdated = 1;  // to check for new bytes
-        dprintf("uart rx 0x%02X (%c)\n", bu->datar, bu->datar);
-
-        if (bu->CallbackRX) {
-            (*bu->CallbackRX)(bu, bu->ArgRX);
-        }
+        bitbang_uart_deliver(bu, bu->insr >> 8);
         bu->bcr = 0;
         bu->pboard->TimerSetState(bu->TimerRXID, 0);
     }
@@ -85,9 +91,21 @@ static void bitbang_uart_rx_callback(void* arg) {
 static void bitbang_uart_tx_callback(void* arg) {
     bitbang_uart_t* bu = (bitbang_uart_t*)arg;
 
+    if (bu->tx_link) {
+        // whole byte time elapsed, deliver it to the peer
+        bu->tx_link = 0;
+        bu->bcw = 0;
+        bu->pboard->TimerSetState(bu->TimerTXID, 0);
+        if (bu->link) {
+            bu->link->leds |= 0x01;
+            bitbang_uart_deliver(bu->link, bu->dataw);
+        }
+        return;
+    }
+
     bu->outsr = (bu->outsr >> 1);
     bu->bcw++;
-    ioupdated = 1;
+    bu->pboard->SetIOUpdated(1);
     bu->tx_value = (bu->outsr & 0x01);
     if (bu->bcw > 10) {
         bu->bcw = 0;
@@ -106,10 +124,12 @@ void bitbang_uart_init(bitbang_uart_t* bu, board* pboard, void (*CallbackRX)(bit
     bu->pboard->TimerSetState(bu->TimerTXID, 0);
     bu->CallbackRX = CallbackRX;
     bu->ArgRX = ArgRX;
+    bu->link = NULL;
     dprintf("uart init\n");
 }
 
 void bitbang_uart_end(bitbang_uart_t* bu) {
+    bitbang_uart_link(bu, NULL);
     bu->pboard->TimerUnregister(bu->TimerRXID);
     bu->pboard->TimerUnregister(bu->TimerTXID);
     dprintf("uart end\n");
@@ -150,8 +170,23 @@ void bitbang_uart_send(bitbang_uart_t* bu, const unsigned char data) {
     bu->data_to_send = 1;
 
     dprintf("uart tx 0x%02X (%c)\n", bu->dataw, bu->dataw);
+
+    // same speed as the peer (2% of tolerance like the pins sampling): the line stays idle and the byte is delivered
+    // after start+eight bits+stop
+    if (bu->link && (labs((long)bu->link->speed - (long)bu->speed) * 50 <= (long)bu->speed)) {
+        bu->tx_link = 1;
+        bu->outsr = 1;
+        bu->tx_value = 1;
+        bu->bcw = 1;
+        bu->leds |= 0x02;
+        bu->pboard->TimerChange_us(bu->TimerTXID, 10e6 / bu->speed);
+        bu->pboard->TimerSetState(bu->TimerTXID, 1);
+        return;
+    }
+    bu->tx_link = 0;
+
     bu->outsr = (bu->dataw << 1) | 0xFE00;
-    ioupdated = 1;
+    bu->pboard->SetIOUpdated(1);
     bu->bcw = 1;
     bu->leds |= 0x02;
 
@@ -169,3 +204,20 @@ unsigned char bitbang_uart_recv(bitbang_uart_t* bu) {
     bu->data_recv = 0;
     return bu->datar;
 }
+
+void bitbang_uart_link(bitbang_uart_t* bu, bitbang_uart_t* peer) {
+    if (bu->link == peer) {
+        return;
+    }
+    if (bu->link) {
+        bu->link->link = NULL;
+    }
+    if (peer) {
+        if (peer->link) {
+            peer->link->link = NULL;
+        }
+        peer->link = bu;
+    }
+    bu->link = peer;
+    dprintf("uart link %p\n", peer);
+}
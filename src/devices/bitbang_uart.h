@@ -55,6 +55,9 @@ struct bitbang_uart_t {
     unsigned char tx_value;
     unsigned char rx_pin;
     unsigned char rx_value;
+    // Byte level link
+    bitbang_uart_t* link;    // peer uart, bytes are delivered without the pins
+    unsigned char tx_link;   // flag byte in transmission sent by link
 };
 
 void bitbang_uart_rst(bitbang_uart_t* bu);
@@ -66,6 +69,7 @@ unsigned char bitbang_uart_transmitting(bitbang_uart_t* bu);
 void bitbang_uart_send(bitbang_uart_t* bu, const unsigned char data);
 unsigned char bitbang_uart_data_available(bitbang_uart_t* bu);
 unsigned char bitbang_uart_recv(bitbang_uart_t* bu);
+void bitbang_uart_link(bitbang_uart_t* bu, bitbang_uart_t* peer);
 
 unsigned char bitbang_uart_io(bitbang_uart_t* bu, const unsigned char rx);
 
@@ -0,0 +1,239 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+
+#include "bus_i2c.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define ACK 0
+#define NACK 1
+
+#define dprintf \
+    if (1) {    \
+    } else      \
+        printf
+
+void bus_i2c_rst(bus_i2c_t* bus) {
+    bitbang_i2c_rst(&bus->bb);
+    bus->active = -1;
+    dprintf("bus_i2c rst\n");
+}
+
+void bus_i2c_init(bus_i2c_t* bus) {
+    bus->count = 0;
+    memset(bus->map, 0, sizeof(bus->map));
+    bitbang_i2c_init(&bus->bb, 0, 0);
+    bus_i2c_rst(bus);
+}
+
+// the addressed device is kept, the owner attaches the same devices again in the same order
+void bus_i2c_detach_all(bus_i2c_t* bus) {
+    bus->count = 0;
+    memset(bus->map, 0, sizeof(bus->map));
+}
+
+int bus_i2c_attach(bus_i2c_t* bus, bitbang_i2c_t* i2c, void (*Process)(void* arg), void* Arg) {
+    if (bus->count >= BUS_I2C_MAX) {
+        return -1;
+    }
+    bus->dev[bus->count].i2c = i2c;
+    bus->dev[bus->count].Process = Process;
+    bus->dev[bus->count].Arg = Arg;
+    bus->count++;
+    return bus->count - 1;
+}
+
+// the device address can be changed at any time, the cached index is only a hint
+static signed char bus_i2c_find(bus_i2c_t* bus, const unsigned char addr) {
+    const int index = bus->map[addr >> 1];
+
+    if (index && ((addr & bus->dev[index - 1].i2c->addr_mask) == bus->dev[index - 1].i2c->addr)) {
+        return index - 1;
+    }
+    for (int i = 0; i < bus->count; i++) {
+        if ((addr & bus->dev[i].i2c->addr_mask) == bus->dev[i].i2c->addr) {
+            bus->map[addr >> 1] = i + 1;
+            return i;
+        }
+    }
+    return -1;
+}
+
+// deliver the byte level status to the addressed device like its own bitbang_i2c_io does
+static void bus_i2c_event(bus_i2c_t* bus, const unsigned char status) {
+    if (bus->active >= bus->count) {
+        // device detached
+        bus->active = -1;
+        return;
+    }
+
+    bus_i2c_dev_t* dev = &bus->dev[bus->active];
+
+    dev->i2c->datar = bus->bb.datar;
+    dev->i2c->byte = bus->bb.byte;
+    dev->i2c->data_reading = bus->bb.data_reading;
+    dev->i2c->status = status;
+    (*dev->Process)(dev->Arg);
+    bus->bb.byte = dev->i2c->byte;  // can be changed by the device
+    bus->bb.datas = dev->i2c->datas;
+}
+
+unsigned char bus_i2c_io(bus_i2c_t* bus, const unsigned char scl, const unsigned char sda) {
+    bitbang_i2c_t* i2c = &bus->bb;
+
+    if ((i2c->sdao == sda) && (i2c->sclo == scl)) {
+        // No edge, return the last value
+        return i2c->ret;
+    }
+
+    if ((i2c->sdao == 1) && (sda == 0) && (scl == 1) && (i2c->sclo == 1)) {
+        // start or restart, the address is decoded again
+        i2c->bit = 0;
+        i2c->byte = 0;
+        i2c->datab = 0;
+        i2c->ret = 0;
+        i2c->data_reading = 0;
+        bus->active = -1;
+    }
+
+    if ((i2c->sdao == 0) && (sda == 1) && (scl == 1) && (i2c->sclo == 1)) {
+        // stop
+        i2c->bit = 0xFF;
+        i2c->byte = 0xFF;
+        i2c->ret = 0;
+        i2c->data_reading = 0;
+        if (bus->active >= 0) {
+            bus_i2c_event(bus, I2C_STOP);
+            bus->active = -1;
+        }
+    }
+
+    if ((i2c->bit < 9) && (i2c->sclo == 0) && (scl == 1)) {
+        // data in
+        if (i2c->bit < 8) {
+            i2c->datab |= (sda << (7 - i2c->bit));
+        }
+        i2c->bit++;
+    }
+
+    if ((i2c->bit < 9) && (i2c->sclo == 1) && (scl == 0) && i2c->data_reading) {
+        // data out
+        if (i2c->bit < 8) {
+            i2c->ret = ((i2c->datas & (1 << (7 - i2c->bit))) > 0);
+        } else {
+            i2c->ret = ACK;
+        }
+    }
+
+    if (i2c->bit == 8) {
+        if (i2c->byte == 0) {  // ADDR
+            if (bus->active < 0) {
+                bus->active = bus_i2c_find(bus, i2c->datab);
+            }
+            i2c->ret = (bus->active >= 0) ? ACK : NACK;
+        } else if (!i2c->data_reading) {
+            // data
+            i2c->ret = ACK;
+        }
+    }
+
+    if (i2c->bit == 9) {
+        i2c->datar = i2c->datab;
+        i2c->bit = 0;
+        i2c->datab = 0;
+        if (i2c->byte == 0) {  // ADDR
+            if (bus->active >= 0) {
+                dprintf("bus_i2c addr OK %02X\n", i2c->datar >> 1);
+                i2c->data_reading = i2c->datar & 0x01;
+                i2c->byte++;
+                bus_i2c_event(bus, i2c->data_reading ? I2C_DATAR : I2C_ADDR);
+            } else {
+                dprintf("bus_i2c addr NOK %02X\n", i2c->datar >> 1);
+                i2c->bit = 0xFF;
+                i2c->byte = 0xFF;
+            }
+        } else {
+            i2c->byte++;
+            bus_i2c_event(bus, i2c->data_reading ? I2C_DATAR : I2C_DATAW);
+        }
+    }
+
+    i2c->sdao = sda;
+    i2c->sclo = scl;
+    return i2c->ret;
+}
+
+int bus_i2c_start(bus_i2c_t* bus, const unsigned char addr) {
+    bitbang_i2c_t* i2c = &bus->bb;
+
+    bus->active = bus_i2c_find(bus, addr);
+    if (bus->active < 0) {
+        i2c->byte = 0xFF;
+        return 0;
+    }
+    i2c->datar = addr;
+    i2c->data_reading = addr & 0x01;
+    i2c->byte = 1;
+    bus_i2c_event(bus, i2c->data_reading ? I2C_DATAR : I2C_ADDR);
+    return 1;
+}
+
+void bus_i2c_write(bus_i2c_t* bus, const unsigned char data) {
+    bitbang_i2c_t* i2c = &bus->bb;
+
+    if ((bus->active < 0) || i2c->data_reading) {
+        return;
+    }
+    i2c->datar = data;
+    i2c->byte++;
+    bus_i2c_event(bus, I2C_DATAW);
+}
+
+unsigned char bus_i2c_read(bus_i2c_t* bus) {
+    bitbang_i2c_t* i2c = &bus->bb;
+    const unsigned char data = i2c->datas;
+
+    if ((bus->active < 0) || (!i2c->data_reading)) {
+        return 0xFF;
+    }
+    // the device loads the next byte to send
+    i2c->datar = data;
+    i2c->byte++;
+    bus_i2c_event(bus, I2C_DATAR);
+    return data;
+}
+
+void bus_i2c_stop(bus_i2c_t* bus) {
+    bitbang_i2c_t* i2c = &bus->bb;
+
+    i2c->byte = 0xFF;
+    i2c->data_reading = 0;
+    if (bus->active >= 0) {
+        bus_i2c_event(bus, I2C_STOP);
+        bus->active = -1;
+    }
+}
@@ -0,0 +1,63 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+
+#ifndef BUS_I2C
+#define BUS_I2C
+
+#include "bitbang_i2c.h"
+
+#define BUS_I2C_MAX 16
+
+typedef struct {
+    bitbang_i2c_t* i2c;  // device address and byte level status
+    void (*Process)(void* arg);
+    void* Arg;
+} bus_i2c_dev_t;
+
+// shared I2C bus: the pins are decoded once and the events dispatched only to the addressed device
+typedef struct {
+    bitbang_i2c_t bb;        // bus decoder state
+    signed char active;      // addressed device, -1 if none
+    unsigned char count;     // devices attached
+    unsigned char map[128];  // device index + 1 by 7 bits address, 0 not cached
+    bus_i2c_dev_t dev[BUS_I2C_MAX];
+} bus_i2c_t;
+
+void bus_i2c_init(bus_i2c_t* bus);
+void bus_i2c_rst(bus_i2c_t* bus);
+void bus_i2c_detach_all(bus_i2c_t* bus);
+int bus_i2c_attach(bus_i2c_t* bus, bitbang_i2c_t* i2c, void (*Process)(void* arg), void* Arg);
+
+// bit level: decode the pins value, returns sda
+unsigned char bus_i2c_io(bus_i2c_t* bus, const unsigned char scl, const unsigned char sda);
+
+// transaction level: used when the microcontroller model provides the I2C events
+int bus_i2c_start(bus_i2c_t* bus, const unsigned char addr);
+void bus_i2c_write(bus_i2c_t* bus, const unsigned char data);
+unsigned char bus_i2c_read(bus_i2c_t* bus);
+void bus_i2c_stop(bus_i2c_t* bus);
+
+#endif  // BUS_I2C
@@ -0,0 +1,124 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "bus_spi.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define dprintf \
+    if (1) {    \
+    } else      \
+        printf
+
+void bus_spi_rst(bus_spi_t* bus) {
+    for (int i = 0; i < BUS_SPI_MAX; i++) {
+        bus->dev[i].selected = 0;
+        bus->dev[i].ret = 1;
+    }
+    dprintf("bus_spi rst\n");
+}
+
+void bus_spi_init(bus_spi_t* bus) {
+    bus->count = 0;
+    bus_spi_rst(bus);
+}
+
+// the selection state is kept, the owner attaches the same devices again in the same order
+void bus_spi_detach_all(bus_spi_t* bus) {
+    bus->count = 0;
+}
+
+int bus_spi_attach(bus_spi_t* bus, const unsigned char* cs, const unsigned char cipo,
+                   unsigned char (*io)(void* arg, const unsigned char sck, const unsigned char copi,
+                                       const unsigned char cs),
+                   void* Arg) {
+    if (bus->count >= BUS_SPI_MAX) {
+        return -1;
+    }
+    bus->dev[bus->count].cs = cs;
+    bus->dev[bus->count].cipo = cipo;
+    bus->dev[bus->count].io = io;
+    bus->dev[bus->count].Arg = Arg;
+    bus->count++;
+    return bus->count - 1;
+}
+
+// returns 1 if the device is selected, a deselected device is called once to reset its transfer state
+static int bus_spi_select(bus_spi_dev_t* dev, const unsigned char sck, const unsigned char copi) {
+    if (!*dev->cs) {
+        dev->selected = 1;
+        return 1;
+    }
+    if (dev->selected) {
+        dev->ret = (*dev->io)(dev->Arg, sck, copi, 1);
+        dev->selected = 0;
+        dprintf("bus_spi deselect\n");
+    }
+    return 0;
+}
+
+void bus_spi_io(bus_spi_t* bus, const unsigned char sck, const unsigned char copi) {
+    for (int i = 0; i < bus->count; i++) {
+        bus_spi_dev_t* dev = &bus->dev[i];
+
+        if (bus_spi_select(dev, sck, copi)) {
+            dev->ret = (*dev->io)(dev->Arg, sck, copi, 0);
+        }
+    }
+}
+
+// the devices with the chip select inactive end the transfer, called when the pins change without clocking
+void bus_spi_cs(bus_spi_t* bus) {
+    for (int i = 0; i < bus->count; i++) {
+        bus_spi_select(&bus->dev[i], 0, 0);
+    }
+}
+
+// each bit is clocked as the board controller drives the pins: copi with sck low, cipo sampled by the rising edge
+// and sck low again
+unsigned char bus_spi_transfer(bus_spi_t* bus, const unsigned char data) {
+    unsigned char in = 0xFF;
+
+    for (int i = 0; i < bus->count; i++) {
+        bus_spi_dev_t* dev = &bus->dev[i];
+        unsigned char din = 0;
+
+        if (!bus_spi_select(dev, 0, 0)) {
+            continue;
+        }
+        for (int b = 7; b >= 0; b--) {
+            const unsigned char copi = (data >> b) & 0x01;
+            din = (din << 1) | ((*dev->io)(dev->Arg, 0, copi, 0) & 0x01);
+            (*dev->io)(dev->Arg, 1, copi, 0);
+            dev->ret = (*dev->io)(dev->Arg, 0, copi, 0);
+        }
+        if (dev->cipo) {
+            in &= din;  // shared cipo line
+        }
+    }
+    dprintf("bus_spi transfer 0x%02X 0x%02X\n", data, in);
+    return in;
+}
@@ -0,0 +1,63 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef BUS_SPI
+#define BUS_SPI
+
+#define BUS_SPI_MAX 16
+
+typedef struct {
+    const unsigned char* cs;  // chip select pin value, active low
+    unsigned char cipo;       // wired to the cipo line
+    unsigned char (*io)(void* arg, const unsigned char sck, const unsigned char copi, const unsigned char cs);
+    void* Arg;
+    unsigned char selected;  // selected in the last io
+    unsigned char ret;       // last cipo value
+} bus_spi_dev_t;
+
+// shared SPI bus: only the devices with the chip select active are clocked
+typedef struct {
+    unsigned char count;  // devices attached
+    bus_spi_dev_t dev[BUS_SPI_MAX];
+} bus_spi_t;
+
+void bus_spi_init(bus_spi_t* bus);
+void bus_spi_rst(bus_spi_t* bus);
+void bus_spi_detach_all(bus_spi_t* bus);
+int bus_spi_attach(bus_spi_t* bus, const unsigned char* cs, const unsigned char cipo,
+                   unsigned char (*io)(void* arg, const unsigned char sck, const unsigned char copi,
+                                       const unsigned char cs),
+                   void* Arg);
+
+// bit level: clock the selected devices with the pins value, the cipo of each device is in dev[].ret
+void bus_spi_io(bus_spi_t* bus, const unsigned char sck, const unsigned char copi);
+
+// chip select pins changed: the deselected devices end the transfer
+void bus_spi_cs(bus_spi_t* bus);
+
+// transaction level: one byte full duplex in mode 0, used when the microcontroller model provides the SPI transfers
+unsigned char bus_spi_transfer(bus_spi_t* bus, const unsigned char data);
+
+#endif  // BUS_SPI
@@ -0,0 +1,371 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "eth_vswitch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define dprintf \
+    if (1) {    \
+    } else      \
+        printf
+
+#define VSW_EPORT 49152  // first ephemeral port
+#define VSW_MAX_FLOWS (VSW_MAX_NODES * 8)
+
+static const unsigned char vsw_broadcast[4] = {255, 255, 255, 255};
+
+int eth_vswitch_attach(eth_vswitch_t* sw, const unsigned char* ip) {
+    for (int i = 0; i < VSW_MAX_NODES; i++) {
+        if (sw->node[i].ip == NULL) {
+            sw->node[i].ip = ip;
+            sw->node[i].tick = 0;
+            sw->node[i].head = NULL;
+            sw->node[i].tail = NULL;
+            sw->count++;
+            dprintf("eth_vswitch: node %i attached\n", i);
+            return i;
+        }
+    }
+    printf("eth_vswitch: max number of nodes reached\n");
+    return -1;
+}
+
+void eth_vswitch_detach(eth_vswitch_t* sw, const int id) {
+    if ((id < 0) || (id >= VSW_MAX_NODES) || (sw->node[id].ip == NULL)) {
+        return;
+    }
+    eth_vswitch_flush(sw, id);
+    sw->node[id].ip = NULL;
+    sw->count--;
+    dprintf("eth_vswitch: node %i detached\n", id);
+}
+
+void eth_vswitch_flush(eth_vswitch_t* sw, const int id) {
+    vsw_node_t* node = &sw->node[id];
+
+    while (node->head) {
+        vsw_packet_t* p = node->head;
+        node->head = p->next;
+        free(p);
+    }
+    node->tail = NULL;
+}
+
+void eth_vswitch_tick(eth_vswitch_t* sw, const int id) {
+    sw->node[id].tick++;
+}
+
+unsigned short eth_vswitch_port(eth_vswitch_t* sw) {
+    if (sw->eport < VSW_EPORT) {
+        sw->eport = VSW_EPORT;
+    }
+    return sw->eport++;
+}
+
+// pcap capture with raw IPv4 link type, the IP and TCP/UDP headers are rebuilt from the packet fields
+
+typedef struct {
+    unsigned int magic;
+    unsigned short version_major;
+    unsigned short version_minor;
+    int thiszone;
+    unsigned int sigfigs;
+    unsigned int snaplen;
+    unsigned int network;
+} pcap_hdr_t;
+
+typedef struct {
+    unsigned int ts_sec;
+    unsigned int ts_usec;
+    unsigned int incl_len;
+    unsigned int orig_len;
+} pcaprec_hdr_t;
+
+int eth_vswitch_capture_start(eth_vswitch_t* sw, const char* fname) {
+    pcap_hdr_t hdr;
+
+    sw->pcap_users++;
+    if (sw->pcap) {
+        return 0;
+    }
+
+    if ((sw->pcap = fopen(fname, "wb")) == NULL) {
+        printf("eth_vswitch: Error opening capture file %s\n", fname);
+        sw->pcap_users--;
+        return -1;
+    }
+
+    hdr.magic = 0xa1b2c3d4;
+    hdr.version_major = 2;
+    hdr.version_minor = 4;
+    hdr.thiszone = 0;
+    hdr.sigfigs = 0;
+    hdr.snaplen = 65535;
+    hdr.network = 101;  // LINKTYPE_RAW
+    fwrite(&hdr, sizeof(hdr), 1, sw->pcap);
+
+    sw->pcap_id = 0;
+    sw->pcap_time = 0;
+    sw->flows = (vsw_flow_t*)calloc(VSW_MAX_FLOWS, sizeof(vsw_flow_t));
+    sw->flows_count = 0;
+    printf("eth_vswitch: capture on %s\n", fname);
+    return 0;
+}
+
+void eth_vswitch_capture_stop(eth_vswitch_t* sw) {
+    if (!sw->pcap_users) {
+        return;
+    }
+    sw->pcap_users--;
+    if (!sw->pcap_users && sw->pcap) {
+        fclose(sw->pcap);
+        sw->pcap = NULL;
+        free(sw->flows);
+        sw->flows = NULL;
+    }
+}
+
+static vsw_flow_t* vsw_flow(eth_vswitch_t* sw, const unsigned char* src_ip, const unsigned short src_port,
+                            const unsigned char* dst_ip, const unsigned short dst_port, const int create) {
+    vsw_flow_t* f;
+
+    for (int i = 0; i < sw->flows_count; i++) {
+        f = &sw->flows[i];
+        if ((f->src_port == src_port) && (f->dst_port == dst_port) && !memcmp(f->src_ip, src_ip, 4) &&
+            !memcmp(f->dst_ip, dst_ip, 4)) {
+            return f;
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    // reuse an entry when full
+    if (sw->flows_count < VSW_MAX_FLOWS) {
+        f = &sw->flows[sw->flows_count++];
+    } else {
+        f = &sw->flows[sw->pcap_id % VSW_MAX_FLOWS];
+    }
+    memcpy(f->src_ip, src_ip, 4);
+    memcpy(f->dst_ip, dst_ip, 4);
+    f->src_port = src_port;
+    f->dst_port = dst_port;
+    f->seq = 0;
+    return f;
+}
+
+static unsigned int vsw_checksum_add(unsigned int sum, const unsigned char* data, const int len) {
+    for (int i = 0; i < len; i += 2) {
+        sum += (data[i] << 8) | ((i + 1) < len ? data[i + 1] : 0);
+    }
+    return sum;
+}
+
+static unsigned short vsw_checksum_end(unsigned int sum) {
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return ~sum;
+}
+
+static void vsw_capture(eth_vswitch_t* sw, const unsigned int tick, const vsw_packet_t* p) {
+    unsigned char hdr[40];
+    unsigned char pseudo[12];
+    pcaprec_hdr_t rec;
+    int hlen = (p->proto == VSW_TCP) ? 20 : 8;
+    int total = 20 + hlen + p->len;
+    unsigned int sum;
+
+    memset(hdr, 0, sizeof(hdr));
+
+    // IPv4 header
+    hdr[0] = 0x45;
+    hdr[2] = total >> 8;
+    hdr[3] = total & 0xFF;
+    hdr[4] = sw->pcap_id >> 8;
+    hdr[5] = sw->pcap_id & 0xFF;
+    hdr[6] = 0x40;  // don't fragment
+    hdr[8] = 64;    // ttl
+    hdr[9] = p->proto;
+    memcpy(&hdr[12], p->src_ip, 4);
+    memcpy(&hdr[16], p->dst_ip, 4);
+    sum = vsw_checksum_end(vsw_checksum_add(0, hdr, 20));
+    hdr[10] = sum >> 8;
+    hdr[11] = sum & 0xFF;
+    sw->pcap_id++;
+
+    unsigned char* l4 = &hdr[20];
+    l4[0] = p->src_port >> 8;
+    l4[1] = p->src_port & 0xFF;
+    l4[2] = p->dst_port >> 8;
+    l4[3] = p->dst_port & 0xFF;
+
+    if (p->proto == VSW_TCP) {
+        vsw_flow_t* f = vsw_flow(sw, p->src_ip, p->src_port, p->dst_ip, p->dst_port, 1);
+        vsw_flow_t* r = vsw_flow(sw, p->dst_ip, p->dst_port, p->src_ip, p->src_port, 0);
+        unsigned int ack = r ? r->seq : 0;
+
+        if (p->flags & VSW_SYN) {
+            f->seq = 0;
+        }
+        l4[4] = f->seq >> 24;
+        l4[5] = (f->seq >> 16) & 0xFF;
+        l4[6] = (f->seq >> 8) & 0xFF;
+        l4[7] = f->seq & 0xFF;
+        if (p->flags & VSW_ACK) {
+            l4[8] = ack >> 24;
+            l4[9] = (ack >> 16) & 0xFF;
+            l4[10] = (ack >> 8) & 0xFF;
+            l4[11] = ack & 0xFF;
+        }
+        l4[12] = 0x50;  // data offset
+        l4[13] = p->flags;
+        l4[14] = 0x40;  // window 16k
+        f->seq += p->len + ((p->flags & (VSW_SYN | VSW_FIN)) ? 1 : 0);
+    } else {
+        l4[4] = (hlen + p->len) >> 8;
+        l4[5] = (hlen + p->len) & 0xFF;
+    }
+
+    memcpy(pseudo, p->src_ip, 4);
+    memcpy(&pseudo[4], p->dst_ip, 4);
+    pseudo[8] = 0;
+    pseudo[9] = p->proto;
+    pseudo[10] = (hlen + p->len) >> 8;
+    pseudo[11] = (hlen + p->len) & 0xFF;
+    // the header length is even, the data can continue the same sum
+    sum = vsw_checksum_add(0, pseudo, 12);
+    sum = vsw_checksum_add(sum, l4, hlen);
+    sum = vsw_checksum_end(vsw_checksum_add(sum, p->data, p->len));
+    if ((p->proto == VSW_UDP) && !sum) {
+        sum = 0xFFFF;
+    }
+    l4[(p->proto == VSW_TCP) ? 16 : 6] = sum >> 8;
+    l4[(p->proto == VSW_TCP) ? 17 : 7] = sum & 0xFF;
+
+    // the nodes ticks are not aligned, keep the timestamps monotonic
+    if ((int)(tick - sw->pcap_time) > 0) {
+        sw->pcap_time = tick;
+    }
+    rec.ts_sec = sw->pcap_time / (1000000L / VSW_TICK_US);
+    rec.ts_usec = (sw->pcap_time % (1000000L / VSW_TICK_US)) * VSW_TICK_US;
+    rec.incl_len = total;
+    rec.orig_len = total;
+    fwrite(&rec, sizeof(rec), 1, sw->pcap);
+    fwrite(hdr, 20 + hlen, 1, sw->pcap);
+    fwrite(p->data, p->len, 1, sw->pcap);
+}
+
+static void vsw_enqueue(eth_vswitch_t* sw, const int id, const vsw_packet_t* src) {
+    vsw_node_t* node = &sw->node[id];
+    vsw_packet_t* p = (vsw_packet_t*)malloc(sizeof(vsw_packet_t) + src->len);
+
+    if (!p) {
+        printf("eth_vswitch: Error allocating packet, dropped\n");
+        return;
+    }
+
+    *p = *src;
+    p->next = NULL;
+    p->due = node->tick + VSW_LATENCY;
+    p->data = (unsigned char*)(p + 1);
+    memcpy(p->data, src->data, src->len);
+
+    if (node->tail) {
+        node->tail->next = p;
+    } else {
+        node->head = p;
+    }
+    node->tail = p;
+}
+
+int eth_vswitch_send(eth_vswitch_t* sw, const int id, const unsigned char proto, const unsigned char flags,
+                     const unsigned short src_port, const unsigned char* dst_ip, const unsigned short dst_port,
+                     const unsigned char* data, const unsigned short len) {
+    vsw_packet_t p;
+    int reached = 0;
+    const int broadcast = !memcmp(dst_ip, vsw_broadcast, 4);
+
+    p.proto = proto;
+    p.flags = flags;
+    memcpy(p.src_ip, sw->node[id].ip, 4);
+    p.src_port = src_port;
+    memcpy(p.dst_ip, dst_ip, 4);
+    p.dst_port = dst_port;
+    p.len = len;
+    p.offset = 0;
+    p.data = (unsigned char*)data;
+
+    if (sw->pcap) {
+        vsw_capture(sw, sw->node[id].tick, &p);
+    }
+
+    for (int i = 0; i < VSW_MAX_NODES; i++) {
+        if (sw->node[i].ip == NULL) {
+            continue;
+        }
+        if (broadcast) {
+            if (i != id) {
+                vsw_enqueue(sw, i, &p);
+                reached++;
+            }
+        } else if (!memcmp(sw->node[i].ip, dst_ip, 4)) {
+            vsw_enqueue(sw, i, &p);
+            return 1;
+        }
+    }
+    return reached;
+}
+
+vsw_packet_t* eth_vswitch_peek(eth_vswitch_t* sw, const int id, vsw_packet_t* prev) {
+    vsw_node_t* node = &sw->node[id];
+    vsw_packet_t* p = prev ? prev->next : node->head;
+
+    // the packets are queued in the delivery order
+    if (p && ((int)(node->tick - p->due) >= 0)) {
+        return p;
+    }
+    return NULL;
+}
+
+void eth_vswitch_remove(eth_vswitch_t* sw, const int id, vsw_packet_t* prev) {
+    vsw_node_t* node = &sw->node[id];
+    vsw_packet_t* p = prev ? prev->next : node->head;
+
+    if (!p) {
+        return;
+    }
+    if (prev) {
+        prev->next = p->next;
+    } else {
+        node->head = p->next;
+    }
+    if (node->tail == p) {
+        node->tail = prev;
+    }
+    free(p);
+}
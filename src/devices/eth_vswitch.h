@@ -0,0 +1,108 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef ETH_VSWITCH
+#define ETH_VSWITCH
+
+#include <stdio.h>
+
+#define VSW_MAX_NODES 64
+#define VSW_TICK_US 100                           // simulated time between two eth_vswitch_tick calls of a node
+#define VSW_LATENCY_US 100                        // delivery delay in simulated time
+#define VSW_LATENCY (VSW_LATENCY_US / VSW_TICK_US)  // delivery delay in node ticks
+
+#define VSW_TCP 6
+#define VSW_UDP 17
+
+// TCP segment flags
+#define VSW_FIN 0x01
+#define VSW_SYN 0x02
+#define VSW_RST 0x04
+#define VSW_PSH 0x08
+#define VSW_ACK 0x10
+
+typedef struct vsw_packet {
+    struct vsw_packet* next;
+    unsigned int due;  // destination node tick of delivery
+    unsigned char proto;
+    unsigned char flags;
+    unsigned char src_ip[4];
+    unsigned short src_port;
+    unsigned char dst_ip[4];
+    unsigned short dst_port;
+    unsigned short len;
+    unsigned short offset;  // data already delivered
+    unsigned char* data;
+} vsw_packet_t;
+
+typedef struct {
+    const unsigned char* ip;  // node address, read on each routing, NULL if the node is free
+    unsigned int tick;
+    vsw_packet_t* head;
+    vsw_packet_t* tail;
+} vsw_node_t;
+
+// TCP sequence numbers of the captured flows
+typedef struct {
+    unsigned char src_ip[4];
+    unsigned char dst_ip[4];
+    unsigned short src_port;
+    unsigned short dst_port;
+    unsigned int seq;
+} vsw_flow_t;
+
+// in-process L3 switch: packets are routed by destination address to the nodes queues
+typedef struct {
+    unsigned char count;  // attached nodes
+    vsw_node_t node[VSW_MAX_NODES];
+    unsigned short eport;  // next ephemeral port
+    FILE* pcap;
+    int pcap_users;
+    unsigned short pcap_id;  // IP identification counter
+    unsigned int pcap_time;  // last timestamp in ticks
+    vsw_flow_t* flows;
+    unsigned short flows_count;
+} eth_vswitch_t;
+
+int eth_vswitch_attach(eth_vswitch_t* sw, const unsigned char* ip);
+void eth_vswitch_detach(eth_vswitch_t* sw, const int id);
+void eth_vswitch_flush(eth_vswitch_t* sw, const int id);
+void eth_vswitch_tick(eth_vswitch_t* sw, const int id);
+unsigned short eth_vswitch_port(eth_vswitch_t* sw);
+
+int eth_vswitch_capture_start(eth_vswitch_t* sw, const char* fname);
+void eth_vswitch_capture_stop(eth_vswitch_t* sw);
+
+// returns the number of nodes reached
+int eth_vswitch_send(eth_vswitch_t* sw, const int id, const unsigned char proto, const unsigned char flags,
+                     const unsigned short src_port, const unsigned char* dst_ip, const unsigned short dst_port,
+                     const unsigned char* data, const unsigned short len);
+
+// next packet due on the node queue after prev (NULL for the first), NULL if none
+vsw_packet_t* eth_vswitch_peek(eth_vswitch_t* sw, const int id, vsw_packet_t* prev);
+// remove and free the packet after prev (NULL for the first)
+void eth_vswitch_remove(eth_vswitch_t* sw, const int id, vsw_packet_t* prev);
+
+#endif  // ETH_VSWITCH
@@ -42,13 +42,17 @@ typedef unsigned int u_int32_t;
 #endif
 #define INVALID_SOCKET_VALUE -1
 
+#if !defined(_WIN_) && !defined(__EMSCRIPTEN__)
+#define ETH_W5500_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #include <errno.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 
 // #define DEBUG
-// #define DUMP
 // #define TEXTDUMP
 
 #define dprintf \
@@ -72,7 +76,12 @@ typedef unsigned int u_int32_t;
 void setblock(int sock_descriptor);
 void setnblock(int sock_descriptor);
 
-#define CONN_TIMEOUT 100000L  // 10 seconds
+#define CONN_TIMEOUT (10000000L / ETH_W5500_PROCESS_US)  // 10 seconds
+#define ACTIVE_TIME (200000L / ETH_W5500_PROCESS_US)     // activity LED on time, 200 ms
+
+// readiness flags
+#define RDY_IN 0x01
+#define RDY_OUT 0x02
 
 #ifdef DEBUG
 
@@ -452,6 +461,83 @@ static const char* debug_BSB(eth_w5500_t* eth) {
 }
 #endif
 
+// add a host socket to the readiness set, id 0-7 for sockets and 8-15 for listen sockets
+static void eth_w5500_watch(eth_w5500_t* eth, const int fd, const int id) {
+    eth->ready[id] = 0;
+#ifdef ETH_W5500_EPOLL
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.u32 = id;
+    if ((eth->epfd >= 0) && (fd != INVALID_SOCKET_VALUE) && epoll_ctl(eth->epfd, EPOLL_CTL_ADD, fd, &ev)) {
+        printf("eth_w5500: epoll_ctl error : %s \n", strerror(errno));
+    }
+#endif
+}
+
+// collect the pending readiness events, the flags are cleared only when the socket returns EAGAIN
+static void eth_w5500_poll(eth_w5500_t* eth) {
+#ifdef ETH_W5500_EPOLL
+    struct epoll_event ev[16];
+    int count;
+
+    if (eth->epfd >= 0) {
+        count = epoll_wait(eth->epfd, ev, 16, 0);
+        for (int i = 0; i < count; i++) {
+            if (ev[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                eth->ready[ev[i].data.u32] |= RDY_IN;
+            }
+            if (ev[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) {
+                eth->ready[ev[i].data.u32] |= RDY_OUT;
+            }
+        }
+        return;
+    }
+#endif
+    // no readiness notification, try all sockets
+    memset(eth->ready, RDY_IN | RDY_OUT, sizeof(eth->ready));
+}
+
+static int eth_w5500_again(void) {
+#ifndef _WIN_
+    return (errno == EAGAIN) || (errno == EWOULDBLOCK);
+#else
+    return (WSAGetLastError() == WSAEWOULDBLOCK);
+#endif
+}
+
+// socket buffers are allocated in sequence on the 16k RX and TX memories, valid sizes are 0, 1, 2, 4, 8 and 16k
+static void eth_w5500_buffers(eth_w5500_t* eth) {
+    unsigned int rx_ptr = 0;
+    unsigned int tx_ptr = 0;
+
+    for (int n = 0; n < 8; n++) {
+        unsigned int rx_size = eth->Socket[n][Sn_RXBUF_SIZE];
+        unsigned int tx_size = eth->Socket[n][Sn_TXBUF_SIZE];
+
+        if ((rx_size > 16) || (rx_size & (rx_size - 1)) || ((rx_ptr + rx_size * 1024) > 0x4000)) {
+            rx_size = 0;
+        }
+        if ((tx_size > 16) || (tx_size & (tx_size - 1)) || ((tx_ptr + tx_size * 1024) > 0x4000)) {
+            tx_size = 0;
+        }
+        rx_size *= 1024;
+        tx_size *= 1024;
+
+        eth->RX_size[n] = rx_size;
+        eth->RX_mask[n] = rx_size ? rx_size - 1 : 0;
+        eth->RX_ptr[n] = rx_size ? rx_ptr : 0;
+        rx_ptr += rx_size;
+
+        if (eth->TX_size[n] != tx_size) {
+            writeWord(eth->Socket[n], Sn_TX_FSR0, tx_size);
+        }
+        eth->TX_size[n] = tx_size;
+        eth->TX_mask[n] = tx_size ? tx_size - 1 : 0;
+        eth->TX_ptr[n] = tx_size ? tx_ptr : 0;
+        tx_ptr += tx_size;
+    }
+}
+
 void eth_w5500_rst(eth_w5500_t* eth) {
     bitbang_spi_rst(&eth->bb_spi);
     eth->control = 0;
@@ -468,32 +554,39 @@ void eth_w5500_rst(eth_w5500_t* eth) {
     } else {
         eth->Common[CR_PHYCFGR] &= ~0x01;  // link off
     }
-    // TODO add support to buffer size different of 2k
     for (int n = 0; n < 8; n++) {
         eth->sockfd[n] = INVALID_SOCKET_VALUE;
         eth->Socket[n][Sn_TXBUF_SIZE] = 2;
         eth->Socket[n][Sn_RXBUF_SIZE] = 2;
-
-        eth->RX_size[n] = eth->Socket[n][Sn_RXBUF_SIZE] * 1024;
-        eth->TX_size[n] = eth->Socket[n][Sn_TXBUF_SIZE] * 1024;
-        eth->RX_mask[n] = eth->RX_size[n] - 1;
-        eth->TX_mask[n] = eth->TX_size[n] - 1;
-
-        writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
-
-        eth->RX_ptr[n] = eth->RX_size[n] * n;
-        eth->TX_ptr[n] = eth->TX_size[n] * n;
         eth->listenfd_map[n] = 0;
     }
+    eth_w5500_buffers(eth);
+    for (int n = 0; n < 8; n++) {
+        writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
+    }
+    memset(eth->ready, 0, sizeof(eth->ready));
+    if (eth->vsw) {
+        eth_vswitch_flush(eth->vsw, eth->vsw_id);
+    }
     dprintf("rst w5500\n");
 }
 
 void eth_w5500_init(eth_w5500_t* eth, unsigned char linkon) {
     eth->link = linkon;
+    eth->epfd = -1;
+    eth->vsw = NULL;
+    eth->vsw_id = -1;
+    memset(eth->conn_timeout, 0, sizeof(eth->conn_timeout));
+#ifdef ETH_W5500_EPOLL
+    if ((eth->epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        printf("eth_w5500: epoll_create1 error : %s \n", strerror(errno));
+    }
+#endif
     bitbang_spi_init(&eth->bb_spi);
     eth_w5500_rst(eth);
 
     for (int n = 0; n < 8; n++) {
+        eth->sockfd[n] = INVALID_SOCKET_VALUE;
         eth->listenfd[n] = INVALID_SOCKET_VALUE;
         eth->listenfd_port[n] = 0;
     }
@@ -510,6 +603,11 @@ void eth_w5500_end(eth_w5500_t* eth) {
             close(eth->listenfd[n]);
         }
     }
+    if (eth->epfd >= 0) {
+        close(eth->epfd);
+        eth->epfd = -1;
+    }
+    eth_w5500_set_switch(eth, NULL);
 }
 
 void eth_w5500_set_link(eth_w5500_t* eth, unsigned char on) {
@@ -521,13 +619,54 @@ void eth_w5500_set_link(eth_w5500_t* eth, unsigned char on) {
     }
 }
 
+// move the sockets between the host network and a virtual switch, the open sockets are closed
+int eth_w5500_set_switch(eth_w5500_t* eth, eth_vswitch_t* sw) {
+    if (eth->vsw == sw) {
+        return 0;
+    }
+
+    for (int n = 0; n < 8; n++) {
+        if (eth->sockfd[n] != INVALID_SOCKET_VALUE) {
+            close(eth->sockfd[n]);
+            eth->sockfd[n] = INVALID_SOCKET_VALUE;
+        }
+        if (eth->listenfd[n] != INVALID_SOCKET_VALUE) {
+            close(eth->listenfd[n]);
+            eth->listenfd[n] = INVALID_SOCKET_VALUE;
+        }
+        eth->listenfd_port[n] = 0;
+        eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+        eth->bindp[n] = 0;
+    }
+    memset(eth->ready, 0, sizeof(eth->ready));
+
+    if (eth->vsw) {
+        eth_vswitch_detach(eth->vsw, eth->vsw_id);
+        eth->vsw_id = -1;
+    }
+
+    eth->vsw = sw;
+    if (sw && ((eth->vsw_id = eth_vswitch_attach(sw, &eth->Common[CR_SIPR0])) < 0)) {
+        eth->vsw = NULL;
+        return -1;
+    }
+    return 0;
+}
+
 unsigned char eth_w5500_get_leds(eth_w5500_t* eth) {
     return (eth->Common[CR_PHYCFGR] & 0x03) | ((eth->active > 0) << 3);
 }
 
-#ifdef DUMP
-static int scont = 0;
-#endif
+unsigned char eth_w5500_get_int(eth_w5500_t* eth) {
+    unsigned char sir = 0;
+    for (int n = 0; n < 8; n++) {
+        if (eth->Socket[n][Sn_IR] & eth->Socket[n][Sn_IMR]) {
+            sir |= (1 << n);
+        }
+    }
+    eth->Common[CR_SIR] = sir;
+    return ((sir & eth->Common[CR_SIMR]) || (eth->Common[CR_IR] & eth->Common[CR_IMR]));
+}
 
 // http://www.tcpipguide.com/free/t_DHCPMessageFormat.htm
 
@@ -579,7 +718,7 @@ typedef struct dhcp {
 #define dhcpClientIdentifier 61
 #define dhcpendOption 255
 
-static void eth_w5500_fake_dhcp_reply(eth_w5500_t* eth, int n) {
+static void eth_w5500_fake_dhcp_reply(eth_w5500_t* eth, int n, const unsigned char host) {
     char temp_buff[0x4000];
     char skt_addr[30];
     dhcp_t* dhcp_pack = (dhcp_t*)&eth->TX_Mem[eth->TX_ptr[n]];
@@ -588,10 +727,6 @@ static void eth_w5500_fake_dhcp_reply(eth_w5500_t* eth, int n) {
     unsigned short addr_base;
     int s;
     int i;
-#ifdef DUMP
-    char sfname[30];
-    FILE* fouts;
-#endif
 
     if (!eth->link)
         return;
@@ -601,7 +736,7 @@ static void eth_w5500_fake_dhcp_reply(eth_w5500_t* eth, int n) {
     dhcp_pack->yiaddr[0] = 192;
     dhcp_pack->yiaddr[1] = 168;
     dhcp_pack->yiaddr[2] = 0;
-    dhcp_pack->yiaddr[3] = 10;
+    dhcp_pack->yiaddr[3] = host;
 
     dhcp_pack->siaddr[0] = 192;
     dhcp_pack->siaddr[1] = 168;
@@ -686,7 +821,7 @@ static void eth_w5500_fake_dhcp_reply(eth_w5500_t* eth, int n) {
     sprintf(skt_addr, "%i.%i.%i.%i", eth->Socket[n][Sn_DIPR0], eth->Socket[n][Sn_DIPR1], eth->Socket[n][Sn_DIPR2],
             eth->Socket[n][Sn_DIPR3]);
 
-    eth->active = 2;
+    eth->active = ACTIVE_TIME;
 
     s = 240 + op;
     memcpy(temp_buff + 8, dhcp_pack, s);
@@ -721,23 +856,391 @@ static void eth_w5500_fake_dhcp_reply(eth_w5500_t* eth, int n) {
     }
     writeWord(eth->Socket[n], Sn_RX_RSR0, size);
 
-#ifdef DUMP
-    sprintf(sfname, "/tmp/%03i_recv_udp.bin", scont++);
-    fouts = fopen(sfname, "w");
-    fwrite(temp_buff, s, 1, fouts);
-    fclose(fouts);
-#endif
-
 #ifdef TEXTDUMP
     temp_buff[s] = 0;
     printf(temp_buff);
 #endif
 }
 
-static unsigned int conn_timeout[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+// receive straight into the socket RX buffer, until the buffer is full or the host socket is empty
+static void eth_w5500_recv_tcp(eth_w5500_t* eth, const int n) {
+    int size;
+    int s = 1;
+    int total = 0;
+    unsigned short addr;
+    unsigned short addr_base = readWord(eth->Socket[n], Sn_RX_WR0);
+
+    size = eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0);
+
+    while (size > 0) {
+        int len;
+
+        addr = (addr_base + total) & eth->RX_mask[n];
+        len = eth->RX_size[n] - addr;  // up to the ring end
+        if (len > size) {
+            len = size;
+        }
+        if ((s = recv(eth->sockfd[n], (char*)&eth->RX_Mem[eth->RX_ptr[n] + addr], len, 0)) <= 0) {
+            break;
+        }
+        total += s;
+        size -= s;
+    }
+
+    if (s < 0) {
+        if (eth_w5500_again()) {
+            eth->ready[n] &= ~RDY_IN;
+        } else {
+            printf("eth_w5500: recv tcp error :[%i] %s \n", errno, strerror(errno));
+            eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+            eth->status[n] = ER_RECV;
+        }
+    } else if (s == 0) {
+        // connection closed by the peer
+        dsprintf("eth_w5500: Socket %i Disconnected\n", n);
+        eth->ready[n] &= ~RDY_IN;
+        eth->Socket[n][Sn_SR] = SOCK_CLOSE_WAIT;
+        eth->Socket[n][Sn_IR] |= 0x02;
+    }
+
+    if (total > 0) {
+        eth->active = ACTIVE_TIME;
+        eth->Socket[n][Sn_IR] |= 0x04;
+
+        dsprintf("eth_w5500: Socket %i Received %i\n", n, total);
+        writeWord(eth->Socket[n], Sn_RX_WR0, addr_base + total);
+
+        size = readWord(eth->Socket[n], Sn_RX_WR0);
+        size -= readWord(eth->Socket[n], Sn_RX_RD0);
+
+        if (size < 0) {
+            size += eth->RX_size[n];
+        }
+
+        writeWord(eth->Socket[n], Sn_RX_RSR0, size);
+    }
+}
+
+// virtual switch: the sockets exchange packets with the other switch nodes instead of using the host network
+
+static void eth_w5500_vsw_rx(eth_w5500_t* eth, const int n, const unsigned char* data, const int len) {
+    int size;
+    unsigned short addr_base = readWord(eth->Socket[n], Sn_RX_WR0);
+
+    for (int i = 0; i < len; i++) {
+        eth->RX_Mem[eth->RX_ptr[n] + ((addr_base + i) & eth->RX_mask[n])] = data[i];
+    }
+    writeWord(eth->Socket[n], Sn_RX_WR0, addr_base + len);
+
+    size = readWord(eth->Socket[n], Sn_RX_WR0);
+    size -= readWord(eth->Socket[n], Sn_RX_RD0);
+    if (size < 0) {
+        size += eth->RX_size[n];
+    }
+    writeWord(eth->Socket[n], Sn_RX_RSR0, size);
+
+    eth->active = ACTIVE_TIME;
+    eth->Socket[n][Sn_IR] |= 0x04;
+}
+
+static void eth_w5500_vsw_reset_ptrs(eth_w5500_t* eth, const int n) {
+    writeWord(eth->Socket[n], Sn_TX_RD0, 0);
+    writeWord(eth->Socket[n], Sn_TX_WR0, 0);
+    writeWord(eth->Socket[n], Sn_RX_RD0, 0);
+    writeWord(eth->Socket[n], Sn_RX_WR0, 0);
+    writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
+    writeWord(eth->Socket[n], Sn_RX_RSR0, 0);
+}
+
+static void eth_w5500_vsw_send_tcp(eth_w5500_t* eth, const int n, const unsigned char flags,
+                                   const unsigned char* data, const unsigned short len) {
+    eth_vswitch_send(eth->vsw, eth->vsw_id, VSW_TCP, flags, readWord(eth->Socket[n], Sn_PORT0),
+                     &eth->Socket[n][Sn_DIPR0], readWord(eth->Socket[n], Sn_DPORT0), data, len);
+}
+
+// connected socket of a TCP packet, -1 if none
+static int eth_w5500_vsw_socket(eth_w5500_t* eth, const vsw_packet_t* p) {
+    for (int n = 0; n < 8; n++) {
+        if (((eth->Socket[n][Sn_MR] & 0x0F) != Sn_MR_TCP) ||
+            ((eth->Socket[n][Sn_SR] != SOCK_ESTABLISHED) && (eth->Socket[n][Sn_SR] != SOCK_CLOSE_WAIT) &&
+             (eth->Socket[n][Sn_SR] != SOCK_SYNSENT) && (eth->Socket[n][Sn_SR] != SOCK_FIN_WAIT))) {
+            continue;
+        }
+        if ((readWord(eth->Socket[n], Sn_PORT0) == p->dst_port) &&
+            (readWord(eth->Socket[n], Sn_DPORT0) == p->src_port) && !memcmp(&eth->Socket[n][Sn_DIPR0], p->src_ip, 4)) {
+            return n;
+        }
+    }
+    return -1;
+}
+
+static void eth_w5500_vsw_reply_rst(eth_w5500_t* eth, const vsw_packet_t* p) {
+    if (!(p->flags & VSW_RST)) {
+        eth_vswitch_send(eth->vsw, eth->vsw_id, VSW_TCP, VSW_RST | VSW_ACK, p->dst_port, p->src_ip, p->src_port,
+                         NULL, 0);
+    }
+}
+
+static void eth_w5500_vsw_accept(eth_w5500_t* eth, const vsw_packet_t* p) {
+    for (int n = 0; n < 8; n++) {
+        if (((eth->Socket[n][Sn_MR] & 0x0F) == Sn_MR_TCP) && (eth->Socket[n][Sn_SR] == SOCK_LISTEN) &&
+            (readWord(eth->Socket[n], Sn_PORT0) == p->dst_port)) {
+            memcpy(&eth->Socket[n][Sn_DIPR0], p->src_ip, 4);
+            writeWord(eth->Socket[n], Sn_DPORT0, p->src_port);
+            eth_w5500_vsw_reset_ptrs(eth, n);
+            eth->Socket[n][Sn_SR] = SOCK_ESTABLISHED;
+            eth->Socket[n][Sn_IR] |= 0x01;
+            eth->bindp[n] = 0;
+            dsprintf("eth_w5500: Socket %i Connected\n", n);
+            eth_w5500_vsw_send_tcp(eth, n, VSW_SYN | VSW_ACK, NULL, 0);
+            return;
+        }
+    }
+    // no one listening
+    eth_w5500_vsw_reply_rst(eth, p);
+}
+
+// returns 0 if the packet must stay in queue waiting RX buffer space
+static int eth_w5500_vsw_deliver_tcp(eth_w5500_t* eth, vsw_packet_t* p, unsigned char* blocked) {
+    int n;
+    int len;
+
+    if ((p->flags & (VSW_SYN | VSW_ACK)) == VSW_SYN) {
+        eth_w5500_vsw_accept(eth, p);
+        return 1;
+    }
+
+    if ((n = eth_w5500_vsw_socket(eth, p)) < 0) {
+        eth_w5500_vsw_reply_rst(eth, p);
+        return 1;
+    }
+
+    if (*blocked & (1 << n)) {
+        return 0;  // keep the connection packets order
+    }
+
+    if (p->flags & VSW_RST) {
+        if (eth->Socket[n][Sn_SR] == SOCK_SYNSENT) {
+            eth->Socket[n][Sn_IR] |= 0x08;  // timeout
+            eth->status[n] = ER_CONN;
+        } else {
+            eth->Socket[n][Sn_IR] |= 0x02;
+        }
+        eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+        return 1;
+    }
+
+    if (p->flags & VSW_SYN) {
+        if (eth->Socket[n][Sn_SR] == SOCK_SYNSENT) {
+            dsprintf("eth_w5500: Socket %i Connected\n", n);
+            eth->Socket[n][Sn_SR] = SOCK_ESTABLISHED;
+            eth->Socket[n][Sn_IR] |= 0x01;
+        }
+        return 1;
+    }
+
+    len = p->len - p->offset;
+    if (len > (eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0))) {
+        len = eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0);
+    }
+    if (len > 0) {
+        eth_w5500_vsw_rx(eth, n, &p->data[p->offset], len);
+        p->offset += len;
+    }
+    if (p->offset < p->len) {
+        *blocked |= 1 << n;
+        return 0;
+    }
+
+    if (p->flags & VSW_FIN) {
+        dsprintf("eth_w5500: Socket %i Disconnected\n", n);
+        eth->Socket[n][Sn_SR] = (eth->Socket[n][Sn_SR] == SOCK_FIN_WAIT) ? SOCK_CLOSED : SOCK_CLOSE_WAIT;
+        eth->Socket[n][Sn_IR] |= 0x02;
+    }
+    return 1;
+}
+
+static void eth_w5500_vsw_deliver_udp(eth_w5500_t* eth, const vsw_packet_t* p) {
+    unsigned char header[8];
+
+    for (int n = 0; n < 8; n++) {
+        if ((eth->Socket[n][Sn_SR] != SOCK_UDP) || (readWord(eth->Socket[n], Sn_PORT0) != p->dst_port)) {
+            continue;
+        }
+        // datagrams that don't fit are lost
+        if ((p->len + 8) > (eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0))) {
+            return;
+        }
+        memcpy(header, p->src_ip, 4);
+        header[4] = p->src_port >> 8;
+        header[5] = p->src_port & 0xFF;
+        header[6] = p->len >> 8;
+        header[7] = p->len & 0xFF;
+        memcpy(&eth->Socket[n][Sn_DIPR0], p->src_ip, 4);
+        writeWord(eth->Socket[n], Sn_DPORT0, p->src_port);
+        dsprintf("eth_w5500: Socket %i Received %i\n", n, p->len);
+        eth_w5500_vsw_rx(eth, n, header, 8);
+        eth_w5500_vsw_rx(eth, n, p->data, p->len);
+        return;
+    }
+}
+
+// deliver the due packets, a blocked connection doesn't stop the others
+static void eth_w5500_vsw_deliver(eth_w5500_t* eth) {
+    vsw_packet_t* prev = NULL;
+    vsw_packet_t* p;
+    unsigned char blocked = 0;
+
+    while ((p = eth_vswitch_peek(eth->vsw, eth->vsw_id, prev)) != NULL) {
+        int done = 1;
+
+        if (p->proto == VSW_TCP) {
+            done = eth_w5500_vsw_deliver_tcp(eth, p, &blocked);
+        } else {
+            eth_w5500_vsw_deliver_udp(eth, p);
+        }
+
+        if (done) {
+            eth_vswitch_remove(eth->vsw, eth->vsw_id, prev);
+        } else {
+            prev = p;
+        }
+    }
+}
+
+static void eth_w5500_vsw_process(eth_w5500_t* eth) {
+    eth_vswitch_tick(eth->vsw, eth->vsw_id);
+
+    if (!eth->link) {
+        eth_vswitch_flush(eth->vsw, eth->vsw_id);
+        return;
+    }
+
+    eth_w5500_vsw_deliver(eth);
+}
+
+static void eth_w5500_vsw_command(eth_w5500_t* eth, const int n) {
+    int size;
+
+    switch (eth->Socket[n][Sn_CR]) {
+        case OPEN:
+            switch (eth->Socket[n][Sn_MR] & 0x0F) {
+                case Sn_MR_CLOSE:
+                    eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+                    break;
+                case Sn_MR_TCP:
+                    eth->Socket[n][Sn_SR] = SOCK_INIT;
+                    break;
+                case Sn_MR_UDP:
+                    eth->Socket[n][Sn_SR] = SOCK_UDP;
+                    eth->bindp[n] = readWord(eth->Socket[n], Sn_PORT0);
+                    break;
+                case S0_MR_MACRAW:
+                    if (n == 0) {
+                        printf("eth_w5500: S0_MR_MACRAW Not implemented\n");
+                    }
+                    break;
+            }
+            eth_w5500_vsw_reset_ptrs(eth, n);
+            eth->status[n] = 0;
+            break;
+        case LISTEN:
+            if (((eth->Socket[n][Sn_MR] & 0x0F) != Sn_MR_TCP) || (eth->Socket[n][Sn_SR] != SOCK_INIT))
+                break;
+            eth->Socket[n][Sn_SR] = SOCK_LISTEN;
+            eth->bindp[n] = readWord(eth->Socket[n], Sn_PORT0);
+            break;
+        case CONNECT:
+            if (((eth->Socket[n][Sn_MR] & 0x0F) != Sn_MR_TCP) || (eth->Socket[n][Sn_SR] != SOCK_INIT))
+                break;
+            if (!readWord(eth->Socket[n], Sn_PORT0)) {
+                size = eth_vswitch_port(eth->vsw);
+                writeWord(eth->Socket[n], Sn_PORT0, size);
+            }
+            eth->status[n] = 0;
+            eth->Socket[n][Sn_SR] = SOCK_SYNSENT;
+            if (!eth->link || !eth_vswitch_send(eth->vsw, eth->vsw_id, VSW_TCP, VSW_SYN,
+                                                readWord(eth->Socket[n], Sn_PORT0), &eth->Socket[n][Sn_DIPR0],
+                                                readWord(eth->Socket[n], Sn_DPORT0), NULL, 0)) {
+                // no node with the destination address
+                eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+                eth->Socket[n][Sn_IR] |= 0x08;
+                eth->status[n] = ER_CONN;
+            }
+            break;
+        case DISCON:
+            // half close, the socket receives until the peer closes too
+            if (eth->Socket[n][Sn_SR] == SOCK_ESTABLISHED) {
+                eth_w5500_vsw_send_tcp(eth, n, VSW_FIN | VSW_ACK, NULL, 0);
+                eth->Socket[n][Sn_SR] = SOCK_FIN_WAIT;
+            } else if (eth->Socket[n][Sn_SR] == SOCK_CLOSE_WAIT) {
+                eth_w5500_vsw_send_tcp(eth, n, VSW_FIN | VSW_ACK, NULL, 0);
+                eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+            }
+            break;
+        case CLOSE:
+            if ((eth->Socket[n][Sn_SR] == SOCK_ESTABLISHED) || (eth->Socket[n][Sn_SR] == SOCK_CLOSE_WAIT) ||
+                (eth->Socket[n][Sn_SR] == SOCK_SYNSENT) || (eth->Socket[n][Sn_SR] == SOCK_FIN_WAIT)) {
+                eth_w5500_vsw_send_tcp(eth, n, VSW_RST | VSW_ACK, NULL, 0);
+            }
+            eth->Socket[n][Sn_SR] = SOCK_CLOSED;
+            break;
+        case SEND:
+            size = readWord(eth->Socket[n], Sn_TX_WR0);
+            if (size > eth->TX_size[n]) {
+                size = eth->TX_size[n];
+            }
+
+            switch (eth->Socket[n][Sn_MR] & 0x0F) {
+                case Sn_MR_TCP:
+                    if ((eth->Socket[n][Sn_SR] != SOCK_ESTABLISHED) && (eth->Socket[n][Sn_SR] != SOCK_CLOSE_WAIT))
+                        return;
+                    if (eth->link && size) {
+                        eth->active = ACTIVE_TIME;
+                        eth_w5500_vsw_send_tcp(eth, n, VSW_PSH | VSW_ACK, &eth->TX_Mem[eth->TX_ptr[n]], size);
+                    }
+                    break;
+                case Sn_MR_UDP:
+                    if (!eth->link)
+                        break;
+                    eth->active = ACTIVE_TIME;
+                    if ((readWord(eth->Socket[n], Sn_DPORT0) == 67) && (eth->Socket[n][Sn_DIPR0] == 255) &&
+                        (eth->Socket[n][Sn_DIPR1] == 255) && (eth->Socket[n][Sn_DIPR2] == 255) &&
+                        (eth->Socket[n][Sn_DIPR3] == 255)) {
+                        // dhcp, each node gets its own address
+                        eth_w5500_fake_dhcp_reply(eth, n, 10 + eth->vsw_id);
+                    } else {
+                        eth_vswitch_send(eth->vsw, eth->vsw_id, VSW_UDP, 0, readWord(eth->Socket[n], Sn_PORT0),
+                                         &eth->Socket[n][Sn_DIPR0], readWord(eth->Socket[n], Sn_DPORT0),
+                                         &eth->TX_Mem[eth->TX_ptr[n]], size);
+                    }
+                    break;
+                default:
+                    return;
+            }
+            writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
+            writeWord(eth->Socket[n], Sn_TX_WR0, 0);
+            writeWord(eth->Socket[n], Sn_TX_RD0, 0);
+            eth->Socket[n][Sn_IR] |= 0x10;
+            break;
+        case RECV:
+            size = readWord(eth->Socket[n], Sn_RX_WR0);
+            size -= readWord(eth->Socket[n], Sn_RX_RD0);
+            if (size < 0) {
+                size += eth->RX_size[n];
+            }
+            writeWord(eth->Socket[n], Sn_RX_RSR0, size);
+
+            // deliver the data waiting the freed space
+            if (eth->link) {
+                eth_w5500_vsw_deliver(eth);
+            }
+            break;
+    }
+}
 
 void eth_w5500_process(eth_w5500_t* eth) {
-    char temp_buff[0x4000];
+    char temp_buff[0x4000 + 8];
     char skt_addr[30];
     unsigned short skt_port;
     struct sockaddr_in cli;
@@ -750,20 +1253,31 @@ void eth_w5500_process(eth_w5500_t* eth) {
     int j;
     socklen_t len;
     struct sockaddr_in serv;
-#ifdef DUMP
-    char sfname[30];
-    FILE* fouts;
-#endif
 
     if (eth->active)
         eth->active--;
 
+    if (eth->vsw) {
+        eth_w5500_vsw_process(eth);
+        return;
+    }
+
     if (!eth->link)
         return;
 
+    eth_w5500_poll(eth);
+
     for (int n = 0; n < 8; n++) {
         switch (eth->Socket[n][Sn_SR]) {
             case SOCK_SYNSENT:
+                if (eth->conn_timeout[n] && !(eth->ready[n] & RDY_OUT)) {
+                    // connection in progress, wait the socket be writable
+                    eth->conn_timeout[n]++;
+                    if (eth->conn_timeout[n] < CONN_TIMEOUT) {
+                        break;
+                    }
+                }
+
                 sprintf(skt_addr, "%i.%i.%i.%i", eth->Socket[n][Sn_DIPR0], eth->Socket[n][Sn_DIPR1],
                         eth->Socket[n][Sn_DIPR2], eth->Socket[n][Sn_DIPR3]);
                 skt_port = readWord(eth->Socket[n], Sn_DPORT0);
@@ -773,6 +1287,7 @@ void eth_w5500_process(eth_w5500_t* eth) {
                 serv.sin_addr.s_addr = inet_addr(skt_addr);
                 serv.sin_port = htons(skt_port);
 
+                eth->ready[n] &= ~RDY_OUT;
                 if (connect(eth->sockfd[n], (sockaddr*)&serv, sizeof(serv)) < 0) {
 #ifndef _WIN_
                     if ((errno == EINPROGRESS) || (errno == EALREADY))
@@ -781,8 +1296,8 @@ void eth_w5500_process(eth_w5500_t* eth) {
                         (WSAGetLastError() == WSAEWOULDBLOCK))
 #endif
                     {
-                        conn_timeout[n]++;
-                        if (conn_timeout[n] < CONN_TIMEOUT) {
+                        eth->conn_timeout[n]++;
+                        if (eth->conn_timeout[n] < CONN_TIMEOUT) {
                             break;
                         }
                     }
@@ -806,80 +1321,37 @@ void eth_w5500_process(eth_w5500_t* eth) {
                 writeWord(eth->Socket[n], Sn_TX_WR0, 0);
                 writeWord(eth->Socket[n], Sn_RX_RD0, 0);
                 writeWord(eth->Socket[n], Sn_RX_WR0, 0);
-                writeWord(eth->Socket[n], Sn_TX_FSR0, eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
+                writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
                 writeWord(eth->Socket[n], Sn_RX_RSR0, 0);
                 setnblock(eth->sockfd[n]);
                 break;
             case SOCK_LISTEN:
+                if (!(eth->ready[8 + eth->listenfd_map[n]] & RDY_IN)) {
+                    break;
+                }
                 if ((eth->sockfd[n] = accept(eth->listenfd[eth->listenfd_map[n]], (sockaddr*)&cli, &clilen)) < 0) {
                     // printf ("eth_w5500: accept error : %s \n", strerror (errno));
+                    if (eth_w5500_again()) {
+                        eth->ready[8 + eth->listenfd_map[n]] &= ~RDY_IN;
+                    }
                     eth->sockfd[n] = INVALID_SOCKET_VALUE;
                 } else {
                     setnblock(eth->sockfd[n]);
+                    eth_w5500_watch(eth, eth->sockfd[n], n);
                     eth->Socket[n][Sn_SR] = SOCK_ESTABLISHED;
                     dsprintf("Socket %i Connected\n", n);
                     writeWord(eth->Socket[n], Sn_TX_RD0, 0);
                     writeWord(eth->Socket[n], Sn_TX_WR0, 0);
                     writeWord(eth->Socket[n], Sn_RX_RD0, 0);
                     writeWord(eth->Socket[n], Sn_RX_WR0, 0);
-                    writeWord(eth->Socket[n], Sn_TX_FSR0, eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
+                    writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
                     writeWord(eth->Socket[n], Sn_RX_RSR0, 0);
                     eth->bindp[n] = 0;
                 }
                 break;
             case SOCK_ESTABLISHED:
-
-                size = eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0);
-                if (size < 0)
-                    size = 0;
-
-                if (size) {
-                    if ((s = recv(eth->sockfd[n], temp_buff, size, 0)) < 0) {
-#ifndef _WIN_
-                        if (errno != EAGAIN)
-#else
-                        if (WSAGetLastError() != WSAEWOULDBLOCK)
-#endif
-                        {
-                            printf("eth_w5500: recv tcp error :[%i] %s \n", errno, strerror(errno));
-                            eth->Socket[n][Sn_SR] = SOCK_CLOSED;
-                            eth->status[n] = ER_RECV;
-                        }
-                    }
-                    if (s > 0) {
-                        eth->active = 2;
-                        eth->Socket[n][Sn_IR] |= 0x04;
-
-                        addr_base = (readWord(eth->Socket[n], Sn_RX_WR0));
-
-                        for (i = 0; i < s; i++) {
-                            addr = (addr_base + i) & eth->RX_mask[n];
-                            eth->RX_Mem[eth->RX_ptr[n] + addr] = temp_buff[i];
-                        }
-
-                        dsprintf("eth_w5500: Socket %i Received %i\n", n, s);
-                        writeWord(eth->Socket[n], Sn_RX_WR0, readWord(eth->Socket[n], Sn_RX_WR0) + s);
-
-                        size = readWord(eth->Socket[n], Sn_RX_WR0);
-                        size -= readWord(eth->Socket[n], Sn_RX_RD0);
-
-                        if (size < 0) {
-                            size += eth->RX_size[n];
-                        }
-
-                        writeWord(eth->Socket[n], Sn_RX_RSR0, size);
-
-#ifdef DUMP
-                        sprintf(sfname, "/tmp/%03i_recv_tcp.bin", scont++);
-                        fouts = fopen(sfname, "w");
-                        fwrite(temp_buff, s, 1, fouts);
-                        fclose(fouts);
-#endif
-#ifdef TEXTDUMP
-                        temp_buff[s] = 0;
-                        printf(temp_buff);
-#endif
-                    }
+                if (eth->ready[n] & RDY_IN) {
+                    eth_w5500_recv_tcp(eth, n);
                 }
                 break;
             case SOCK_UDP:
@@ -935,16 +1407,19 @@ void eth_w5500_process(eth_w5500_t* eth) {
                     dsprintf("Socket %i listen on port %i \n", n, skt_port);
                 }
 
-                size = (eth->Socket[n][Sn_RXBUF_SIZE] * 1024);
+                // free space for the datagram and its 8 bytes header
+                size = eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0) - 8;
                 if (size < 0)
                     size = 0;
 
-                if (size) {
+                if (size && (eth->ready[n] & RDY_IN)) {
                     len = sizeof(serv);
 
-                    if ((s = recvfrom(eth->sockfd[n], &temp_buff[8],
-                                      eth->RX_size[n] - readWord(eth->Socket[n], Sn_RX_RSR0),
-                                      0 /*MSG_DONTWAIT MSG_WAITALL*/, (struct sockaddr*)&serv, &len)) < 0) {
+                    if ((s = recvfrom(eth->sockfd[n], &temp_buff[8], size, 0 /*MSG_DONTWAIT MSG_WAITALL*/,
+                                      (struct sockaddr*)&serv, &len)) < 0) {
+                        if (eth_w5500_again()) {
+                            eth->ready[n] &= ~RDY_IN;
+                        }
 #ifndef _WIN_
                         if (errno != EAGAIN)
 #else
@@ -958,7 +1433,7 @@ void eth_w5500_process(eth_w5500_t* eth) {
                     }
 
                     if (s > 0) {
-                        eth->active = 2;
+                        eth->active = ACTIVE_TIME;
                         eth->Socket[n][Sn_IR] |= 0x04;
 
                         strncpy(skt_addr, inet_ntoa(serv.sin_addr), 29);
@@ -1001,12 +1476,6 @@ void eth_w5500_process(eth_w5500_t* eth) {
                         }
                         writeWord(eth->Socket[n], Sn_RX_RSR0, size);
 
-#ifdef DUMP
-                        sprintf(sfname, "/tmp/%03i_recv_udp.bin", scont++);
-                        fouts = fopen(sfname, "w");
-                        fwrite(temp_buff, s, 1, fouts);
-                        fclose(fouts);
-#endif
 #ifdef TEXTDUMP
                         temp_buff[s] = 0;
                         printf(temp_buff);
@@ -1033,10 +1502,6 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
     char skt_addr[30];
     unsigned short skt_port;
 
-#ifdef DUMP
-    char sfname[30];
-    FILE* fouts;
-#endif
     /*
      if (!rst)
       {
@@ -1102,8 +1567,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                             case B_SCK6RX:
                             case B_SCK7RX:
                                 n = (BSB - B_SCK0RX) / 4;
-                                size = (eth->Socket[n][Sn_RXBUF_SIZE] * 1024);
-                                addr = eth->addr & (size - 1);
+                                addr = eth->addr & eth->RX_mask[n];
                                 eth->bb_spi.outsr = eth->RX_Mem[eth->RX_ptr[n] + addr];
                                 break;
                             case B_SCK0TX:
@@ -1115,8 +1579,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                             case B_SCK6TX:
                             case B_SCK7TX:
                                 n = (BSB - B_SCK0TX) / 4;
-                                size = (eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
-                                addr = eth->addr & (size - 1);
+                                addr = eth->addr & eth->TX_mask[n];
                                 eth->bb_spi.outsr = eth->TX_Mem[eth->TX_ptr[n] + addr];
                                 break;
                             default:
@@ -1160,6 +1623,11 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                             eth->Socket[n][eth->addr + offset] = eth->bb_spi.insr & 0x00FF;
                                             if (eth->Socket[n][Sn_CR]) {
                                                 dprintf("eth_w5500: socket cmd = 0x%02X\n", eth->Socket[n][Sn_CR]);
+                                                if (eth->vsw) {
+                                                    eth_w5500_vsw_command(eth, n);
+                                                    eth->Socket[n][Sn_CR] = 0;
+                                                    break;
+                                                }
                                                 switch (eth->Socket[n][Sn_CR]) {
                                                     case OPEN:
                                                         dsprintf("eth_w5500: Socket %i Open type(%i)\n", n,
@@ -1198,11 +1666,11 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                         writeWord(eth->Socket[n], Sn_TX_WR0, 0);
                                                         writeWord(eth->Socket[n], Sn_RX_RD0, 0);
                                                         writeWord(eth->Socket[n], Sn_RX_WR0, 0);
-                                                        writeWord(eth->Socket[n], Sn_TX_FSR0,
-                                                                  eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
+                                                        writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
                                                         writeWord(eth->Socket[n], Sn_RX_RSR0, 0);
                                                         eth->status[n] = 0;
                                                         setnblock(eth->sockfd[n]);
+                                                        eth_w5500_watch(eth, eth->sockfd[n], n);
                                                         break;
                                                     case LISTEN:
                                                         if ((eth->Socket[n][Sn_MR] & 0x0F) != Sn_MR_TCP)
@@ -1224,6 +1692,10 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
 
                                                         eth->Socket[n][Sn_SR] = SOCK_LISTEN;
 
+                                                        // the connection comes from the shared listen socket
+                                                        close(eth->sockfd[n]);
+                                                        eth->sockfd[n] = INVALID_SOCKET_VALUE;
+
                                                         for (j = 0; j < 8; j++) {
                                                             if ((eth->listenfd_port[j] == 0) ||
                                                                 (eth->listenfd_port[j] == skt_port)) {
@@ -1284,6 +1756,8 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                             }
 
                                                             setnblock(eth->listenfd[eth->listenfd_map[n]]);
+                                                            eth_w5500_watch(eth, eth->listenfd[eth->listenfd_map[n]],
+                                                                            8 + eth->listenfd_map[n]);
                                                         } else {
                                                             eth->sockfd[n] = INVALID_SOCKET_VALUE;
                                                         }
@@ -1293,7 +1767,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                             break;
                                                         eth->status[n] = 0;
                                                         eth->Socket[n][Sn_SR] = SOCK_SYNSENT;
-                                                        conn_timeout[n] = 0;
+                                                        eth->conn_timeout[n] = 0;
                                                         sprintf(skt_addr, "%i.%i.%i.%i", eth->Socket[n][Sn_DIPR0],
                                                                 eth->Socket[n][Sn_DIPR1], eth->Socket[n][Sn_DIPR2],
                                                                 eth->Socket[n][Sn_DIPR3]);
@@ -1319,21 +1793,17 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                     case SEND:
 
                                                         if (eth->link)
-                                                            eth->active = 2;
+                                                            eth->active = ACTIVE_TIME;
 
                                                         switch (eth->Socket[n][Sn_MR] & 0x0F) {
                                                             case Sn_MR_TCP:
 
-                                                                if (eth->Socket[n][Sn_SR] != SOCK_ESTABLISHED)
+                                                                // the peer half closed socket still accepts data
+                                                                if ((eth->Socket[n][Sn_SR] != SOCK_ESTABLISHED) &&
+                                                                    (eth->Socket[n][Sn_SR] != SOCK_CLOSE_WAIT))
                                                                     break;
 
                                                                 size = readWord(eth->Socket[n], Sn_TX_WR0);
-#ifdef DUMP
-                                                                sprintf(sfname, "/tmp/%03i_send_tcp.bin", scont++);
-                                                                fouts = fopen(sfname, "w");
-                                                                fwrite(&eth->TX_Mem[eth->TX_ptr[n]], size, 1, fouts);
-                                                                fclose(fouts);
-#endif
 #ifdef TEXTDUMP
                                                                 eth->TX_Mem[eth->TX_ptr[n] + size] = 0;
                                                                 printf((char*)&eth->TX_Mem[eth->TX_ptr[n]]);
@@ -1352,8 +1822,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                                     dsprintf(".");
                                                                     eth->Socket[n][Sn_IR] |= 0x10;
 
-                                                                    size = (eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
-                                                                    writeWord(eth->Socket[n], Sn_TX_FSR0, (size));
+                                                                    writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
                                                                     writeWord(eth->Socket[n], Sn_TX_WR0, 0);
                                                                     writeWord(eth->Socket[n], Sn_TX_RD0, 0);
                                                                 }
@@ -1374,12 +1843,6 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                                 serv.sin_addr.s_addr = inet_addr(skt_addr);
 
                                                                 size = readWord(eth->Socket[n], Sn_TX_WR0);
-#ifdef DUMP
-                                                                sprintf(sfname, "/tmp/%03i_send_udp.bin", scont++);
-                                                                fouts = fopen(sfname, "w");
-                                                                fwrite(&eth->TX_Mem[eth->TX_ptr[n]], size, 1, fouts);
-                                                                fclose(fouts);
-#endif
 #ifdef TEXTDUMP
                                                                 eth->TX_Mem[eth->TX_ptr[n] + size] = 0;
                                                                 printf((char*)&eth->TX_Mem[eth->TX_ptr[n]]);
@@ -1391,7 +1854,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                                 {
                                                                     if (skt_port == 67)  // dhcp
                                                                     {
-                                                                        eth_w5500_fake_dhcp_reply(eth, n);
+                                                                        eth_w5500_fake_dhcp_reply(eth, n, 10);
                                                                     }
                                                                 } else {
                                                                     sendto(eth->sockfd[n],
@@ -1400,8 +1863,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                                            (const struct sockaddr*)&serv, sizeof(serv));
                                                                 }
 
-                                                                size = (eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
-                                                                writeWord(eth->Socket[n], Sn_TX_FSR0, (size));
+                                                                writeWord(eth->Socket[n], Sn_TX_FSR0, eth->TX_size[n]);
                                                                 writeWord(eth->Socket[n], Sn_TX_WR0, 0);
                                                                 writeWord(eth->Socket[n], Sn_TX_RD0, 0);
                                                                 eth->Socket[n][Sn_IR] |= 0x10;
@@ -1428,6 +1890,12 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                                             size += eth->RX_size[n];
                                                         }
                                                         writeWord(eth->Socket[n], Sn_RX_RSR0, size);
+
+                                                        // refill the freed space without wait the next process
+                                                        if (eth->link && (eth->Socket[n][Sn_SR] == SOCK_ESTABLISHED) &&
+                                                            (eth->ready[n] & RDY_IN)) {
+                                                            eth_w5500_recv_tcp(eth, n);
+                                                        }
                                                         break;
                                                 }
                                                 eth->Socket[n][Sn_CR] = 0;
@@ -1436,6 +1904,11 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                                         case Sn_IR:
                                             eth->Socket[n][Sn_IR] &= ~(eth->bb_spi.insr & 0x00FF);
                                             break;
+                                        case Sn_RXBUF_SIZE:
+                                        case Sn_TXBUF_SIZE:
+                                            eth->Socket[n][eth->addr + offset] = eth->bb_spi.insr & 0x00FF;
+                                            eth_w5500_buffers(eth);
+                                            break;
                                         default:
                                             eth->Socket[n][eth->addr + offset] = eth->bb_spi.insr & 0x00FF;
                                             break;
@@ -1451,8 +1924,10 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                             case B_SCK6TX:
                             case B_SCK7TX:
                                 n = (BSB - B_SCK0TX) / 4;
-                                size = (eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
-                                addr = (eth->addr + offset) % size;
+                                if (!eth->TX_size[n]) {
+                                    break;
+                                }
+                                addr = (eth->addr + offset) & eth->TX_mask[n];
                                 // printf ("TX write 0x%04X 0x%04X 0x%04X 0x%04X\n", addr, eth->addr + offset, size,
                                 // readWord (eth->Socket[n], Sn_TX_WR0));
                                 eth->TX_Mem[eth->TX_ptr[n] + addr] = eth->bb_spi.insr & 0x00FF;
@@ -1499,8 +1974,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                             case B_SCK6RX:
                             case B_SCK7RX:
                                 n = (BSB - B_SCK0RX) / 4;
-                                size = (eth->Socket[n][Sn_RXBUF_SIZE] * 1024);
-                                addr = (eth->addr + offset + 1) % size;
+                                addr = (eth->addr + offset + 1) & eth->RX_mask[n];
                                 eth->bb_spi.outsr = eth->RX_Mem[eth->RX_ptr[n] + addr];
                                 break;
                             case B_SCK0TX:
@@ -1512,8 +1986,7 @@ unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char
                             case B_SCK6TX:
                             case B_SCK7TX:
                                 n = (BSB - B_SCK0TX) / 4;
-                                size = (eth->Socket[n][Sn_TXBUF_SIZE] * 1024);
-                                addr = (eth->addr + offset + 1) & (size - 1);
+                                addr = (eth->addr + offset + 1) & eth->TX_mask[n];
                                 eth->bb_spi.outsr = eth->TX_Mem[eth->TX_ptr[n] + addr];
                                 break;
                             default:
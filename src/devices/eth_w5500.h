@@ -27,6 +27,7 @@
 #define ETH_W5500
 
 #include "bitbang_spi.h"
+#include "eth_vswitch.h"
 
 // BSB
 #define B_COMMON 0x00  // 00000 Selects Common Register.
@@ -181,6 +182,7 @@
 #define SOCK_LISTEN 0x14
 #define SOCK_SYNSENT 0x15
 #define SOCK_ESTABLISHED 0x17
+#define SOCK_FIN_WAIT 0x18
 #define SOCK_CLOSE_WAIT 0x1C
 #define SOCK_UDP 0x22
 #define SOCK_MACRAW 0x42
@@ -193,9 +195,11 @@
 #define ER_CONN 6
 #define ER_SHUT 7
 
+#define ETH_W5500_PROCESS_US VSW_TICK_US  // simulated time between two eth_w5500_process calls, one switch tick
+
 typedef struct {
     unsigned char link;
-    unsigned char active;
+    unsigned short active;  // activity LED on time in process calls
     bitbang_spi_t bb_spi;
     unsigned short addr;
     unsigned char control;
@@ -215,6 +219,11 @@ typedef struct {
     unsigned short TX_mask[8];
     unsigned char status[8];
     unsigned short bindp[8];
+    unsigned int conn_timeout[8];  // connect polls of the SOCK_SYNSENT sockets
+    int epfd;                 // host sockets readiness set
+    unsigned char ready[16];  // readiness flags, 0-7 sockets, 8-15 listen sockets
+    eth_vswitch_t* vsw;       // virtual switch, NULL to use the host sockets
+    int vsw_id;
 } eth_w5500_t;
 
 void eth_w5500_rst(eth_w5500_t* eth);
@@ -222,7 +231,11 @@ void eth_w5500_init(eth_w5500_t* eth, unsigned char linkon = 1);
 void eth_w5500_process(eth_w5500_t* eth);
 void eth_w5500_end(eth_w5500_t* eth);
 void eth_w5500_set_link(eth_w5500_t* eth, unsigned char on);
+// returns 0 on success, -1 if the switch is full and the host network is used
+int eth_w5500_set_switch(eth_w5500_t* eth, eth_vswitch_t* sw);
 unsigned char eth_w5500_get_leds(eth_w5500_t* eth);
+// interrupt pending (INT pin active), updates the SIR register
+unsigned char eth_w5500_get_int(eth_w5500_t* eth);
 
 unsigned short eth_w5500_io(eth_w5500_t* eth, unsigned char mosi, unsigned char sclk, unsigned char scs,
                             unsigned char rst);
@@ -59,6 +59,14 @@ void io_PCF8574_end(io_PCF8574_t* ioe8) {
 unsigned char io_PCF8574_I2C_io(io_PCF8574_t* ioe8, unsigned char scl, unsigned char sda) {
     unsigned char ret = bitbang_i2c_io(&ioe8->bb_i2c, scl, sda);
 
+    io_PCF8574_I2C_process(ioe8);
+
+    return ret;
+}
+
+void io_PCF8574_I2C_process(void* arg) {
+    io_PCF8574_t* ioe8 = (io_PCF8574_t*)arg;
+
     switch (bitbang_i2c_get_status(&ioe8->bb_i2c)) {
         case I2C_DATAW:
             ioe8->dataIn = ioe8->bb_i2c.datar;
@@ -69,6 +77,4 @@ unsigned char io_PCF8574_I2C_io(io_PCF8574_t* ioe8, unsigned char scl, unsigned
             dprintf("ioe8 read =%02X\n", ioe8->dataOut);
             break;
     }
-
-    return ret;
 }
@@ -37,3 +37,4 @@ void io_PCF8574_end(io_PCF8574_t* ioe8);
 void io_PCF8574_set_addr(io_PCF8574_t* ioe8, unsigned char addr);
 
 unsigned char io_PCF8574_I2C_io(io_PCF8574_t* ioe8, unsigned char scl, unsigned char sda);
+void io_PCF8574_I2C_process(void* arg);
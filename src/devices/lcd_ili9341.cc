@@ -33,12 +33,32 @@
         printf
 
 #include "lcd_ili9341.h"
+#include <string.h>
+
+static void lcd_ili9341_set_dirty(lcd_ili9341_t* lcd, const unsigned short x, const unsigned short y) {
+    if (lcd->dirty[x >> 3] & (1 << (x & 7))) {
+        if (y < lcd->dmin[x])
+            lcd->dmin[x] = y;
+        if (y > lcd->dmax[x])
+            lcd->dmax[x] = y;
+    } else {
+        lcd->dirty[x >> 3] |= 1 << (x & 7);
+        lcd->dmin[x] = y;
+        lcd->dmax[x] = y;
+    }
+}
+
+static void lcd_ili9341_set_all_dirty(lcd_ili9341_t* lcd) {
+    memset(lcd->dirty, 0xFF, sizeof(lcd->dirty));
+    for (int i = 0; i < 240; i++) {
+        lcd->dmin[i] = 0;
+        lcd->dmax[i] = 319;
+    }
+}
 
 void lcd_ili9341_rst(lcd_ili9341_t* lcd) {
-    int i, j;
-    for (i = 0; i < 240; i++)
-        for (j = 0; j < 320; j++)
-            lcd->ram[i][j] = 0xFF000000;
+    memset(lcd->ram, 0, sizeof(lcd->ram));
+    lcd_ili9341_set_all_dirty(lcd);
 
     bitbang_spi_rst(&lcd->bb_spi);
     lcd->pwr = -1;
@@ -69,11 +89,8 @@ void lcd_ili9341_init(lcd_ili9341_t* lcd) {
 }
 
 void lcd_ili9341_update(lcd_ili9341_t* lcd) {
-    int i, j;
     lcd->update = 1;
-    for (i = 0; i < 240; i++)
-        for (j = 0; j < 320; j++)
-            lcd->ram[i][j] |= 0xFF000000;
+    lcd_ili9341_set_all_dirty(lcd);
 }
 
 static void lcd_ili9341_readdata(lcd_ili9341_t* lcd) {
@@ -91,7 +108,10 @@ static void lcd_ili9341_readdata(lcd_ili9341_t* lcd) {
 
             dcprint("data[%i][%i]:%#08lX  \n", lcd->x, lcd->y, lcd->color);
 
-            lcd->ram[lcd->x % 240][lcd->y % 320] = lcd->color;
+            lx = lcd->x % 240;
+            ly = lcd->y % 320;
+            lcd->ram[lx][ly] = lcd->color & 0x00FFFFFF;
+            lcd_ili9341_set_dirty(lcd, lx, ly);
             lcd->update = 1;
 
             lcd->x++;
@@ -133,7 +153,8 @@ static void lcd_ili9341_readdata(lcd_ili9341_t* lcd) {
                     lx = 239 - lx;
                 }
 
-                lcd->ram[lx][ly] = lcd->color;
+                lcd->ram[lx][ly] = lcd->color & 0x00FFFFFF;
+                lcd_ili9341_set_dirty(lcd, lx, ly);
             }
             lcd->update = 1;
 
@@ -594,8 +615,8 @@ unsigned short lcd_ili9341_8_io(lcd_ili9341_t* lcd, const unsigned char** pins_v
 
 void lcd_ili9341_draw(lcd_ili9341_t* lcd, CCanvas* canvas, const int x1, const int y1, const int w1, const int h1,
                       const int picpwr) {
-    unsigned short x, y;
-    unsigned char r, g, b;
+    unsigned short x, y, ys;
+    unsigned int color;
 
     lcd->update = 0;
 
@@ -603,29 +624,27 @@ void lcd_ili9341_draw(lcd_ili9341_t* lcd, CCanvas* canvas, const int x1, const i
         return;
 
     for (x = 0; x < 240; x++) {
-        for (y = 0; y < 320; y++) {
-            if (lcd->ram[x][y] & 0xFF000000) {
-                lcd->ram[x][y] &= 0x00FFFFFF;  // clear draw
-
-                r = (lcd->ram[x][y] & 0xFF0000) >> 16;
-                g = (lcd->ram[x][y] & 0x00FF00) >> 8;
-                b = (lcd->ram[x][y] & 0x0000FF);
-
-                /*
-                r = (lcd->ram[x][y] & 0x00F800) >> 8;
-                g = (lcd->ram[x][y] & 0x0007E0) >> 3;
-                b = (lcd->ram[x][y] & 0x00001F) << 3;
-                r = ((lcd->ram[x][y] & 0x00F800) >> 11)*8.23;
-                g = ((lcd->ram[x][y] & 0x0007E0) >> 5)*4.05;
-                b = (lcd->ram[x][y] & 0x00001F)*8.23;
-                 */
-
-                canvas->SetColor(r, g, b);
-
-                // canvas->Rectangle (1, x1 + (x * 2), y1 + (y * 8 * 2)+(z * 2), 2, 2);
-
-                canvas->Point(x1 + y, y1 + (239 - x));
-            }
+        if (!lcd->dirty[x >> 3]) {
+            x |= 7;  // skip 8 clean rows
+            continue;
+        }
+        if (!(lcd->dirty[x >> 3] & (1 << (x & 7))))
+            continue;
+
+        lcd->dirty[x >> 3] &= ~(1 << (x & 7));  // clear draw
+
+        // draw the changed span as runs of same color pixels
+        y = lcd->dmin[x];
+        while (y <= lcd->dmax[x]) {
+            ys = y;
+            color = lcd->ram[x][y];
+            do {
+                y++;
+            } while ((y <= lcd->dmax[x]) && (lcd->ram[x][y] == color));
+
+            canvas->SetFgColor((color & 0xFF0000) >> 16, (color & 0x00FF00) >> 8, color & 0x0000FF);
+            canvas->SetColor((color & 0xFF0000) >> 16, (color & 0x00FF00) >> 8, color & 0x0000FF);
+            canvas->Rectangle(1, x1 + ys, y1 + (239 - x), y - ys, 1);
         }
     }
 }
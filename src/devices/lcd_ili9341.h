@@ -41,7 +41,10 @@
 */
 
 typedef struct {
-    unsigned long int ram[240][320];
+    unsigned int ram[240][320];    // RGB888 framebuffer
+    unsigned char dirty[240 / 8];  // one bit per ram row changed since last draw
+    unsigned short dmin[240];      // first changed column of each dirty row
+    unsigned short dmax[240];      // last changed column of each dirty row
     unsigned char pwr;  // previous wr
     unsigned char prd;  // previous rw
     bitbang_spi_t bb_spi;
@@ -29,12 +29,17 @@
         printf
 
 #include "lcd_pcd8544.h"
+#include <string.h>
+
+static void lcd_pcd8544_set_all_dirty(lcd_pcd8544_t* lcd) {
+    lcd->dirty = 0x3F;
+    memset(lcd->dmin, 0, sizeof(lcd->dmin));
+    memset(lcd->dmax, 83, sizeof(lcd->dmax));
+}
 
 void lcd_pcd8544_rst(lcd_pcd8544_t* lcd) {
-    int i, j;
-    for (i = 0; i < 84; i++)
-        for (j = 0; j < 6; j++)
-            lcd->ram[i][j] = 0xFF00;
+    memset(lcd->ram, 0, sizeof(lcd->ram));
+    lcd_pcd8544_set_all_dirty(lcd);
     lcd->update = 1;
     lcd->dat = 0;
     lcd->x = 0;
@@ -54,11 +59,8 @@ void lcd_pcd8544_init(lcd_pcd8544_t* lcd) {
 }
 
 void lcd_pcd8544_update(lcd_pcd8544_t* lcd) {
-    int i, j;
     lcd->update = 1;
-    for (i = 0; i < 84; i++)
-        for (j = 0; j < 6; j++)
-            lcd->ram[i][j] |= 0xFF00;
+    lcd_pcd8544_set_all_dirty(lcd);
 }
 // void lcd_pcd8544_end(lcd_pcd8544_t *lcd){}
 
@@ -130,7 +132,17 @@ unsigned char lcd_pcd8544_io(lcd_pcd8544_t* lcd, unsigned char din, unsigned cha
             } else  // data
             {
                 dprint("data[%i][%i]:%#02X  \n", lcd->x, lcd->y, lcd->dat);
-                lcd->ram[lcd->x][lcd->y] = 0xFF00 | lcd->dat;
+                lcd->ram[lcd->x][lcd->y] = lcd->dat;
+                if (lcd->dirty & (1 << lcd->y)) {
+                    if (lcd->x < lcd->dmin[lcd->y])
+                        lcd->dmin[lcd->y] = lcd->x;
+                    if (lcd->x > lcd->dmax[lcd->y])
+                        lcd->dmax[lcd->y] = lcd->x;
+                } else {
+                    lcd->dirty |= 1 << lcd->y;
+                    lcd->dmin[lcd->y] = lcd->x;
+                    lcd->dmax[lcd->y] = lcd->x;
+                }
                 lcd->update = 1;
                 if (lcd->v) {
                     lcd->y++;
@@ -157,7 +169,7 @@ unsigned char lcd_pcd8544_io(lcd_pcd8544_t* lcd, unsigned char din, unsigned cha
 }
 
 void lcd_pcd8544_draw(lcd_pcd8544_t* lcd, CCanvas* canvas, int x1, int y1, int w1, int h1, int picpwr) {
-    unsigned char x, y, z;
+    unsigned char x, y, z, xs, on;
 
     if (lcd->e) {
         canvas->SetFgColor(0, 0, 0);
@@ -174,21 +186,30 @@ void lcd_pcd8544_draw(lcd_pcd8544_t* lcd, CCanvas* canvas, int x1, int y1, int w
     if ((lcd->pd) || (!lcd->d))
         return;
 
-    for (x = 0; x < 84; x++) {
-        for (y = 0; y < 6; y++) {
-            if (lcd->ram[x][y] & 0xFF00) {
-                lcd->ram[x][y] &= 0x00FF;  // clear draw
-                for (z = 0; z < 8; z++) {
-                    if (!(lcd->ram[x][y] & (0x01 << z)) != (!lcd->e)) {
-                        canvas->SetFgColor(0, 0, 0);
-                        canvas->SetColor(0, 0, 0);
-                    } else {
-                        canvas->SetFgColor(82, 129, 111);
-                        canvas->SetColor(82, 129, 111);
-                    }
-                    canvas->Rectangle(1, x1 + (x * 2), y1 + (y * 8 * 2) + (z * 2), 2, 2);
-                    // canvas->Point (x1 + x, y1 + y*8 +z);
+    for (y = 0; y < 6; y++) {
+        if (!(lcd->dirty & (1 << y)))
+            continue;
+
+        lcd->dirty &= ~(1 << y);  // clear draw
+
+        // draw each pixel line of the bank changed span as runs of same color
+        for (z = 0; z < 8; z++) {
+            x = lcd->dmin[y];
+            while (x <= lcd->dmax[y]) {
+                xs = x;
+                on = ((lcd->ram[x][y] >> z) & 0x01);
+                do {
+                    x++;
+                } while ((x <= lcd->dmax[y]) && (((lcd->ram[x][y] >> z) & 0x01) == on));
+
+                if (!on != (!lcd->e)) {
+                    canvas->SetFgColor(0, 0, 0);
+                    canvas->SetColor(0, 0, 0);
+                } else {
+                    canvas->SetFgColor(82, 129, 111);
+                    canvas->SetColor(82, 129, 111);
                 }
+                canvas->Rectangle(1, x1 + (xs * 2), y1 + (y * 8 * 2) + (z * 2), (x - xs) * 2, 2);
             }
         }
     }
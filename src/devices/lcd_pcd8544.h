@@ -41,7 +41,10 @@
  */
 
 typedef struct {
-    unsigned short int ram[84][6];
+    unsigned char ram[84][6];
+    unsigned char dirty;    // one bit per bank changed since last draw
+    unsigned char dmin[6];  // first changed column of each dirty bank
+    unsigned char dmax[6];  // last changed column of each dirty bank
     bitbang_spi_t bb_spi;
     unsigned char hrst;
     unsigned char dat;
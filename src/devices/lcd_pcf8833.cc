@@ -29,6 +29,7 @@
         printf
 
 #include "lcd_pcf8833.h"
+#include <string.h>
 
 // Philips PCF8833 LCD controller command codes
 #define NOP 0x00       // nop
@@ -85,11 +86,44 @@
 #define MY 0x80
 #define MX 0x40
 
+static void lcd_pcf8833_set_all_dirty(lcd_pcf8833_t* lcd) {
+    memset(lcd->dirty, 0xFF, sizeof(lcd->dirty));
+    memset(lcd->dmin, 0, sizeof(lcd->dmin));
+    memset(lcd->dmax, 131, sizeof(lcd->dmax));
+}
+
+static void lcd_pcf8833_write_ram(lcd_pcf8833_t* lcd) {
+    unsigned char x = lcd->x;
+    unsigned char y = lcd->y;
+
+    if ((lcd->madctl & MX) && (lcd->madctl & MX)) {
+        x = 131 - x;
+        y = 131 - y;
+    } else if (lcd->madctl & MX)
+        x = 131 - x;
+    else if (lcd->madctl & MY)
+        y = 131 - y;
+
+    if ((x > 131) || (y > 131))
+        return;
+
+    lcd->ram[x][y] = lcd->color;
+
+    if (lcd->dirty[y >> 3] & (1 << (y & 7))) {
+        if (x < lcd->dmin[y])
+            lcd->dmin[y] = x;
+        if (x > lcd->dmax[y])
+            lcd->dmax[y] = x;
+    } else {
+        lcd->dirty[y >> 3] |= 1 << (y & 7);
+        lcd->dmin[y] = x;
+        lcd->dmax[y] = x;
+    }
+}
+
 void lcd_pcf8833_rst(lcd_pcf8833_t* lcd) {
-    int i, j;
-    for (i = 0; i < 132; i++)
-        for (j = 0; j < 132; j++)
-            lcd->ram[i][j] = 0xFF000000;
+    memset(lcd->ram, 0, sizeof(lcd->ram));
+    lcd_pcf8833_set_all_dirty(lcd);
 
     lcd->tp = 0;
     lcd->update = 1;
@@ -119,6 +153,7 @@ void lcd_pcf8833_init(lcd_pcf8833_t* lcd) {
 
 void lcd_pcf8833_update(lcd_pcf8833_t* lcd) {
     lcd->update = 1;
+    lcd_pcf8833_set_all_dirty(lcd);
 }
 // void lcd_pcf8833_end(lcd_pcf8833_t *lcd){}
 
@@ -269,15 +304,8 @@ unsigned char lcd_pcf8833_io(lcd_pcf8833_t* lcd, unsigned char pdat, unsigned ch
                                 case 1:
                                     lcd->b = ((lcd->dat & 0xF0) >> 4);
 
-                                    lcd->color = 0xFF000000 | (lcd->r << 20) | (lcd->g << 12) | (lcd->b << 4);
-                                    if ((lcd->madctl & MX) && (lcd->madctl & MX))
-                                        lcd->ram[131 - lcd->x][131 - lcd->y] = lcd->color;
-                                    else if (lcd->madctl & MX)
-                                        lcd->ram[131 - lcd->x][lcd->y] = lcd->color;
-                                    else if (lcd->madctl & MY)
-                                        lcd->ram[lcd->x][131 - lcd->y] = lcd->color;
-                                    else
-                                        lcd->ram[lcd->x][lcd->y] = lcd->color;
+                                    lcd->color = (lcd->r << 20) | (lcd->g << 12) | (lcd->b << 4);
+                                    lcd_pcf8833_write_ram(lcd);
                                     lcd->update = 1;
                                     lcd->x++;
                                     if (lcd->x > lcd->cmax) {
@@ -294,15 +322,8 @@ unsigned char lcd_pcf8833_io(lcd_pcf8833_t* lcd, unsigned char pdat, unsigned ch
                                     lcd->g = ((lcd->dat & 0xF0) >> 4);
                                     lcd->b = (lcd->dat & 0x0F);
 
-                                    lcd->color = 0xFF000000 | (lcd->r << 20) | (lcd->g << 12) | (lcd->b << 4);
-                                    if ((lcd->madctl & MX) && (lcd->madctl & MX))
-                                        lcd->ram[131 - lcd->x][131 - lcd->y] = lcd->color;
-                                    else if (lcd->madctl & MX)
-                                        lcd->ram[131 - lcd->x][lcd->y] = lcd->color;
-                                    else if (lcd->madctl & MY)
-                                        lcd->ram[lcd->x][131 - lcd->y] = lcd->color;
-                                    else
-                                        lcd->ram[lcd->x][lcd->y] = lcd->color;
+                                    lcd->color = (lcd->r << 20) | (lcd->g << 12) | (lcd->b << 4);
+                                    lcd_pcf8833_write_ram(lcd);
                                     lcd->update = 1;
                                     lcd->x++;
                                     if (lcd->x > lcd->cmax) {
@@ -327,16 +348,9 @@ unsigned char lcd_pcf8833_io(lcd_pcf8833_t* lcd, unsigned char pdat, unsigned ch
                                     lcd->g = (lcd->g | ((lcd->dat & 0xE0) >> 5));
                                     lcd->b = (lcd->dat & 0x1F);
 
-                                    lcd->color = 0xFF000000 | (lcd->r << 19) | (lcd->g << 10) | (lcd->b << 3);
+                                    lcd->color = (lcd->r << 19) | (lcd->g << 10) | (lcd->b << 3);
 
-                                    if ((lcd->madctl & MX) && (lcd->madctl & MX))
-                                        lcd->ram[131 - lcd->x][131 - lcd->y] = lcd->color;
-                                    else if (lcd->madctl & MX)
-                                        lcd->ram[131 - lcd->x][lcd->y] = lcd->color;
-                                    else if (lcd->madctl & MY)
-                                        lcd->ram[lcd->x][131 - lcd->y] = lcd->color;
-                                    else
-                                        lcd->ram[lcd->x][lcd->y] = lcd->color;
+                                    lcd_pcf8833_write_ram(lcd);
                                     lcd->update = 1;
                                     lcd->x++;
                                     if (lcd->x > lcd->cmax) {
@@ -360,27 +374,31 @@ unsigned char lcd_pcf8833_io(lcd_pcf8833_t* lcd, unsigned char pdat, unsigned ch
 }
 
 void lcd_pcf8833_draw(lcd_pcf8833_t* lcd, CCanvas* canvas, int x1, int y1, int w1, int h1, int picpwr) {
-    unsigned char x, y;
+    unsigned char x, y, xs;
+    unsigned int color;
 
     // canvas->Rectangle (1, x1, y1, w1, h1);//erase all
 
     lcd->update = 0;
 
-    for (x = 0; x < 132; x++) {
-        for (y = 0; y < 132; y++) {
-            if (lcd->ram[x][y] & 0xFF000000) {
-                unsigned int color = lcd->ram[x][y];
-                unsigned char r = ((color & 0x00FF0000) >> 16);
-                unsigned char g = ((color & 0x0000FF00) >> 8);
-                unsigned char b = (color & 0x000000FF);
+    for (y = 0; y < 132; y++) {
+        if (!(lcd->dirty[y >> 3] & (1 << (y & 7))))
+            continue;
 
-                lcd->ram[x][y] &= 0x00FFFFFF;  // clear draw
+        lcd->dirty[y >> 3] &= ~(1 << (y & 7));  // clear draw
 
-                canvas->SetFgColor(r, g, b);
-                canvas->SetColor(r, g, b);
-                // canvas->Rectangle (1, x1+(x*2), y1+(y*2), 2,2 );
-                canvas->Point(x1 + x, y1 + y);
-            }
+        // draw the changed span as runs of same color pixels
+        x = lcd->dmin[y];
+        while (x <= lcd->dmax[y]) {
+            xs = x;
+            color = lcd->ram[x][y];
+            do {
+                x++;
+            } while ((x <= lcd->dmax[y]) && (lcd->ram[x][y] == color));
+
+            canvas->SetFgColor((color & 0xFF0000) >> 16, (color & 0x00FF00) >> 8, color & 0x0000FF);
+            canvas->SetColor((color & 0xFF0000) >> 16, (color & 0x00FF00) >> 8, color & 0x0000FF);
+            canvas->Rectangle(1, x1 + xs, y1 + y, x - xs, 1);
         }
     }
 }
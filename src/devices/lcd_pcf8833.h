@@ -43,7 +43,10 @@
 */
 
 typedef struct {
-    unsigned int ram[132][132];
+    unsigned int ram[132][132];        // RGB888 framebuffer, ram[column][row]
+    unsigned char dirty[132 / 8 + 1];  // one bit per row changed since last draw
+    unsigned char dmin[132];           // first changed column of each dirty row
+    unsigned char dmax[132];           // last changed column of each dirty row
     bitbang_spi_t bb_spi;
     int dc;
     unsigned char colm;
@@ -33,12 +33,17 @@
         printf
 
 #include "lcd_ssd1306.h"
+#include <string.h>
+
+static void lcd_ssd1306_set_all_dirty(lcd_ssd1306_t* lcd) {
+    lcd->dirty = 0xFF;
+    memset(lcd->dmin, 0, sizeof(lcd->dmin));
+    memset(lcd->dmax, 127, sizeof(lcd->dmax));
+}
 
 void lcd_ssd1306_rst(lcd_ssd1306_t* lcd) {
-    int i, j;
-    for (i = 0; i < 128; i++)
-        for (j = 0; j < 8; j++)
-            lcd->ram[i][j] = 0xFF00;
+    memset(lcd->ram, 0, sizeof(lcd->ram));
+    lcd_ssd1306_set_all_dirty(lcd);
 
     bitbang_i2c_rst(&lcd->bb_i2c);
     bitbang_spi_rst(&lcd->bb_spi);
@@ -68,11 +73,8 @@ void lcd_ssd1306_init(lcd_ssd1306_t* lcd) {
 }
 
 void lcd_ssd1306_update(lcd_ssd1306_t* lcd) {
-    int i, j;
     lcd->update = 1;
-    for (i = 0; i < 128; i++)
-        for (j = 0; j < 8; j++)
-            lcd->ram[i][j] |= 0xFF00;
+    lcd_ssd1306_set_all_dirty(lcd);
 }
 
 static void lcd_ssd1306_process(lcd_ssd1306_t* lcd) {
@@ -298,7 +300,17 @@ static void lcd_ssd1306_process(lcd_ssd1306_t* lcd) {
     } else  // data
     {
         dcprint("data[%i][%i]:%#02X  \n", lcd->x, lcd->y, lcd->dat);
-        lcd->ram[lcd->x][lcd->y] = 0xFF00 | lcd->dat;
+        lcd->ram[lcd->x][lcd->y] = lcd->dat;
+        if (lcd->dirty & (1 << lcd->y)) {
+            if (lcd->x < lcd->dmin[lcd->y])
+                lcd->dmin[lcd->y] = lcd->x;
+            if (lcd->x > lcd->dmax[lcd->y])
+                lcd->dmax[lcd->y] = lcd->x;
+        } else {
+            lcd->dirty |= 1 << lcd->y;
+            lcd->dmin[lcd->y] = lcd->x;
+            lcd->dmax[lcd->y] = lcd->x;
+        }
         lcd->update = 1;
         switch (lcd->am) {
             case 1:  // vertical
@@ -358,6 +370,14 @@ unsigned char lcd_ssd1306_SPI_io(lcd_ssd1306_t* lcd, unsigned char din, unsigned
 unsigned char lcd_ssd1306_I2C_io(lcd_ssd1306_t* lcd, unsigned char sda, unsigned char scl) {
     unsigned char ret = bitbang_i2c_io(&lcd->bb_i2c, scl, sda);
 
+    lcd_ssd1306_I2C_process(lcd);
+
+    return ret;
+}
+
+void lcd_ssd1306_I2C_process(void* arg) {
+    lcd_ssd1306_t* lcd = (lcd_ssd1306_t*)arg;
+
     switch (bitbang_i2c_get_status(&lcd->bb_i2c)) {
         case I2C_DATAW:
             if ((lcd->bb_i2c.byte > 3) && lcd->co && !lcd->cmd_argc) {
@@ -375,12 +395,10 @@ unsigned char lcd_ssd1306_I2C_io(lcd_ssd1306_t* lcd, unsigned char sda, unsigned
             }
             break;
     }
-
-    return ret;
 }
 
 void lcd_ssd1306_draw(lcd_ssd1306_t* lcd, CCanvas* canvas, int x1, int y1, int w1, int h1, int picpwr) {
-    unsigned char x, y, z;
+    unsigned char x, y, z, xs, on;
 
     lxColor front(0xb4, 0xff, 0xfc);
     lxColor back(0x0f, 0x0f, 0x17);
@@ -390,20 +408,30 @@ void lcd_ssd1306_draw(lcd_ssd1306_t* lcd, CCanvas* canvas, int x1, int y1, int w
     if (!lcd->on)
         return;
 
-    for (x = 0; x < 128; x++) {
-        for (y = 0; y < 8; y++) {
-            if (lcd->ram[x][y] & 0xFF00) {
-                lcd->ram[x][y] &= 0x00FF;  // clear draw
-                for (z = 0; z < 8; z++) {
-                    if (!(lcd->ram[x][y] & (0x01 << z)) != (!lcd->inv)) {
-                        canvas->SetColor(front);
-                    } else {
-                        canvas->SetColor(back);
-                    }
-                    // canvas->Rectangle (1, x1 + (x * 2), y1 + (y * 8 * 2)+(z * 2), 2,
-                    // 2);
-                    canvas->Point(x1 + x, y1 + y * 8 + z);
+    for (y = 0; y < 8; y++) {
+        if (!(lcd->dirty & (1 << y)))
+            continue;
+
+        lcd->dirty &= ~(1 << y);  // clear draw
+
+        // draw each pixel line of the page changed span as runs of same color
+        for (z = 0; z < 8; z++) {
+            x = lcd->dmin[y];
+            while (x <= lcd->dmax[y]) {
+                xs = x;
+                on = ((lcd->ram[x][y] >> z) & 0x01);
+                do {
+                    x++;
+                } while ((x <= lcd->dmax[y]) && (((lcd->ram[x][y] >> z) & 0x01) == on));
+
+                if (!on != (!lcd->inv)) {
+                    canvas->SetFgColor(front);
+                    canvas->SetColor(front);
+                } else {
+                    canvas->SetFgColor(back);
+                    canvas->SetColor(back);
                 }
+                canvas->Rectangle(1, x1 + xs, y1 + y * 8 + z, x - xs, 1);
             }
         }
     }
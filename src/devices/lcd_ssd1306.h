@@ -42,7 +42,10 @@
  */
 
 typedef struct {
-    unsigned short int ram[128][8];
+    unsigned char ram[128][8];
+    unsigned char dirty;    // one bit per page changed since last draw
+    unsigned char dmin[8];  // first changed column of each dirty page
+    unsigned char dmax[8];  // last changed column of each dirty page
     unsigned char hrst;
     unsigned char dat;
     unsigned char am;   // address mode
@@ -72,6 +75,7 @@ void lcd_ssd1306_update(lcd_ssd1306_t* lcd);
 unsigned char lcd_ssd1306_SPI_io(lcd_ssd1306_t* lcd, unsigned char din, unsigned char clk, unsigned char ncs,
                                  unsigned char nrst, unsigned char dc);
 unsigned char lcd_ssd1306_I2C_io(lcd_ssd1306_t* lcd, unsigned char sda, unsigned char scl);
+void lcd_ssd1306_I2C_process(void* arg);
 
 void lcd_ssd1306_draw(lcd_ssd1306_t* lcd, CCanvas* canvas, int x1, int y1, int w1, int h1, int picpwr);
 
@@ -83,6 +83,14 @@ void mi2c_end(mi2c_t* mem) {
 unsigned char mi2c_io(mi2c_t* mem, unsigned char scl, unsigned char sda) {
     unsigned char ret = bitbang_i2c_io(&mem->bb_i2c, scl, sda);
 
+    mi2c_process(mem);
+
+    return ret;
+}
+
+void mi2c_process(void* arg) {
+    mi2c_t* mem = (mi2c_t*)arg;
+
     switch (bitbang_i2c_get_status(&mem->bb_i2c)) {
         case I2C_ADDR:
             if ((mem->bb_i2c.datar & 0x01) == 0x00) {
@@ -129,6 +137,4 @@ unsigned char mi2c_io(mi2c_t* mem, unsigned char scl, unsigned char sda) {
             }
             break;
     }
-
-    return ret;
 }
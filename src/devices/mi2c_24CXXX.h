@@ -43,3 +43,4 @@ void mi2c_end(mi2c_t* mem);
 void mi2c_set_addr(mi2c_t* mem, unsigned char addr);
 
 unsigned char mi2c_io(mi2c_t* mem, unsigned char scl, unsigned char sda);
+void mi2c_process(void* arg);
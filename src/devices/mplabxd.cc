@@ -61,6 +61,7 @@ static WSADATA wsaData;
 #include <string.h>
 #include <unistd.h>
 
+#include "../lib/breakpoints.h"
 #include "../lib/picsimlab.h"
 
 typedef struct sockaddr sockaddr;
@@ -116,6 +117,7 @@ static int server_started = 0;
 static board* dbg_board = NULL;
 static unsigned char* ramsend = NULL;
 static unsigned char* ramreceived = NULL;
+static breakpoints_t bps;
 
 void setnblock(int sock_descriptor);
 void setblock(int sock_descriptor);
@@ -160,6 +162,7 @@ int mplabxd_init(board* mboard, unsigned short tcpport) {
     if (!ramsend) {
         ramsend = (unsigned char*)malloc(dbg_board->DBGGetRAMSize());
         ramreceived = (unsigned char*)malloc(dbg_board->DBGGetRAMSize());
+        breakpoints_init(&bps, dbg_board->DBGGetROMSize(), dbg_board->DBGGetRAMSize());
     }
     return 0;
 }
@@ -198,6 +201,7 @@ void mplabxd_end(void) {
         free(ramreceived);
         ramsend = NULL;
         ramreceived = NULL;
+        breakpoints_free(&bps);
         dbg_board = NULL;
     }
 }
@@ -226,37 +230,44 @@ static unsigned int bpdr[100];
 
 static unsigned short dbuff[2];
 
+// rebuild the bitmap of the type with the received breakpoints list
+static void mplabxd_setbp(const int type, const unsigned int* list, const int count) {
+    breakpoints_clear(&bps, type);
+    for (int i = 0; i < count; i++) {
+        if (breakpoints_set(&bps, type, list[i]) < 0) {
+            printf("mplabxd: breakpoint address 0x%04X out of range\n", list[i]);
+        }
+    }
+}
+
 int mplabxd_testbp(void) {
-    int i;
-    if (!PICSimLab.GetMcuDbg()) {
-        for (i = 0; i < bpc; i++) {
-            if (dbg_board->DBGGetPC() == bp[i]) {
-                dprint("breakpoint 0x%04X!!!!!=========================\n", bp[i]);
-                PICSimLab.SetCpuState(CPU_BREAKPOINT);
-                PICSimLab.Set_mcudbg(1);
-                return PICSimLab.GetMcuDbg();
-            }
+    if (bps.armed && !PICSimLab.GetMcuDbg()) {
+        if (bps.map[BP_CODE].count && breakpoints_test(&bps, BP_CODE, dbg_board->DBGGetPC())) {
+            dprint("breakpoint 0x%04X!!!!!=========================\n", dbg_board->DBGGetPC());
+            PICSimLab.SetCpuState(CPU_BREAKPOINT);
+            PICSimLab.Set_mcudbg(1);
+            return PICSimLab.GetMcuDbg();
         }
-        for (i = 0; i < bpdwc; i++) {
-            if (dbg_board->DBGGetRAMLAWR() == bpdw[i]) {
-                dprint("breakpoint data wr 0x%04X!!!!!=========================\n", bpdw[i]);
-                PICSimLab.SetCpuState(CPU_BREAKPOINT);
-                PICSimLab.Set_mcudbg(1);
-                return PICSimLab.GetMcuDbg();
-            }
+        if (bps.map[BP_DATA_WR].count && breakpoints_test(&bps, BP_DATA_WR, dbg_board->DBGGetRAMLAWR())) {
+            dprint("breakpoint data wr 0x%04X!!!!!=========================\n", dbg_board->DBGGetRAMLAWR());
+            PICSimLab.SetCpuState(CPU_BREAKPOINT);
+            PICSimLab.Set_mcudbg(1);
+            return PICSimLab.GetMcuDbg();
         }
-        for (i = 0; i < bpdrc; i++) {
-            if (dbg_board->DBGGetRAMLARD() == bpdr[i]) {
-                dprint("breakpoint data rd 0x%04X!!!!!=========================\n", bpdr[i]);
-                PICSimLab.SetCpuState(CPU_BREAKPOINT);
-                PICSimLab.Set_mcudbg(1);
-                return PICSimLab.GetMcuDbg();
-            }
+        if (bps.map[BP_DATA_RD].count && breakpoints_test(&bps, BP_DATA_RD, dbg_board->DBGGetRAMLARD())) {
+            dprint("breakpoint data rd 0x%04X!!!!!=========================\n", dbg_board->DBGGetRAMLARD());
+            PICSimLab.SetCpuState(CPU_BREAKPOINT);
+            PICSimLab.Set_mcudbg(1);
+            return PICSimLab.GetMcuDbg();
         }
     }
     return PICSimLab.GetMcuDbg();
 }
 
+int mplabxd_bp_count(void) {
+    return bps.armed;
+}
+
 int mplabxd_loop(void) {
     unsigned int pc;
     int i;
@@ -299,6 +310,9 @@ int mplabxd_loop(void) {
                 bpc = 0;
                 bpdwc = 0;
                 bpdrc = 0;
+                breakpoints_clear(&bps, BP_CODE);
+                breakpoints_clear(&bps, BP_DATA_WR);
+                breakpoints_clear(&bps, BP_DATA_RD);
                 break;
             case STEP:
                 dprint("STEP cmd\n");
@@ -362,6 +376,7 @@ int mplabxd_loop(void) {
                         printf("bp %i = %#06X\n", i, bp[i]);
 #endif
                 }
+                mplabxd_setbp(BP_CODE, bp, bpc);
                 dprint("SETBK cmd\n");
                 break;
             case STRUN:
@@ -393,6 +408,7 @@ int mplabxd_loop(void) {
                         printf("bpdw %i = %#06X\n", i, bpdw[i]);
 #endif
                 }
+                mplabxd_setbp(BP_DATA_WR, bpdw, bpdwc);
                 dprint("SDWBK cmd\n");
                 break;
             case SDRBK:
@@ -415,6 +431,7 @@ int mplabxd_loop(void) {
                         printf("bpdr %i = %#06X\n", i, bpdr[i]);
 #endif
                 }
+                mplabxd_setbp(BP_DATA_RD, bpdr, bpdrc);
                 dprint("SDRBK cmd\n");
                 break;
             case GETID:
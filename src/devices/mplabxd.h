@@ -33,6 +33,7 @@ int mplabxd_init(board* mboard, unsigned short tcpport);
 int mplabxd_loop(void);
 void mplabxd_end(void);
 int mplabxd_testbp(void);
+int mplabxd_bp_count(void);
 void mplabxd_server_end(void);
 
 #endif /* MPLABXD_H */
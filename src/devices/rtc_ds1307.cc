@@ -238,6 +238,14 @@ void rtc_ds1307_end(rtc_ds1307_t* rtc) {
 unsigned char rtc_ds1307_I2C_io(rtc_ds1307_t* rtc, unsigned char scl, unsigned char sda) {
     unsigned char ret = bitbang_i2c_io(&rtc->bb_i2c, scl, sda);
 
+    rtc_ds1307_I2C_process(rtc);
+
+    return ret;
+}
+
+void rtc_ds1307_I2C_process(void* arg) {
+    rtc_ds1307_t* rtc = (rtc_ds1307_t*)arg;
+
     switch (bitbang_i2c_get_status(&rtc->bb_i2c)) {
         case I2C_DATAW:
             if (rtc->bb_i2c.byte == 2) {
@@ -292,8 +300,6 @@ unsigned char rtc_ds1307_I2C_io(rtc_ds1307_t* rtc, unsigned char scl, unsigned c
             }
             break;
     }
-
-    return ret;
 }
 
 // TODO int output
\ No newline at end of file
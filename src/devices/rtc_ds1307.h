@@ -48,3 +48,4 @@ void rtc_ds1307_setUtime(rtc_ds1307_t* rtc, time_t utime);
 time_t rtc_ds1307_getUtime(rtc_ds1307_t* rtc);
 
 unsigned char rtc_ds1307_I2C_io(rtc_ds1307_t* rtc, unsigned char scl, unsigned char sda);
+void rtc_ds1307_I2C_process(void* arg);
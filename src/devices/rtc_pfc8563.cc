@@ -217,6 +217,14 @@ void rtc_pfc8563_end(rtc_pfc8563_t* rtc) {
 unsigned char rtc_pfc8563_I2C_io(rtc_pfc8563_t* rtc, unsigned char scl, unsigned char sda) {
     unsigned char ret = bitbang_i2c_io(&rtc->bb_i2c, scl, sda);
 
+    rtc_pfc8563_I2C_process(rtc);
+
+    return ret;
+}
+
+void rtc_pfc8563_I2C_process(void* arg) {
+    rtc_pfc8563_t* rtc = (rtc_pfc8563_t*)arg;
+
     switch (bitbang_i2c_get_status(&rtc->bb_i2c)) {
         case I2C_DATAW:
 
@@ -274,8 +282,6 @@ unsigned char rtc_pfc8563_I2C_io(rtc_pfc8563_t* rtc, unsigned char scl, unsigned
             }
             break;
     }
-
-    return ret;
 }
 
 // TODO int output and countdown timer
@@ -48,3 +48,4 @@ void rtc_pfc8563_setUtime(rtc_pfc8563_t* rtc, time_t utime);
 time_t rtc_pfc8563_getUtime(rtc_pfc8563_t* rtc);
 
 unsigned char rtc_pfc8563_I2C_io(rtc_pfc8563_t* rtc, unsigned char scl, unsigned char sda);
+void rtc_pfc8563_I2C_process(void* arg);
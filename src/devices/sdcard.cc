@@ -76,8 +76,6 @@ void sdcard_set_card_present(sdcard_t* sd, unsigned char cp) {
     }
 }
 
-static char buff[512];
-
 unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, unsigned char ss) {
     unsigned int offset = 0;
 
@@ -122,10 +120,10 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                         sd->bb_spi.outsr = (sd->bb_spi.outsr & 0xFF00) | 0x05;
                     }
                 } else {
-                    buff[512 - (sd->data_wc - 2)] = sd->bb_spi.insr & 0xFF;
+                    sd->buff[512 - (sd->data_wc - 2)] = sd->bb_spi.insr & 0xFF;
                     dsprintf("sdcard write buff[%i]= 0x%02X \n", 512 - (sd->data_wc - 2), sd->bb_spi.insr & 0xFF);
                     if ((sd->data_wc - 3) == 0) {
-                        fwrite(buff, 512, 1, sd->fd);
+                        fwrite(sd->buff, 512, 1, sd->fd);
                         dprintf("sdcard 512 bytes writed end %li \n", ftell(sd->fd) / 512);
                     }
                 }
@@ -287,7 +285,7 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                                     sd->data_rc = 512;
 
                                     fseek(sd->fd, sd->arg /* 512*/, SEEK_SET);
-                                    fread(buff, 512, 1, sd->fd);
+                                    fread(sd->buff, 512, 1, sd->fd);
                                     dprintf("sdcard reading block %li\n", sd->arg / 512);
                                     break;
                                 case CMD24:                   // WRITE_BLOCK - write a single data block to the card
@@ -328,9 +326,9 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                                     sd->replyc = 2;
                                     dprintf("sdcard erasing blocks %li to %li\n", sd->ebstart, sd->ebend);
                                     fseek(sd->fd, sd->ebstart, SEEK_SET);
-                                    memset(buff, 0, 512);
+                                    memset(sd->buff, 0, 512);
                                     for (offset = sd->ebstart; offset < sd->ebend; offset++) {
-                                        fwrite(buff, 512, 1, sd->fd);
+                                        fwrite(sd->buff, 512, 1, sd->fd);
                                     }
                                     break;
                                 case CMD55:                   // APP_CMD - escape for application specific command
@@ -381,7 +379,7 @@ unsigned short sdcard_io(sdcard_t* sd, unsigned char mosi, unsigned char clk, un
                                 sd->bb_spi.outsr = (sd->bb_spi.outsr & 0xFF00) | sd->reply[offset - 1];
                             } else {
                                 if (sd->data_rc) {
-                                    sd->bb_spi.outsr = (sd->bb_spi.outsr & 0xFF00) | buff[512 - sd->data_rc];
+                                    sd->bb_spi.outsr = (sd->bb_spi.outsr & 0xFF00) | sd->buff[512 - sd->data_rc];
                                     sd->data_rc--;
                                 } else {
                                     sd->bb_spi.outsr = (sd->bb_spi.outsr & 0xFF00) | 0;  // crc
@@ -73,6 +73,7 @@ typedef struct {
     unsigned long disk_size;  // in kb
     unsigned long ebstart;
     unsigned long ebend;
+    char buff[512];  // block data
 } sdcard_t;
 
 void sdcard_rst(sdcard_t* sd);
@@ -86,6 +86,14 @@ static void adxl345_regwrited(adxl345_t* adxl) {
 unsigned char adxl345_io_I2C(adxl345_t* adxl, unsigned char scl, unsigned char sda) {
     unsigned char ret = bitbang_i2c_io(&adxl->bb_i2c, scl, sda);
 
+    adxl345_process_I2C(adxl);
+
+    return ret;
+}
+
+void adxl345_process_I2C(void* arg) {
+    adxl345_t* adxl = (adxl345_t*)arg;
+
     switch (bitbang_i2c_get_status(&adxl->bb_i2c)) {
         case I2C_ADDR:
             break;
@@ -114,8 +122,6 @@ unsigned char adxl345_io_I2C(adxl345_t* adxl, unsigned char scl, unsigned char s
             }
             break;
     }
-
-    return ret;
 }
 
 unsigned short adxl345_io_SPI(adxl345_t* adxl, unsigned char mosi, unsigned char clk, unsigned char ss) {
@@ -87,6 +87,14 @@ void sen_bmp180_end(sen_bmp180_t* bmp180) {
 
 unsigned char sen_bmp180_I2C_io(sen_bmp180_t* bmp180, const unsigned char scl, const unsigned char sda) {
     unsigned char ret = bitbang_i2c_io(&bmp180->bb_i2c, scl, sda);
+
+    sen_bmp180_I2C_process(bmp180);
+
+    return ret;
+}
+
+void sen_bmp180_I2C_process(void* arg) {
+    sen_bmp180_t* bmp180 = (sen_bmp180_t*)arg;
     int temp;
 
     switch (bitbang_i2c_get_status(&bmp180->bb_i2c)) {
@@ -152,8 +160,6 @@ unsigned char sen_bmp180_I2C_io(sen_bmp180_t* bmp180, const unsigned char scl, c
             bmp180->addr++;
             break;
     }
-
-    return ret;
 }
 
 void sen_bmp180_setPressTemp(sen_bmp180_t* bmp180, const float pressureh, const float temp) {
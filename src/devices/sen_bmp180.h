@@ -39,3 +39,4 @@ void sen_bmp180_end(sen_bmp180_t* bmp180);
 void sen_bmp180_setPressTemp(sen_bmp180_t* bmp180, const float pressure, const float temp);
 
 unsigned char sen_bmp180_I2C_io(sen_bmp180_t* bmp180, const unsigned char scl, const unsigned char sda);
+void sen_bmp180_I2C_process(void* arg);
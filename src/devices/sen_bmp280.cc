@@ -146,6 +146,14 @@ static unsigned char bmp280_read(sen_bmp280_t* bmp280) {
 unsigned char sen_bmp280_I2C_io(sen_bmp280_t* bmp280, const unsigned char scl, const unsigned char sda) {
     unsigned char ret = bitbang_i2c_io(&bmp280->bb_i2c, scl, sda);
 
+    sen_bmp280_I2C_process(bmp280);
+
+    return ret;
+}
+
+void sen_bmp280_I2C_process(void* arg) {
+    sen_bmp280_t* bmp280 = (sen_bmp280_t*)arg;
+
     switch (bitbang_i2c_get_status(&bmp280->bb_i2c)) {
         case I2C_DATAW:
             dprintf("bmp280 data %02X  byte=%i\n", bmp280->bb_i2c.datar, bmp280->bb_i2c.byte);
@@ -173,8 +181,6 @@ unsigned char sen_bmp280_I2C_io(sen_bmp280_t* bmp280, const unsigned char scl, c
             bmp280->addr++;
             break;
     }
-
-    return ret;
 }
 
 unsigned short sen_bmp280_io_SPI(sen_bmp280_t* bmp280, unsigned char mosi, unsigned char clk, unsigned char ss) {
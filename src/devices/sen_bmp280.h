@@ -44,4 +44,5 @@ void sen_bmp280_setPressTemp(sen_bmp280_t* bmp280, const float pressure, const f
 void sen_bmp280_set_addr(sen_bmp280_t* bmp280, unsigned char addr);
 
 unsigned char sen_bmp280_I2C_io(sen_bmp280_t* bmp280, const unsigned char scl, const unsigned char sda);
+void sen_bmp280_I2C_process(void* arg);
 unsigned short sen_bmp280_io_SPI(sen_bmp280_t* bmp280, unsigned char mosi, unsigned char clk, unsigned char ss);
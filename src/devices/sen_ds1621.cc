@@ -66,6 +66,14 @@ void sen_ds1621_end(sen_ds1621_t* ds1621) {
 unsigned char sen_ds1621_I2C_io(sen_ds1621_t* ds1621, unsigned char scl, unsigned char sda) {
     unsigned char ret = bitbang_i2c_io(&ds1621->bb_i2c, scl, sda);
 
+    sen_ds1621_I2C_process(ds1621);
+
+    return ret;
+}
+
+void sen_ds1621_I2C_process(void* arg) {
+    sen_ds1621_t* ds1621 = (sen_ds1621_t*)arg;
+
     switch (bitbang_i2c_get_status(&ds1621->bb_i2c)) {
         case I2C_DATAW:
             dprintf("data %02X  byte=%i\n", ds1621->bb_i2c.datar, ds1621->bb_i2c.byte);
@@ -147,8 +155,6 @@ unsigned char sen_ds1621_I2C_io(sen_ds1621_t* ds1621, unsigned char scl, unsigne
             }
             break;
     }
-
-    return ret;
 }
 
 void sen_ds1621_setTemp(sen_ds1621_t* ds1621, float temp) {
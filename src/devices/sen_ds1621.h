@@ -42,3 +42,4 @@ void sen_ds1621_setTemp(sen_ds1621_t* ds1621, float temp);
 void sen_ds1621_set_addr(sen_ds1621_t* ds1621, unsigned char addr);
 
 unsigned char sen_ds1621_I2C_io(sen_ds1621_t* ds1621, unsigned char scl, unsigned char sda);
+void sen_ds1621_I2C_process(void* arg);
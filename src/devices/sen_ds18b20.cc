@@ -102,18 +102,18 @@ static void sen_ds18b20_callback(void* arg) {
                 case 0:
                     ds18b20->out = 0;  // odd values are logic one
                     ds18b20->pboard->TimerChange_us(ds18b20->TimerID, 200);
-                    ioupdated = 1;
+                    ds18b20->pboard->SetIOUpdated(1);
                     ds18b20->statebit++;
                     break;
                 case 1:
                     ds18b20->out = 1;  // odd values are logic one
                     ds18b20->pboard->TimerChange_us(ds18b20->TimerID, 200);
-                    ioupdated = 1;
+                    ds18b20->pboard->SetIOUpdated(1);
                     ds18b20->statebit++;
                     break;
                 case 2:
                     ds18b20->out = 1;
-                    ioupdated = 1;
+                    ds18b20->pboard->SetIOUpdated(1);
                     ds18b20->pboard->TimerSetState(ds18b20->TimerID, 0);
                     ds18b20->state = OW_CMD;
                     ds18b20->statebit = 0;
@@ -226,7 +226,7 @@ static void sen_ds18b20_callback(void* arg) {
             if (ds18b20->start) {
                 ds18b20->start = 0;
                 ds18b20->out = (ds18b20->scratchpad[ds18b20->addrc] & (1 << (ds18b20->statebit & 0x07))) > 0;
-                ioupdated = 1;
+                ds18b20->pboard->SetIOUpdated(1);
                 ds18b20->pboard->TimerChange_us(ds18b20->TimerID, 15);
 
                 if (!((ds18b20->statebit + 1) & 0x07)) {
@@ -237,7 +237,7 @@ static void sen_ds18b20_callback(void* arg) {
                 ds18b20->start = 1;
                 if (!ds18b20->out) {
                     ds18b20->out = 1;
-                    ioupdated = 1;
+                    ds18b20->pboard->SetIOUpdated(1);
                 }
 
                 ds18b20->pboard->TimerSetState(ds18b20->TimerID, 0);
@@ -253,7 +253,7 @@ static void sen_ds18b20_callback(void* arg) {
             switch (ds18b20->start) {
                 case 0:
                     ds18b20->out = (ds18b20->addr[ds18b20->addrc] & (1 << (ds18b20->statebit & 0x07))) > 0;
-                    ioupdated = 1;
+                    ds18b20->pboard->SetIOUpdated(1);
                     ds18b20->pboard->TimerChange_us(ds18b20->TimerID, 15);
 
                     break;
@@ -261,13 +261,13 @@ static void sen_ds18b20_callback(void* arg) {
                 case 3:
                     if (!ds18b20->out) {
                         ds18b20->out = 1;
-                        ioupdated = 1;
+                        ds18b20->pboard->SetIOUpdated(1);
                     }
                     ds18b20->pboard->TimerSetState(ds18b20->TimerID, 0);
                     break;
                 case 2:
                     ds18b20->out = (ds18b20->addr[ds18b20->addrc] & (1 << (ds18b20->statebit & 0x07))) == 0;
-                    ioupdated = 1;
+                    ds18b20->pboard->SetIOUpdated(1);
                     ds18b20->pboard->TimerChange_us(ds18b20->TimerID, 15);
 
                     break;
@@ -297,7 +297,7 @@ static void sen_ds18b20_callback(void* arg) {
             if (ds18b20->start) {
                 ds18b20->start = 0;
                 ds18b20->out = (ds18b20->addr[ds18b20->addrc] & (1 << (ds18b20->statebit & 0x07))) > 0;
-                ioupdated = 1;
+                ds18b20->pboard->SetIOUpdated(1);
                 ds18b20->pboard->TimerChange_us(ds18b20->TimerID, 15);
 
                 if (!((ds18b20->statebit + 1) & 0x07)) {
@@ -308,7 +308,7 @@ static void sen_ds18b20_callback(void* arg) {
                 ds18b20->start = 1;
                 if (!ds18b20->out) {
                     ds18b20->out = 1;
-                    ioupdated = 1;
+                    ds18b20->pboard->SetIOUpdated(1);
                 }
 
                 ds18b20->pboard->TimerSetState(ds18b20->TimerID, 0);
@@ -59,6 +59,11 @@ unsigned short sen_hx711_io_SPI(sen_hx711_t* hx711, unsigned char clk) {
     if ((!hx711->aclk) && (clk)) {  // rising edge
         hx711->tstart = hx711->pboard->InstCounterGet();
     } else if ((hx711->aclk) && (!clk)) {  // falling edge
+        // the clock high time is checked on the edge too, the part is only processed on clock changes
+        if (hx711->power && (hx711->pboard->InstCounterGet_us(hx711->tstart) > 60)) {
+            dprintf("hx711 power down\n");
+            hx711->power = 0;
+        }
 
         if (!hx711->power) {
             bitbang_spi_rst(&hx711->bb_spi);
@@ -103,5 +108,5 @@ void sen_hx711_setWeight(sen_hx711_t* hx711, const float weight) {
         hx711->bb_spi.ret = 1;
     }
 
-    ioupdated = 1;
+    hx711->pboard->SetIOUpdated(1);
 }
@@ -67,6 +67,14 @@ void mpu6050_end(mpu6050_t* mpu) {
 unsigned char mpu6050_io_I2C(mpu6050_t* mpu, unsigned char scl, unsigned char sda) {
     unsigned char ret = bitbang_i2c_io(&mpu->bb_i2c, scl, sda);
 
+    mpu6050_process_I2C(mpu);
+
+    return ret;
+}
+
+void mpu6050_process_I2C(void* arg) {
+    mpu6050_t* mpu = (mpu6050_t*)arg;
+
     switch (bitbang_i2c_get_status(&mpu->bb_i2c)) {
         case I2C_ADDR:
             break;
@@ -114,8 +122,6 @@ unsigned char mpu6050_io_I2C(mpu6050_t* mpu, unsigned char scl, unsigned char sd
             }
             break;
     }
-
-    return ret;
 }
 
 void mpu6050_set_temp(mpu6050_t* mpu, double temp) {
@@ -44,6 +44,7 @@ void mpu6050_set_accel_raw(mpu6050_t* mpu, short x, short y, short z);  // g
 void mpu6050_set_gyro_raw(mpu6050_t* mpu, short x, short y, short z);   // degrees/s
 
 unsigned char mpu6050_io_I2C(mpu6050_t* mpu, unsigned char scl, unsigned char sda);
+void mpu6050_process_I2C(void* arg);
 
 // REGISTERS ADDRESS
 #define SELF_TEST_X 0x0D
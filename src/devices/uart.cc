@@ -44,7 +44,7 @@ static void uart_rx_callback(bitbang_uart_t* bu, void* arg) {
     uart_t* sr = (uart_t*)arg;
     unsigned char data = bitbang_uart_recv(&sr->bb_uart);
     if (sr->connected) {
-        serial_port_send(sr->serialfd, data);
+        serial_stream_send(&sr->serial, data);
     }
 }
 
@@ -52,13 +52,13 @@ void uart_init(uart_t* sr, board* pboard) {
     bitbang_uart_init(&sr->bb_uart, pboard, uart_rx_callback, sr);
     sr->connected = 0;
     uart_rst(sr);
-    sr->serialfd = 0;
+    serial_stream_init(&sr->serial);
     dprintf("init uart\n");
 }
 
 void uart_end(uart_t* sr) {
     if (sr->connected) {
-        serial_port_close(sr->serialfd);
+        serial_stream_close(&sr->serial);
         sr->connected = 0;
     }
     bitbang_uart_end(&sr->bb_uart);
@@ -71,7 +71,7 @@ unsigned char uart_io(uart_t* sr, const unsigned char rx) {
 
     if (!bitbang_uart_transmitting(&sr->bb_uart)) {
         unsigned char data;
-        if (serial_port_rec(sr->serialfd, &data)) {
+        if (serial_stream_rec(&sr->serial, &data)) {
             bitbang_uart_send(&sr->bb_uart, data);
         }
     }
@@ -80,14 +80,14 @@ unsigned char uart_io(uart_t* sr, const unsigned char rx) {
 
 void uart_set_port(uart_t* sr, const char* port, const unsigned int speed) {
     if (sr->connected) {
-        serial_port_close(sr->serialfd);
+        serial_stream_close(&sr->serial);
         sr->connected = 0;
     }
 
-    if (serial_port_open(&sr->serialfd, port)) {
+    if (serial_stream_open(&sr->serial, port)) {
         sr->connected = 1;
         bitbang_uart_set_speed(&sr->bb_uart, speed);
-        serial_port_cfg(sr->serialfd, speed);
+        serial_stream_cfg(&sr->serial, speed);
         dprintf("uart serial open: %s  speed %i\n", port, speed);
     } else {
         sr->connected = 0;
@@ -32,7 +32,7 @@
 
 typedef struct {
     unsigned char connected;
-    serialfd_t serialfd;
+    serial_stream_t serial;
     bitbang_uart_t bb_uart;
 } uart_t;
 
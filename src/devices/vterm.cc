@@ -105,6 +105,7 @@ void vterm_init(vterm_t* vt, board* pboard) {
 }
 
 void vterm_end(vterm_t* vt) {
+    bitbang_uart_link(&vt->bb_uart, NULL);
     delete vt->inMutex;
 }
 
@@ -25,10 +25,13 @@
 
 #include "board.h"
 #include "picsimlab.h"
-
-int ioupdated = 0;
+#include "spareparts.h"
 
 board::board(void) {
+    static unsigned int instances = 0;
+
+    // boards are created by the batch contexts in parallel
+    Instance = __atomic_add_fetch(&instances, 1, __ATOMIC_RELAXED);
     ioupdated = 1;
     inputc = 0;
     outputc = 0;
@@ -38,12 +41,8 @@ board::board(void) {
     p_RST = 1;
     Scale = PICSimLab.GetScale();
     InstCounter = 0;
-    TimersCount = 0;
-    for (int i = 0; i < MAX_TIMERS; i++) {
-        Timers[i].Arg = NULL;
-        Timers[i].Callback = NULL;
-        Timers[i].Enabled = 0;
-    }
+    TimerQueue_init(&Timers, InstCounter);
+    PinTrace = NULL;
 }
 
 board::~board(void) {}
@@ -311,6 +310,16 @@ output_t* board::GetOutput(int n) {
     return NULL;
 }
 
+int board::GetOutputsUpdate(void) {
+    int count = 0;
+    for (int i = 0; i < outputc; i++) {
+        if (output[i].update) {
+            count++;
+        }
+    }
+    return count;
+}
+
 unsigned char board::CalcAngle(int in, int x, int y) {
     int dx = input[in].cx - x;
     int dy = y - input[in].cy;
@@ -365,109 +374,43 @@ void board::StartThread(void) {
 #endif
 }
 
-void board::InstCounterInc(void) {
-    InstCounter++;
-    for (int t = 0; t < TimersCount; t++) {
-        if (TimersList[t]->Enabled) {
-            TimersList[t]->Timer--;
-            if (!TimersList[t]->Timer) {
-                (*TimersList[t]->Callback)(TimersList[t]->Arg);
-                TimersList[t]->Timer = TimersList[t]->Reload;
-            }
-        }
+static uint32_t TimerCalcReload(const double time, const double freq) {
+    const double reload = time * freq;
+    if (reload < 1) {
+        return 1;
     }
+    return reload;
 }
 
 int board::TimerRegister_us(const double micros, void (*Callback)(void* arg), void* arg) {
-    if (TimersCount < MAX_TIMERS) {
-        int timern = 0;
-        for (int i = 0; i < MAX_TIMERS; i++) {
-            if (Timers[i].Callback == NULL) {
-                timern = i + 1;
-                break;
-            }
-        }
-        TimerChange_us(timern, micros);
-        Timers[timern - 1].Callback = Callback;
-        Timers[timern - 1].Arg = arg;
-        Timers[timern - 1].Enabled = 1;
-        TimersList[TimersCount] = &Timers[timern - 1];
-        TimersCount++;
-        return timern;
-    }
-    return -1;
+    return TimerQueue_register(&Timers, InstCounter, TimerCalcReload(micros * 1e-6, MGetInstClockFreq()), Callback,
+                               arg);
 }
 
 int board::TimerRegister_ms(const double miles, void (*Callback)(void* arg), void* arg) {
-    if (TimersCount < MAX_TIMERS) {
-        int timern = 0;
-        for (int i = 0; i < MAX_TIMERS; i++) {
-            if (Timers[i].Callback == NULL) {
-                timern = i + 1;
-                break;
-            }
-        }
-        TimerChange_us(timern, miles);
-        Timers[timern - 1].Callback = Callback;
-        Timers[timern - 1].Arg = arg;
-        Timers[timern - 1].Enabled = 1;
-        TimersList[TimersCount] = &Timers[timern - 1];
-        TimersCount++;
-        return timern;
-    }
-    return -1;
+    return TimerQueue_register(&Timers, InstCounter, TimerCalcReload(miles * 1e-3, MGetInstClockFreq()), Callback,
+                               arg);
 }
 
 int board::TimerUnregister(const int timer) {
-    if (timer <= MAX_TIMERS) {
-        Timers[timer - 1].Callback = NULL;  // free timer
-        for (int t = timer - 1; t < (TimersCount - 1); t++) {
-            TimersList[t] = TimersList[t + 1];
-        }
-        TimersCount--;
-        TimersList[TimersCount] = NULL;
-        return 0;
-    }
-    return -1;
+    return TimerQueue_unregister(&Timers, InstCounter, timer);
 }
 
 int board::TimerChange_us(const int timer, const double micros) {
-    if (timer <= MAX_TIMERS) {
-        Timers[timer - 1].Reload = micros * 1e-6 * MGetInstClockFreq();
-        if (Timers[timer - 1].Reload <= 0) {
-            Timers[timer - 1].Reload = 1;
-        }
-        Timers[timer - 1].Timer = Timers[timer - 1].Reload;
-        return 0;
-    }
-    return -1;
+    return TimerQueue_change(&Timers, InstCounter, timer, TimerCalcReload(micros * 1e-6, MGetInstClockFreq()));
 }
 
 int board::TimerChange_ms(const int timer, const double miles) {
-    if (timer <= MAX_TIMERS) {
-        Timers[timer - 1].Reload = miles * 1e-3 * MGetInstClockFreq();
-        if (Timers[timer - 1].Reload <= 0) {
-            Timers[timer - 1].Reload = 1;
-        }
-        Timers[timer - 1].Timer = Timers[timer - 1].Reload;
-        return 0;
-    }
-    return -1;
+    return TimerQueue_change(&Timers, InstCounter, timer, TimerCalcReload(miles * 1e-3, MGetInstClockFreq()));
 }
+
 int board::TimerSetState(const int timer, const int enabled) {
-    if (timer <= MAX_TIMERS) {
-        Timers[timer - 1].Enabled = enabled;
-        if (enabled) {
-            Timers[timer - 1].Timer = Timers[timer - 1].Reload;
-        }
-        return 0;
-    }
-    return -1;
+    return TimerQueue_set_state(&Timers, InstCounter, timer, enabled);
 }
 
 uint64_t board::TimerGet_ns(const int timer) {
-    if (timer <= MAX_TIMERS) {
-        return (Timers[timer - 1].Reload * 1e9) / MGetInstClockFreq();
+    if ((timer > 0) && (timer <= MAX_TIMERS)) {
+        return (TimerQueue_get_reload(&Timers, timer) * 1e9) / MGetInstClockFreq();
     }
     return -1;
 }
@@ -479,6 +422,188 @@ uint32_t board::InstCounterGet_ms(const uint32_t start) {
     return ((InstCounter - start) * 1e3) / MGetInstClockFreq();
 }
 
+void board::SetPinTrace(pin_trace_t* pt) {
+    __atomic_store_n(&PinTrace, pt, __ATOMIC_RELEASE);
+}
+
+void board::PinTraceUpdate(void) {
+    pin_trace_t* pt = __atomic_load_n(&PinTrace, __ATOMIC_ACQUIRE);
+    if (!pt) {
+        return;
+    }
+
+    if (__atomic_load_n(&pt->resync, __ATOMIC_ACQUIRE)) {
+        memset(pt->last, 0xFF, sizeof(pt->last));
+        __atomic_store_n(&pt->resync, 0, __ATOMIC_RELEASE);
+    }
+
+    const picpin* pins = MGetPinsValues();
+    int count = MGetPinCount();
+    if (count > 256) {
+        count = 256;
+    }
+    for (int i = 0; i < count; i++) {
+        const unsigned char state = (pins[i].value & 0x01) | ((pins[i].dir == PD_IN) << 1);
+        if (state != pt->last[i]) {
+            pt->last[i] = state;
+            pin_trace_put(pt, InstCounter, i + 1, state);
+        }
+    }
+}
+
+uint32_t board::IdleFastForward(const uint32_t max) {
+    uint32_t steps = MGetIdleSteps();
+
+    if ((!steps) || (!max) || ioupdated || (!StepBatchEnabled())) {
+        return 0;
+    }
+
+    if (Timers.HeapCount) {
+        const uint32_t next = Timers.Next - InstCounter - 1;
+        if (next < steps) {
+            steps = next;
+        }
+    }
+    if (steps > max) {
+        steps = max;
+    }
+    if (steps) {
+        MIdleSkip(steps);
+        InstCounter += steps;
+    }
+    return steps;
+}
+
+int board::StepBatchEnabled(void) {
+    return !(use_oscope || (use_spare && SpareParts.GetAlwaysUpdateCount()) || PICSimLab.GetMcuDbg());
+}
+
+uint32_t board::StepBatch(const uint32_t max) {
+    uint32_t steps = max;
+
+    if (!StepBatchEnabled()) {
+        return 1;
+    }
+
+    if (Timers.HeapCount) {
+        const uint32_t next = Timers.Next - InstCounter;
+        if (next < steps) {
+            steps = next;
+        }
+    }
+    return steps ? steps : 1;
+}
+
+void board::MeanValueSteps(unsigned int* alm, const picpin* pins, const int pinc, unsigned char* pi,
+                           const uint32_t steps) {
+    const uint32_t laps = steps / pinc;
+    uint32_t rem = steps % pinc;
+
+    if (laps) {
+        for (int p = 0; p < pinc; p++) {
+            alm[p] += pins[p].value * laps;
+        }
+    }
+    while (rem--) {
+        alm[*pi] += pins[*pi].value;
+        (*pi)++;
+        if (*pi == pinc)
+            *pi = 0;
+    }
+}
+
+void board::MeanValueSave(unsigned char* values, const picpin* pins, const int pinc) {
+    for (int p = 0; p < pinc; p++) {
+        values[p] = pins[p].value;
+    }
+}
+
+void board::MeanValueBatch(unsigned int* alm, const unsigned char* values, const picpin* pins, const int pinc,
+                           unsigned char* pi, const uint32_t steps) {
+    const uint32_t laps = (steps - 1) / pinc;
+    uint32_t rem = (steps - 1) % pinc;
+
+    if (laps) {
+        for (int p = 0; p < pinc; p++) {
+            alm[p] += values[p] * laps;
+        }
+    }
+    while (rem--) {
+        alm[*pi] += values[*pi];
+        (*pi)++;
+        if (*pi == pinc)
+            *pi = 0;
+    }
+    // the last step
+    alm[*pi] += pins[*pi].value;
+    (*pi)++;
+    if (*pi == pinc)
+        *pi = 0;
+}
+
+// the same sequence saves and restores, all checks are done before any state is restored
+void board::SnapshotState(snapshot_t* sn) {
+    const int use_parts = GetUseSpareParts();
+    const int count = use_parts ? SpareParts.GetCount() : 0;
+    unsigned char registered[MAX_TIMERS];
+
+    snapshot_check_string(sn, (const char*)GetName().c_str(), "board");
+    snapshot_check_string(sn, (const char*)Proc.c_str(), "microcontroller");
+    snapshot_check(sn, &Instance, sizeof(Instance), "board instance");
+    snapshot_check(sn, &count, sizeof(count), "parts count");
+    for (int i = 0; i < count; i++) {
+        snapshot_check_string(sn, (const char*)SpareParts.GetPart(i)->GetName().c_str(), "parts");
+    }
+    // timer callbacks are kept, only the counters are saved
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        registered[i] = Timers.Timers[i].Callback != NULL;
+    }
+    snapshot_check(sn, registered, MAX_TIMERS, "timers");
+    if (sn->error) {
+        return;
+    }
+
+    // the core checks its own struct before restore
+    if (MSnapshot(sn) || sn->error) {
+        return;
+    }
+
+    SNAPSHOT_VAR(sn, InstCounter);
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        SNAPSHOT_VAR(sn, Timers.Timers[i].Deadline);
+        SNAPSHOT_VAR(sn, Timers.Timers[i].Reload);
+        SNAPSHOT_VAR(sn, Timers.Timers[i].Enabled);
+        SNAPSHOT_VAR(sn, Timers.Timers[i].HeapPos);
+    }
+    SNAPSHOT_VAR(sn, Timers.Heap);
+    SNAPSHOT_VAR(sn, Timers.HeapCount);
+    SNAPSHOT_VAR(sn, Timers.Count);
+    SNAPSHOT_VAR(sn, Timers.Next);
+
+    SNAPSHOT_VAR(sn, p_RST);
+    Snapshot(sn);
+
+    for (int i = 0; i < count; i++) {
+        SpareParts.GetPart(i)->Snapshot(sn);
+    }
+}
+
+int board::SnapshotSave(snapshot_t* sn) {
+    snapshot_begin(sn, 0);
+    SnapshotState(sn);
+    return sn->error ? -1 : 0;
+}
+
+int board::SnapshotLoad(snapshot_t* sn) {
+    snapshot_begin(sn, 1);
+    SnapshotState(sn);
+    if (sn->error) {
+        return -1;
+    }
+    ioupdated = 1;  // pins changed
+    return 0;
+}
+
 // BOARDS_DEFS
 
 board_desc boards_list[BOARDS_MAX];
@@ -29,11 +29,17 @@
 #include <lxrad.h>
 #include <picsim/picsim.h>
 #include <stdint.h>
+#include "pin_trace.h"
+#include "profiler.h"
+#include "snapshot.h"
+#include "timer_queue.h"
 
 #define INCOMPLETE                                                      \
     printf("Incomplete: %s -> %s :%i\n", __func__, __FILE__, __LINE__); \
     exit(-1);
 
+typedef struct bitbang_uart_t bitbang_uart_t;
+
 enum { ARCH_P16, ARCH_P16E, ARCH_P18, ARCH_AVR8, ARCH_STM32, ARCH_STM8, ARCH_C51, ARCH_Z80, ARCH_UNKNOWN };
 
 /**
@@ -81,20 +87,6 @@ typedef struct {
     };
 } output_t;
 
-#define MAX_TIMERS 256
-
-/**
- * @brief internal timer struct
- *
- */
-typedef struct {
-    uint32_t Timer;
-    uint32_t Reload;
-    void* Arg;
-    void (*Callback)(void* arg);
-    int Enabled;
-} Timers_t;
-
 /**
  * @brief Board class
  *
@@ -107,6 +99,11 @@ public:
      */
     virtual void Draw(CDraw* draw) = 0;
 
+    /**
+     * @brief Return the number of outputs waiting to be redrawn
+     */
+    int GetOutputsUpdate(void);
+
     /**
      * @brief Paralle thread called ever 100ms to run cpu code
      */
@@ -182,6 +179,11 @@ public:
      */
     virtual void ReadPreferences(char* name, char* value){};
 
+    /**
+     * @brief  Called to save or restore the board state (sn->load) in a simulation snapshot
+     */
+    virtual void Snapshot(snapshot_t* sn){};
+
     /**
      * @brief  return the input ids numbers of names used in input map
      */
@@ -392,6 +394,15 @@ public:
      */
     virtual void MStep(void) = 0;
 
+    /**
+     * @brief board microcontroller run up to max steps without return to the board glue, stops after the step that
+     * changed the IO pins or reached a debugger breakpoint. Returns the number of steps executed
+     */
+    virtual uint32_t MStepUntil(const uint32_t max) {
+        MStep();
+        return 1;
+    };
+
     /**
      * @brief board microcontroller run one or two steps to resume instruction
      */
@@ -402,6 +413,38 @@ public:
      */
     virtual void MReset(int flags) = 0;
 
+    /**
+     * @brief board microcontroller save or restore (sn->load) the core state, returns 0 on success
+     */
+    virtual int MSnapshot(snapshot_t* sn) {
+        snapshot_set_error(sn, "snapshot not supported by the simulator backend");
+        return -1;
+    };
+
+    /**
+     * @brief board microcontroller number of steps that can be skipped without observable effect (sleeping or in a
+     * side effect free wait loop) until the next internal peripheral event, 0 if it is running. Called on each step.
+     * Only the simavr backend implements it.
+     */
+    virtual uint32_t MGetIdleSteps(void) { return 0; };
+
+    /**
+     * @brief board microcontroller advance the time of the idle core by steps
+     */
+    virtual void MIdleSkip(const uint32_t steps){};
+
+    /**
+     * @brief board microcontroller discard the idle detection state, called after steps not seen by MGetIdleSteps
+     */
+    virtual void MIdleReset(void){};
+
+    /**
+     * @brief board microcontroller get the hardware UART model wired to a part with pins rx_pin and tx_pin, used to
+     * exchange whole bytes at the byte time instead of sampling the pins. Returns NULL if there is none. Only simavr
+     * implements it, the PIC UART is internal to picsim and the QEMU boards use their own serial bridge.
+     */
+    virtual bitbang_uart_t* MGetUARTLink(const unsigned char rx_pin, const unsigned char tx_pin) { return NULL; };
+
     /**
      * @brief board microcontroller get pointer to processor ID
      */
@@ -552,6 +595,27 @@ public:
 
     void SetDefaultProcessor(lxString dproc) { DProc = dproc; };
 
+    /**
+     * @brief Set the IO updated flag (pins changed, board glue and parts need process)
+     */
+    void SetIOUpdated(const int iou) { ioupdated = iou; };
+
+    /**
+     * @brief Get the IO updated flag
+     */
+    int GetIOUpdated(void) { return ioupdated; };
+
+    /**
+     * @brief Record the pin changes with the instruction counter in the trace ring (NULL stops), the ring is filled
+     * by the simulation thread
+     */
+    void SetPinTrace(pin_trace_t* pt);
+
+    /**
+     * @brief Record the pins changed since the last record in the trace ring
+     */
+    void PinTraceUpdate(void);
+
     /**
      * @brief Get instruction counter
      */
@@ -602,6 +666,16 @@ public:
      */
     uint64_t TimerGet_ns(const int timer);
 
+    /**
+     * @brief Save the simulation state (core, board, timers and spare parts), returns 0 on success
+     */
+    int SnapshotSave(snapshot_t* sn);
+
+    /**
+     * @brief Restore a simulation state saved by SnapshotSave, returns 0 on success
+     */
+    int SnapshotLoad(snapshot_t* sn);
+
 protected:
     /**
      * @brief Register remote control variables
@@ -609,9 +683,67 @@ protected:
     virtual void RegisterRemoteControl(void){};
 
     /**
-     * @brief Increment the Intructions Counter
+     * @brief Increment the Intructions Counter and run the expired timers
+     */
+    void InstCounterInc(void) {
+        InstCounter++;
+        if (InstCounter == Timers.Next) {
+            PROF_STAGE(PROF_TIMERS, TimerQueue_dispatch(&Timers, InstCounter));
+        }
+        if (ioupdated && PinTrace) {
+            PinTraceUpdate();
+        }
+    };
+
+    /**
+     * @brief Fast-forward the idle microcontroller up to one step before the next core event or board timer deadline,
+     * at most max steps. Called after InstCounterInc on each step, returns the number of skipped steps already added to
+     * the Instructions Counter
+     */
+    uint32_t IdleFastForward(const uint32_t max);
+
+    /**
+     * @brief Add steps to the Intructions Counter and run the expired timers, the steps can't pass the next timer
+     * deadline (see StepBatch)
+     */
+    void InstCounterAdd(const uint32_t steps) {
+        InstCounter += steps;
+        if (InstCounter == Timers.Next) {
+            PROF_STAGE(PROF_TIMERS, TimerQueue_dispatch(&Timers, InstCounter));
+        }
+        if (ioupdated && PinTrace) {
+            PinTraceUpdate();
+        }
+    };
+
+    /**
+     * @brief Returns 0 when each step needs the board glue (oscilloscope, always updated parts or stopped debugger)
      */
-    void InstCounterInc(void);
+    int StepBatchEnabled(void);
+
+    /**
+     * @brief Number of steps, at most max, that can run with MStepUntil up to the next timer deadline. Returns 1 when
+     * the batch is not enabled
+     */
+    uint32_t StepBatch(const uint32_t max);
+
+    /**
+     * @brief Add the steps run or skipped with constant pins to the pins mean value counters sampled one pin per step
+     */
+    static void MeanValueSteps(unsigned int* alm, const picpin* pins, const int pinc, unsigned char* pi,
+                               const uint32_t steps);
+
+    /**
+     * @brief Save the pins values before a MStepUntil batch, used by MeanValueBatch
+     */
+    static void MeanValueSave(unsigned char* values, const picpin* pins, const int pinc);
+
+    /**
+     * @brief Add the steps run by MStepUntil to the pins mean value counters. The pins have the values saved before the
+     * batch in all steps except the last, that can be the one that changed them
+     */
+    static void MeanValueBatch(unsigned int* alm, const unsigned char* values, const picpin* pins, const int pinc,
+                               unsigned char* pi, const uint32_t steps);
 
     lxString Proc;              ///< Name of processor in use
     lxString DProc;             ///< Name of default board processor
@@ -624,6 +756,7 @@ protected:
     int use_oscope;             ///< use oscilloscope window
     int use_spare;              ///< use spare parts window
     unsigned char p_RST;        ///< board /RESET pin state
+    int ioupdated;              ///< IO pins updated flag
     double Scale;
 
     /**
@@ -638,9 +771,11 @@ protected:
 
 private:
     uint32_t InstCounter;
-    int TimersCount;
-    Timers_t Timers[MAX_TIMERS];
-    Timers_t* TimersList[MAX_TIMERS];
+    TimerQueue_t Timers;
+    pin_trace_t* PinTrace;  ///< pin changes trace ring, NULL if not tracing
+    unsigned int Instance;  ///< unique board instance number, snapshots are only valid in the same instance
+
+    void SnapshotState(snapshot_t* sn);
 
     /**
      * @brief Read the Input Map
@@ -653,8 +788,6 @@ private:
     void ReadOutputMap(lxString fname);
 };
 
-extern int ioupdated;
-
 #endif /* BOARD_H */
 
 #ifndef BOARDS_DEFS_H
@@ -0,0 +1,88 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "breakpoints.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void breakpoints_update_armed(breakpoints_t* bp) {
+    bp->armed = bp->map[BP_CODE].count + bp->map[BP_DATA_WR].count + bp->map[BP_DATA_RD].count;
+}
+
+void breakpoints_init(breakpoints_t* bp, const uint32_t code_size, const uint32_t data_size) {
+    const uint32_t sizes[BP_TYPES] = {code_size, data_size, data_size};
+
+    for (int t = 0; t < BP_TYPES; t++) {
+        bpmap_t* m = &bp->map[t];
+        m->map = (uint32_t*)calloc((sizes[t] + 31) >> 5, sizeof(uint32_t));
+        m->size = m->map ? sizes[t] : 0;
+        m->count = 0;
+    }
+    bp->armed = 0;
+}
+
+void breakpoints_free(breakpoints_t* bp) {
+    for (int t = 0; t < BP_TYPES; t++) {
+        free(bp->map[t].map);
+        bp->map[t].map = NULL;
+        bp->map[t].size = 0;
+        bp->map[t].count = 0;
+    }
+    bp->armed = 0;
+}
+
+void breakpoints_clear(breakpoints_t* bp, const int type) {
+    bpmap_t* m = &bp->map[type];
+
+    if (m->count) {
+        memset(m->map, 0, ((m->size + 31) >> 5) * sizeof(uint32_t));
+        m->count = 0;
+        breakpoints_update_armed(bp);
+    }
+}
+
+int breakpoints_set(breakpoints_t* bp, const int type, const uint32_t addr) {
+    bpmap_t* m = &bp->map[type];
+
+    if (addr >= m->size) {
+        return -1;
+    }
+    if (!breakpoints_test(bp, type, addr)) {
+        m->map[addr >> 5] |= 1U << (addr & 0x1F);
+        m->count++;
+        breakpoints_update_armed(bp);
+    }
+    return 0;
+}
+
+void breakpoints_unset(breakpoints_t* bp, const int type, const uint32_t addr) {
+    bpmap_t* m = &bp->map[type];
+
+    if (breakpoints_test(bp, type, addr)) {
+        m->map[addr >> 5] &= ~(1U << (addr & 0x1F));
+        m->count--;
+        breakpoints_update_armed(bp);
+    }
+}
@@ -0,0 +1,84 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef BREAKPOINTS_H
+#define BREAKPOINTS_H
+
+#include <stdint.h>
+
+enum { BP_CODE = 0, BP_DATA_WR, BP_DATA_RD, BP_TYPES };
+
+/**
+ * @brief breakpoints bitmap over an address space
+ */
+typedef struct {
+    uint32_t* map;
+    uint32_t size;  ///< address space size
+    int count;      ///< number of addresses set
+} bpmap_t;
+
+/**
+ * @brief debugger breakpoints and watchpoints
+ *
+ * One bitmap for the program address space and two for the data address space, so the test on each simulated
+ * instruction don't depend on the number of breakpoints. The bitmaps are allocated once by breakpoints_init and
+ * are not resized, the debugger thread can change the breakpoints while the simulation thread tests them.
+ * armed is nonzero if any breakpoint is set, the simulation loop only need to test it while no breakpoint is set.
+ */
+typedef struct {
+    bpmap_t map[BP_TYPES];
+    int armed;
+} breakpoints_t;
+
+/**
+ * @brief allocate the bitmaps for code_size program addresses and data_size data addresses
+ */
+void breakpoints_init(breakpoints_t* bp, const uint32_t code_size, const uint32_t data_size);
+void breakpoints_free(breakpoints_t* bp);
+
+/**
+ * @brief remove all breakpoints of the type
+ */
+void breakpoints_clear(breakpoints_t* bp, const int type);
+
+/**
+ * @brief set a breakpoint of the type, returns -1 if the address is out of the address space
+ */
+int breakpoints_set(breakpoints_t* bp, const int type, const uint32_t addr);
+
+/**
+ * @brief remove a breakpoint of the type
+ */
+void breakpoints_unset(breakpoints_t* bp, const int type, const uint32_t addr);
+
+/**
+ * @brief returns nonzero if a breakpoint of the type is set in the address
+ */
+static inline int breakpoints_test(const breakpoints_t* bp, const int type, const uint32_t addr) {
+    const bpmap_t* m = &bp->map[type];
+    return (addr < m->size) && ((m->map[addr >> 5] >> (addr & 0x1F)) & 1);
+}
+
+#endif  // BREAKPOINTS_H
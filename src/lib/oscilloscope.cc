@@ -25,28 +25,48 @@
 
 #include "oscilloscope.h"
 #include "picsimlab.h"
+#include "profiler.h"
 #include "spareparts.h"
+#include "wave_file.h"
 
 #include <picsim/picsim.h>
 
-COscilloscope Oscilloscope;
+static COscilloscope Oscilloscope_main;
+__thread COscilloscope* Oscilloscope_ctx = &Oscilloscope_main;
 
 COscilloscope::COscilloscope() {
+    Window = NULL;
+    pboard = NULL;
     Dt = 0;
     Rt = 0;
     usetrigger = 1;
     triggerlv = 2.5;
     chpin[0] = 0;
     chpin[1] = 1;
+    chpin[2] = -1;
+    chpin[3] = -1;
     toffset = 250;
     run = 1;
 
-    fp = 0;
+    depth = OSC_DEPTH_DEFAULT;
+    memset(frames, 0, sizeof(frames));
+    back = 0;
+    ready = 1;
+    front = 2;
+    memset(noise, 0, sizeof(noise));
+    memset(pins_, 0, sizeof(pins_));
+    memset(ch_status, 0, sizeof(ch_status));
+
     tch = 0;
-    is = 0;
-    t = 0;
+    wp = 0;
+    ns = 0;
+    len = 0;
+    pre = 0;
+    stride = 1;
+    skip = 1;
+    trp = 0;
+    post = 0;
     tr = 0;
-    update = 0;
 
     measures[0] = 1;
     measures[1] = 2;
@@ -60,65 +80,304 @@ COscilloscope::COscilloscope() {
     tbsingle = NULL;
 }
 
-void COscilloscope::SetSample(void) {
-    double pins[2];
+COscilloscope::~COscilloscope() {
+    for (int f = 0; f < OSC_FRAMES; f++) {
+        for (int c = 0; c < OSC_CHANNELS; c++) {
+            free(frames[f].data[c]);
+            frames[f].data[c] = NULL;
+        }
+    }
+}
 
-    const picpin* ppins = pboard->MGetPinsValues();
+void COscilloscope::SetDepth(unsigned int dp) {
+    if (frames[0].size) {
+        return;  // capture memory already allocated
+    }
+    if (dp < 2 * WMAX) {
+        dp = 2 * WMAX;
+    }
+    if (dp > OSC_DEPTH_MAX) {
+        dp = OSC_DEPTH_MAX;
+    }
+    depth = dp;
+}
+
+// called from simulation thread before the first capture, only the channels in use get a record
+void COscilloscope::AllocFrames(void) {
+    while (1) {
+        int ok = 1;
+        for (int f = 0; f < OSC_FRAMES; f++) {
+            for (int c = 0; c < OSC_CHANNELS; c++) {
+                if (chpin[c] < 0) {
+                    continue;
+                }
+                frames[f].data[c] = (float*)calloc(depth, sizeof(float));
+                if (!frames[f].data[c]) {
+                    ok = 0;
+                }
+            }
+            frames[f].size = depth;
+            frames[f].count = 0;
+        }
+        if (ok || (depth <= OSC_DEPTH_DEFAULT)) {
+            break;
+        }
+        printf("PICSimLab: Oscilloscope can't allocate %u samples, using %u\n", depth, OSC_DEPTH_DEFAULT);
+        for (int f = 0; f < OSC_FRAMES; f++) {
+            for (int c = 0; c < OSC_CHANNELS; c++) {
+                free(frames[f].data[c]);
+                frames[f].data[c] = NULL;
+            }
+        }
+        depth = OSC_DEPTH_DEFAULT;
+    }
+}
+
+// records of the channels enabled after the first capture, the back frame is not shared with the window
+void COscilloscope::AllocChannels(void) {
+    osc_frame_t* fr = &frames[back];
+
+    for (int c = 0; c < OSC_CHANNELS; c++) {
+        if ((chpin[c] >= 0) && (!fr->data[c])) {
+            fr->data[c] = (float*)calloc(fr->size, sizeof(float));
+            if (!fr->data[c]) {
+                printf("PICSimLab: Oscilloscope can't allocate channel %i samples\n", c + 1);
+            }
+        }
+    }
+}
+
+void COscilloscope::StartFrame(void) {
+    // simulation steps of two screen widths, half before and half after trigger
+    double steps = (Dt > 0) ? (2.0 * WMAX * Rt / Dt) : (2.0 * WMAX);
+
+    if (steps < 1.0) {
+        steps = 1.0;
+    }
 
+    stride = ceil(steps / depth);
+    if (stride < 1) {
+        stride = 1;
+    }
+    len = ceil(steps / stride);
+    if (len < 16) {
+        len = 16;
+    }
+    if (len > depth) {
+        len = depth;
+    }
+    pre = len / 2;
+
+    AllocChannels();
+
+    wp = 0;
+    ns = 0;
+    tr = 0;
+    post = 0;
+    skip = stride;
+}
+
+void COscilloscope::PublishFrame(const unsigned int start) {
+    osc_frame_t* fr = &frames[back];
+
+    fr->start = start;
+    fr->count = len;
+    fr->trigger = pre;
+    fr->ds = stride * Dt;
+
+    if (tr && tbsingle->GetCheck()) {
+        tbstop->SetCheck(1);
+    }
+
+    // swap the complete frame with the ready one
+    back = __atomic_exchange_n(&ready, back | OSC_NEW, __ATOMIC_ACQ_REL) & ~OSC_NEW;
+
+    StartFrame();
+}
+
+void COscilloscope::SetSample(void) {
     if ((!run) || (tbsingle == NULL))
         return;
 
-    if ((ppins[chpin[0]].ptype == PT_ANALOG) && (ppins[chpin[0]].dir == PD_IN))
-        pins[0] = ppins[chpin[0]].avalue;
-    else
-        pins[0] = ppins[chpin[0]].value * vmax;
-
-    if ((ppins[chpin[1]].ptype == PT_ANALOG) && (ppins[chpin[1]].dir == PD_IN))
-        pins[1] = ppins[chpin[1]].avalue;
-    else
-        pins[1] = ppins[chpin[1]].value * vmax;
-
-    // sampling
-    if (t > Rt) {
-        t -= Rt;
-        databuffer[fp][0][is] = -pins[0] + ((1.0 * rand() / RAND_MAX) - 0.5) * 0.1;
-        databuffer[fp][1][is] = -pins[1] + ((1.0 * rand() / RAND_MAX) - 0.5) * 0.1;
-        is++;
-        if (is >= NPOINTS)  // buffer full
-        {
-            if (tr && tbsingle->GetCheck()) {
-                tbstop->SetCheck(1);
-            }
-            is = 0;
-            tr = 0;
-            t = 0;
-            ch[0] = &databuffer[fp][0][toffset];
-            ch[1] = &databuffer[fp][1][toffset];
-            fp = !fp;    // togle fp
-            update = 1;  // Request redraw screen
+    // only read pins at sampling steps
+    if (--skip)
+        return;
+
+    PROF_BEGIN();
+
+    if (!frames[0].size) {
+        AllocFrames();
+        StartFrame();
+    }
+    skip = stride;
+
+    const picpin* ppins = pboard->MGetPinsValues();
+    osc_frame_t* fr = &frames[back];
+    double pins[OSC_CHANNELS];
+
+    for (int c = 0; c < OSC_CHANNELS; c++) {
+        const int pin = chpin[c];
+        if ((pin < 0) || (!fr->data[c])) {
+            pins[c] = 0;
+            continue;
         }
+        if ((ppins[pin].ptype == PT_ANALOG) && (ppins[pin].dir == PD_IN))
+            pins[c] = ppins[pin].avalue;
+        else
+            pins[c] = ppins[pin].value * vmax;
+        fr->data[c][wp] = pins[c];
     }
-    t += Dt;
 
     // trigger
-    if (usetrigger) {
-        if ((!tr) && (is >= NPOINTS / 2)) {
-            if ((pins_[tch] < triggerlv) && (pins[tch] >= triggerlv)) {
-                tr = 1;
+    if (usetrigger && (!tr) && (ns >= pre)) {
+        if ((pins_[tch] < triggerlv) && (pins[tch] >= triggerlv)) {
+            tr = 1;
+            trp = wp;
+        }
+    }
 
-                is = is - (NPOINTS / 2);
+    memcpy(pins_, pins, sizeof(pins));
 
-                for (int i = 0; i < NPOINTS / 2; i++) {
-                    databuffer[fp][0][i] = databuffer[fp][0][i + is];
-                    databuffer[fp][1][i] = databuffer[fp][1][i + is];
-                }
-                is = (NPOINTS / 2);
+    wp++;
+    if (wp >= fr->size) {
+        wp = 0;
+    }
+    ns++;
+
+    if (tr) {
+        post++;
+        if (post >= (len - pre)) {
+            PublishFrame((trp + fr->size - pre) % fr->size);
+        }
+    } else if (ns >= len) {  // no trigger, buffer full
+        PublishFrame((wp + fr->size - len) % fr->size);
+    }
+
+    PROF_END(PROF_OSCOPE);
+}
+
+int COscilloscope::FetchFrame(void) {
+    if (!(__atomic_load_n(&ready, __ATOMIC_ACQUIRE) & OSC_NEW)) {
+        return 0;
+    }
+
+    front = __atomic_exchange_n(&ready, front, __ATOMIC_ACQ_REL) & ~OSC_NEW;
+
+    for (int i = 0; i < WMAX; i++) {
+        noise[i] = ((1.0 * rand() / RAND_MAX) - 0.5) * 0.1;
+    }
+    return 1;
+}
+
+// sample position of the first screen column and samples per column
+int COscilloscope::GetSpan(const int columns, double* first, double* spc) {
+    const osc_frame_t* fr = &frames[front];
+
+    if ((!fr->count) || (fr->ds <= 0)) {
+        return 0;
+    }
+
+    *spc = Rt / fr->ds;
+    *first = fr->trigger - (columns - toffset) * (*spc);
+    return 1;
+}
+
+int COscilloscope::GetColumns(const int channel, float* cmin, float* cmax, const int columns) {
+    const osc_frame_t* fr = &frames[front];
+    double first, spc;
+
+    if ((channel < 0) || (channel >= OSC_CHANNELS)) {
+        return 0;
+    }
+
+    const float* data = fr->data[channel];
+
+    if ((!data) || (!GetSpan(columns, &first, &spc))) {
+        return 0;
+    }
+
+    for (int c = 0; c < columns; c++) {
+        const double a = first + c * spc;
+        // the sample held at column start links the column with the previous one
+        long s = ceil(a) - 1;
+        long e = ceil(a + spc) - 1;
+
+        if (e < s)
+            e = s;
+        if (s < 0)
+            s = 0;
+        if (e >= (long)fr->count)
+            e = fr->count - 1;
+
+        if (s > e) {
+            cmin[c] = NAN;
+            cmax[c] = NAN;
+            continue;
+        }
+
+        unsigned int p = (fr->start + s) % fr->size;
+        float lo = data[p];
+        float hi = lo;
+        for (long n = s + 1; n <= e; n++) {
+            p++;
+            if (p >= fr->size) {
+                p = 0;
             }
+            if (data[p] < lo)
+                lo = data[p];
+            if (data[p] > hi)
+                hi = data[p];
         }
+        cmin[c] = lo + noise[c % WMAX];
+        cmax[c] = hi + noise[c % WMAX];
     }
+    return 1;
+}
+
+int COscilloscope::SaveFrame(const char* fname) {
+    const osc_frame_t* fr = &frames[front];
+    int signals[OSC_CHANNELS];
 
-    pins_[0] = pins[0];
-    pins_[1] = pins[1];
+    if (!fr->count) {
+        return -1;
+    }
+
+    wave_writer_t* ww = (wave_writer_t*)malloc(sizeof(wave_writer_t));
+    if (!ww) {
+        return -1;
+    }
+
+    if (wave_writer_open(ww, fname, fr->ds * 1e12)) {
+        free(ww);
+        return -1;
+    }
+
+    // only the channels in use
+    for (int ch = 0; ch < OSC_CHANNELS; ch++) {
+        signals[ch] = -1;
+        if ((chpin[ch] >= 0) && fr->data[ch]) {
+            char name[10];
+            snprintf(name, 10, "CH%i", ch + 1);
+            signals[ch] = wave_writer_add_signal(ww, name, WAVE_REAL);
+        }
+    }
+
+    unsigned int p = fr->start % fr->size;
+    for (unsigned int s = 0; s < fr->count; s++) {
+        for (int ch = 0; ch < OSC_CHANNELS; ch++) {
+            if (signals[ch] >= 0) {
+                wave_writer_real(ww, s, signals[ch], fr->data[ch][p]);
+            }
+        }
+        p++;
+        if (p >= fr->size) {
+            p = 0;
+        }
+    }
+
+    wave_writer_close(ww);
+    free(ww);
+    return 0;
 }
 
 void COscilloscope::NextMeasure(int mn) {
@@ -137,22 +396,48 @@ void COscilloscope::SetMeasure(int nm, int value) {
 }
 
 void COscilloscope::CalculateStats(int channel) {
+    const osc_frame_t* fr = &frames[front];
+    const float* data = fr->data[channel];
+    double first, spc;
+
+    if (!GetSpan(WMAX, &first, &spc)) {
+        return;
+    }
+
+    // samples of the displayed window
+    long s = ceil(first);
+    long e = ceil(first + WMAX * spc);
+    if (s < 0)
+        s = 0;
+    if (e > (long)fr->count)
+        e = fr->count;
+    const long count = e - s;
+
+    if (count < 3) {
+        return;
+    }
+
     ch_status[channel].Vmax = -1000;
     ch_status[channel].Vmin = 1000;
     double sumSamples = 0;
     double sumSquares = 0;
-    double val = -ch[channel][0];
-    int i = 1;
+    unsigned int p = (fr->start + s) % fr->size;
+    double val = data[p];
+    long i = 1;
     bool ltr_down = (val < ch_status[channel].Vavr);  // last transition down
     bool firstUp = true;
-    unsigned short ltrsHigh = 0;    // last transition sample high number
-    unsigned short sumFCW = 0;      // Full cycle width sum
-    unsigned short sumPCW = 0;      // Positive semi-cycle width sum
-    unsigned short numFCycles = 0;  // Number of full cycles
-    unsigned short numPCycles = 0;  // Number of positive semi-cycles
-
-    for (i = 1; i < (NPOINTS / 2) - 1; i++) {
-        val = -ch[channel][i];
+    unsigned int ltrsHigh = 0;    // last transition sample high number
+    unsigned int sumFCW = 0;      // Full cycle width sum
+    unsigned int sumPCW = 0;      // Positive semi-cycle width sum
+    unsigned int numFCycles = 0;  // Number of full cycles
+    unsigned int numPCycles = 0;  // Number of positive semi-cycles
+
+    for (i = 1; i < count - 1; i++) {
+        p++;
+        if (p >= fr->size) {
+            p = 0;
+        }
+        val = data[p];
 
         if (ch_status[channel].Vmax < val)
             ch_status[channel].Vmax = val;
@@ -182,11 +467,11 @@ void COscilloscope::CalculateStats(int channel) {
         }
     }
 
-    ch_status[channel].Vavr = sumSamples / (NPOINTS / 2);  // Voltage average
-    ch_status[channel].Vrms = sqrt(sumSquares / (NPOINTS / 2));
+    ch_status[channel].Vavr = sumSamples / (count - 2);  // Voltage average
+    ch_status[channel].Vrms = sqrt(sumSquares / (count - 2));
 
-    double avgFCycleWidth = sumFCW * Rt / numFCycles;
-    double avgPCycleWidth = sumPCW * Rt / numPCycles;
+    double avgFCycleWidth = sumFCW * fr->ds / numFCycles;
+    double avgPCycleWidth = sumPCW * fr->ds / numPCycles;
 
     int pulseValid = (numFCycles > 0) && (avgFCycleWidth != 0) && (avgPCycleWidth != 0) &&
                      ((ch_status[channel].Vmax - ch_status[channel].Vmin) > 0.2);
@@ -250,6 +535,10 @@ void COscilloscope::WritePreferences(void) {
     PICSimLab.SavePrefs(lxT("osc_inv2"), itoa(((CToggleButton*)Window->GetChildByName("togglebutton4"))->GetCheck()));
     PICSimLab.SavePrefs(lxT("osc_ch2"), ((CCombo*)Window->GetChildByName("combo3"))->GetText());
 
+    // channels 3 and 4 have no window controls, only the pin
+    PICSimLab.SavePrefs(lxT("osc_ch3"), itoa(chpin[2] + 1));
+    PICSimLab.SavePrefs(lxT("osc_ch4"), itoa(chpin[3] + 1));
+
     PICSimLab.SavePrefs(lxT("osc_tscale"), ftoa(((CSpind*)Window->GetChildByName("spind5"))->GetValue()));
     PICSimLab.SavePrefs(lxT("osc_toffset"), ftoa(((CSpind*)Window->GetChildByName("spind6"))->GetValue()));
     PICSimLab.SavePrefs(lxT("osc_usetrigger"),
@@ -261,6 +550,7 @@ void COscilloscope::WritePreferences(void) {
     PICSimLab.SavePrefs(lxT("osc_measures"), itoa(GetMeasures(0)) + lxT(",") + itoa(GetMeasures(1)) + lxT(",") +
                                                  itoa(GetMeasures(2)) + lxT(",") + itoa(GetMeasures(3)) + lxT(",") +
                                                  itoa(GetMeasures(4)));
+    PICSimLab.SavePrefs(lxT("osc_depth"), itoa(GetDepth()));
 }
 
 void COscilloscope::ReadPreferences(char* name, char* value) {
@@ -318,6 +608,14 @@ void COscilloscope::ReadPreferences(char* name, char* value) {
         SetChannelPin(1, atoi(((CCombo*)Window->GetChildByName("combo3"))->GetText()) - 1);
     }
 
+    if (!strcmp(name, "osc_ch3")) {
+        SetChannelPin(2, atoi(value) - 1);
+    }
+
+    if (!strcmp(name, "osc_ch4")) {
+        SetChannelPin(3, atoi(value) - 1);
+    }
+
     if (!strcmp(name, "osc_tscale")) {
         ((CSpind*)Window->GetChildByName("spind5"))->SetValue(atof(value));
     }
@@ -353,6 +651,10 @@ void COscilloscope::ReadPreferences(char* name, char* value) {
             SetMeasure(i, measures[i]);
         }
     }
+
+    if (!strcmp(name, "osc_depth")) {
+        SetDepth(atoi(value));
+    }
 }
 
 lxStringList COscilloscope::WritePreferencesList(void) {
@@ -409,6 +711,10 @@ lxStringList COscilloscope::WritePreferencesList(void) {
     line += ((CCombo*)Window->GetChildByName("combo3"))->GetText();
     list.AddLine(line);
 
+    // osc_ch3 and osc_ch4 pins
+    list.AddLine("osc_ch3,0,0,0:" + itoa(chpin[2] + 1));
+    list.AddLine("osc_ch4,0,0,0:" + itoa(chpin[3] + 1));
+
     return list;
 }
 
@@ -31,10 +31,28 @@
 #define WMAX 350
 #define HMAX 250
 
-#define NPOINTS (2 * WMAX)
-
 #define MAX_MEASURES 10
 
+#define OSC_CHANNELS 4                     ///< number of capture channels
+#define OSC_DEPTH_DEFAULT (64 * 1024)      ///< default capture memory depth in samples per channel
+#define OSC_DEPTH_MAX (4 * 1024 * 1024)    ///< max capture memory depth in samples per channel
+#define OSC_FRAMES 3                       ///< capture frames: one being written, one ready, one displayed
+#define OSC_NEW 0x100                      ///< ready frame not yet fetched flag
+
+/**
+ * @brief oscilloscope capture frame
+ *
+ * Samples are stored in a circular record, the frame starts at sample start and the trigger is at start + trigger.
+ */
+typedef struct {
+    float* data[OSC_CHANNELS];  ///< sample record of each channel
+    unsigned int size;          ///< record size (capture depth)
+    unsigned int start;         ///< first sample of the frame
+    unsigned int count;         ///< number of samples in the frame
+    unsigned int trigger;       ///< trigger sample, relative to start
+    double ds;                  ///< time between samples
+} osc_frame_t;
+
 typedef struct {
     double Vrms;
     double Vavr;
@@ -49,6 +67,7 @@ typedef struct {
 class COscilloscope {
 public:
     COscilloscope();
+    ~COscilloscope();
 
     void Init(CWindow* win);
 
@@ -71,17 +90,41 @@ public:
     int GetTriggerChannel(void) { return tch; };
     void SetTriggerChannel(int tc) { tch = tc; };
 
-    double* GetChannel(int cn) { return ch[cn]; };
+    /**
+     * @brief  Fetch the last captured frame for display, returns 1 if there is a new frame
+     */
+    int FetchFrame(void);
+
+    /**
+     * @brief  Min/max decimation of the displayed window of the fetched frame to one value pair per screen column,
+     * columns without samples are set to NAN. Returns 0 if there is no frame to show.
+     */
+    int GetColumns(const int channel, float* cmin, float* cmax, const int columns);
+
+    /**
+     * @brief  Save all samples of the fetched frame in a PICSimLab waveform file, returns 0 on success
+     */
+    int SaveFrame(const char* fname);
 
     void CalculateStats(int channel);
     void ClearStats(int channel);
 
     ch_status_t GetChannelStatus(int cn) { return ch_status[cn]; };
 
-    int GetUpdate(void) { return update; };
-    void SetUpdate(int up) { update = up; };
+    /**
+     * @brief  Set the board pin (from 0) captured by the channel, -1 to disable it
+     */
+    void SetChannelPin(int ch, int pin) {
+        if ((ch >= 0) && (ch < OSC_CHANNELS))
+            chpin[ch] = pin;
+    };
+    int GetChannelPin(int ch) { return ((ch >= 0) && (ch < OSC_CHANNELS)) ? chpin[ch] : -1; };
 
-    void SetChannelPin(int ch, int pin) { chpin[ch] = pin; };
+    /**
+     * @brief  Set the capture memory depth in samples per channel, only applied before the first capture
+     */
+    void SetDepth(unsigned int dp);
+    unsigned int GetDepth(void) { return depth; };
 
     int GetTimeOffset(void) { return toffset; };
     void SetTimeOffset(int to) { toffset = to; };
@@ -112,6 +155,12 @@ public:
     void ReadPreferencesList(lxStringList pl);
 
 private:
+    void AllocFrames(void);
+    void AllocChannels(void);
+    void StartFrame(void);
+    void PublishFrame(const unsigned int start);
+    int GetSpan(const int columns, double* first, double* spc);
+
     CWindow* Window;
     board* pboard;
     double Dt;  // Delta T
@@ -120,17 +169,25 @@ private:
     double triggerlv;
     int tch;  // trigger channel
     int toffset;
-    int chpin[2];
-    double databuffer[2][2][NPOINTS];  // flip buffers + 2 channels + 700 points
-    int fp;                            // actual flip buffer
-    double* ch[2];                     // actual channel data (pointer to databuffer)
-    ch_status_t ch_status[2];          // channel measurament status
-    double pins_[2];                   // last value of input pins
-    int is;                            // input samples
-    double t;                          // time
+    int chpin[OSC_CHANNELS];
+    unsigned int depth;                // capture memory depth
+    osc_frame_t frames[OSC_FRAMES];    // capture frames
+    int back;                          // frame written by the simulation thread
+    int ready;                         // last complete frame, handoff between threads
+    int front;                         // frame shown by the oscilloscope window
+    ch_status_t ch_status[OSC_CHANNELS];  // channel measurament status
+    float noise[WMAX];                 // display noise, generated once per frame
+    double pins_[OSC_CHANNELS];        // last value of input pins
+    unsigned int wp;                   // write position in the back frame
+    unsigned int ns;                   // samples written in the back frame
+    unsigned int len;                  // back frame length
+    unsigned int pre;                  // back frame samples before trigger
+    unsigned int stride;               // back frame simulation steps per sample
+    unsigned int skip;                 // steps to next sample
+    unsigned int trp;                  // trigger position in the back frame
+    unsigned int post;                 // samples after trigger
     int tr;                            // trigger
     int run;
-    int update;
     int measures[5];
     float vmax;
 
@@ -138,6 +195,8 @@ private:
     CToggleButton* tbsingle;
 };
 
-extern COscilloscope Oscilloscope;
+// Oscilloscope object of the simulation context of the calling thread, see simcontext.h
+extern __thread COscilloscope* Oscilloscope_ctx;
+#define Oscilloscope (*Oscilloscope_ctx)
 
 #endif  // OSCILLOSCOPE
\ No newline at end of file
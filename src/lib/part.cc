@@ -574,6 +574,75 @@ unsigned char part::GetPWCComboSelectedPin(CPWindow* WProp, const char* combo_na
     return selectedpin;
 }
 
+// pins list as text "1,3,5-9", unconnected pins (0) are skipped
+void part::SetPCWEditWithPinList(CPWindow* WProp, const char* edit_name, const unsigned char* pins, const int count) {
+    char text[512];
+    int len = 0;
+
+    text[0] = 0;
+    for (int i = 0; i < count; i++) {
+        if (!pins[i]) {
+            continue;
+        }
+        int j = i;
+        while (((j + 1) < count) && (pins[j + 1] == pins[j] + 1)) {
+            j++;
+        }
+        if (j > i + 1) {
+            len += snprintf(text + len, 511 - len, "%s%i-%i", len ? "," : "", pins[i], pins[j]);
+            i = j;
+        } else {
+            len += snprintf(text + len, 511 - len, "%s%i", len ? "," : "", pins[i]);
+        }
+        if (len >= 511) {
+            break;
+        }
+    }
+
+    CEdit* edit = (CEdit*)WProp->GetChildByName(edit_name);
+    if (edit) {
+        edit->SetText(text);
+    } else {
+        printf("PICSimLab: Edit (%s) not found in Part Configuration Window!\n", edit_name);
+    }
+}
+
+// returns the number of pins read from a "1,3,5-9" list, the unused positions are set to 0
+int part::GetPWCEditPinList(CPWindow* WProp, const char* edit_name, unsigned char* pins, const int max) {
+    int count = 0;
+
+    memset(pins, 0, max);
+
+    CEdit* edit = (CEdit*)WProp->GetChildByName(edit_name);
+    if (!edit) {
+        printf("PICSimLab: Edit (%s) not found in Part Configuration Window!\n", edit_name);
+        return 0;
+    }
+
+    lxString text = edit->GetText();
+    const char* ptr = text.c_str();
+    while (*ptr && (count < max)) {
+        char* end;
+        int first = strtol(ptr, &end, 10);
+        if (end == ptr) {
+            ptr++;  // skip separators
+            continue;
+        }
+        int last = first;
+        ptr = end;
+        if (*ptr == '-') {
+            last = strtol(ptr + 1, &end, 10);
+            ptr = end;
+        }
+        for (int pin = first; (pin <= last) && (count < max); pin++) {
+            if ((pin > 0) && (pin < 256)) {
+                pins[count++] = pin;
+            }
+        }
+    }
+    return count;
+}
+
 lxString part::GetName(void) {
     return Name;
 }
@@ -83,6 +83,12 @@ public:
      */
     virtual void Process(void){};
 
+    /**
+     * @brief  Fill wpins with the pins that need a Process call when changed and return the count.
+     * The default -1 calls Process on any IO change.
+     */
+    virtual int GetWatchPins(unsigned char* wpins) { return -1; };
+
     /**
      * @brief  Called every end of CPU process
      */
@@ -128,6 +134,11 @@ public:
      */
     virtual void Reset(void){};
 
+    /**
+     * @brief  Save or restore (sn->load) the part state in a simulation snapshot
+     */
+    virtual void Snapshot(snapshot_t* sn){};
+
     /**
      * @brief  Stop part simulation
      */
@@ -407,6 +418,8 @@ protected:
     void SetPCWProperties(const PCWProp* pcwprop);
     void SetPCWComboWithPinNames(CPWindow* WProp, const char* combo_name, const unsigned char pin);
     unsigned char GetPWCComboSelectedPin(CPWindow* WProp, const char* combo_name);
+    void SetPCWEditWithPinList(CPWindow* WProp, const char* edit_name, const unsigned char* pins, const int count);
+    int GetPWCEditPinList(CPWindow* WProp, const char* edit_name, unsigned char* pins, const int max);
 
 private:
     const PCWProp* PCWProperties;
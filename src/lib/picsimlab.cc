@@ -31,14 +31,20 @@
 #include <emscripten.h>
 #endif
 
+#include "pinshm.h"
+#include "profiler.h"
 #include "rcontrol.h"
 
+#include <sys/time.h>
+#include <unistd.h>
+
 #ifdef _USE_PICSTARTP_
 extern char PROGDEVICE[100];
 #endif
 char SERIALDEVICE[100];
 
-CPICSimLab PICSimLab;
+static CPICSimLab PICSimLab_main;
+__thread CPICSimLab* PICSimLab_ctx = &PICSimLab_main;
 
 CPICSimLab::CPICSimLab() {
     JUMPSTEPS = DEFAULTJS;
@@ -46,6 +52,7 @@ CPICSimLab::CPICSimLab() {
     NSTEPJ = NSTEP / JUMPSTEPS;
     pboard = NULL;
     Window = NULL;
+    statusbar = NULL;
     mcurun = 1;
     mcupwr = 1;
     mcurst = 0;
@@ -58,6 +65,7 @@ CPICSimLab::CPICSimLab() {
     OldPath = "";
     PATH = "";
     Instance = 0;
+    Context = 0;
     debug_type = 0;
     debug = 0;
     Errors.Clear();
@@ -73,9 +81,14 @@ CPICSimLab::CPICSimLab() {
     plHeight = 10;
     need_clkupdate = 0;
     use_dsr_reset = 1;
+    use_uart_fast = 1;
     settodestroy = 0;
     sync = 0;
     SHARE = "";
+    batch = 0;
+    batch_exit = -1;
+    batch_errors = 0;
+    snapshot_init(&snapshot);
 
 #ifndef _NOTHREAD
     cpu_mutex = NULL;
@@ -192,7 +205,9 @@ void CPICSimLab::StartRControl(void) {
             exit(-1);
         }
     }
+    pinshm_init(GetRemotecPort());
 #endif
+    prof_reset();
 }
 
 void CPICSimLab::Set_mcudbg(int pd) {
@@ -219,6 +234,7 @@ void CPICSimLab::SetRemotecPort(unsigned short rcp) {
 #ifndef __EMSCRIPTEN__
     rcontrol_end();
     rcontrol_init(remotec_port);
+    pinshm_init(GetRemotecPort());
 #endif
 }
 
@@ -297,6 +313,7 @@ void CPICSimLab::SetNeedReboot(int nr) {
 
 void CPICSimLab::RegisterError(const lxString error) {
     Errors.AddLine(error);
+    batch_errors++;
 }
 
 void CPICSimLab::EndSimulation(int saveold, const char* newpath) {
@@ -368,6 +385,7 @@ void CPICSimLab::EndSimulation(int saveold, const char* newpath) {
     }
     SavePrefs(lxT("picsimlab_scale"), ftoa(scale));
     SavePrefs(lxT("picsimlab_dsr_reset"), itoa(GetUseDSRReset()));
+    SavePrefs(lxT("picsimlab_uart_fast"), itoa(GetUARTFastPath()));
     SavePrefs(lxT("osc_on"), itoa(pboard->GetUseOscilloscope()));
     SavePrefs(lxT("spare_on"), itoa(pboard->GetUseSpareParts()));
 #ifndef _WIN_
@@ -448,6 +466,7 @@ void CPICSimLab::EndSimulation(int saveold, const char* newpath) {
         char cmd[1024];
         printf("PICSimLab: Reboot !!!\n");
         rcontrol_server_end();
+        pinshm_end();
         pboard->EndServers();
         DeleteBoard();
         strcpy(cmd, lxGetExecutablePath().c_str());
@@ -514,17 +533,20 @@ void CPICSimLab::LoadWorkspace(lxString fnpzw, const int show_readme) {
         return;
     }
     // write options
-    strncpy(fzip, (char*)lxGetTempDir(lxT("picsimlab")).char_str(), 1023);
-    strncat(fzip, "/", 1023);
+    strncpy(fzip, (char*)GetWorkspaceTempDir().char_str(), 1023);
 
-    strncpy(home, (char*)lxGetTempDir(lxT("picsimlab")).char_str(), 1023);
-    strncat(home, "/picsimlab_workspace/", 1023);
+    strncpy(home, fzip, 1023);
+    strncat(home, "picsimlab_workspace/", 1023);
 
     lxRemoveDir(home);
+    lxCreateDir(fzip);
 
     lxUnzipDir(fnpzw, fzip);
 
-    EndSimulation(0, fnpzw.c_str());
+    // a batch context loads only one workspace and has no windows or preferences to save
+    if (!Context) {
+        EndSimulation(0, fnpzw.c_str());
+    }
 
     SetWorkspaceFileName(fnpzw);
 
@@ -722,6 +744,14 @@ void CPICSimLab::LoadWorkspace(lxString fnpzw, const int show_readme) {
 #endif  // CONVERTER_MODE
 }
 
+lxString CPICSimLab::GetWorkspaceTempDir(void) {
+    if (Context) {
+        // batch contexts of all running instances unzip in parallel
+        return lxGetTempDir(lxT("picsimlab")) + lxString().Format("/picsimlab_ctx%i_%i/", getpid(), Context);
+    }
+    return lxGetTempDir(lxT("picsimlab")) + lxT("/");
+}
+
 void CPICSimLab::SaveWorkspace(lxString fnpzw) {
     char home[1024];
     char fname[1280];
@@ -741,8 +771,8 @@ void CPICSimLab::SaveWorkspace(lxString fnpzw) {
     snprintf(fname, 1279, "%s/picsimlab.ini", home);
     PrefsSaveToFile(fname);
 
-    strncpy(home, (char*)lxGetTempDir(lxT("picsimlab")).char_str(), 1023);
-    strncat(home, "/picsimlab_workspace/", 1023);
+    strncpy(home, (char*)GetWorkspaceTempDir().char_str(), 1023);
+    strncat(home, "picsimlab_workspace/", 1023);
 
 #ifdef CONVERTER_MODE
     snprintf(fname, 1279, "rm -rf %s/*.ini", home);
@@ -842,6 +872,46 @@ int CPICSimLab::GetSimulationRun(void) {
     return (status.st[0] & ST_DI) == 0;
 }
 
+int CPICSimLab::Snapshot(const int load, const char* fname) {
+    int ret;
+
+    if (!pboard) {
+        snapshot_set_error(&snapshot, "no board loaded");
+        return -1;
+    }
+
+    const int run = GetSimulationRun();
+    SetSimulationRun(0);
+    // wait the cpu thread finish the current frame
+    for (int i = 0; (status.st[1] & ST_TH) && (i < 1000); i++) {
+        msleep(1);
+    }
+
+    if (load) {
+        ret = fname ? snapshot_load_file(&snapshot, fname) : 0;
+        if (!ret) {
+            if (!snapshot.size) {
+                snapshot_set_error(&snapshot, "no snapshot saved");
+                ret = -1;
+            } else {
+                ret = pboard->SnapshotLoad(&snapshot);
+            }
+        }
+    } else {
+        ret = pboard->SnapshotSave(&snapshot);
+        if ((!ret) && fname) {
+            ret = snapshot_save_file(&snapshot, fname);
+        }
+    }
+
+    if (ret) {
+        printf("PICSimLab: Snapshot %s error: %s\n", load ? "load" : "save", snapshot.msg);
+    }
+
+    SetSimulationRun(run);
+    return ret;
+}
+
 void CPICSimLab::Configure(const char* home, int use_default_board, int create, const char* lfile,
                            const int disable_debug) {
     char line[1024];
@@ -861,7 +931,7 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
     lxString status;
 
 #ifndef _NOTHREAD
-    if (cpu_mutex == NULL) {
+    if ((cpu_mutex == NULL) && (!Context)) {
         cpu_mutex = new lxMutex();
         cpu_cond = new lxCondition(*cpu_mutex);
     }
@@ -872,12 +942,14 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
     } else {
         snprintf(fname, 1023, "%s/picsimlab.ini", home);
     }
-    SERIALDEVICE[0] = ' ';
-    SERIALDEVICE[1] = 0;
+    if (!Context) {
+        SERIALDEVICE[0] = ' ';
+        SERIALDEVICE[1] = 0;
 #ifdef _USE_PICSTARTP_
-    PROGDEVICE[0] = ' ';
-    PROGDEVICE[1] = 0;
+        PROGDEVICE[0] = ' ';
+        PROGDEVICE[1] = 0;
 #endif
+    }
     DeleteBoard();
 
     PrefsClear();
@@ -893,14 +965,14 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
                 if ((name == NULL) || (value == NULL))
                     continue;
 #ifndef _WIN_
-                if (!strcmp("picsimlab_lser", name))
+                if ((!Context) && (!strcmp("picsimlab_lser", name)))
                     strcpy(SERIALDEVICE, value);
 #ifdef _USE_PICSTARTP_
                 if (!strcmp("picsimlab_lprog", name))
                     strcpy(PROGDEVICE, value);
 #endif
 #else
-                if (!strcmp("picsimlab_wser", name))
+                if ((!Context) && (!strcmp("picsimlab_wser", name)))
                     strcpy(SERIALDEVICE, value);
 #ifdef _USE_PICSTARTP_
                 if (!strcmp("picsimlab_wprog", name))
@@ -989,6 +1061,10 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
                     sscanf(value, "%i", &use_dsr_reset);
                 }
 
+                if (!strcmp(name, "picsimlab_uart_fast")) {
+                    sscanf(value, "%i", &use_uart_fast);
+                }
+
                 if (!strcmp(name, "picsimlab_lpath")) {
                     SetPath(lxString(value, lxConvUTF8));
                 }
@@ -1026,17 +1102,19 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
         SetJUMPSTEPS(DEFAULTJS);
         SetClock(pboard->GetDefaultClock());
 
+        if (!Context) {
 #ifndef _WIN_
-        strcpy(SERIALDEVICE, "/dev/tnt2");
+            strcpy(SERIALDEVICE, "/dev/tnt2");
 #ifdef _USE_PICSTARTP_
-        strcpy(PROGDEVICE, "/dev/tnt4");
+            strcpy(PROGDEVICE, "/dev/tnt4");
 #endif
 #else
-        strcpy(SERIALDEVICE, "com6");
+            strcpy(SERIALDEVICE, "com6");
 #ifdef _USE_PICSTARTP_
-        strcpy(PROGDEVICE, "com8");
+            strcpy(PROGDEVICE, "com8");
 #endif
 #endif
+        }
     }
 
     if (Window) {
@@ -1070,7 +1148,7 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
             ->SetImgFileName(lxGetLocalFile(GetSharePath() + lxT("boards/") + pboard->GetPictureFileName()), GetScale(),
                              GetScale());
     }
-    pboard->MSetSerial(SERIALDEVICE);
+    pboard->MSetSerial(GetSerialDevice());
 
     if (lfile) {
         if (lxFileExists(lfile)) {
@@ -1112,6 +1190,23 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
         }
     }
 
+    if (Context) {
+        // the gpsim, uCsim, QEMU and remote simulators have process wide state
+        switch (pboard->MGetArchitecture()) {
+            case ARCH_P16:
+            case ARCH_P16E:
+            case ARCH_P18:
+            case ARCH_AVR8:
+                break;
+            default:
+                printf("PICSimLab: Board \"%s\" can't run in a batch context!\n", boards_list[lab].name);
+                RegisterError(lxString("Board ") + boards_list[lab].name + " can't run in a batch context!");
+                DeleteBoard();
+                return;
+        }
+        load_demo = 0;
+    }
+
     switch (pboard->MInit(pboard->GetProcessorName(), fname, GetNSTEP() * NSTEPKF)) {
         // case HEX_NFOUND:
         //     break;
@@ -1207,8 +1302,10 @@ void CPICSimLab::Configure(const char* home, int use_default_board, int create,
 #endif
 
 #ifndef __EMSCRIPTEN__
-    printf("PICSimLab: Remote Control Port %i\n", GetRemotecPort());
-    rcontrol_init(GetRemotecPort() + Instance);
+    if (!Context) {
+        printf("PICSimLab: Remote Control Port %i\n", GetRemotecPort());
+        rcontrol_init(GetRemotecPort() + Instance);
+    }
 #endif
 
     if (load_demo) {
@@ -1235,6 +1332,90 @@ void CPICSimLab::SetToDestroy(void) {
     settodestroy = 1;
 }
 
+static double get_wall_time(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+void CPICSimLab::SetBatch(const double time, const unsigned long long insts) {
+    batch = 1;
+    batch_started = 0;
+    batch_stall = 0;
+    batch_exit = BATCH_OK;
+    batch_errors = 0;
+    batch_time = time;
+    batch_insts = insts;
+    batch_simtime = 0;
+    batch_count = 0;
+}
+
+int CPICSimLab::BatchUpdate(void) {
+    if (!batch || !pboard) {
+        return 0;
+    }
+
+    if (!batch_started) {
+        batch_started = 1;
+        batch_lastic = pboard->InstCounterGet();
+        batch_start = get_wall_time();
+        return 1;
+    }
+
+    // simulated time from the instructions executed since the last call (includes the idle steps skipped),
+    // a Run_CPU call with the microcontroller stopped or in reset simulates one TIMER period
+    const uint32_t ic = pboard->InstCounterGet();
+    const uint32_t insts = ic - batch_lastic;
+    const float freq = pboard->MGetInstClockFreq();
+    batch_count += insts;
+    if (insts && (freq > 0)) {
+        batch_simtime += insts / freq;
+    } else {
+        batch_simtime += TIMER;
+    }
+
+    if (ic == batch_lastic) {
+        batch_stall++;
+    } else {
+        batch_stall = 0;
+    }
+    batch_lastic = ic;
+
+    int end = 0;
+    if ((batch_time > 0) && (batch_simtime >= batch_time)) {
+        end = 1;
+    }
+    if (batch_insts && (batch_count >= batch_insts)) {
+        end = 1;
+    }
+    // instructions limit can't be reached with the microcontroller stopped (10s of simulation)
+    if (batch_insts && (batch_stall > 100)) {
+        end = 1;
+        batch_exit = BATCH_STALLED;
+    }
+
+    if (!end) {
+        return 1;
+    }
+
+    const double wall = get_wall_time() - batch_start;
+
+    if (batch_errors) {
+        batch_exit = BATCH_ERROR;
+    } else if ((batch_exit == BATCH_OK) && (cpustate == CPU_ERROR)) {
+        batch_exit = BATCH_CPU_ERROR;
+    }
+
+    printf("PICSimLab: Batch finished: simulated %.3f s, %llu instructions, wall %.3f s, speedup %.2fx, exit code %i\n",
+           batch_simtime, batch_count, wall, (wall > 0) ? batch_simtime / wall : 0.0, batch_exit);
+    fflush(stdout);
+
+    batch = 0;
+    SetSimulationRun(0);
+    SetToDestroy();
+    return 0;
+}
+
 int CPICSimLab::LoadHexFile(lxString fname) {
     int pa;
     int ret = 0;
@@ -1260,7 +1441,7 @@ int CPICSimLab::LoadHexFile(lxString fname) {
     }
 
     GetBoard()->MEnd();
-    GetBoard()->MSetSerial(SERIALDEVICE);
+    GetBoard()->MSetSerial(GetSerialDevice());
 
     switch (GetBoard()->MInit(GetBoard()->GetProcessorName(), fname.char_str(), GetNSTEP() * NSTEPKF)) {
         case HEX_NFOUND:
@@ -40,6 +40,9 @@ extern char SERIALDEVICE[100];
 
 enum { CPU_RUNNING, CPU_STEPPING, CPU_HALTED, CPU_BREAKPOINT, CPU_ERROR, CPU_POWER_OFF };
 
+// batch mode exit codes
+enum { BATCH_OK, BATCH_ERROR, BATCH_CPU_ERROR, BATCH_STALLED };
+
 class CPICSimLab {
 public:
     CPICSimLab();
@@ -158,6 +161,17 @@ public:
      */
     int GetInstanceNumber(void) { return Instance; };
 
+    /**
+     * @brief  Return the simulation context number, 0 for the main context that owns the windows and the servers
+     */
+    int GetContextNumber(void) { return Context; };
+    void SetContextNumber(int cn) { Context = cn; };
+
+    /**
+     * @brief  Return the serial port of the board, batch contexts have no serial port
+     */
+    const char* GetSerialDevice(void) { return Context ? "" : SERIALDEVICE; };
+
     /**
      * @brief  Return the selected debugger type
      */
@@ -223,9 +237,21 @@ public:
     void LoadWorkspace(lxString fnpzw, const int show_readme = 1);
     void SaveWorkspace(lxString fnpzw);
 
+    /**
+     * @brief  Return the temporary directory where the workspace files are unzipped
+     */
+    lxString GetWorkspaceTempDir(void);
+
     void SetSimulationRun(int run);
     int GetSimulationRun(void);
 
+    /**
+     * @brief Save (load = 0) or restore (load = 1) the simulation state in memory or, if fname is not NULL, in a file.
+     * The simulation is paused during the operation. Returns 0 on success, the error message is in GetSnapshotError
+     */
+    int Snapshot(const int load, const char* fname = NULL);
+    const char* GetSnapshotError(void) { return snapshot.msg; };
+
     double GetScale(void) { return scale; };
     void SetScale(double s) { scale = s; };
 
@@ -245,12 +271,39 @@ public:
     int GetUseDSRReset(void) { return use_dsr_reset; };
     void SetUseDSRReset(int udsr) { use_dsr_reset = udsr; };
 
+    /**
+     * @brief  Return if parts wired to a microcontroller hardware UART exchange whole bytes instead of pin bits
+     */
+    int GetUARTFastPath(void) { return use_uart_fast; };
+    void SetUARTFastPath(int ufast) { use_uart_fast = ufast; };
+
     void SetToDestroy(void);
     int GetToDestroy(void) { return settodestroy; };
 
     void SetSync(unsigned char s) { sync = s; };
     unsigned char GetSync(void) { return sync; };
 
+    /**
+     * @brief  Enable batch mode: run without wall-clock pacing until the simulated time (s) or the instructions limit
+     */
+    void SetBatch(const double time, const unsigned long long insts);
+
+    /**
+     * @brief  Return if batch mode is running
+     */
+    int GetBatch(void) { return batch; };
+
+    /**
+     * @brief  Update batch counters, return 0 when the limit is reached
+     */
+    int BatchUpdate(void);
+
+    /**
+     * @brief  Return the batch mode exit code or -1 if batch mode is not used
+     */
+    int GetBatchExitCode(void) { return batch_exit; };
+    void SetBatchExitCode(int be) { batch_exit = be; };
+
 #ifndef _NOTHREAD
     lxCondition* cpu_cond;
     lxMutex* cpu_mutex;
@@ -265,6 +318,7 @@ public:
     int plWidth;
     int plHeight;
     int use_dsr_reset;
+    int use_uart_fast;
 
     CItemMenu MBoard[BOARDS_MAX];
     CItemMenu MMicro[MAX_MIC];
@@ -301,6 +355,7 @@ private:
     lxString proc_;
     lxString pzw_ver;
     int Instance;
+    int Context;
     int debug_type;
     int debug;
     int need_resize;
@@ -313,9 +368,23 @@ private:
     double idle_ms;
     int settodestroy;
     unsigned char sync;
+    int batch;
+    int batch_started;
+    int batch_stall;
+    int batch_exit;
+    unsigned int batch_errors;
+    uint32_t batch_lastic;
+    double batch_time;
+    double batch_simtime;
+    double batch_start;
+    unsigned long long batch_insts;
+    unsigned long long batch_count;
+    snapshot_t snapshot;
 };
 
-extern CPICSimLab PICSimLab;
+// PICSimLab object of the simulation context of the calling thread, see simcontext.h
+extern __thread CPICSimLab* PICSimLab_ctx;
+#define PICSimLab (*PICSimLab_ctx)
 
 #ifdef _WIN_
 #define msleep(x) Sleep(x)
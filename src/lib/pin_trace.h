@@ -0,0 +1,74 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef PIN_TRACE_H
+#define PIN_TRACE_H
+
+#include <stdint.h>
+
+#define PIN_TRACE_SIZE 4096  // power of 2
+
+typedef struct {
+    uint32_t ic;          ///< instruction counter of the step that changed the pin
+    unsigned char pin;    ///< pin number (1 based)
+    unsigned char state;  ///< bit 0 value, bit 1 direction is input
+} pin_trace_rec_t;
+
+/**
+ * @brief pin changes recorded by the simulation thread, single producer single consumer lock free ring
+ */
+typedef struct {
+    pin_trace_rec_t data[PIN_TRACE_SIZE];
+    uint32_t head;            ///< written only by the producer
+    uint32_t tail;            ///< written only by the consumer
+    uint32_t lost;            ///< changes dropped with the ring full, written only by the producer
+    uint32_t resync;          ///< set by the consumer, the producer records the state of all pins on next update
+    unsigned char last[256];  ///< last recorded state of each pin, used only by the producer
+} pin_trace_t;
+
+static inline void pin_trace_put(pin_trace_t* t, const uint32_t ic, const unsigned char pin, const unsigned char state) {
+    const uint32_t head = t->head;
+    if ((head - __atomic_load_n(&t->tail, __ATOMIC_ACQUIRE)) >= PIN_TRACE_SIZE) {
+        __atomic_store_n(&t->lost, t->lost + 1, __ATOMIC_RELAXED);
+        return;
+    }
+    pin_trace_rec_t* rec = &t->data[head & (PIN_TRACE_SIZE - 1)];
+    rec->ic = ic;
+    rec->pin = pin;
+    rec->state = state;
+    __atomic_store_n(&t->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static inline int pin_trace_get(pin_trace_t* t, pin_trace_rec_t* rec) {
+    const uint32_t tail = t->tail;
+    if (__atomic_load_n(&t->head, __ATOMIC_ACQUIRE) == tail) {
+        return 0;
+    }
+    *rec = t->data[tail & (PIN_TRACE_SIZE - 1)];
+    __atomic_store_n(&t->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+#endif  // PIN_TRACE_H
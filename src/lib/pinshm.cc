@@ -0,0 +1,158 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#if !defined(_WIN_) && !defined(__EMSCRIPTEN__)
+#define _PINSHM_
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "pinshm.h"
+
+static pinshm_t* shm = NULL;
+static char shm_name[64];
+
+static char pintypetoletter(unsigned char type) {
+    switch (type) {
+        case PT_POWER:
+            return 'P';
+        case PT_DIGITAL:
+            return 'D';
+        case PT_ANALOG:
+            return 'A';
+        case PT_ANAREF:
+            return 'R';
+        case PT_USART:
+            return 'U';
+        case PT_NC:
+            return '-';
+    }
+    return '?';
+}
+
+int pinshm_init(const unsigned short port) {
+    pinshm_end();
+#ifdef _PINSHM_
+    snprintf(shm_name, 63, PINSHM_NAME, port);
+
+    int fd = shm_open(shm_name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        printf("PICSimLab: pins shared memory %s error : %s \n", shm_name, strerror(errno));
+        return 1;
+    }
+
+    if (ftruncate(fd, sizeof(pinshm_t))) {
+        printf("PICSimLab: pins shared memory %s error : %s \n", shm_name, strerror(errno));
+        close(fd);
+        shm_unlink(shm_name);
+        return 1;
+    }
+
+    void* ptr = mmap(NULL, sizeof(pinshm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        printf("PICSimLab: pins shared memory %s error : %s \n", shm_name, strerror(errno));
+        shm_unlink(shm_name);
+        return 1;
+    }
+
+    shm = (pinshm_t*)ptr;
+    memset(shm, 0, sizeof(pinshm_t));
+    shm->version = PINSHM_VERSION;
+    __atomic_store_n(&shm->magic, PINSHM_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+#else
+    return 1;
+#endif
+}
+
+void pinshm_publish(board* pboard, const int cpustate) {
+    static char names[PINSHM_MAX_PINS][12];
+    static char bname[32];
+    static char pname[32];
+    static board* lboard = NULL;
+
+    if (!shm || !pboard) {
+        return;
+    }
+
+    const picpin* pins = pboard->MGetPinsValues();
+    unsigned int count = pboard->MGetPinCount();
+    if (count > PINSHM_MAX_PINS) {
+        count = PINSHM_MAX_PINS;
+    }
+
+    // pin names change only with board or configuration, refresh them once in 10 updates
+    if ((pboard != lboard) || (count != shm->pincount) || !(shm->update % 10)) {
+        lboard = pboard;
+        for (unsigned int i = 0; i < count; i++) {
+            strncpy(names[i], pboard->MGetPinName(i + 1).c_str(), 11);
+            names[i][11] = 0;
+        }
+        strncpy(bname, pboard->GetName().c_str(), 31);
+        bname[31] = 0;
+        strncpy(pname, pboard->GetProcessorName().c_str(), 31);
+        pname[31] = 0;
+    }
+
+    // seqlock write: odd seq while updating
+    __atomic_store_n(&shm->seq, shm->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    shm->update++;
+    shm->instcounter = pboard->InstCounterGet();
+    shm->cpustate = cpustate;
+    shm->pincount = count;
+    memcpy(shm->board, bname, 32);
+    memcpy(shm->processor, pname, 32);
+    for (unsigned int i = 0; i < count; i++) {
+        pinshm_pin_t* pin = &shm->pins[i];
+        pin->type = pintypetoletter(pins[i].ptype);
+        pin->dir = (pins[i].dir == PD_IN) ? 'I' : 'O';
+        pin->value = pins[i].value;
+        pin->mean = pins[i].oavalue - 55;
+        pin->avalue = pins[i].avalue;
+        memcpy(pin->name, names[i], 12);
+    }
+
+    __atomic_store_n(&shm->seq, shm->seq + 1, __ATOMIC_RELEASE);
+}
+
+void pinshm_end(void) {
+#ifdef _PINSHM_
+    if (shm) {
+        __atomic_store_n(&shm->magic, 0, __ATOMIC_RELEASE);
+        munmap(shm, sizeof(pinshm_t));
+        shm_unlink(shm_name);
+        shm = NULL;
+    }
+#endif
+}
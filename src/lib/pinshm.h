@@ -0,0 +1,91 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef PINSHM_H
+#define PINSHM_H
+
+#include <stdint.h>
+
+// shared memory pin state export, the layout don't depend on picsim and can be read by external tools
+
+#define PINSHM_NAME "/picsimlab_pins_%i"  // %i = remote control TCP port
+#define PINSHM_MAGIC 0x4E495053           // "SPIN"
+#define PINSHM_VERSION 1
+#define PINSHM_MAX_PINS 256
+
+typedef struct {
+    char type;      ///< pin type letter: P D A R U - (same as rcontrol pinsl)
+    char dir;       ///< I or O
+    uint8_t value;  ///< digital value
+    uint8_t mean;   ///< digital mean value 0-200
+    float avalue;   ///< analog value
+    char name[12];  ///< pin name
+} pinshm_pin_t;
+
+/**
+ * @brief shared memory segment
+ *
+ * The writer increments seq before and after each update, readers retry while seq is odd or changed during the copy,
+ * so the simulation thread never waits for readers.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;          ///< seqlock counter
+    uint32_t update;       ///< number of updates
+    uint32_t instcounter;  ///< board instruction counter
+    int32_t cpustate;      ///< CPU_RUNNING, CPU_HALTED, ... (picsimlab.h)
+    uint32_t pincount;
+    char board[32];
+    char processor[32];
+    pinshm_pin_t pins[PINSHM_MAX_PINS];
+} pinshm_t;
+
+/**
+ * @brief copy a consistent snapshot of the shared segment, returns 0 if the writer is busy after some retries
+ */
+static inline int pinshm_read(const pinshm_t* shm, pinshm_t* copy) {
+    for (int retry = 0; retry < 100; retry++) {
+        uint32_t s1 = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+        if (s1 & 1) {
+            continue;
+        }
+        __builtin_memcpy(copy, shm, sizeof(pinshm_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shm->seq, __ATOMIC_RELAXED) == s1) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+class board;
+
+// PICSimLab side
+int pinshm_init(const unsigned short port);
+void pinshm_publish(board* pboard, const int cpustate);
+void pinshm_end(void);
+
+#endif  // PINSHM_H
@@ -0,0 +1,151 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "picsimlab.h"
+#include "profiler.h"
+#include "spareparts.h"
+
+#ifdef _PROFILER_
+
+static prof_t Profiler_main;
+__thread prof_t* Profiler_ctx = &Profiler_main;
+
+static const char* stage_names[PROF_STAGES + 1] = {"run_cpu", "cpu", "timers", "oscope", "parts", "board"};
+
+static double prof_wall_time(void) {
+    struct timeval time;
+    gettimeofday(&time, NULL);
+    return (double)time.tv_sec + (double)time.tv_usec * .000001;
+}
+
+static __thread struct {
+    double elapsed;  ///< wall seconds since reset
+    double tps;      ///< ticks per second
+    uint64_t ticks[PROF_STAGES + 1];
+} snap;
+
+// take a copy of counters to report consistent values
+static void prof_snapshot(void) {
+    const uint64_t now = prof_ticks();
+    snap.elapsed = prof_wall_time() - Profiler.start_time;
+    snap.tps = (snap.elapsed > 0) ? (now - Profiler.start_ticks) / snap.elapsed : 1;
+    if (snap.tps <= 0) {
+        snap.tps = 1;
+    }
+    uint64_t others = 0;
+    for (int i = 0; i < PROF_STAGES; i++) {
+        snap.ticks[i] = Profiler.ticks[i];
+        if (i != PROF_RUN) {
+            others += snap.ticks[i];
+        }
+    }
+    // board pin glue and loop overhead
+    snap.ticks[PROF_STAGES] = (snap.ticks[PROF_RUN] > others) ? snap.ticks[PROF_RUN] - others : 0;
+}
+
+void prof_reset(void) {
+    memset(&Profiler, 0, sizeof(prof_t));
+    Profiler.start_time = prof_wall_time();
+    Profiler.start_ticks = prof_ticks();
+}
+
+// same count as CPICSimLab::BatchUpdate, a Run_CPU call with the microcontroller stopped simulates one TIMER period
+void prof_sim_time(board* pboard, const uint32_t start_ic) {
+    const uint32_t insts = pboard->InstCounterGet() - start_ic;
+    const float freq = pboard->MGetInstClockFreq();
+
+    if (insts && (freq > 0)) {
+        Profiler.sim_time += insts / freq;
+    } else {
+        Profiler.sim_time += TIMER;
+    }
+}
+
+int prof_line(const int n, char* line, const int size) {
+    const double run = snap.ticks[PROF_RUN] ? snap.ticks[PROF_RUN] : 1;
+
+    if (n == 0) {
+        prof_snapshot();
+        const double simtime = Profiler.sim_time;
+        snprintf(line, size, "profile: %.3f s wall %.3f s simulated (%.2fx) %.3f s in Run_CPU", snap.elapsed, simtime,
+                 (snap.elapsed > 0) ? simtime / snap.elapsed : 0, snap.ticks[PROF_RUN] / snap.tps);
+        return 1;
+    }
+    if (n == 1) {
+        snprintf(line, size, "  %-16s %10s %6s %12s %9s", "stage", "ms", "%", "calls", "ns/call");
+        return 1;
+    }
+    if (n < (PROF_STAGES + 3)) {
+        const int s = n - 2;
+        const uint64_t calls = (s < PROF_STAGES) ? Profiler.calls[s] : Profiler.calls[PROF_RUN];
+        snprintf(line, size, "  %-16s %10.1f %6.2f %12llu %9.1f", stage_names[s], snap.ticks[s] * 1e3 / snap.tps,
+                 snap.ticks[s] * 100.0 / run, (unsigned long long)calls,
+                 calls ? (snap.ticks[s] * 1e9 / snap.tps) / calls : 0);
+        return 1;
+    }
+
+    // per part lines, only the parts with process time
+    int p = n - (PROF_STAGES + 3);
+    for (int i = 0; i < SpareParts.GetCount(); i++) {
+        const int id = SpareParts.GetPart(i)->GetId();
+        if ((id >= 0) && (id < PROF_MAX_PARTS) && Profiler.part_ticks[id]) {
+            if (!p) {
+                snprintf(line, size, "  part[%02i] %-7.7s %10.1f %6.2f", id,
+                         (const char*)SpareParts.GetPart(i)->GetName().c_str(), Profiler.part_ticks[id] * 1e3 / snap.tps,
+                         Profiler.part_ticks[id] * 100.0 / run);
+                return 1;
+            }
+            p--;
+        }
+    }
+    return 0;
+}
+
+void prof_print(void) {
+    char line[128];
+    for (int i = 0; prof_line(i, line, 128); i++) {
+        printf("PICSimLab: %s\n", line);
+    }
+}
+
+#else
+
+void prof_reset(void) {}
+
+int prof_line(const int n, char* line, const int size) {
+    if (n == 0) {
+        snprintf(line, size, "profiler disabled, rebuild with make prof");
+        return 1;
+    }
+    return 0;
+}
+
+void prof_print(void) {}
+
+#endif
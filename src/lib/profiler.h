@@ -0,0 +1,121 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+class board;
+
+// simulation profiler, the instrumentation is only compiled with -D_PROFILER_ (make prof)
+
+/**
+ * @brief Run_CPU profiled stages, the board pin glue time is PROF_RUN minus the other stages
+ */
+enum { PROF_RUN = 0, PROF_CPU, PROF_TIMERS, PROF_OSCOPE, PROF_PARTS, PROF_STAGES };
+
+#define PROF_MAX_PARTS 100  // same as MAX_PARTS
+
+typedef struct {
+    uint64_t ticks[PROF_STAGES];
+    uint64_t calls[PROF_STAGES];
+    uint64_t part_ticks[PROF_MAX_PARTS];
+    double sim_time;       ///< simulated seconds of the profiled Run_CPU calls
+    uint64_t start_ticks;  ///< ticks at last reset, used to convert ticks to seconds
+    double start_time;     ///< wall time at last reset
+} prof_t;
+
+#ifdef _PROFILER_
+
+// counters of the simulation context of the calling thread, see simcontext.h
+extern __thread prof_t* Profiler_ctx;
+#define Profiler (*Profiler_ctx)
+
+/**
+ * @brief profiler time base, TSC on x86 or nanoseconds
+ */
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t prof_ticks(void) {
+    return __builtin_ia32_rdtsc();
+}
+#else
+#include <time.h>
+static inline uint64_t prof_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+#endif
+
+// time a single call
+#define PROF_STAGE(stage, call)                          \
+    do {                                                 \
+        const uint64_t prof_ts = prof_ticks();           \
+        call;                                            \
+        Profiler.ticks[stage] += prof_ticks() - prof_ts; \
+        Profiler.calls[stage]++;                         \
+    } while (0)
+
+// time a part method call
+#define PROF_PART(id, call)                                \
+    do {                                                   \
+        const uint64_t prof_tp = prof_ticks();             \
+        call;                                              \
+        Profiler.part_ticks[id] += prof_ticks() - prof_tp; \
+    } while (0)
+
+// time a Run_CPU call and count its simulated time from the instructions executed
+#define PROF_RUN_CPU(pboard)                                 \
+    do {                                                     \
+        const uint32_t prof_ic = (pboard)->InstCounterGet(); \
+        PROF_STAGE(PROF_RUN, (pboard)->Run_CPU());           \
+        prof_sim_time(pboard, prof_ic);                      \
+    } while (0)
+
+// time a function body from PROF_BEGIN to PROF_END
+#define PROF_BEGIN() const uint64_t prof_t0 = prof_ticks()
+#define PROF_END(stage)                                  \
+    do {                                                 \
+        Profiler.ticks[stage] += prof_ticks() - prof_t0; \
+        Profiler.calls[stage]++;                         \
+    } while (0)
+
+#else
+
+#define PROF_STAGE(stage, call) call
+#define PROF_RUN_CPU(pboard) (pboard)->Run_CPU()
+#define PROF_PART(id, call) call
+#define PROF_BEGIN()
+#define PROF_END(stage)
+
+#endif
+
+void prof_reset(void);
+void prof_sim_time(board* pboard, const uint32_t start_ic);
+int prof_line(const int n, char* line, const int size);
+void prof_print(void);
+
+#endif  // PROFILER_H
@@ -49,15 +49,20 @@
 #endif
 // system headers independent
 #include <errno.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 #include "../devices/lcd_hd44780.h"
 #include "../devices/vterm.h"
+#include "oscilloscope.h"
 #include "picsimlab.h"
+#include "pin_trace.h"
+#include "profiler.h"
 #include "rcontrol.h"
 #include "spareparts.h"
 
@@ -66,9 +71,32 @@ static int listenfd = -1;
 static int server_started = 0;
 
 #define BSIZE 1024
-static char buffer[BSIZE];
+static char buffer[BSIZE + 1];
 static int bp = 0;
 
+// responses are coalesced and sent once per loop
+#define OBSIZE 8192
+static char obuffer[OBSIZE];
+static int obp = 0;
+
+// subscription: changes pushed to client
+static int subscribed = 0;
+static int sub_period = 100;  // ms
+static double sub_last = 0;
+static unsigned char sub_pins[256];
+static pin_trace_t sub_trace;  // pin changes recorded by the simulation thread
+static board* sub_board = NULL;
+static uint32_t sub_lost = 0;
+static uint32_t sub_line_ic = 0;
+
+static void SubscribeStop(void);
+static float sub_bin[120];
+static float sub_bout[120];
+static float sub_pout[MAX_PARTS][100];
+
+#define RC_BIN_HEADER 4
+#define RC_BIN_MAX_RESP 4096
+
 void setnblock(int sock_descriptor) {
 #ifndef _WIN_
     int flags;
@@ -150,17 +178,56 @@ int rcontrol_init(const unsigned short tcpport, const int reporterror) {
     return 0;
 }
 
-static int sendtext(const char* str) {
-    int size = strlen(str);
+static int sendall(const char* data, int size) {
+    while (size > 0) {
+        int n = send(sockfd, data, size, MSG_NOSIGNAL);
+        if (n > 0) {
+            data += n;
+            size -= n;
+        } else {
+#ifndef _WIN_
+            if ((n < 0) && (errno == EAGAIN))
+#else
+            if ((n < 0) && (WSAGetLastError() == WSAEWOULDBLOCK))
+#endif
+            {
+                usleep(100);  // socket buffer full, wait client
+                continue;
+            }
+            printf("rcontrol: send error : %s \n", strerror(errno));
+            return 1;
+        }
+    }
+    return 0;
+}
 
-    if (send(sockfd, str, size, MSG_NOSIGNAL) != size) {
-        printf("rcontrol: send error : %s \n", strerror(errno));
-        return 1;
+static int sendflush(void) {
+    int ret = 0;
+    if (obp) {
+        ret = sendall(obuffer, obp);
+        obp = 0;
     }
+    return ret;
+}
 
+static int sendbin(const void* data, const int size) {
+    if ((obp + size) > OBSIZE) {
+        if (sendflush()) {
+            return 1;
+        }
+        if (size > OBSIZE) {
+            return sendall((const char*)data, size);
+        }
+    }
+    memcpy(obuffer + obp, data, size);
+    obp += size;
     return 0;
 }
 
+static int sendtext(const char* str) {
+    return sendbin(str, strlen(str));
+}
+
 int rcontrol_start(void) {
     struct sockaddr_in cli;
 #ifndef _WIN_
@@ -181,12 +248,14 @@ int rcontrol_start(void) {
     setnblock(sockfd);
     dprint("rcontrol: Client connected!---------------------------------\n");
 
-    memset(buffer, 0, BSIZE);
+    memset(buffer, 0, BSIZE + 1);
     bp = 0;
+    obp = 0;
 
-    return sendtext(
+    sendtext(
         "\r\nPICSimLab Remote Control Interface\r\n\r\n  Type help "
         "to see supported commands\r\n\r\n>");
+    return sendflush();
 }
 
 void rcontrol_stop(void) {
@@ -196,6 +265,7 @@ void rcontrol_stop(void) {
         close(sockfd);
     }
     sockfd = -1;
+    SubscribeStop();
 }
 
 void rcontrol_end(void) {
@@ -271,6 +341,181 @@ static int type_is_equal(const char* name, const char* type) {
     return ((name[0] == type[0]) && (name[1] == type[1]));
 }
 
+// numeric value of input, returns 0 if the type don't have a single value
+static int InputValue(input_t* Input, float* value) {
+    if (type_is_equal(Input->name, "VS")) {
+        *value = (short)(((*((unsigned char*)Input->status)) << 8) | (*(((unsigned char*)(Input->status)) + 1)));
+    } else if (type_is_equal(Input->name, "PB") || type_is_equal(Input->name, "KB") ||
+               type_is_equal(Input->name, "PO") || type_is_equal(Input->name, "JP")) {
+        *value = *((unsigned char*)Input->status);
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// numeric value of output, returns 0 if the type don't have a single value
+static int OutputValue(output_t* Output, float* value) {
+    if (type_is_equal(Output->name, "LD")) {
+        *value = *((float*)Output->status) - 55;
+    } else if (type_is_equal(Output->name, "DG")) {
+        *value = *((float*)Output->status) * 180.0 / M_PI;
+    } else if (type_is_equal(Output->name, "SS")) {
+        *value = *((int*)Output->status);
+    } else if (type_is_equal(Output->name, "MT")) {
+        *value = *((unsigned char**)Output->status)[1];
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+static double get_wall_time(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static void SubscribeStop(void) {
+    subscribed = 0;
+    board* Board = PICSimLab.GetBoard();
+    if (Board && (Board == sub_board)) {
+        Board->SetPinTrace(NULL);
+    }
+    sub_board = NULL;
+}
+
+static void Subscribe(const int period) {
+    SubscribeStop();
+    subscribed = 1;
+    sub_period = period;
+    sub_last = get_wall_time();
+    // invalid values, the first push sends all objects
+    memset(sub_pins, 0xFF, sizeof(sub_pins));
+    for (int i = 0; i < 120; i++) {
+        sub_bin[i] = NAN;
+        sub_bout[i] = NAN;
+    }
+    for (int i = 0; i < MAX_PARTS; i++) {
+        for (int j = 0; j < 100; j++) {
+            sub_pout[i][j] = NAN;
+        }
+    }
+}
+
+// append one changed value to the push, a new line with the instruction counter is started on each counter change
+static int SubscribeItem(int* changes, const uint32_t ic, const char* item) {
+    char lstemp[30];
+    int ret = 0;
+
+    if ((!*changes) || (ic != sub_line_ic)) {
+        if (*changes) {
+            ret += sendtext("\r\n");
+        }
+        snprintf(lstemp, 29, "@%u", ic);
+        ret += sendtext(lstemp);
+        sub_line_ic = ic;
+    }
+    (*changes)++;
+    ret += sendtext(item);
+    return ret;
+}
+
+// send the pin changes recorded by the simulation thread, one line per instruction counter value, and a line with
+// the objects changed since last push:
+// @instcounter pin[nn]=v pdir[nn]=I|O board.in[nn]=v board.out[nn]=v part[nn].out[nn]=v
+static int SubscribePush(void) {
+    char lstemp[60];
+    int changes = 0;
+    int ret = 0;
+    float value;
+
+    board* Board = PICSimLab.GetBoard();
+    if (!Board) {
+        return 0;
+    }
+
+    if (Board != sub_board) {
+        // subscription start or board changed, trace from the state of all pins
+        __atomic_store_n(&sub_trace.tail, __atomic_load_n(&sub_trace.head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+        __atomic_store_n(&sub_trace.resync, 1, __ATOMIC_RELEASE);
+        sub_lost = __atomic_load_n(&sub_trace.lost, __ATOMIC_RELAXED);
+        memset(sub_pins, 0xFF, sizeof(sub_pins));
+        sub_board = Board;
+        Board->SetPinTrace(&sub_trace);
+    }
+
+    double now = get_wall_time();
+    if (((now - sub_last) * 1000) < sub_period) {
+        return 0;
+    }
+    sub_last = now;
+
+    pin_trace_rec_t rec;
+    while (pin_trace_get(&sub_trace, &rec)) {
+        const unsigned char pv = rec.state;
+        const int i = rec.pin - 1;
+        if ((sub_pins[i] == 0xFF) || ((pv ^ sub_pins[i]) & 0x02)) {
+            snprintf(lstemp, 59, " pdir[%02i]=%c", i + 1, (pv & 0x02) ? 'I' : 'O');
+            ret += SubscribeItem(&changes, rec.ic, lstemp);
+        }
+        if ((sub_pins[i] == 0xFF) || ((pv ^ sub_pins[i]) & 0x01)) {
+            snprintf(lstemp, 59, " pin[%02i]=%i", i + 1, pv & 0x01);
+            ret += SubscribeItem(&changes, rec.ic, lstemp);
+        }
+        sub_pins[i] = pv;
+    }
+
+    const uint32_t ic = Board->InstCounterGet();
+
+    // ring full, changes lost: the next push carries the state of all pins
+    const uint32_t lost = __atomic_load_n(&sub_trace.lost, __ATOMIC_RELAXED);
+    if (lost != sub_lost) {
+        snprintf(lstemp, 59, " lost=%u", lost - sub_lost);
+        ret += SubscribeItem(&changes, ic, lstemp);
+        sub_lost = lost;
+        memset(sub_pins, 0xFF, sizeof(sub_pins));
+        __atomic_store_n(&sub_trace.resync, 1, __ATOMIC_RELEASE);
+    }
+
+    for (int i = 0; (i < Board->GetInputCount()) && (i < 120); i++) {
+        input_t* Input = Board->GetInput(i);
+        if ((Input->status != NULL) && InputValue(Input, &value) && (value != sub_bin[i])) {
+            snprintf(lstemp, 59, " board.in[%02i]=%g", i, value);
+            ret += SubscribeItem(&changes, ic, lstemp);
+            sub_bin[i] = value;
+        }
+    }
+
+    for (int i = 0; (i < Board->GetOutputCount()) && (i < 120); i++) {
+        output_t* Output = Board->GetOutput(i);
+        if ((Output->status != NULL) && OutputValue(Output, &value) && (value != sub_bout[i])) {
+            snprintf(lstemp, 59, " board.out[%02i]=%g", i, value);
+            ret += SubscribeItem(&changes, ic, lstemp);
+            sub_bout[i] = value;
+        }
+    }
+
+    if (Board->GetUseSpareParts()) {
+        for (int p = 0; p < SpareParts.GetCount(); p++) {
+            part* Part = SpareParts.GetPart(p);
+            for (int i = 0; (i < Part->GetOutputCount()) && (i < 100); i++) {
+                output_t* Output = Part->GetOutput(i);
+                if ((Output->status != NULL) && OutputValue(Output, &value) && (value != sub_pout[p][i])) {
+                    snprintf(lstemp, 59, " part[%02i].out[%02i]=%g", p, i, value);
+                    ret += SubscribeItem(&changes, ic, lstemp);
+                    sub_pout[p][i] = value;
+                }
+            }
+        }
+    }
+
+    if (changes) {
+        ret += sendtext("\r\n");
+    }
+    return ret;
+}
+
 static void ProcessInput(const char* msg, input_t* Input, int* ret) {
     char lstemp[200];
     if (type_is_equal(Input->name, "VS")) {
@@ -408,9 +653,8 @@ static char pintypetoletter(unsigned char type) {
     return '?';
 }
 
-int rcontrol_loop(void) {
+static int rcontrol_cmd(char* cmd) {
     int i, j;
-    int n;
     int ret = 0;
     lxString stemp;
     char lstemp[200];
@@ -420,243 +664,284 @@ int rcontrol_loop(void) {
     output_t* Output;
     const picpin* pins;
 
-    // open connection
-    if (sockfd < 0) {
-        return rcontrol_start();
-    }
-
-    n = recv(sockfd, (char*)&buffer[bp], 1024 - bp, 0);
+    dprint("cmd[%s]\n", cmd);
 
-    if (n > 0) {
-        // remove putty telnet handshake
-        if (buffer[bp + n] == 3) {
-            for (int x = 0; x < bp + n + 1; x++) {
-                buffer[x] = 0;
-            }
-            n = 0;
-            bp = 0;
-        }
+    switch (cmd[0]) {
+        case 'c':
+            if (!strncmp(cmd, "clk", 3)) {
+                // Command clk =====================================================
 
-        if (strchr(buffer, '\n')) {
-            char cmd[BSIZE];
-            int cmdsize = 0;
+                if (strlen(cmd) < 4) {
+                    snprintf(lstemp, 100, "%2.1f MHz\r\nOk\r\n>", PICSimLab.GetClock());
+                    ret = sendtext(lstemp);
+                } else {
+                    float clk;
+                    sscanf(cmd + 3, "%f", &clk);
 
-            while (buffer[cmdsize] != '\n') {
-                cmd[cmdsize] = buffer[cmdsize];
-                cmdsize++;
-            }
-            cmd[cmdsize] = 0;
-
-            for (int i = 0; i < BSIZE - cmdsize - 1; i++) {
-                buffer[i] = buffer[i + cmdsize + 1];
-            }
-            bp -= cmdsize - n + 1;
+                    PICSimLab.SetClock(clk, 0);
 
-            if (cmd[cmdsize - 1] == '\r') {
-                cmd[cmdsize - 1] = 0;  // strip \r
+                    snprintf(lstemp, 100, "Set to %2.1f MHz\r\nOk\r\n>", PICSimLab.GetClock());
+                    ret = sendtext(lstemp);
+                }
             }
-
-            // strcpy (cmd, (const char *) lowercase (cmd).c_str ());
-
-            dprint("cmd[%s]\n", cmd);
-
-            switch (cmd[0]) {
-                case 'c':
-                    if (!strncmp(cmd, "clk", 3)) {
-                        // Command clk =====================================================
-
-                        if (strlen(cmd) < 4) {
-                            snprintf(lstemp, 100, "%2.1f MHz\r\nOk\r\n>", PICSimLab.GetClock());
-                            ret = sendtext(lstemp);
-                        } else {
-                            float clk;
-                            sscanf(cmd + 3, "%f", &clk);
-
-                            PICSimLab.SetClock(clk, 0);
-
-                            snprintf(lstemp, 100, "Set to %2.1f MHz\r\nOk\r\n>", PICSimLab.GetClock());
-                            ret = sendtext(lstemp);
+            break;
+        case 'd':
+            if (strstr(cmd, "dumpr")) {
+                // Command dumpr
+                // ========================================================
+                Board = PICSimLab.GetBoard();
+                unsigned int addr;
+                unsigned int size;
+                int ret = sscanf(cmd + 5, "%x %u \n", &addr, &size);
+
+                if (ret == -1)  // all
+                {
+                    for (unsigned int i = 0; i < Board->DBGGetRAMSize(); i += 16) {
+                        snprintf(lstemp, 100, "%04X: ", i);
+                        ret += sendtext(lstemp);
+                        for (int j = 0; j < 16; j++) {
+                            snprintf(lstemp, 100, "%02X ", Board->DBGGetRAM_p()[j + i]);
+                            ret += sendtext(lstemp);
                         }
+                        snprintf(lstemp, 100, "\r\n");
+                        ret += sendtext(lstemp);
                     }
-                    break;
-                case 'd':
-                    if (strstr(cmd, "dumpr")) {
-                        // Command dumpr
-                        // ========================================================
-                        Board = PICSimLab.GetBoard();
-                        unsigned int addr;
-                        unsigned int size;
-                        int ret = sscanf(cmd + 5, "%x %u \n", &addr, &size);
-
-                        if (ret == -1)  // all
-                        {
-                            for (unsigned int i = 0; i < Board->DBGGetRAMSize(); i += 16) {
-                                snprintf(lstemp, 100, "%04X: ", i);
-                                ret += sendtext(lstemp);
-                                for (int j = 0; j < 16; j++) {
-                                    snprintf(lstemp, 100, "%02X ", Board->DBGGetRAM_p()[j + i]);
-                                    ret += sendtext(lstemp);
-                                }
-                                snprintf(lstemp, 100, "\r\n");
-                                ret += sendtext(lstemp);
-                            }
-                            snprintf(lstemp, 100, "\r\nOk\r\n>");
-                            ret += sendtext(lstemp);
-                        } else if (ret == 1)  // only one addr
-                        {
-                            if (addr < Board->DBGGetRAMSize()) {
-                                snprintf(lstemp, 100, "%04X: %02X \r\nOk\r\n>", addr, Board->DBGGetRAM_p()[addr]);
-                                ret += sendtext(lstemp);
-                            } else {
-                                ret = sendtext("ERROR\r\n>");
-                            }
-                        } else  // vector from addr
-                        {
-                            for (unsigned int i = addr; (i < (addr + size)) && i < Board->DBGGetRAMSize(); i += 16) {
-                                snprintf(lstemp, 100, "%04X: ", i);
-                                ret += sendtext(lstemp);
-
-                                for (unsigned int j = 0;
-                                     (j < 16) && (j < size - (i - addr)) && (i + j) < Board->DBGGetRAMSize(); j++) {
-                                    snprintf(lstemp, 100, "%02X ", Board->DBGGetRAM_p()[j + i]);
-                                    ret += sendtext(lstemp);
-                                }
+                    snprintf(lstemp, 100, "\r\nOk\r\n>");
+                    ret += sendtext(lstemp);
+                } else if (ret == 1)  // only one addr
+                {
+                    if (addr < Board->DBGGetRAMSize()) {
+                        snprintf(lstemp, 100, "%04X: %02X \r\nOk\r\n>", addr, Board->DBGGetRAM_p()[addr]);
+                        ret += sendtext(lstemp);
+                    } else {
+                        ret = sendtext("ERROR\r\n>");
+                    }
+                } else  // vector from addr
+                {
+                    for (unsigned int i = addr; (i < (addr + size)) && i < Board->DBGGetRAMSize(); i += 16) {
+                        snprintf(lstemp, 100, "%04X: ", i);
+                        ret += sendtext(lstemp);
 
-                                snprintf(lstemp, 100, "\r\n");
-                                ret += sendtext(lstemp);
-                            }
-                            snprintf(lstemp, 100, "\r\nOk\r\n>");
+                        for (unsigned int j = 0;
+                             (j < 16) && (j < size - (i - addr)) && (i + j) < Board->DBGGetRAMSize(); j++) {
+                            snprintf(lstemp, 100, "%02X ", Board->DBGGetRAM_p()[j + i]);
                             ret += sendtext(lstemp);
                         }
-                    } else if (strstr(cmd, "dumpe")) {
-                        // Command dumpe
-                        // ========================================================
-                        Board = PICSimLab.GetBoard();
-                        unsigned int addr;
-                        unsigned int size;
-                        int ret = sscanf(cmd + 5, "%x %u \n", &addr, &size);
-
-                        if (ret == -1)  // all
-                        {
-                            for (unsigned int i = 0; i < Board->DBGGetEEPROM_Size(); i += 16) {
-                                snprintf(lstemp, 100, "%04X: ", i);
-                                ret += sendtext(lstemp);
-                                for (int j = 0; j < 16; j++) {
-                                    snprintf(lstemp, 100, "%02X ", Board->DBGGetEEPROM_p()[j + i]);
-                                    ret += sendtext(lstemp);
-                                }
-                                snprintf(lstemp, 100, "\r\n");
-                                ret += sendtext(lstemp);
-                            }
-                            snprintf(lstemp, 100, "\r\nOk\r\n>");
-                            ret += sendtext(lstemp);
-                        } else if (ret == 1)  // only one addr
-                        {
-                            if (addr < Board->DBGGetEEPROM_Size()) {
-                                snprintf(lstemp, 100, "%04X: %02X \r\nOk\r\n>", addr, Board->DBGGetEEPROM_p()[addr]);
-                                ret += sendtext(lstemp);
-                            } else {
-                                ret = sendtext("ERROR\r\n>");
-                            }
-                        } else  // vector from addr
-                        {
-                            for (unsigned int i = addr; (i < (addr + size)) && i < Board->DBGGetEEPROM_Size();
-                                 i += 16) {
-                                snprintf(lstemp, 100, "%04X: ", i);
-                                ret += sendtext(lstemp);
-
-                                for (unsigned int j = 0;
-                                     (j < 16) && (j < size - (i - addr)) && (i + j) < Board->DBGGetEEPROM_Size(); j++) {
-                                    snprintf(lstemp, 100, "%02X ", Board->DBGGetEEPROM_p()[j + i]);
-                                    ret += sendtext(lstemp);
-                                }
 
-                                snprintf(lstemp, 100, "\r\n");
-                                ret += sendtext(lstemp);
-                            }
-                            snprintf(lstemp, 100, "\r\nOk\r\n>");
+                        snprintf(lstemp, 100, "\r\n");
+                        ret += sendtext(lstemp);
+                    }
+                    snprintf(lstemp, 100, "\r\nOk\r\n>");
+                    ret += sendtext(lstemp);
+                }
+            } else if (strstr(cmd, "dumpe")) {
+                // Command dumpe
+                // ========================================================
+                Board = PICSimLab.GetBoard();
+                unsigned int addr;
+                unsigned int size;
+                int ret = sscanf(cmd + 5, "%x %u \n", &addr, &size);
+
+                if (ret == -1)  // all
+                {
+                    for (unsigned int i = 0; i < Board->DBGGetEEPROM_Size(); i += 16) {
+                        snprintf(lstemp, 100, "%04X: ", i);
+                        ret += sendtext(lstemp);
+                        for (int j = 0; j < 16; j++) {
+                            snprintf(lstemp, 100, "%02X ", Board->DBGGetEEPROM_p()[j + i]);
                             ret += sendtext(lstemp);
                         }
-                    } else if (strstr(cmd, "dumpf")) {
-                        // Command dumpf
-                        // ========================================================
-                        Board = PICSimLab.GetBoard();
-                        unsigned int addr;
-                        unsigned int size;
-                        int ret = sscanf(cmd + 5, "%x %u \n", &addr, &size);
-
-                        if (ret == -1)  // all
-                        {
-                            for (unsigned int i = 0; i < Board->DBGGetROMSize(); i += 16) {
-                                snprintf(lstemp, 100, "%04X: ", i);
-                                ret += sendtext(lstemp);
-                                for (int j = 0; j < 16; j++) {
-                                    snprintf(lstemp, 100, "%02X ", Board->DBGGetROM_p()[j + i]);
-                                    ret += sendtext(lstemp);
-                                }
-                                snprintf(lstemp, 100, "\r\n");
-                                ret += sendtext(lstemp);
-                            }
-                            snprintf(lstemp, 100, "\r\nOk\r\n>");
+                        snprintf(lstemp, 100, "\r\n");
+                        ret += sendtext(lstemp);
+                    }
+                    snprintf(lstemp, 100, "\r\nOk\r\n>");
+                    ret += sendtext(lstemp);
+                } else if (ret == 1)  // only one addr
+                {
+                    if (addr < Board->DBGGetEEPROM_Size()) {
+                        snprintf(lstemp, 100, "%04X: %02X \r\nOk\r\n>", addr, Board->DBGGetEEPROM_p()[addr]);
+                        ret += sendtext(lstemp);
+                    } else {
+                        ret = sendtext("ERROR\r\n>");
+                    }
+                } else  // vector from addr
+                {
+                    for (unsigned int i = addr; (i < (addr + size)) && i < Board->DBGGetEEPROM_Size();
+                         i += 16) {
+                        snprintf(lstemp, 100, "%04X: ", i);
+                        ret += sendtext(lstemp);
+
+                        for (unsigned int j = 0;
+                             (j < 16) && (j < size - (i - addr)) && (i + j) < Board->DBGGetEEPROM_Size(); j++) {
+                            snprintf(lstemp, 100, "%02X ", Board->DBGGetEEPROM_p()[j + i]);
                             ret += sendtext(lstemp);
-                        } else if (ret == 1)  // only one addr
-                        {
-                            if (addr < Board->DBGGetROMSize()) {
-                                snprintf(lstemp, 100, "%04X: %02X \r\nOk\r\n>", addr, Board->DBGGetROM_p()[addr]);
-                                ret += sendtext(lstemp);
-                            } else {
-                                ret = sendtext("ERROR\r\n>");
-                            }
-                        } else  // vector from addr
-                        {
-                            for (unsigned int i = addr; (i < (addr + size)) && i < Board->DBGGetROMSize(); i += 16) {
-                                snprintf(lstemp, 100, "%04X: ", i);
-                                ret += sendtext(lstemp);
-
-                                for (unsigned int j = 0;
-                                     (j < 16) && (j < size - (i - addr)) && (i + j) < Board->DBGGetROMSize(); j++) {
-                                    snprintf(lstemp, 100, "%02X ", Board->DBGGetROM_p()[j + i]);
-                                    ret += sendtext(lstemp);
-                                }
+                        }
 
-                                snprintf(lstemp, 100, "\r\n");
-                                ret += sendtext(lstemp);
-                            }
-                            snprintf(lstemp, 100, "\r\nOk\r\n>");
+                        snprintf(lstemp, 100, "\r\n");
+                        ret += sendtext(lstemp);
+                    }
+                    snprintf(lstemp, 100, "\r\nOk\r\n>");
+                    ret += sendtext(lstemp);
+                }
+            } else if (strstr(cmd, "dumpf")) {
+                // Command dumpf
+                // ========================================================
+                Board = PICSimLab.GetBoard();
+                unsigned int addr;
+                unsigned int size;
+                int ret = sscanf(cmd + 5, "%x %u \n", &addr, &size);
+
+                if (ret == -1)  // all
+                {
+                    for (unsigned int i = 0; i < Board->DBGGetROMSize(); i += 16) {
+                        snprintf(lstemp, 100, "%04X: ", i);
+                        ret += sendtext(lstemp);
+                        for (int j = 0; j < 16; j++) {
+                            snprintf(lstemp, 100, "%02X ", Board->DBGGetROM_p()[j + i]);
                             ret += sendtext(lstemp);
                         }
+                        snprintf(lstemp, 100, "\r\n");
+                        ret += sendtext(lstemp);
+                    }
+                    snprintf(lstemp, 100, "\r\nOk\r\n>");
+                    ret += sendtext(lstemp);
+                } else if (ret == 1)  // only one addr
+                {
+                    if (addr < Board->DBGGetROMSize()) {
+                        snprintf(lstemp, 100, "%04X: %02X \r\nOk\r\n>", addr, Board->DBGGetROM_p()[addr]);
+                        ret += sendtext(lstemp);
                     } else {
                         ret = sendtext("ERROR\r\n>");
                     }
-                    break;
-                case 'e':
-                    if (!strcmp(cmd, "exit")) {
-                        // Command exit
-                        // ========================================================
-                        sendtext("Ok\r\n>");
-                        PICSimLab.SetWorkspaceFileName("");
-                        PICSimLab.SetToDestroy();
-                        return 0;
+                } else  // vector from addr
+                {
+                    for (unsigned int i = addr; (i < (addr + size)) && i < Board->DBGGetROMSize(); i += 16) {
+                        snprintf(lstemp, 100, "%04X: ", i);
+                        ret += sendtext(lstemp);
+
+                        for (unsigned int j = 0;
+                             (j < 16) && (j < size - (i - addr)) && (i + j) < Board->DBGGetROMSize(); j++) {
+                            snprintf(lstemp, 100, "%02X ", Board->DBGGetROM_p()[j + i]);
+                            ret += sendtext(lstemp);
+                        }
+
+                        snprintf(lstemp, 100, "\r\n");
+                        ret += sendtext(lstemp);
+                    }
+                    snprintf(lstemp, 100, "\r\nOk\r\n>");
+                    ret += sendtext(lstemp);
+                }
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'e':
+            if (!strcmp(cmd, "exit")) {
+                // Command exit
+                // ========================================================
+                sendtext("Ok\r\n>");
+                PICSimLab.SetWorkspaceFileName("");
+                PICSimLab.SetToDestroy();
+                return 0;
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'g':
+            if (!strncmp(cmd, "get ", 4)) {
+                // Command
+                // get==========================================================
+                char* ptr;
+                char* ptr2;
+                Board = PICSimLab.GetBoard();
+
+                if ((ptr = strstr(cmd, " board.in["))) {
+                    int in = (ptr[10] - '0') * 10 + (ptr[11] - '0');
+
+                    if (in < Board->GetInputCount()) {
+                        Input = Board->GetInput(in);
+
+                        if (Input->status != NULL) {
+                            snprintf(lstemp, 100, "board.in[%02i]", in);
+                            ProcessInput(lstemp, Input, &ret);
+                            sendtext("Ok\r\n>");
+                        } else {
+                            ret = sendtext("ERROR\r\n>");
+                        }
                     } else {
                         ret = sendtext("ERROR\r\n>");
                     }
-                    break;
-                case 'g':
-                    if (!strncmp(cmd, "get ", 4)) {
-                        // Command
-                        // get==========================================================
-                        char* ptr;
-                        char* ptr2;
-                        Board = PICSimLab.GetBoard();
+                } else if ((ptr = strstr(cmd, " board.out["))) {
+                    int out = (ptr[11] - '0') * 10 + (ptr[12] - '0');
 
-                        if ((ptr = strstr(cmd, " board.in["))) {
-                            int in = (ptr[10] - '0') * 10 + (ptr[11] - '0');
+                    if (out < Board->GetOutputCount()) {
+                        Output = Board->GetOutput(out);
 
-                            if (in < Board->GetInputCount()) {
-                                Input = Board->GetInput(in);
+                        if (Output->status != NULL) {
+                            snprintf(lstemp, 100, "board.out[%02i]", out);
+                            ProcessOutput(lstemp, Output, &ret, 1);
+                            sendtext("Ok\r\n>");
+                        } else {
+                            ret = sendtext("ERROR\r\n>");
+                        }
+                    } else {
+                        ret = sendtext("ERROR\r\n>");
+                    }
+                } else if ((ptr = strstr(cmd, " apin["))) {
+                    int pin = (ptr[6] - '0') * 10 + (ptr[7] - '0');
+                    if (Board->GetUseSpareParts()) {
+                        pins = SpareParts.GetPinsValues();
+                    } else {
+                        Board = PICSimLab.GetBoard();
+                        pins = Board->MGetPinsValues();
+                    }
+                    snprintf(lstemp, 100, "apin[%02i]= %5.3f \r\nOk\r\n>", pin, pins[pin - 1].avalue);
+                    ret = sendtext(lstemp);
+                } else if ((ptr = strstr(cmd, " pin["))) {
+                    int pin = (ptr[5] - '0') * 10 + (ptr[6] - '0');
+                    if (Board->GetUseSpareParts()) {
+                        pins = SpareParts.GetPinsValues();
+                    } else {
+                        Board = PICSimLab.GetBoard();
+                        pins = Board->MGetPinsValues();
+                    }
+                    snprintf(lstemp, 100, "pin[%02i]= %i \r\nOk\r\n>", pin, pins[pin - 1].value);
+                    sendtext(lstemp);
+                } else if ((ptr = strstr(cmd, " pinl["))) {
+                    int pin = (ptr[6] - '0') * 10 + (ptr[7] - '0');
+                    if (Board->GetUseSpareParts()) {
+                        pins = SpareParts.GetPinsValues();
+                    } else {
+                        Board = PICSimLab.GetBoard();
+                        pins = Board->MGetPinsValues();
+                    }
+                    snprintf(lstemp, 100, "pin[%02i] %c %c %i %03i %5.3f \"%-8s\" \r\nOk\r\n>", pin,
+                             pintypetoletter(pins[pin - 1].ptype), (pins[pin - 1].dir == PD_IN) ? 'I' : 'O',
+                             pins[pin - 1].value, (int)(pins[pin - 1].oavalue - 55), pins[pin - 1].avalue,
+                             (const char*)Board->MGetPinName(pin).c_str());
+                    ret = sendtext(lstemp);
+                } else if ((ptr = strstr(cmd, " pinm["))) {
+                    int pin = (ptr[6] - '0') * 10 + (ptr[7] - '0');
+                    if (Board->GetUseSpareParts()) {
+                        pins = SpareParts.GetPinsValues();
+                    } else {
+                        Board = PICSimLab.GetBoard();
+                        pins = Board->MGetPinsValues();
+                    }
+                    snprintf(lstemp, 100, "pin[%02i] %03i\r\nOk\r\n>", pin, (int)(pins[pin - 1].oavalue - 55));
+                    ret = sendtext(lstemp);
+                } else if (Board->GetUseSpareParts()) {
+                    if ((ptr = strstr(cmd, "part[")) && (ptr2 = strstr(cmd, "].in["))) {
+                        int pn = (ptr[5] - '0') * 10 + (ptr[6] - '0');
+                        int in = (ptr2[5] - '0') * 10 + (ptr2[6] - '0');
+
+                        if (pn < SpareParts.GetCount()) {
+                            Part = SpareParts.GetPart(pn);
+                            if (in < Part->GetInputCount()) {
+                                Input = Part->GetInput(in);
 
                                 if (Input->status != NULL) {
-                                    snprintf(lstemp, 100, "board.in[%02i]", in);
+                                    snprintf(lstemp, 100, "part[%02i].in[%02i]", pn, in);
                                     ProcessInput(lstemp, Input, &ret);
                                     sendtext("Ok\r\n>");
                                 } else {
@@ -665,14 +950,20 @@ int rcontrol_loop(void) {
                             } else {
                                 ret = sendtext("ERROR\r\n>");
                             }
-                        } else if ((ptr = strstr(cmd, " board.out["))) {
-                            int out = (ptr[11] - '0') * 10 + (ptr[12] - '0');
+                        } else {
+                            ret = sendtext("ERROR\r\n>");
+                        }
+                    } else if ((ptr = strstr(cmd, "part[")) && (ptr2 = strstr(cmd, "].out["))) {
+                        int pn = (ptr[5] - '0') * 10 + (ptr[6] - '0');
+                        int out = (ptr2[6] - '0') * 10 + (ptr2[7] - '0');
 
-                            if (out < Board->GetOutputCount()) {
-                                Output = Board->GetOutput(out);
+                        if (pn < SpareParts.GetCount()) {
+                            Part = SpareParts.GetPart(pn);
+                            if (out < Part->GetOutputCount()) {
+                                Output = Part->GetOutput(out);
 
                                 if (Output->status != NULL) {
-                                    snprintf(lstemp, 100, "board.out[%02i]", out);
+                                    snprintf(lstemp, 100, "part[%02i].out[%02i]", pn, out);
                                     ProcessOutput(lstemp, Output, &ret, 1);
                                     sendtext("Ok\r\n>");
                                 } else {
@@ -681,436 +972,758 @@ int rcontrol_loop(void) {
                             } else {
                                 ret = sendtext("ERROR\r\n>");
                             }
-                        } else if ((ptr = strstr(cmd, " apin["))) {
-                            int pin = (ptr[6] - '0') * 10 + (ptr[7] - '0');
-                            if (Board->GetUseSpareParts()) {
-                                pins = SpareParts.GetPinsValues();
-                            } else {
-                                Board = PICSimLab.GetBoard();
-                                pins = Board->MGetPinsValues();
-                            }
-                            snprintf(lstemp, 100, "apin[%02i]= %5.3f \r\nOk\r\n>", pin, pins[pin - 1].avalue);
-                            ret = sendtext(lstemp);
-                        } else if ((ptr = strstr(cmd, " pin["))) {
-                            int pin = (ptr[5] - '0') * 10 + (ptr[6] - '0');
-                            if (Board->GetUseSpareParts()) {
-                                pins = SpareParts.GetPinsValues();
-                            } else {
-                                Board = PICSimLab.GetBoard();
-                                pins = Board->MGetPinsValues();
-                            }
-                            snprintf(lstemp, 100, "pin[%02i]= %i \r\nOk\r\n>", pin, pins[pin - 1].value);
-                            sendtext(lstemp);
-                        } else if ((ptr = strstr(cmd, " pinl["))) {
-                            int pin = (ptr[6] - '0') * 10 + (ptr[7] - '0');
-                            if (Board->GetUseSpareParts()) {
-                                pins = SpareParts.GetPinsValues();
-                            } else {
-                                Board = PICSimLab.GetBoard();
-                                pins = Board->MGetPinsValues();
-                            }
-                            snprintf(lstemp, 100, "pin[%02i] %c %c %i %03i %5.3f \"%-8s\" \r\nOk\r\n>", pin,
-                                     pintypetoletter(pins[pin - 1].ptype), (pins[pin - 1].dir == PD_IN) ? 'I' : 'O',
-                                     pins[pin - 1].value, (int)(pins[pin - 1].oavalue - 55), pins[pin - 1].avalue,
-                                     (const char*)Board->MGetPinName(pin).c_str());
-                            ret = sendtext(lstemp);
-                        } else if ((ptr = strstr(cmd, " pinm["))) {
-                            int pin = (ptr[6] - '0') * 10 + (ptr[7] - '0');
-                            if (Board->GetUseSpareParts()) {
-                                pins = SpareParts.GetPinsValues();
-                            } else {
-                                Board = PICSimLab.GetBoard();
-                                pins = Board->MGetPinsValues();
-                            }
-                            snprintf(lstemp, 100, "pin[%02i] %03i\r\nOk\r\n>", pin, (int)(pins[pin - 1].oavalue - 55));
-                            ret = sendtext(lstemp);
-                        } else if (Board->GetUseSpareParts()) {
-                            if ((ptr = strstr(cmd, "part[")) && (ptr2 = strstr(cmd, "].in["))) {
-                                int pn = (ptr[5] - '0') * 10 + (ptr[6] - '0');
-                                int in = (ptr2[5] - '0') * 10 + (ptr2[6] - '0');
-
-                                if (pn < SpareParts.GetCount()) {
-                                    Part = SpareParts.GetPart(pn);
-                                    if (in < Part->GetInputCount()) {
-                                        Input = Part->GetInput(in);
-
-                                        if (Input->status != NULL) {
-                                            snprintf(lstemp, 100, "part[%02i].in[%02i]", pn, in);
-                                            ProcessInput(lstemp, Input, &ret);
-                                            sendtext("Ok\r\n>");
-                                        } else {
-                                            ret = sendtext("ERROR\r\n>");
-                                        }
-                                    } else {
-                                        ret = sendtext("ERROR\r\n>");
-                                    }
-                                } else {
-                                    ret = sendtext("ERROR\r\n>");
-                                }
-                            } else if ((ptr = strstr(cmd, "part[")) && (ptr2 = strstr(cmd, "].out["))) {
-                                int pn = (ptr[5] - '0') * 10 + (ptr[6] - '0');
-                                int out = (ptr2[6] - '0') * 10 + (ptr2[7] - '0');
-
-                                if (pn < SpareParts.GetCount()) {
-                                    Part = SpareParts.GetPart(pn);
-                                    if (out < Part->GetOutputCount()) {
-                                        Output = Part->GetOutput(out);
-
-                                        if (Output->status != NULL) {
-                                            snprintf(lstemp, 100, "part[%02i].out[%02i]", pn, out);
-                                            ProcessOutput(lstemp, Output, &ret, 1);
-                                            sendtext("Ok\r\n>");
-                                        } else {
-                                            ret = sendtext("ERROR\r\n>");
-                                        }
-                                    } else {
-                                        ret = sendtext("ERROR\r\n>");
-                                    }
-                                } else {
-                                    ret = sendtext("ERROR\r\n>");
-                                }
-                            } else {
-                                ret = sendtext("ERROR\r\n>");
-                            }
                         } else {
                             ret = sendtext("ERROR\r\n>");
                         }
-                        return 0;
                     } else {
                         ret = sendtext("ERROR\r\n>");
                     }
-                    break;
-                case 'h':
-                    if (!strcmp(cmd, "help")) {
-                        // Command help
-                        // ========================================================
-                        ret += sendtext("List of supported commands:\r\n");
-                        ret += sendtext("  clk [val MHz]- show or set simulation clock\r\n");
-                        ret += sendtext("  dumpe [a] [s]- dump internal EEPROM memory\r\n");
-                        ret += sendtext("  dumpf [a] [s]- dump Flash memory\r\n");
-                        ret += sendtext("  dumpr [a] [s]- dump RAM memory\r\n");
-                        ret += sendtext("  exit         - shutdown PICSimLab\r\n");
-                        ret += sendtext("  get ob       - get object value\r\n");
-                        ret += sendtext("  help         - show this message\r\n");
-                        ret += sendtext("  info         - show actual setup info and objects\r\n");
-                        ret += sendtext("  loadhex file - load hex file (use full path)\r\n");
-                        ret += sendtext("  pins         - show pins directions and values\r\n");
-                        ret += sendtext("  pinsl        - show pins formated info\r\n");
-                        ret += sendtext("  quit         - exit remote control interface\r\n");
-                        ret += sendtext("  reset        - reset the board\r\n");
-                        ret += sendtext("  set ob vl    - set object with value\r\n");
-                        ret += sendtext(
-                            "  sim [cmd]    - show simulation status or execute "
-                            "cmd start/stop\r\n");
-                        ret += sendtext("  sync         - wait to syncronize with timer event\r\n");
-                        ret += sendtext("  version      - show PICSimLab version\r\n");
-
-                        ret += sendtext("Ok\r\n>");
-                    } else {
-                        ret = sendtext("ERROR\r\n>");
+                } else {
+                    ret = sendtext("ERROR\r\n>");
+                }
+                return 0;
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'h':
+            if (!strcmp(cmd, "help")) {
+                // Command help
+                // ========================================================
+                ret += sendtext("List of supported commands:\r\n");
+                ret += sendtext("  clk [val MHz]- show or set simulation clock\r\n");
+                ret += sendtext("  dumpe [a] [s]- dump internal EEPROM memory\r\n");
+                ret += sendtext("  dumpf [a] [s]- dump Flash memory\r\n");
+                ret += sendtext("  dumpr [a] [s]- dump RAM memory\r\n");
+                ret += sendtext("  exit         - shutdown PICSimLab\r\n");
+                ret += sendtext("  get ob       - get object value\r\n");
+                ret += sendtext("  help         - show this message\r\n");
+                ret += sendtext("  info         - show actual setup info and objects\r\n");
+                ret += sendtext("  loadhex file - load hex file (use full path)\r\n");
+                ret += sendtext("  osc [ch pin] - show or set oscilloscope channels pins (0 disable)\r\n");
+                ret += sendtext("  pins         - show pins directions and values\r\n");
+                ret += sendtext("  pinsl        - show pins formated info\r\n");
+                ret += sendtext("  prof [reset] - show or reset simulation profile\r\n");
+                ret += sendtext("  quit         - exit remote control interface\r\n");
+                ret += sendtext("  reset        - reset the board\r\n");
+                ret += sendtext("  set ob vl    - set object with value\r\n");
+                ret += sendtext(
+                    "  sim [cmd]    - show simulation status or execute "
+                    "cmd start/stop\r\n");
+                ret += sendtext("  snapshot save|load [file]- save or restore the simulation state\r\n");
+                ret += sendtext("  subscribe [ms]- push changed pins and objects (max rate)\r\n");
+                ret += sendtext("  sync         - wait to syncronize with timer event\r\n");
+                ret += sendtext("  unsubscribe  - stop subscription push\r\n");
+                ret += sendtext("  version      - show PICSimLab version\r\n");
+
+                ret += sendtext("Ok\r\n>");
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'i':
+            if (!strcmp(cmd, "info")) {
+                // Command info
+                // ========================================================
+                Board = PICSimLab.GetBoard();
+                stemp.Printf("Board:     %s\r\n", Board->GetName().c_str());
+                ret += sendtext((const char*)stemp.c_str());
+                stemp.Printf("Processor: %s\r\n", Board->GetProcessorName().c_str());
+                ret += sendtext((const char*)stemp.c_str());
+                stemp.Printf("Frequency: %10.0f Hz\r\n", Board->MGetFreq());
+                ret += sendtext((const char*)stemp.c_str());
+                stemp.Printf("Use Spare: %i\r\n", Board->GetUseSpareParts());
+                ret += sendtext((const char*)stemp.c_str());
+
+                for (i = 0; i < Board->GetInputCount(); i++) {
+                    Input = Board->GetInput(i);
+                    if ((Input->status != NULL)) {
+                        snprintf(lstemp, 100, "    board.in[%02i]", i);
+                        ProcessInput(lstemp, Input, &ret);
                     }
-                    break;
-                case 'i':
-                    if (!strcmp(cmd, "info")) {
-                        // Command info
-                        // ========================================================
-                        Board = PICSimLab.GetBoard();
-                        stemp.Printf("Board:     %s\r\n", Board->GetName().c_str());
-                        ret += sendtext((const char*)stemp.c_str());
-                        stemp.Printf("Processor: %s\r\n", Board->GetProcessorName().c_str());
-                        ret += sendtext((const char*)stemp.c_str());
-                        stemp.Printf("Frequency: %10.0f Hz\r\n", Board->MGetFreq());
-                        ret += sendtext((const char*)stemp.c_str());
-                        stemp.Printf("Use Spare: %i\r\n", Board->GetUseSpareParts());
+                }
+
+                for (i = 0; i < Board->GetOutputCount(); i++) {
+                    Output = Board->GetOutput(i);
+                    if (Output->status != NULL) {
+                        snprintf(lstemp, 100, "    board.out[%02i]", i);
+                        ProcessOutput(lstemp, Output, &ret);
+                    }
+                }
+
+                if (Board->GetUseSpareParts()) {
+                    for (i = 0; i < SpareParts.GetCount(); i++) {
+                        Part = SpareParts.GetPart(i);
+                        stemp.Printf("  part[%02i]: %s\r\n", i, (const char*)Part->GetName());
                         ret += sendtext((const char*)stemp.c_str());
 
-                        for (i = 0; i < Board->GetInputCount(); i++) {
-                            Input = Board->GetInput(i);
-                            if ((Input->status != NULL)) {
-                                snprintf(lstemp, 100, "    board.in[%02i]", i);
+                        for (j = 0; j < Part->GetInputCount(); j++) {
+                            Input = Part->GetInput(j);
+                            if (Input->status != NULL) {
+                                snprintf(lstemp, 100, "    part[%02i].in[%02i]", i, j);
                                 ProcessInput(lstemp, Input, &ret);
                             }
                         }
-
-                        for (i = 0; i < Board->GetOutputCount(); i++) {
-                            Output = Board->GetOutput(i);
+                        for (j = 0; j < Part->GetOutputCount(); j++) {
+                            Output = Part->GetOutput(j);
                             if (Output->status != NULL) {
-                                snprintf(lstemp, 100, "    board.out[%02i]", i);
+                                snprintf(lstemp, 100, "    part[%02i].out[%02i]", i, j);
                                 ProcessOutput(lstemp, Output, &ret);
                             }
                         }
+                    }
+                }
+                ret += sendtext("Ok\r\n>");
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'l':
+            if (!strncmp(cmd, "loadhex", 7)) {
+                // Command loadhex
+                // ========================================================
+                char* ptr;
+                if ((ptr = strchr(cmd, '\r'))) {
+                    ptr[0] = 0;
+                }
+                if ((ptr = strchr(cmd, '\n'))) {
+                    ptr[0] = 0;
+                }
+                if (PICSimLab.LoadHexFile(cmd + 8)) {
+                    ret += sendtext("ERROR\r\n>");
+                } else {
+                    ret += sendtext("Ok\r\n>");
+                }
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'o':
+            if (!strncmp(cmd, "osc", 3)) {
+                // Command osc ========================================================
+                if (strlen(cmd) < 4) {
+                    ret = 0;
+                    for (i = 0; i < OSC_CHANNELS; i++) {
+                        snprintf(lstemp, 100, "CH%i pin %i\r\n", i + 1, Oscilloscope.GetChannelPin(i) + 1);
+                        ret += sendtext(lstemp);
+                    }
+                    ret += sendtext("Ok\r\n>");
+                } else if ((sscanf(cmd + 3, "%i %i", &i, &j) == 2) && (i >= 1) && (i <= OSC_CHANNELS) &&
+                           (j >= 0) && (j <= PICSimLab.GetBoard()->MGetPinCount())) {
+                    Oscilloscope.SetChannelPin(i - 1, j - 1);
+                    ret = sendtext("Ok\r\n>");
+                } else {
+                    ret = sendtext("ERROR\r\n>");
+                }
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'p':
+            if (!strcmp(cmd, "pins")) {
+                // Command pins
+                // ========================================================
+                Board = PICSimLab.GetBoard();
+                pins = Board->MGetPinsValues();
+                int p2 = Board->MGetPinCount() / 2;
+                for (i = 0; i < p2; i++) {
+                    snprintf(lstemp, 100,
+                             "  pin[%02i] (%8s) %c %i                 pin[%02i] (%8s) %c %i "
+                             "\r\n",
+                             i + 1, (const char*)Board->MGetPinName(i + 1).c_str(),
+                             (pins[i].dir == PD_IN) ? '<' : '>', pins[i].value, i + 1 + p2,
+                             (const char*)Board->MGetPinName(i + 1 + p2).c_str(),
+                             (pins[i + p2].dir == PD_IN) ? '<' : '>', pins[i + p2].value);
+                    ret += sendtext(lstemp);
+                }
+                ret += sendtext("Ok\r\n>");
+            } else if (!strcmp(cmd, "pinsl")) {
+                // Command pinsl
+                // ========================================================
+                Board = PICSimLab.GetBoard();
+                pins = Board->MGetPinsValues();
+                snprintf(lstemp, 100, "%i pins [%s]:\r\n", Board->MGetPinCount(),
+                         (const char*)Board->GetProcessorName().c_str());
+                ret += sendtext(lstemp);
+                for (i = 0; i < Board->MGetPinCount(); i++) {
+                    snprintf(lstemp, 100, "  pin[%02i] %c %c %i %03i %5.3f \"%-8s\" \r\n", i + 1,
+                             pintypetoletter(pins[i].ptype), (pins[i].dir == PD_IN) ? 'I' : 'O', pins[i].value,
+                             (int)(pins[i].oavalue - 55), pins[i].avalue,
+                             (const char*)Board->MGetPinName(i + 1).c_str());
+                    ret += sendtext(lstemp);
+                }
+                ret += sendtext("Ok\r\n>");
+            } else if (!strncmp(cmd, "prof", 4)) {
+                // Command prof
+                // ========================================================
+                if (!strcmp(cmd, "prof reset")) {
+                    prof_reset();
+                    ret += sendtext("Ok\r\n>");
+                } else if (!strcmp(cmd, "prof")) {
+                    for (i = 0; prof_line(i, lstemp, sizeof(lstemp) - 2); i++) {
+                        strcat(lstemp, "\r\n");
+                        ret += sendtext(lstemp);
+                    }
+                    ret += sendtext("Ok\r\n>");
+                } else {
+                    ret = sendtext("ERROR\r\n>");
+                }
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'q':
+            if (!strcmp(cmd, "quit")) {
+                // Command quit
+                // ========================================================
+                sendtext("Ok\r\n>");
+                ret = 1;
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'r':
+            if (!strcmp(cmd, "reset")) {
+                // Command reset
+                // =======================================================
+                PICSimLab.GetBoard()->MReset(0);
+                ret = sendtext("Ok\r\n>");
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 's':
+            if (!strncmp(cmd, "set ", 4)) {
+                // Command set
+                // =========================================================
+                char* ptr;
+                char* ptr2;
+                Board = PICSimLab.GetBoard();
 
-                        if (Board->GetUseSpareParts()) {
-                            for (i = 0; i < SpareParts.GetCount(); i++) {
-                                Part = SpareParts.GetPart(i);
-                                stemp.Printf("  part[%02i]: %s\r\n", i, (const char*)Part->GetName());
-                                ret += sendtext((const char*)stemp.c_str());
-
-                                for (j = 0; j < Part->GetInputCount(); j++) {
-                                    Input = Part->GetInput(j);
-                                    if (Input->status != NULL) {
-                                        snprintf(lstemp, 100, "    part[%02i].in[%02i]", i, j);
-                                        ProcessInput(lstemp, Input, &ret);
-                                    }
-                                }
-                                for (j = 0; j < Part->GetOutputCount(); j++) {
-                                    Output = Part->GetOutput(j);
-                                    if (Output->status != NULL) {
-                                        snprintf(lstemp, 100, "    part[%02i].out[%02i]", i, j);
-                                        ProcessOutput(lstemp, Output, &ret);
-                                    }
-                                }
+                if ((ptr = strstr(cmd, " board.in["))) {
+                    int in = (ptr[10] - '0') * 10 + (ptr[11] - '0');
+                    int value;
+
+                    sscanf(ptr + 13, "%i", &value);
+
+                    dprint("board.in[%02i] = %i \r\n", in, value);
+
+                    if (in < Board->GetInputCount()) {
+                        Input = Board->GetInput(in);
+
+                        if (Input->status != NULL) {
+                            *((unsigned char*)Input->status) = value;
+                            sendtext("Ok\r\n>");
+                            if (Input->update) {
+                                *Input->update = 1;
                             }
-                        }
-                        ret += sendtext("Ok\r\n>");
-                    } else {
-                        ret = sendtext("ERROR\r\n>");
-                    }
-                    break;
-                case 'l':
-                    if (!strncmp(cmd, "loadhex", 7)) {
-                        // Command loadhex
-                        // ========================================================
-                        char* ptr;
-                        if ((ptr = strchr(cmd, '\r'))) {
-                            ptr[0] = 0;
-                        }
-                        if ((ptr = strchr(cmd, '\n'))) {
-                            ptr[0] = 0;
-                        }
-                        if (PICSimLab.LoadHexFile(cmd + 8)) {
-                            ret += sendtext("ERROR\r\n>");
                         } else {
-                            ret += sendtext("Ok\r\n>");
+                            ret = sendtext("ERROR\r\n>");
                         }
                     } else {
                         ret = sendtext("ERROR\r\n>");
                     }
-                    break;
-                case 'p':
-                    if (!strcmp(cmd, "pins")) {
-                        // Command pins
-                        // ========================================================
+                } else if ((ptr = strstr(cmd, " apin["))) {
+                    int pin = (ptr[6] - '0') * 10 + (ptr[7] - '0');
+                    float value;
+
+                    sscanf(ptr + 9, "%f", &value);
+
+                    dprint("apin[%02i] = %f \r\n", pin, value);
+
+                    if (Board->GetUseSpareParts()) {
+                        SpareParts.SetAPin(pin, value);
+                    } else {
                         Board = PICSimLab.GetBoard();
-                        pins = Board->MGetPinsValues();
-                        int p2 = Board->MGetPinCount() / 2;
-                        for (i = 0; i < p2; i++) {
-                            snprintf(lstemp, 100,
-                                     "  pin[%02i] (%8s) %c %i                 pin[%02i] (%8s) %c %i "
-                                     "\r\n",
-                                     i + 1, (const char*)Board->MGetPinName(i + 1).c_str(),
-                                     (pins[i].dir == PD_IN) ? '<' : '>', pins[i].value, i + 1 + p2,
-                                     (const char*)Board->MGetPinName(i + 1 + p2).c_str(),
-                                     (pins[i + p2].dir == PD_IN) ? '<' : '>', pins[i + p2].value);
-                            ret += sendtext(lstemp);
-                        }
-                        ret += sendtext("Ok\r\n>");
-                    } else if (!strcmp(cmd, "pinsl")) {
-                        // Command pinsl
-                        // ========================================================
+                        Board->MSetAPin(pin, value);
+                    }
+                    sendtext("Ok\r\n>");
+                } else if ((ptr = strstr(cmd, " pin["))) {
+                    int pin = (ptr[5] - '0') * 10 + (ptr[6] - '0');
+                    int value;
+
+                    sscanf(ptr + 8, "%i", &value);
+
+                    dprint("pin[%02i] = %i \r\n", pin, value);
+
+                    if (Board->GetUseSpareParts()) {
+                        SpareParts.SetPin(pin, value);
+                    } else {
                         Board = PICSimLab.GetBoard();
-                        pins = Board->MGetPinsValues();
-                        snprintf(lstemp, 100, "%i pins [%s]:\r\n", Board->MGetPinCount(),
-                                 (const char*)Board->GetProcessorName().c_str());
-                        ret += sendtext(lstemp);
-                        for (i = 0; i < Board->MGetPinCount(); i++) {
-                            snprintf(lstemp, 100, "  pin[%02i] %c %c %i %03i %5.3f \"%-8s\" \r\n", i + 1,
-                                     pintypetoletter(pins[i].ptype), (pins[i].dir == PD_IN) ? 'I' : 'O', pins[i].value,
-                                     (int)(pins[i].oavalue - 55), pins[i].avalue,
-                                     (const char*)Board->MGetPinName(i + 1).c_str());
-                            ret += sendtext(lstemp);
+                        Board->MSetPin(pin, value);
+                    }
+                    sendtext("Ok\r\n>");
+                } else if (Board->GetUseSpareParts() && (ptr = strstr(cmd, "part[")) &&
+                           (ptr2 = strstr(cmd, "].in["))) {
+                    int pn = (ptr[5] - '0') * 10 + (ptr[6] - '0');
+                    int in = (ptr2[5] - '0') * 10 + (ptr2[6] - '0');
+                    int value;
+
+                    sscanf(ptr2 + 8, "%i", &value);
+
+                    dprint("part[%02i].in[%02i] = %i \r\n", pn, in, value);
+
+                    if (pn < SpareParts.GetCount()) {
+                        Part = SpareParts.GetPart(pn);
+
+                        if (in < Part->GetInputCount()) {
+                            Input = Part->GetInput(in);
+
+                            if (Input->status != NULL) {
+                                if (type_is_equal(Input->name, "VS")) {
+                                    *((unsigned char*)Input->status) = (value & 0xFF00) >> 8;
+                                    *(((unsigned char*)Input->status) + 1) = value & 0x00FF;
+                                } else if (type_is_equal(Input->name, "PB") ||
+                                           type_is_equal(Input->name, "KB") ||
+                                           type_is_equal(Input->name, "PO") ||
+                                           type_is_equal(Input->name, "JP")) {
+                                    *((unsigned char*)Input->status) = value;
+                                } else if (type_is_equal(Input->name, "VT")) {
+                                    vterm_t* vt = (vterm_t*)Input->status;
+                                    if (!vt->ReceiveCallback) {
+                                        vt->ReceiveCallback = VtReceiveCallback;
+                                    }
+                                    const char* sval = ptr2 + 9;
+                                    strcpy((char*)vt->buff_out, sval);
+                                    vt->count_out = strlen(sval);
+                                }
+                                if (Input->update) {
+                                    *Input->update = 1;
+                                }
+                                sendtext("Ok\r\n>");
+                            } else {
+                                ret = sendtext("ERROR\r\n>");
+                            }
+                        } else {
+                            ret = sendtext("ERROR\r\n>");
                         }
-                        ret += sendtext("Ok\r\n>");
                     } else {
                         ret = sendtext("ERROR\r\n>");
                     }
+                } else {
+                    ret = sendtext("ERROR\r\n>");
+                }
+                return 0;
+            } else if (!strncmp(cmd, "subscribe", 9)) {
+                // Command subscribe ===============================================
+                int period = 100;
+                if (strlen(cmd) > 9) {
+                    sscanf(cmd + 9, "%i", &period);
+                }
+                if (period < 1) {
+                    ret = sendtext("ERROR\r\n>");
+                } else {
+                    Subscribe(period);
+                    ret = sendtext("Ok\r\n>");
+                }
+            } else if (!strncmp(cmd, "sim", 3)) {
+                // Command sim =====================================================
+                PICSimLab.SetSync(0);
+
+                if (strstr(cmd + 3, "stop")) {
+                    PICSimLab.SetSimulationRun(0);
+                    ret = sendtext("Ok\r\n>");
+                } else if (strstr(cmd + 3, "start")) {
+                    PICSimLab.SetSimulationRun(1);
+                    ret = sendtext("Ok\r\n>");
+                } else {
+                    if (PICSimLab.GetSimulationRun()) {
+                        ret = sendtext(lxString().Format(
+                            "Simulation running %5.2fx\r\nOk\r\n>",
+                            100.0 / ((CTimer*)PICSimLab.GetWindow()->GetChildByName("timer1"))->GetTime()));
+                    } else {
+                        ret = sendtext("Simulation stopped\r\nOk\r\n>");
+                    }
+                }
+
+            } else if (!strcmp(cmd, "sync")) {
+                // Command sync =====================================================
+                PICSimLab.SetSync(0);
+                while (!PICSimLab.GetSync()) {
+                    usleep(1);  // FIXME avoid use of usleep to reduce cpu usage
+                }
+                ret = sendtext("Ok\r\n>");
+            } else if (!strncmp(cmd, "snapshot ", 9)) {
+                // Command snapshot =================================================
+                char* fname = NULL;
+                int load = -1;
+
+                if (!strncmp(cmd + 9, "save", 4)) {
+                    load = 0;
+                } else if (!strncmp(cmd + 9, "load", 4)) {
+                    load = 1;
+                }
+                if ((load >= 0) && (cmd[13] == ' ')) {
+                    fname = cmd + 14;
+                } else if ((load >= 0) && cmd[13]) {
+                    load = -1;
+                }
+
+                if (load < 0) {
+                    ret = sendtext("ERROR\r\n>");
+                } else if (PICSimLab.Snapshot(load, fname)) {
+                    ret = sendtext(lxString(PICSimLab.GetSnapshotError()) + "\r\nERROR\r\n>");
+                } else {
+                    ret = sendtext("Ok\r\n>");
+                }
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'u':
+            if (!strcmp(cmd, "unsubscribe")) {
+                // Command unsubscribe
+                // =====================================================
+                SubscribeStop();
+                ret = sendtext("Ok\r\n>");
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        case 'v':
+            if (!strcmp(cmd, "version")) {
+                // Command version
+                // =====================================================
+                stemp.Printf(lxT("Developed by L.C. Gamboa\r\n "
+                                 "<lcgamboa@yahoo.com>\r\n Version: %s %s %s %s\r\n"),
+                             lxT(_VERSION_), lxT(_DATE_), lxT(_ARCH_), lxT(_PKG_));
+                ret += sendtext((const char*)stemp.c_str());
+                ret += sendtext("Ok\r\n>");
+            } else {
+                ret = sendtext("ERROR\r\n>");
+            }
+            break;
+        default:
+            // Uknown command
+            // ========================================================
+            ret = sendtext("ERROR\r\n>");
+            break;
+    }
+
+    return ret;
+}
+
+// binary frame ======================================================================
+
+static unsigned short get_u16(const unsigned char* buff) {
+    return buff[0] | (buff[1] << 8);
+}
+
+static void put_u16(unsigned char* buff, const unsigned short value) {
+    buff[0] = value & 0xFF;
+    buff[1] = (value >> 8) & 0xFF;
+}
+
+static float get_f32(const unsigned char* buff) {
+    union {
+        unsigned int u;
+        float f;
+    } v;
+    v.u = buff[0] | (buff[1] << 8) | (buff[2] << 16) | ((unsigned int)buff[3] << 24);
+    return v.f;
+}
+
+static void put_f32(unsigned char* buff, const float value) {
+    union {
+        unsigned int u;
+        float f;
+    } v;
+    v.f = value;
+    buff[0] = v.u & 0xFF;
+    buff[1] = (v.u >> 8) & 0xFF;
+    buff[2] = (v.u >> 16) & 0xFF;
+    buff[3] = (v.u >> 24) & 0xFF;
+}
+
+// returns the pins array and the number of valid pins
+static const picpin* rcontrol_pins(board* Board, int* count) {
+    if (Board->GetUseSpareParts()) {
+        *count = 255;
+        return SpareParts.GetPinsValues();
+    }
+    *count = Board->MGetPinCount();
+    return Board->MGetPinsValues();
+}
+
+// returns the input/output owner part, board inputs and outputs use part number 0xFF
+static input_t* rcontrol_get_input(board* Board, const int pn, const int in) {
+    if (pn == 0xFF) {
+        if (in < Board->GetInputCount()) {
+            return Board->GetInput(in);
+        }
+    } else if (Board->GetUseSpareParts() && (pn < SpareParts.GetCount())) {
+        part* Part = SpareParts.GetPart(pn);
+        if (in < Part->GetInputCount()) {
+            return Part->GetInput(in);
+        }
+    }
+    return NULL;
+}
+
+static output_t* rcontrol_get_output(board* Board, const int pn, const int out) {
+    if (pn == 0xFF) {
+        if (out < Board->GetOutputCount()) {
+            return Board->GetOutput(out);
+        }
+    } else if (Board->GetUseSpareParts() && (pn < SpareParts.GetCount())) {
+        part* Part = SpareParts.GetPart(pn);
+        if (out < Part->GetOutputCount()) {
+            return Part->GetOutput(out);
+        }
+    }
+    return NULL;
+}
+
+// process all operations of one frame and send the results as one response frame
+static int rcontrol_frame(const unsigned char id, const unsigned char* req, const int size) {
+    static unsigned char resp[RC_BIN_HEADER + RC_BIN_MAX_RESP];
+    unsigned char* rp = resp + RC_BIN_HEADER;
+    const unsigned char* end = resp + RC_BIN_HEADER + RC_BIN_MAX_RESP;
+    board* Board = PICSimLab.GetBoard();
+    const picpin* pins;
+    int count;
+    int p = 0;
+
+    while (p < size) {
+        const unsigned char op = req[p];
+        // largest result is the pins list
+        if ((end - rp) < (4 + 2 * 256)) {
+            *rp++ = op;
+            *rp++ = RB_ERR_SIZE;
+            break;
+        }
+        *rp++ = op;
+        unsigned char* st = rp++;
+        *st = RB_OK;
+
+        switch (op) {
+            case RB_PIN_GET:
+            case RB_PINM_GET:
+            case RB_APIN_GET:
+                if ((p + 2) > size) {
+                    *st = RB_ERR_ARGS;
                     break;
-                case 'q':
-                    if (!strcmp(cmd, "quit")) {
-                        // Command quit
-                        // ========================================================
-                        sendtext("Ok\r\n>");
-                        ret = 1;
+                }
+                pins = rcontrol_pins(Board, &count);
+                if ((req[p + 1] < 1) || (req[p + 1] > count)) {
+                    *st = RB_ERR_VALUE;
+                } else if (op == RB_PIN_GET) {
+                    *rp++ = req[p + 1];
+                    *rp++ = pins[req[p + 1] - 1].value;
+                    *rp++ = pins[req[p + 1] - 1].dir;
+                } else if (op == RB_PINM_GET) {
+                    *rp++ = req[p + 1];
+                    *rp++ = pins[req[p + 1] - 1].oavalue - 55;
+                } else {
+                    *rp++ = req[p + 1];
+                    put_f32(rp, pins[req[p + 1] - 1].avalue);
+                    rp += 4;
+                }
+                p += 2;
+                break;
+            case RB_PIN_SET:
+            case RB_APIN_SET:
+                if ((p + ((op == RB_PIN_SET) ? 3 : 6)) > size) {
+                    *st = RB_ERR_ARGS;
+                    break;
+                }
+                pins = rcontrol_pins(Board, &count);
+                if ((req[p + 1] < 1) || (req[p + 1] > count)) {
+                    *st = RB_ERR_VALUE;
+                } else if (op == RB_PIN_SET) {
+                    if (Board->GetUseSpareParts()) {
+                        SpareParts.SetPin(req[p + 1], req[p + 2]);
                     } else {
-                        ret = sendtext("ERROR\r\n>");
+                        Board->MSetPin(req[p + 1], req[p + 2]);
+                    }
+                } else {
+                    if (Board->GetUseSpareParts()) {
+                        SpareParts.SetAPin(req[p + 1], get_f32(&req[p + 2]));
+                    } else {
+                        Board->MSetAPin(req[p + 1], get_f32(&req[p + 2]));
                     }
+                }
+                p += (op == RB_PIN_SET) ? 3 : 6;
+                break;
+            case RB_PINS_GET:
+                // only the microcontroller pins
+                pins = rcontrol_pins(Board, &count);
+                count = Board->MGetPinCount();
+                *rp++ = count;
+                for (int i = 0; i < count; i++) {
+                    *rp++ = (pins[i].value & 0x01) | ((pins[i].dir == PD_IN) << 1) | ((pins[i].ptype & 0x0F) << 4);
+                    *rp++ = pins[i].oavalue - 55;
+                }
+                p += 1;
+                break;
+            case RB_IN_GET:
+            case RB_IN_SET: {
+                if ((p + ((op == RB_IN_GET) ? 3 : 5)) > size) {
+                    *st = RB_ERR_ARGS;
                     break;
-                case 'r':
-                    if (!strcmp(cmd, "reset")) {
-                        // Command reset
-                        // =======================================================
-                        PICSimLab.GetBoard()->MReset(0);
-                        ret = sendtext("Ok\r\n>");
+                }
+                input_t* Input = rcontrol_get_input(Board, req[p + 1], req[p + 2]);
+                if ((Input == NULL) || (Input->status == NULL)) {
+                    *st = RB_ERR_VALUE;
+                } else if (type_is_equal(Input->name, "VS")) {
+                    unsigned char* status = (unsigned char*)Input->status;
+                    if (op == RB_IN_GET) {
+                        put_u16(rp, (status[0] << 8) | status[1]);
+                        rp += 2;
                     } else {
-                        ret = sendtext("ERROR\r\n>");
+                        status[0] = req[p + 4];
+                        status[1] = req[p + 3];
                     }
+                } else if (type_is_equal(Input->name, "PB") || type_is_equal(Input->name, "KB") ||
+                           type_is_equal(Input->name, "PO") || type_is_equal(Input->name, "JP")) {
+                    if (op == RB_IN_GET) {
+                        put_u16(rp, *((unsigned char*)Input->status));
+                        rp += 2;
+                    } else {
+                        *((unsigned char*)Input->status) = req[p + 3];
+                    }
+                } else {
+                    *st = RB_ERR_TYPE;
+                }
+                if ((op == RB_IN_SET) && (*st == RB_OK) && Input->update) {
+                    *Input->update = 1;
+                }
+                p += (op == RB_IN_GET) ? 3 : 5;
+            } break;
+            case RB_OUT_GET: {
+                if ((p + 3) > size) {
+                    *st = RB_ERR_ARGS;
                     break;
-                case 's':
-                    if (!strncmp(cmd, "set ", 4)) {
-                        // Command set
-                        // =========================================================
-                        char* ptr;
-                        char* ptr2;
-                        Board = PICSimLab.GetBoard();
-
-                        if ((ptr = strstr(cmd, " board.in["))) {
-                            int in = (ptr[10] - '0') * 10 + (ptr[11] - '0');
-                            int value;
-
-                            sscanf(ptr + 13, "%i", &value);
-
-                            dprint("board.in[%02i] = %i \r\n", in, value);
+                }
+                output_t* Output = rcontrol_get_output(Board, req[p + 1], req[p + 2]);
+                float value = 0;
+                if ((Output == NULL) || (Output->status == NULL)) {
+                    *st = RB_ERR_VALUE;
+                } else if (!OutputValue(Output, &value)) {
+                    *st = RB_ERR_TYPE;
+                }
+                if (*st == RB_OK) {
+                    *rp++ = Output->name[0];
+                    *rp++ = Output->name[1];
+                    put_f32(rp, value);
+                    rp += 4;
+                }
+                p += 3;
+            } break;
+            case RB_SIM:
+                if ((p + 2) > size) {
+                    *st = RB_ERR_ARGS;
+                    break;
+                }
+                PICSimLab.SetSync(0);
+                if (req[p + 1] == 0) {
+                    PICSimLab.SetSimulationRun(0);
+                } else if (req[p + 1] == 1) {
+                    PICSimLab.SetSimulationRun(1);
+                }
+                *rp++ = PICSimLab.GetSimulationRun();
+                p += 2;
+                break;
+            case RB_RESET:
+                Board->MReset(0);
+                p += 1;
+                break;
+            case RB_SYNC:
+                PICSimLab.SetSync(0);
+                while (!PICSimLab.GetSync()) {
+                    usleep(1);  // FIXME avoid use of usleep to reduce cpu usage
+                }
+                p += 1;
+                break;
+            default:
+                *st = RB_ERR_OP;
+                break;
+        }
 
-                            if (in < Board->GetInputCount()) {
-                                Input = Board->GetInput(in);
+        // the size of next operation is unknown
+        if ((*st == RB_ERR_OP) || (*st == RB_ERR_ARGS)) {
+            break;
+        }
+    }
 
-                                if (Input->status != NULL) {
-                                    *((unsigned char*)Input->status) = value;
-                                    sendtext("Ok\r\n>");
-                                    if (Input->update) {
-                                        *Input->update = 1;
-                                    }
-                                } else {
-                                    ret = sendtext("ERROR\r\n>");
-                                }
-                            } else {
-                                ret = sendtext("ERROR\r\n>");
-                            }
-                        } else if ((ptr = strstr(cmd, " apin["))) {
-                            int pin = (ptr[6] - '0') * 10 + (ptr[7] - '0');
-                            float value;
+    resp[0] = RC_BIN_MAGIC;
+    resp[1] = id;
+    put_u16(&resp[2], (rp - resp) - RC_BIN_HEADER);
+    return sendbin(resp, rp - resp);
+}
 
-                            sscanf(ptr + 9, "%f", &value);
+// remove size bytes from the start of the receive buffer
+static void rcontrol_consume(const int size) {
+    memmove(buffer, buffer + size, bp - size);
+    bp -= size;
+    buffer[bp] = 0;
+}
 
-                            dprint("apin[%02i] = %f \r\n", pin, value);
+int rcontrol_loop(void) {
+    int n;
+    int ret = 0;
 
-                            if (Board->GetUseSpareParts()) {
-                                SpareParts.SetAPin(pin, value);
-                            } else {
-                                Board = PICSimLab.GetBoard();
-                                Board->MSetAPin(pin, value);
-                            }
-                            sendtext("Ok\r\n>");
-                        } else if ((ptr = strstr(cmd, " pin["))) {
-                            int pin = (ptr[5] - '0') * 10 + (ptr[6] - '0');
-                            int value;
+    // open connection
+    if (sockfd < 0) {
+        return rcontrol_start();
+    }
 
-                            sscanf(ptr + 8, "%i", &value);
+    // push before the commands responses, the write always ends with the prompt when there is a response
+    if (subscribed && SubscribePush()) {
+        rcontrol_stop();
+        return 1;
+    }
 
-                            dprint("pin[%02i] = %i \r\n", pin, value);
+    n = recv(sockfd, (char*)&buffer[bp], BSIZE - bp, 0);
 
-                            if (Board->GetUseSpareParts()) {
-                                SpareParts.SetPin(pin, value);
-                            } else {
-                                Board = PICSimLab.GetBoard();
-                                Board->MSetPin(pin, value);
-                            }
-                            sendtext("Ok\r\n>");
-                        } else if (Board->GetUseSpareParts() && (ptr = strstr(cmd, "part[")) &&
-                                   (ptr2 = strstr(cmd, "].in["))) {
-                            int pn = (ptr[5] - '0') * 10 + (ptr[6] - '0');
-                            int in = (ptr2[5] - '0') * 10 + (ptr2[6] - '0');
-                            int value;
-
-                            sscanf(ptr2 + 8, "%i", &value);
-
-                            dprint("part[%02i].in[%02i] = %i \r\n", pn, in, value);
-
-                            if (pn < SpareParts.GetCount()) {
-                                Part = SpareParts.GetPart(pn);
-
-                                if (in < Part->GetInputCount()) {
-                                    Input = Part->GetInput(in);
-
-                                    if (Input->status != NULL) {
-                                        if (type_is_equal(Input->name, "VS")) {
-                                            *((unsigned char*)Input->status) = (value & 0xFF00) >> 8;
-                                            *(((unsigned char*)Input->status) + 1) = value & 0x00FF;
-                                        } else if (type_is_equal(Input->name, "PB") ||
-                                                   type_is_equal(Input->name, "KB") ||
-                                                   type_is_equal(Input->name, "PO") ||
-                                                   type_is_equal(Input->name, "JP")) {
-                                            *((unsigned char*)Input->status) = value;
-                                        } else if (type_is_equal(Input->name, "VT")) {
-                                            vterm_t* vt = (vterm_t*)Input->status;
-                                            if (!vt->ReceiveCallback) {
-                                                vt->ReceiveCallback = VtReceiveCallback;
-                                            }
-                                            const char* sval = ptr2 + 9;
-                                            strcpy((char*)vt->buff_out, sval);
-                                            vt->count_out = strlen(sval);
-                                        }
-                                        if (Input->update) {
-                                            *Input->update = 1;
-                                        }
-                                        sendtext("Ok\r\n>");
-                                    } else {
-                                        ret = sendtext("ERROR\r\n>");
-                                    }
-                                } else {
-                                    ret = sendtext("ERROR\r\n>");
-                                }
-                            } else {
-                                ret = sendtext("ERROR\r\n>");
-                            }
-                        } else {
-                            ret = sendtext("ERROR\r\n>");
-                        }
-                        return 0;
-                    } else if (!strncmp(cmd, "sim", 3)) {
-                        // Command sim =====================================================
-                        PICSimLab.SetSync(0);
-
-                        if (strstr(cmd + 3, "stop")) {
-                            PICSimLab.SetSimulationRun(0);
-                            ret = sendtext("Ok\r\n>");
-                        } else if (strstr(cmd + 3, "start")) {
-                            PICSimLab.SetSimulationRun(1);
-                            ret = sendtext("Ok\r\n>");
-                        } else {
-                            if (PICSimLab.GetSimulationRun()) {
-                                ret = sendtext(lxString().Format(
-                                    "Simulation running %5.2fx\r\nOk\r\n>",
-                                    100.0 / ((CTimer*)PICSimLab.GetWindow()->GetChildByName("timer1"))->GetTime()));
-                            } else {
-                                ret = sendtext("Simulation stopped\r\nOk\r\n>");
-                            }
-                        }
+    if (n > 0) {
+        bp += n;
+        buffer[bp] = 0;
 
-                    } else if (!strcmp(cmd, "sync")) {
-                        // Command sync =====================================================
-                        PICSimLab.SetSync(0);
-                        while (!PICSimLab.GetSync()) {
-                            usleep(1);  // FIXME avoid use of usleep to reduce cpu usage
-                        }
-                        ret = sendtext("Ok\r\n>");
-                    } else {
-                        ret = sendtext("ERROR\r\n>");
-                    }
+        // process all complete commands and frames received, the responses are sent together
+        while ((bp > 0) && !ret) {
+            if ((unsigned char)buffer[0] == RC_BIN_MAGIC) {
+                if (bp < RC_BIN_HEADER) {
                     break;
-                case 'v':
-                    if (!strcmp(cmd, "version")) {
-                        // Command version
-                        // =====================================================
-                        stemp.Printf(lxT("Developed by L.C. Gamboa\r\n "
-                                         "<lcgamboa@yahoo.com>\r\n Version: %s %s %s %s\r\n"),
-                                     lxT(_VERSION_), lxT(_DATE_), lxT(_ARCH_), lxT(_PKG_));
-                        ret += sendtext((const char*)stemp.c_str());
-                        ret += sendtext("Ok\r\n>");
-                    } else {
+                }
+                int size = get_u16((unsigned char*)&buffer[2]);
+                if (size > (BSIZE - RC_BIN_HEADER)) {
+                    printf("rcontrol: frame too big (%i bytes)\n", size);
+                    ret = 1;
+                    break;
+                }
+                if (bp < (RC_BIN_HEADER + size)) {
+                    break;
+                }
+                ret = rcontrol_frame(buffer[1], (unsigned char*)&buffer[RC_BIN_HEADER], size);
+                rcontrol_consume(RC_BIN_HEADER + size);
+            } else {
+                char cmd[BSIZE + 1];
+                char* end = (char*)memchr(buffer, '\n', bp);
+
+                if (!end) {
+                    if (buffer[bp - 1] == 3) {
+                        // remove putty telnet handshake (text mode only, binary frames may end with 3)
+                        rcontrol_consume(bp);
+                    } else if (bp == BSIZE) {
+                        // line too long, discard
+                        rcontrol_consume(bp);
                         ret = sendtext("ERROR\r\n>");
                     }
                     break;
-                default:
-                    // Uknown command
-                    // ========================================================
-                    ret = sendtext("ERROR\r\n>");
-                    break;
+                }
+
+                int cmdsize = end - buffer;
+                memcpy(cmd, buffer, cmdsize);
+                cmd[cmdsize] = 0;
+                rcontrol_consume(cmdsize + 1);
+
+                if ((cmdsize > 0) && (cmd[cmdsize - 1] == '\r')) {
+                    cmd[cmdsize - 1] = 0;  // strip \r
+                }
+
+                ret = rcontrol_cmd(cmd);
             }
-        } else {
-            bp += n;
-            if (bp > BSIZE)
-                bp = BSIZE;
         }
     } else {
         // socket close by client
@@ -1130,6 +1743,8 @@ int rcontrol_loop(void) {
         }
     }
 
+    ret |= sendflush();
+
     // close connection
     if (ret)
         rcontrol_stop();
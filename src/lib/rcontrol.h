@@ -40,6 +40,38 @@
  PB - push button
  */
 
+/* Binary protocol
+ A frame starting with the RC_BIN_MAGIC byte is processed as a binary request, any other byte starts a text command.
+ Binary and text requests can be mixed and pipelined in the same connection, all responses ready in one loop are
+ sent in a single write. Multibyte values are little endian, floats are IEEE 754 single precision.
+
+ Request:  magic(u8) id(u8) size(u16) operations[size]
+ Response: magic(u8) id(u8) size(u16) results[size]
+
+ Each operation generates one result starting with the opcode and a status byte (RB_OK or RB_ERR_*) followed by the
+ data listed below (only when status is RB_OK). Part number 0xFF selects the board inputs and outputs.
+ After RB_ERR_OP or RB_ERR_ARGS the remaining operations of the frame are ignored.
+ */
+
+#define RC_BIN_MAGIC 0xB5
+
+enum {
+    RB_PIN_GET = 0x01,   // pin(u8)                        -> pin(u8) value(u8) dir(u8)
+    RB_PIN_SET = 0x02,   // pin(u8) value(u8)              ->
+    RB_APIN_GET = 0x03,  // pin(u8)                        -> pin(u8) value(f32)
+    RB_APIN_SET = 0x04,  // pin(u8) value(f32)             ->
+    RB_PINM_GET = 0x05,  // pin(u8)                        -> pin(u8) mean(u8)
+    RB_PINS_GET = 0x06,  //                                -> count(u8) {value|dir_in<<1|type<<4 (u8) mean(u8)}[count]
+    RB_IN_GET = 0x07,    // part(u8) input(u8)             -> value(u16)
+    RB_IN_SET = 0x08,    // part(u8) input(u8) value(u16)  ->
+    RB_OUT_GET = 0x09,   // part(u8) output(u8)            -> type(2 chars) value(f32)
+    RB_SIM = 0x0A,       // cmd(u8) 0=stop 1=start 2=query -> running(u8)
+    RB_RESET = 0x0B,     //                                ->
+    RB_SYNC = 0x0C       //                                ->
+};
+
+enum { RB_OK = 0, RB_ERR_OP, RB_ERR_ARGS, RB_ERR_VALUE, RB_ERR_TYPE, RB_ERR_SIZE };
+
 // PICSimLab remote control
 int rcontrol_init(const unsigned short tcpport, const int reporterror = 0);
 int rcontrol_loop(void);
@@ -42,6 +42,13 @@
 #include <termios.h>
 #endif
 
+#include <pthread.h>
+#if !defined(_WIN_) && !defined(__EMSCRIPTEN__)
+#define SERIAL_IO_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
 #include "serial_port.h"
 
 // uart support ============================================================
@@ -176,12 +183,44 @@ int serial_port_cfg(serialfd_t serialfd, float serialexbaud) {
             BAUDRATE = 57600;
 #endif
             break;
-        default:
+        case 384 ... 575:
             serialbaud = 115200;
 #ifndef _WIN_
             BAUDRATE = B115200;
 #else
             BAUDRATE = 115200;
+#endif
+            break;
+        case 576 ... 1151:
+            serialbaud = 230400;
+#ifndef _WIN_
+            BAUDRATE = B230400;
+#else
+            BAUDRATE = 230400;
+#endif
+            break;
+        case 1152 ... 2303:
+            serialbaud = 460800;
+#ifndef _WIN_
+            BAUDRATE = B460800;
+#else
+            BAUDRATE = 460800;
+#endif
+            break;
+        case 2304 ... 3199:
+            serialbaud = 921600;
+#ifndef _WIN_
+            BAUDRATE = B921600;
+#else
+            BAUDRATE = 921600;
+#endif
+            break;
+        default:
+            serialbaud = 1000000;
+#ifndef _WIN_
+            BAUDRATE = B1000000;
+#else
+            BAUDRATE = 1000000;
 #endif
             break;
     }
@@ -466,3 +505,360 @@ char* serial_port_list(void) {
 
     return resp;
 }
+
+// serial stream I/O thread ================================================
+
+#define SERIAL_STREAM_MAX 16
+#define SERIAL_IO_TOUT 10  // DSR poll period in ms
+#define SERIAL_IO_TX_TOUT 1  // tx flush and paused rx retry period in ms
+
+static pthread_mutex_t serial_io_ctl = PTHREAD_MUTEX_INITIALIZER;   // serialize open and close
+static pthread_mutex_t serial_io_lock = PTHREAD_MUTEX_INITIALIZER;  // streams list, held by the I/O thread
+static pthread_t serial_io_thread;
+static serial_stream_t* serial_io_streams[SERIAL_STREAM_MAX];
+static int serial_io_count = 0;
+static int serial_io_stop = 0;
+#ifdef SERIAL_IO_EPOLL
+static int serial_io_epfd = -1;
+static int serial_io_evfd = -1;
+#endif
+
+static long serial_io_read(serialfd_t serialfd, unsigned char* buff, const uint32_t len) {
+#ifdef _WIN_
+    unsigned long nbytes = 0;
+    if (!ReadFile(serialfd, buff, len, &nbytes, NULL)) {
+        return 0;
+    }
+    return nbytes;
+#else
+    const long nbytes = read(serialfd, buff, len);
+    return nbytes < 0 ? 0 : nbytes;
+#endif
+}
+
+static long serial_io_write(serialfd_t serialfd, const unsigned char* buff, const uint32_t len) {
+#ifdef _WIN_
+    unsigned long nbytes = 0;
+    if (!WriteFile(serialfd, buff, len, &nbytes, NULL)) {
+        return 0;
+    }
+    return nbytes;
+#else
+    const long nbytes = write(serialfd, buff, len);
+    return nbytes < 0 ? 0 : nbytes;
+#endif
+}
+
+#ifdef SERIAL_IO_EPOLL
+static void serial_io_set_events(serial_stream_t* st, const uint32_t events) {
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.ptr = st;
+    epoll_ctl(serial_io_epfd, EPOLL_CTL_MOD, st->serialfd, &ev);
+}
+#endif
+
+// read the port to the rx ring, the read is paused while the ring is full
+static void serial_io_fill_rx(serial_stream_t* st) {
+    serial_ring_t* r = &st->rx;
+
+    while (1) {
+        const uint32_t head = r->head;
+        const uint32_t pos = head & (SERIAL_RING_SIZE - 1);
+        uint32_t len = SERIAL_RING_SIZE - (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE));
+
+        if (!len) {
+            if (!st->rx_paused) {
+                st->rx_paused = 1;
+#ifdef SERIAL_IO_EPOLL
+                serial_io_set_events(st, 0);
+#endif
+            }
+            return;
+        }
+        if (len > (SERIAL_RING_SIZE - pos)) {
+            len = SERIAL_RING_SIZE - pos;
+        }
+        const long n = serial_io_read(st->serialfd, r->data + pos, len);
+        if (n <= 0) {
+            return;
+        }
+        __atomic_store_n(&r->head, head + n, __ATOMIC_RELEASE);
+        if ((uint32_t)n < len) {
+            return;
+        }
+    }
+}
+
+// write the tx ring to the port, returns the bytes left in the ring
+static uint32_t serial_io_flush_tx(serial_stream_t* st) {
+    serial_ring_t* r = &st->tx;
+
+    while (1) {
+        const uint32_t tail = r->tail;
+        const uint32_t used = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) - tail;
+        const uint32_t pos = tail & (SERIAL_RING_SIZE - 1);
+        uint32_t len = used;
+
+        if (!used) {
+            return 0;
+        }
+        if (len > (SERIAL_RING_SIZE - pos)) {
+            len = SERIAL_RING_SIZE - pos;
+        }
+        const long n = serial_io_write(st->serialfd, r->data + pos, len);
+        if (n > 0) {
+            __atomic_store_n(&r->tail, tail + n, __ATOMIC_RELEASE);
+        }
+        if ((uint32_t)n < len) {
+            return used - n;
+        }
+    }
+}
+
+// service one stream, returns the wait time in ms for the next loop, -1 to wait for events
+static int serial_io_service(serial_stream_t* st) {
+    int tout = -1;
+
+#ifndef SERIAL_IO_EPOLL
+    serial_io_fill_rx(st);
+#endif
+    if (st->rx_paused && ((st->rx.head - __atomic_load_n(&st->rx.tail, __ATOMIC_ACQUIRE)) < SERIAL_RING_SIZE)) {
+        st->rx_paused = 0;
+#ifdef SERIAL_IO_EPOLL
+        serial_io_set_events(st, EPOLLIN);
+#endif
+        serial_io_fill_rx(st);
+    }
+    if (st->rx_paused) {
+        tout = SERIAL_IO_TX_TOUT;
+    }
+
+    if (__atomic_load_n(&st->tx_wake, __ATOMIC_RELAXED)) {
+        if (serial_io_flush_tx(st)) {
+            st->tx_idle = 0;
+        } else if (st->tx_idle++) {
+            // no data for a whole period, the next byte sent wakes up the thread
+            st->tx_idle = 0;
+            __atomic_store_n(&st->tx_wake, 0, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&st->tx.head, __ATOMIC_RELAXED) != st->tx.tail) {
+                __atomic_store_n(&st->tx_wake, 1, __ATOMIC_RELAXED);
+            }
+        }
+        if (__atomic_load_n(&st->tx_wake, __ATOMIC_RELAXED)) {
+            tout = SERIAL_IO_TX_TOUT;
+        }
+    }
+
+    if (st->dsr_poll) {
+        __atomic_store_n(&st->dsr, serial_port_get_dsr(st->serialfd), __ATOMIC_RELAXED);
+        if (tout < 0) {
+            tout = SERIAL_IO_TOUT;
+        }
+    }
+    return tout;
+}
+
+static int serial_io_registered(serial_stream_t* st) {
+    for (int i = 0; i < serial_io_count; i++) {
+        if (serial_io_streams[i] == st) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void* serial_io_run(void* arg) {
+    int tout = -1;
+
+    while (!__atomic_load_n(&serial_io_stop, __ATOMIC_ACQUIRE)) {
+#ifdef SERIAL_IO_EPOLL
+        struct epoll_event ev[SERIAL_STREAM_MAX + 1];
+        const int n = epoll_wait(serial_io_epfd, ev, SERIAL_STREAM_MAX + 1, tout);
+#else
+        (void)tout;
+#ifdef _WIN_
+        Sleep(SERIAL_IO_TX_TOUT);
+#else
+        usleep(SERIAL_IO_TX_TOUT * 1000);
+#endif
+#endif
+        pthread_mutex_lock(&serial_io_lock);
+#ifdef SERIAL_IO_EPOLL
+        for (int i = 0; i < n; i++) {
+            serial_stream_t* st = (serial_stream_t*)ev[i].data.ptr;
+            if (!st) {
+                uint64_t v;
+                if (read(serial_io_evfd, &v, sizeof(v)) < 0) {
+                    // nothing to do, the counter was already cleared
+                }
+            } else if (serial_io_registered(st)) {  // can be closed after epoll_wait
+                serial_io_fill_rx(st);
+            }
+        }
+#endif
+        tout = -1;
+        for (int i = 0; i < serial_io_count; i++) {
+            const int t = serial_io_service(serial_io_streams[i]);
+            if ((t >= 0) && ((tout < 0) || (t < tout))) {
+                tout = t;
+            }
+        }
+        pthread_mutex_unlock(&serial_io_lock);
+    }
+    return NULL;
+}
+
+static int serial_io_start(void) {
+    serial_io_stop = 0;
+#ifdef SERIAL_IO_EPOLL
+    struct epoll_event ev;
+
+    serial_io_epfd = epoll_create1(0);
+    serial_io_evfd = eventfd(0, EFD_NONBLOCK);
+    if ((serial_io_epfd < 0) || (serial_io_evfd < 0)) {
+        printf("PICSimLab: Error on serial I/O thread start!\n");
+        if (serial_io_epfd >= 0)
+            close(serial_io_epfd);
+        if (serial_io_evfd >= 0)
+            close(serial_io_evfd);
+        serial_io_epfd = -1;
+        serial_io_evfd = -1;
+        return 0;
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    epoll_ctl(serial_io_epfd, EPOLL_CTL_ADD, serial_io_evfd, &ev);
+#endif
+    if (pthread_create(&serial_io_thread, NULL, serial_io_run, NULL)) {
+        printf("PICSimLab: Error on serial I/O thread start!\n");
+#ifdef SERIAL_IO_EPOLL
+        close(serial_io_epfd);
+        close(serial_io_evfd);
+        serial_io_epfd = -1;
+        serial_io_evfd = -1;
+#endif
+        return 0;
+    }
+    return 1;
+}
+
+static void serial_io_end(void) {
+    __atomic_store_n(&serial_io_stop, 1, __ATOMIC_RELEASE);
+    serial_stream_wake();
+    pthread_join(serial_io_thread, NULL);
+#ifdef SERIAL_IO_EPOLL
+    close(serial_io_epfd);
+    close(serial_io_evfd);
+    serial_io_epfd = -1;
+    serial_io_evfd = -1;
+#endif
+}
+
+void serial_stream_wake(void) {
+#ifdef SERIAL_IO_EPOLL
+    const uint64_t v = 1;
+    if (write(serial_io_evfd, &v, sizeof(v)) < 0) {
+        // the counter is full, the thread is already awake
+    }
+#endif
+}
+
+void serial_stream_init(serial_stream_t* st) {
+    memset(st, 0, sizeof(serial_stream_t));
+}
+
+int serial_stream_open(serial_stream_t* st, const char* SERIALDEVICE) {
+    int ret = 0;
+
+    serial_stream_close(st);
+    serial_stream_init(st);
+
+    if (!serial_port_open(&st->serialfd, SERIALDEVICE)) {
+        return 0;
+    }
+
+#ifdef _WIN_
+    // the I/O thread reads the port without wait
+    COMMTIMEOUTS CommTimeouts;
+    GetCommTimeouts(st->serialfd, &CommTimeouts);
+    CommTimeouts.ReadIntervalTimeout = MAXDWORD;
+    CommTimeouts.ReadTotalTimeoutConstant = 0;
+    CommTimeouts.ReadTotalTimeoutMultiplier = 0;
+    SetCommTimeouts(st->serialfd, &CommTimeouts);
+#endif
+
+    pthread_mutex_lock(&serial_io_ctl);
+    if ((serial_io_count < SERIAL_STREAM_MAX) && (serial_io_count || serial_io_start())) {
+        pthread_mutex_lock(&serial_io_lock);
+#ifdef SERIAL_IO_EPOLL
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = st;
+        if (epoll_ctl(serial_io_epfd, EPOLL_CTL_ADD, st->serialfd, &ev) == 0)
+#endif
+        {
+            serial_io_streams[serial_io_count++] = st;
+            st->registered = 1;
+            ret = 1;
+        }
+        pthread_mutex_unlock(&serial_io_lock);
+        if (!serial_io_count) {
+            serial_io_end();
+        }
+    }
+    pthread_mutex_unlock(&serial_io_ctl);
+
+    if (!ret) {
+        printf("PICSimLab: Error on serial I/O registration of %s!\n", SERIALDEVICE);
+        serial_port_close(st->serialfd);
+        st->serialfd = 0;
+    }
+    return ret;
+}
+
+int serial_stream_cfg(serial_stream_t* st, float serialexbaud) {
+    // like the tcflush of serial_port_cfg, drop the received data
+    __atomic_store_n(&st->rx.tail, __atomic_load_n(&st->rx.head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    return serial_port_cfg(st->serialfd, serialexbaud);
+}
+
+int serial_stream_close(serial_stream_t* st) {
+    if (st->registered) {
+        pthread_mutex_lock(&serial_io_ctl);
+        pthread_mutex_lock(&serial_io_lock);
+        for (int i = 0; i < serial_io_count; i++) {
+            if (serial_io_streams[i] == st) {
+                serial_io_count--;
+                serial_io_streams[i] = serial_io_streams[serial_io_count];
+                break;
+            }
+        }
+#ifdef SERIAL_IO_EPOLL
+        epoll_ctl(serial_io_epfd, EPOLL_CTL_DEL, st->serialfd, NULL);
+#endif
+        st->registered = 0;
+        pthread_mutex_unlock(&serial_io_lock);
+        if (!serial_io_count) {
+            serial_io_end();
+        }
+        pthread_mutex_unlock(&serial_io_ctl);
+
+        serial_io_flush_tx(st);
+    }
+    serial_port_close(st->serialfd);
+    st->serialfd = 0;
+    return 0;
+}
+
+int serial_stream_get_dsr(serial_stream_t* st) {
+    if (!st->registered) {
+        return 0;
+    }
+    if (!st->dsr_poll) {
+        st->dsr_poll = 1;
+        serial_stream_wake();
+    }
+    return __atomic_load_n(&st->dsr, __ATOMIC_RELAXED);
+}
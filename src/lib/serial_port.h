@@ -26,6 +26,8 @@
 #ifndef SERIAL_PORT_H
 #define SERIAL_PORT_H
 
+#include <stdint.h>
+
 #ifdef _WIN_
 #include <windows.h>
 #define serialfd_t HANDLE
@@ -41,4 +43,90 @@ int serial_port_cfg(serialfd_t serialfd, float serialexbaud);
 int serial_port_close(serialfd_t serialfd);
 char* serial_port_list(void);
 
+// serial stream ============================================================
+
+#define SERIAL_RING_SIZE 8192  // power of 2
+
+/**
+ * @brief single producer single consumer lock free byte ring
+ */
+typedef struct {
+    unsigned char data[SERIAL_RING_SIZE];
+    uint32_t head;  ///< written only by the producer
+    uint32_t tail;  ///< written only by the consumer
+} serial_ring_t;
+
+/**
+ * @brief serial port with RX and TX rings serviced by the serial I/O thread
+ *
+ * The I/O thread reads the port into the rx ring and writes the tx ring to the port, so the simulation thread
+ * sends and receives bytes without system calls. On Linux the thread waits for the ports with epoll, on Windows it
+ * polls the ports each millisecond.
+ */
+typedef struct {
+    serialfd_t serialfd;
+    serial_ring_t rx;
+    serial_ring_t tx;
+    int tx_wake;     ///< set by the sender, the I/O thread is flushing the tx ring
+    int tx_idle;     ///< I/O thread loops without tx data
+    int rx_paused;   ///< rx ring full, the port read is paused
+    int dsr;         ///< last DSR state read by the I/O thread
+    int dsr_poll;    ///< DSR state requested
+    int registered;  ///< serviced by the I/O thread
+} serial_stream_t;
+
+static inline int serial_ring_put(serial_ring_t* r, const unsigned char c) {
+    const uint32_t head = r->head;
+    if ((head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) >= SERIAL_RING_SIZE) {
+        return 0;
+    }
+    r->data[head & (SERIAL_RING_SIZE - 1)] = c;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static inline int serial_ring_get(serial_ring_t* r, unsigned char* c) {
+    const uint32_t tail = r->tail;
+    if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == tail) {
+        return 0;
+    }
+    *c = r->data[tail & (SERIAL_RING_SIZE - 1)];
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+void serial_stream_init(serial_stream_t* st);
+int serial_stream_open(serial_stream_t* st, const char* SERIALDEVICE);
+int serial_stream_cfg(serial_stream_t* st, float serialexbaud);
+int serial_stream_close(serial_stream_t* st);
+int serial_stream_get_dsr(serial_stream_t* st);
+
+/**
+ * @brief wake up the I/O thread
+ */
+void serial_stream_wake(void);
+
+/**
+ * @brief queue a byte to send, returns 0 if the tx ring is full or the port is closed
+ */
+static inline unsigned long serial_stream_send(serial_stream_t* st, const unsigned char c) {
+    if (!st->registered || !serial_ring_put(&st->tx, c)) {
+        return 0;
+    }
+    // pairs with the fence of the I/O thread when it stops flushing
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&st->tx_wake, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&st->tx_wake, 1, __ATOMIC_RELAXED);
+        serial_stream_wake();
+    }
+    return 1;
+}
+
+/**
+ * @brief get a received byte, returns 0 if there is no data
+ */
+static inline unsigned long serial_stream_rec(serial_stream_t* st, unsigned char* c) {
+    return st->registered && serial_ring_get(&st->rx, c);
+}
+
 #endif /* SERIAL_PORT_H */
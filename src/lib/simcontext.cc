@@ -0,0 +1,165 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "simcontext.h"
+
+#include <pthread.h>
+#include <thread>
+
+CSimContext::CSimContext(const int number) {
+    // paths of the main context, read before any thread enter the new one
+    picsimlab.SetSharePath(PICSimLab.GetSharePath());
+    picsimlab.SetLibPath(PICSimLab.GetLibPath());
+    picsimlab.SetHomePath(PICSimLab.GetHomePath());
+    picsimlab.SetContextNumber(number);
+}
+
+void CSimContext::Enter(void) {
+    PICSimLab_ctx = &picsimlab;
+    SpareParts_ctx = &spareparts;
+    Oscilloscope_ctx = &oscilloscope;
+#ifdef _PROFILER_
+    Profiler_ctx = &profiler;
+#endif
+}
+
+int CSimContext::RunBatch(const char* fnpzw, const double time, const unsigned long long insts) {
+    int ret;
+
+    Enter();
+    prof_reset();
+
+    PICSimLab.SetBatch(time, insts);
+    PICSimLab.LoadWorkspace(fnpzw, 0);
+    PICSimLab.SetWorkspaceFileName("");
+
+    board* pboard = PICSimLab.GetBoard();
+
+    if (pboard) {
+        while (PICSimLab.GetBatch()) {
+            if (PICSimLab.BatchUpdate()) {
+                PROF_RUN_CPU(pboard);
+                pboard->PinTraceUpdate();
+            }
+        }
+        ret = PICSimLab.GetBatchExitCode();
+        prof_print();
+
+        pboard->MEnd();
+        SpareParts.DeleteParts();
+        PICSimLab.DeleteBoard();
+    } else {
+        ret = BATCH_ERROR;
+    }
+
+    for (int i = 0; i < PICSimLab.GetErrorCount(); i++) {
+        printf("PICSimLab: %s Error: %s\n", fnpzw, (const char*)PICSimLab.GetError(i).c_str());
+    }
+
+    lxRemoveDir(PICSimLab.GetWorkspaceTempDir());
+    fflush(stdout);
+    return ret;
+}
+
+typedef struct {
+    CSimContext** ctx;
+    char* const* files;
+    int* exit_codes;
+    int count;
+    int next;  // next workspace to run
+    double time;
+    unsigned long long insts;
+} simcontext_pool_t;
+
+static void* simcontext_worker(void* arg) {
+    simcontext_pool_t* pool = (simcontext_pool_t*)arg;
+    int n;
+
+    while ((n = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) < pool->count) {
+        pool->exit_codes[n] = pool->ctx[n]->RunBatch(pool->files[n], pool->time, pool->insts);
+    }
+    return NULL;
+}
+
+int simcontext_batch(const int count, char* const* files, const double time, const unsigned long long insts,
+                     int threads) {
+    simcontext_pool_t pool;
+    pthread_t* tids;
+    int ret = BATCH_OK;
+
+    if (threads <= 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads > count) {
+        threads = count;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    pool.ctx = new CSimContext*[count];
+    pool.files = files;
+    pool.exit_codes = new int[count];
+    pool.count = count;
+    pool.next = 0;
+    pool.time = time;
+    pool.insts = insts;
+
+    for (int i = 0; i < count; i++) {
+        pool.ctx[i] = new CSimContext(i + 1);
+        pool.exit_codes[i] = BATCH_ERROR;
+    }
+
+    printf("PICSimLab: Batch of %i workspaces in %i threads\n", count, threads);
+    fflush(stdout);
+
+    tids = new pthread_t[threads];
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&tids[started], NULL, simcontext_worker, &pool) == 0) {
+            started++;
+        }
+    }
+    if (!started) {
+        printf("PICSimLab: Error creating the batch threads!\n");
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+
+    for (int i = 0; i < count; i++) {
+        printf("PICSimLab: Batch %s exit code %i\n", files[i], pool.exit_codes[i]);
+        if (pool.exit_codes[i] > ret) {
+            ret = pool.exit_codes[i];
+        }
+        delete pool.ctx[i];
+    }
+    fflush(stdout);
+
+    delete[] tids;
+    delete[] pool.exit_codes;
+    delete[] pool.ctx;
+    return ret;
+}
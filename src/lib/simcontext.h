@@ -0,0 +1,74 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef SIMCONTEXT
+#define SIMCONTEXT
+
+#include "oscilloscope.h"
+#include "picsimlab.h"
+#include "profiler.h"
+#include "spareparts.h"
+
+/**
+ * @brief headless simulation context
+ *
+ * A context owns the state of one simulation: the PICSimLab object (board, timers, IO flags and batch counters), the
+ * spare parts with their buses and virtual ethernet switch, and the oscilloscope. The PICSimLab, SpareParts and
+ * Oscilloscope names refer to the context entered by the calling thread, the threads that never enter a context use
+ * the main one, that owns the windows, the serial port and the remote control and debug servers.
+ * Only the picsim and simavr boards can run in a batch context, the other simulators have process wide state.
+ */
+class CSimContext {
+public:
+    CSimContext(const int number);
+
+    /**
+     * @brief  Make the calling thread use the context
+     */
+    void Enter(void);
+
+    /**
+     * @brief  Run the workspace in batch mode until the simulated time (s) or the instructions limit, returns the
+     * batch exit code
+     */
+    int RunBatch(const char* fnpzw, const double time, const unsigned long long insts);
+
+private:
+    CPICSimLab picsimlab;
+    CSpareParts spareparts;
+    COscilloscope oscilloscope;
+#ifdef _PROFILER_
+    prof_t profiler;
+#endif
+};
+
+/**
+ * @brief  Run each workspace in batch mode in its own context, on up to threads threads (0 to use one per processor).
+ * Returns the highest batch exit code.
+ */
+int simcontext_batch(const int count, char* const* files, const double time, const unsigned long long insts,
+                     int threads);
+
+#endif  // SIMCONTEXT
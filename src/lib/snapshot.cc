@@ -0,0 +1,172 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_MAGIC "PSNP"
+#define SNAPSHOT_VERSION 2
+
+void snapshot_init(snapshot_t* sn) {
+    memset(sn, 0, sizeof(snapshot_t));
+}
+
+void snapshot_free(snapshot_t* sn) {
+    free(sn->data);
+    snapshot_init(sn);
+}
+
+void snapshot_begin(snapshot_t* sn, const int load) {
+    if (!load) {
+        sn->size = 0;  // the buffer is reused, no allocation after the first save
+    }
+    sn->pos = 0;
+    sn->load = load;
+    sn->error = 0;
+    sn->msg[0] = 0;
+}
+
+void snapshot_set_error(snapshot_t* sn, const char* msg) {
+    if (!sn->error) {
+        sn->error = 1;
+        strncpy(sn->msg, msg, sizeof(sn->msg) - 1);
+        sn->msg[sizeof(sn->msg) - 1] = 0;
+    }
+}
+
+static int snapshot_reserve(snapshot_t* sn, const unsigned int size) {
+    if ((sn->size + size) > sn->alloc) {
+        unsigned int na = sn->alloc ? sn->alloc : 64 * 1024;
+        while (na < (sn->size + size)) {
+            na *= 2;
+        }
+        unsigned char* nd = (unsigned char*)realloc(sn->data, na);
+        if (!nd) {
+            snapshot_set_error(sn, "out of memory");
+            return -1;
+        }
+        sn->data = nd;
+        sn->alloc = na;
+    }
+    return 0;
+}
+
+void snapshot_data(snapshot_t* sn, void* data, const unsigned int size) {
+    if (sn->error || !size) {
+        return;
+    }
+    if (sn->load) {
+        if ((sn->pos + size) > sn->size) {
+            snapshot_set_error(sn, "truncated snapshot");
+            return;
+        }
+        memcpy(data, sn->data + sn->pos, size);
+        sn->pos += size;
+    } else {
+        if (snapshot_reserve(sn, size)) {
+            return;
+        }
+        memcpy(sn->data + sn->size, data, size);
+        sn->size += size;
+    }
+}
+
+const void* snapshot_peek(snapshot_t* sn, const unsigned int size) {
+    if (sn->error || !sn->load || ((sn->pos + size) > sn->size)) {
+        return NULL;
+    }
+    return sn->data + sn->pos;
+}
+
+void snapshot_check(snapshot_t* sn, const void* data, const unsigned int size, const char* what) {
+    if (sn->error) {
+        return;
+    }
+    if (sn->load) {
+        if (((sn->pos + size) > sn->size) || memcmp(sn->data + sn->pos, data, size)) {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "%s don't match", what);
+            snapshot_set_error(sn, msg);
+            return;
+        }
+        sn->pos += size;
+    } else {
+        snapshot_data(sn, (void*)data, size);
+    }
+}
+
+void snapshot_check_string(snapshot_t* sn, const char* str, const char* what) {
+    const uint32_t len = strlen(str);
+    snapshot_check(sn, &len, sizeof(len), what);
+    snapshot_check(sn, str, len, what);
+}
+
+int snapshot_save_file(snapshot_t* sn, const char* fname) {
+    const uint32_t version = SNAPSHOT_VERSION;
+    FILE* f = fopen(fname, "wb");
+    if (!f) {
+        snapshot_set_error(sn, "can't create file");
+        return -1;
+    }
+    int ret = (fwrite(SNAPSHOT_MAGIC, 1, 4, f) != 4) || (fwrite(&version, 1, 4, f) != 4) ||
+              (fwrite(&sn->size, 1, 4, f) != 4) || (fwrite(sn->data, 1, sn->size, f) != sn->size);
+    ret |= fclose(f);
+    if (ret) {
+        snapshot_set_error(sn, "file write error");
+        return -1;
+    }
+    return 0;
+}
+
+int snapshot_load_file(snapshot_t* sn, const char* fname) {
+    char magic[4];
+    uint32_t version;
+    uint32_t size;
+    sn->size = 0;
+    sn->error = 0;
+    sn->msg[0] = 0;
+    FILE* f = fopen(fname, "rb");
+    if (!f) {
+        snapshot_set_error(sn, "can't open file");
+        return -1;
+    }
+    if ((fread(magic, 1, 4, f) != 4) || memcmp(magic, SNAPSHOT_MAGIC, 4) || (fread(&version, 1, 4, f) != 4) ||
+        (version != SNAPSHOT_VERSION) || (fread(&size, 1, 4, f) != 4)) {
+        snapshot_set_error(sn, "invalid snapshot file");
+        fclose(f);
+        return -1;
+    }
+    if (snapshot_reserve(sn, size) || (fread(sn->data, 1, size, f) != size)) {
+        snapshot_set_error(sn, "truncated snapshot file");
+        sn->size = 0;
+        fclose(f);
+        return -1;
+    }
+    sn->size = size;
+    fclose(f);
+    return 0;
+}
@@ -0,0 +1,87 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+
+/**
+ * @brief simulation state snapshot buffer
+ *
+ * The same function saves and restores each state: snapshot_data appends the data to the buffer when saving and
+ * copies the data back from the buffer when loading, so the save and load sequences can't diverge.
+ * Snapshots keep the internal pointers of the simulator structs, they can only be loaded in the same PICSimLab
+ * session with the same board, microcontroller and parts loaded.
+ */
+typedef struct {
+    unsigned char* data;
+    unsigned int size;   ///< used size
+    unsigned int alloc;  ///< allocated size
+    unsigned int pos;    ///< read position
+    int load;            ///< 1 restoring, 0 saving
+    int error;
+    char msg[128];  ///< error message
+} snapshot_t;
+
+#define SNAPSHOT_VAR(sn, var) snapshot_data(sn, &(var), sizeof(var))
+
+void snapshot_init(snapshot_t* sn);
+void snapshot_free(snapshot_t* sn);
+
+/**
+ * @brief start a save (load = 0) or a restore (load = 1) sequence
+ */
+void snapshot_begin(snapshot_t* sn, const int load);
+
+/**
+ * @brief save or restore size bytes of data
+ */
+void snapshot_data(snapshot_t* sn, void* data, const unsigned int size);
+
+/**
+ * @brief on restore, returns a pointer to the next size bytes without consume them, NULL on save or if truncated
+ */
+const void* snapshot_peek(snapshot_t* sn, const unsigned int size);
+
+/**
+ * @brief save data or, on restore, check if the saved data is equal to data without change it
+ */
+void snapshot_check(snapshot_t* sn, const void* data, const unsigned int size, const char* what);
+
+/**
+ * @brief save a string or, on restore, check if the saved string is equal
+ */
+void snapshot_check_string(snapshot_t* sn, const char* str, const char* what);
+
+/**
+ * @brief set the error flag with a message, only the first error is kept
+ */
+void snapshot_set_error(snapshot_t* sn, const char* msg);
+
+int snapshot_save_file(snapshot_t* sn, const char* fname);
+int snapshot_load_file(snapshot_t* sn, const char* fname);
+
+#endif  // SNAPSHOT_H
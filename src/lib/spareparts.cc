@@ -28,14 +28,26 @@
 #include "spareparts.h"
 #include "oscilloscope.h"
 #include "picsimlab.h"
+#include "profiler.h"
 
 // Global objects;
-CSpareParts SpareParts;
+static CSpareParts SpareParts_main;
+__thread CSpareParts* SpareParts_ctx = &SpareParts_main;
 
 CSpareParts::CSpareParts() {
     pboard = NULL;
+    Window = NULL;
+    filedialog = NULL;
     partsc = 0;
     partsc_aup = 0;
+    partsc_aio = 0;
+    watch_count = 0;
+    watch_stamp = 0;
+    i2c_bus_count = 0;
+    spi_bus_count = 0;
+    memset(watch_state, 0xFF, sizeof(watch_state));
+    memset(watch_mark, 0, sizeof(watch_mark));
+    memset(&eth_switch, 0, sizeof(eth_switch));
     useAlias = 0;
     alias_fname = "";
     scale = 1.0;
@@ -92,6 +104,11 @@ void CSpareParts::DeleteParts(void) {
     int partsc_ = partsc;
     partsc = 0;  // for disable process
     partsc_aup = 0;
+    partsc_aio = 0;
+    watch_count = 0;
+    memset(watch_state, 0xFF, sizeof(watch_state));
+    i2c_bus_count = 0;
+    spi_bus_count = 0;
     useAlias = 0;
 
     for (int i = 0; i < partsc_; i++) {
@@ -176,6 +193,159 @@ const picpin* CSpareParts::GetPinsValues(void) {
     return Pins;
 }
 
+bitbang_uart_t* CSpareParts::GetUARTLink(part* owner, const unsigned char rx_pin, const unsigned char tx_pin) {
+    if ((!pboard) || (!PICSimLab.GetUARTFastPath()) || (!rx_pin) || (!tx_pin) || pboard->GetUseOscilloscope()) {
+        return NULL;
+    }
+
+    for (int i = 0; i < partsc; i++) {
+        const unsigned char* ppins = parts[i]->GetPins();
+        if ((parts[i] == owner) || (!ppins)) {
+            continue;
+        }
+        for (int p = 0; p < parts[i]->GetPinCount(); p++) {
+            if ((ppins[p] == rx_pin) || (ppins[p] == tx_pin)) {
+                return NULL;
+            }
+        }
+    }
+    return pboard->MGetUARTLink(rx_pin, tx_pin);
+}
+
+int CSpareParts::AttachI2CBus(part* owner, const unsigned char scl_pin, const unsigned char sda_pin,
+                              bitbang_i2c_t* i2c, void (*Process)(void* arg), void* Arg) {
+    int b;
+
+    if ((!scl_pin) || (!sda_pin)) {
+        return 0;
+    }
+
+    for (b = 0; b < i2c_bus_count; b++) {
+        if ((i2c_bus_pins[b][0] == scl_pin) && (i2c_bus_pins[b][1] == sda_pin)) {
+            break;
+        }
+    }
+    if (b == i2c_bus_count) {
+        if (i2c_bus_count == MAX_I2C_BUS) {
+            return 0;
+        }
+        bus_i2c_init(&i2c_bus[b]);
+        i2c_bus_pins[b][0] = scl_pin;
+        i2c_bus_pins[b][1] = sda_pin;
+        i2c_bus_count++;
+    }
+
+    const int dev = bus_i2c_attach(&i2c_bus[b], i2c, Process, Arg);
+    if (dev < 0) {
+        return 0;
+    }
+    i2c_bus_owner[b][dev] = owner;
+    return 1;
+}
+
+bus_i2c_t* CSpareParts::GetI2CLink(const unsigned char scl_pin, const unsigned char sda_pin) {
+    if ((!pboard) || pboard->GetUseOscilloscope()) {
+        return NULL;
+    }
+
+    for (int b = 0; b < i2c_bus_count; b++) {
+        if ((i2c_bus_pins[b][0] == scl_pin) && (i2c_bus_pins[b][1] == sda_pin)) {
+            return (i2c_bus[b].count && i2c_bus_link[b]) ? &i2c_bus[b] : NULL;
+        }
+    }
+    return NULL;
+}
+
+int CSpareParts::AttachSPIBus(part* owner, const unsigned char sck_pin, const unsigned char copi_pin,
+                              const unsigned char cs_pin, const unsigned char cipo_pin,
+                              unsigned char (*io)(void* arg, const unsigned char sck, const unsigned char copi,
+                                                  const unsigned char cs),
+                              void* Arg) {
+    int b;
+
+    if ((!sck_pin) || (!copi_pin) || (!cs_pin)) {
+        return 0;
+    }
+
+    for (b = 0; b < spi_bus_count; b++) {
+        if ((spi_bus_pins[b][0] == sck_pin) && (spi_bus_pins[b][1] == copi_pin)) {
+            break;
+        }
+    }
+    if (b == spi_bus_count) {
+        if (spi_bus_count == MAX_SPI_BUS) {
+            return 0;
+        }
+        bus_spi_init(&spi_bus[b]);
+        spi_bus_pins[b][0] = sck_pin;
+        spi_bus_pins[b][1] = copi_pin;
+        spi_bus_count++;
+    }
+
+    const int dev = bus_spi_attach(&spi_bus[b], &Pins[cs_pin - 1].value, cipo_pin > 0, io, Arg);
+    if (dev < 0) {
+        return 0;
+    }
+    spi_bus_cipo[b][dev] = cipo_pin;
+    spi_bus_owner[b][dev] = owner;
+    return 1;
+}
+
+bus_spi_t* CSpareParts::GetSPILink(const unsigned char sck_pin, const unsigned char copi_pin,
+                                   const unsigned char cipo_pin) {
+    if ((!pboard) || pboard->GetUseOscilloscope()) {
+        return NULL;
+    }
+
+    for (int b = 0; b < spi_bus_count; b++) {
+        if ((spi_bus_pins[b][0] == sck_pin) && (spi_bus_pins[b][1] == copi_pin)) {
+            if ((!spi_bus[b].count) || (!spi_bus_link[b])) {
+                return NULL;
+            }
+            // only the master cipo is read
+            for (int d = 0; d < spi_bus[b].count; d++) {
+                if (spi_bus_cipo[b][d] && (spi_bus_cipo[b][d] != cipo_pin)) {
+                    return NULL;
+                }
+            }
+            return &spi_bus[b];
+        }
+    }
+    return NULL;
+}
+
+void CSpareParts::UpdateSPILinkCS(void) {
+    for (int b = 0; b < spi_bus_count; b++) {
+        if (spi_bus_link[b]) {
+            bus_spi_cs(&spi_bus[b]);
+        }
+    }
+}
+
+// 1 if only the owners are wired to the pins
+int CSpareParts::BusLink(part** owner, const int count, const unsigned char* pins, const int pinc) {
+    for (int i = 0; i < partsc; i++) {
+        const unsigned char* ppins = parts[i]->GetPins();
+        int d;
+        for (d = 0; d < count; d++) {
+            if (owner[d] == parts[i]) {
+                break;
+            }
+        }
+        if ((d < count) || (!ppins)) {
+            continue;
+        }
+        for (int p = 0; p < parts[i]->GetPinCount(); p++) {
+            for (int n = 0; n < pinc; n++) {
+                if (ppins[p] && (ppins[p] == pins[n])) {
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
 void CSpareParts::SetPin(unsigned char pin, unsigned char value) {
     if (pin) {
         if ((pin > PinsCount)) {
@@ -479,6 +649,8 @@ bool CSpareParts::LoadConfig(lxString fname, const int disable_debug) {
             } else if (!strcmp(name, "osc_ch2")) {
                 osc_list.AddLine(prefs.GetLine(i));
                 Oscilloscope.ReadPreferencesList(osc_list);
+            } else if ((!strcmp(name, "osc_ch3")) || (!strcmp(name, "osc_ch4"))) {
+                Oscilloscope.SetChannelPin(name[6] - '1', atoi(temp) - 1);
             } else if ((parts[partsc_] = create_part(name, x, y))) {
                 printf("Spare parts: parts[%02i] (%s) created \n", partsc_, name);
                 parts[partsc_]->ReadPreferences(temp);
@@ -507,6 +679,12 @@ void CSpareParts::DeletePart(const int partn) {
     int partsc_ = partsc;
     partsc = 0;  // disable process
     partsc_aup = 0;
+    for (int b = 0; b < i2c_bus_count; b++) {
+        bus_i2c_detach_all(&i2c_bus[b]);
+    }
+    for (int b = 0; b < spi_bus_count; b++) {
+        bus_spi_detach_all(&spi_bus[b]);
+    }
 
     delete parts[partn];
 
@@ -520,16 +698,77 @@ void CSpareParts::DeletePart(const int partn) {
 
 void CSpareParts::PreProcess(void) {
     int i;
+    unsigned char wpins[256];
+    int wcount[257];
+    unsigned char watched[MAX_PARTS];
+
+    PROF_BEGIN();
 
     memset(pullup_bus, 0, PinsCount);
 
+    // the parts attach again in the same order, the bus decoder state is kept
+    for (i = 0; i < i2c_bus_count; i++) {
+        bus_i2c_detach_all(&i2c_bus[i]);
+    }
+    for (i = 0; i < spi_bus_count; i++) {
+        bus_spi_detach_all(&spi_bus[i]);
+    }
+
     partsc_aup = 0;
+    partsc_aio = 0;
+    memset(wcount, 0, sizeof(wcount));
+    int total = 0;
     for (i = 0; i < partsc; i++) {
         parts[i]->PreProcess();
         if (parts[i]->GetAwaysUpdate()) {
             parts_aup[partsc_aup] = parts[i];
             partsc_aup++;
         }
+        int n = parts[i]->GetWatchPins(wpins);
+        watched[i] = !(parts[i]->GetAwaysUpdate() || (n < 0) || ((total + n) > MAX_WATCH));
+        if (!watched[i]) {
+            parts_aio[partsc_aio] = parts[i];
+            partsc_aio++;
+        } else {
+            for (int j = 0; j < n; j++) {
+                if (wpins[j]) {
+                    wcount[wpins[j]]++;
+                    total++;
+                }
+            }
+        }
+    }
+
+    // per pin subscribers lists
+    watch_count = 0;
+    watch_first[0] = 0;
+    for (i = 0; i < 256; i++) {
+        watch_first[i + 1] = watch_first[i] + wcount[i];
+        if (wcount[i]) {
+            watch_pins[watch_count++] = i;
+        }
+        wcount[i] = watch_first[i];
+    }
+    for (i = 0; i < partsc; i++) {
+        if (watched[i]) {
+            int n = parts[i]->GetWatchPins(wpins);
+            for (int j = 0; j < n; j++) {
+                if (wpins[j]) {
+                    watch_list[wcount[wpins[j]]++] = parts[i];
+                }
+            }
+        }
+    }
+
+    // the bus pins can't be left idle if a part not attached uses them
+    for (i = 0; i < i2c_bus_count; i++) {
+        i2c_bus_link[i] = BusLink(i2c_bus_owner[i], i2c_bus[i].count, i2c_bus_pins[i], 2);
+    }
+    for (i = 0; i < spi_bus_count; i++) {
+        unsigned char bpins[2 + BUS_SPI_MAX];
+        memcpy(bpins, spi_bus_pins[i], 2);
+        memcpy(&bpins[2], spi_bus_cipo[i], spi_bus[i].count);
+        spi_bus_link[i] = BusLink(spi_bus_owner[i], spi_bus[i].count, bpins, 2 + spi_bus[i].count);
     }
 
     pullup_bus_count = 0;
@@ -541,35 +780,85 @@ void CSpareParts::PreProcess(void) {
         }
         pullup_bus[i] = 0;
     }
+
+    PROF_END(PROF_PARTS);
 }
 
 void CSpareParts::Process(void) {
     int i;
 
-    if (ioupdated) {
+    PROF_BEGIN();
+
+    if (PICSimLab.GetBoard()->GetIOUpdated()) {
         for (i = 0; i < pullup_bus_count; i++) {
             pullup_bus[pullup_bus_ptr[i]] = 1;
         }
-        for (i = 0; i < partsc; i++) {
-            parts[i]->Process();
+        for (i = 0; i < i2c_bus_count; i++) {
+            if (i2c_bus[i].count) {
+                const unsigned char scl = i2c_bus_pins[i][0];
+                const unsigned char sda = i2c_bus_pins[i][1];
+                SetPullupBus(sda - 1, bus_i2c_io(&i2c_bus[i], Pins[scl - 1].value, Pins[sda - 1].value));
+            }
+        }
+        for (i = 0; i < spi_bus_count; i++) {
+            bus_spi_t* spi = &spi_bus[i];
+            bus_spi_io(spi, Pins[spi_bus_pins[i][0] - 1].value, Pins[spi_bus_pins[i][1] - 1].value);
+            for (int d = 0; d < spi->count; d++) {
+                if (spi->dev[d].selected) {
+                    SetPin(spi_bus_cipo[i][d], spi->dev[d].ret);
+                }
+            }
+        }
+        for (i = 0; i < partsc_aio; i++) {
+            PROF_PART(parts_aio[i]->GetId(), parts_aio[i]->Process());
+        }
+        // dispatch only to the parts subscribed to changed pins
+        if (watch_count) {
+            watch_stamp++;
+            for (i = 0; i < watch_count; i++) {
+                const unsigned char pin = watch_pins[i];
+                const unsigned char state = (Pins[pin - 1].value & 0x01) | ((Pins[pin - 1].dir & 0x01) << 1);
+                if (state != watch_state[pin]) {
+                    watch_state[pin] = state;
+                    for (int j = watch_first[pin]; j < watch_first[pin + 1]; j++) {
+                        part* wpart = watch_list[j];
+                        if (watch_mark[wpart->GetId()] != watch_stamp) {
+                            watch_mark[wpart->GetId()] = watch_stamp;
+                            PROF_PART(wpart->GetId(), wpart->Process());
+                        }
+                    }
+                }
+            }
         }
         for (i = 0; i < pullup_bus_count; i++) {
             SetPin(pullup_bus_ptr[i] + 1, pullup_bus[pullup_bus_ptr[i]]);
         }
     } else {
         for (i = 0; i < partsc_aup; i++) {
-            parts_aup[i]->Process();
+            PROF_PART(parts_aup[i]->GetId(), parts_aup[i]->Process());
         }
     }
+
+    PROF_END(PROF_PARTS);
 }
 
 void CSpareParts::PostProcess(void) {
+    PROF_BEGIN();
+
     for (int i = 0; i < partsc; i++) {
-        parts[i]->PostProcess();
+        PROF_PART(parts[i]->GetId(), parts[i]->PostProcess());
     }
+
+    PROF_END(PROF_PARTS);
 }
 
 void CSpareParts::Reset(void) {
+    for (int b = 0; b < i2c_bus_count; b++) {
+        bus_i2c_rst(&i2c_bus[b]);
+    }
+    for (int b = 0; b < spi_bus_count; b++) {
+        bus_spi_rst(&spi_bus[b]);
+    }
     for (int i = 0; i < GetCount(); i++) {
         parts[i]->Reset();
         parts[i]->SetUpdate(1);
@@ -26,9 +26,15 @@
 #ifndef SPAREPARTS
 #define SPAREPARTS
 
+#include "../devices/bus_i2c.h"
+#include "../devices/bus_spi.h"
+#include "../devices/eth_vswitch.h"
 #include "../lib/part.h"
 
 #define IOINIT 110
+#define MAX_WATCH 2048
+#define MAX_I2C_BUS 8
+#define MAX_SPI_BUS 8
 
 class CSpareParts {
 public:
@@ -38,6 +44,7 @@ public:
 
     void UpdateAll(const int force = 0);
     int GetCount(void) { return partsc; };
+    int GetAlwaysUpdateCount(void) { return partsc_aup; };
     part* GetPart(const int partn);
     void DeleteParts(void);
     void ResetPullupBus(unsigned char pin);
@@ -71,6 +78,59 @@ public:
 
     const picpin* GetPinsValues(void);
     void SetPin(unsigned char pin, unsigned char value);
+
+    /**
+     * @brief  Return the board hardware UART that the UART of the part owner wired to rx_pin and tx_pin can exchange
+     * whole bytes with, or NULL to sample the pins. While linked both TX lines stay idle, so the link is only used when
+     * the owner is the only part wired to these pins and the oscilloscope is off. Only the simavr boards have UART
+     * links.
+     */
+    bitbang_uart_t* GetUARTLink(part* owner, const unsigned char rx_pin, const unsigned char tx_pin);
+
+    /**
+     * @brief  Attach the I2C device of a part to the shared bus of scl_pin and sda_pin, called in the part PreProcess.
+     * While attached the bus decodes the pins once for all its devices and calls Process only for the addressed one,
+     * so the part don't need to process the pins. Returns 1 if attached.
+     */
+    int AttachI2CBus(part* owner, const unsigned char scl_pin, const unsigned char sda_pin, bitbang_i2c_t* i2c,
+                     void (*Process)(void* arg), void* Arg);
+
+    /**
+     * @brief  Return the I2C bus of scl_pin and sda_pin that a board controller can drive by transactions, or NULL to
+     * drive the pins. While linked the pins stay idle, so the link is only used when all parts wired to these pins are
+     * attached to the bus and the oscilloscope is off.
+     */
+    bus_i2c_t* GetI2CLink(const unsigned char scl_pin, const unsigned char sda_pin);
+
+    /**
+     * @brief  Attach the SPI device of a part to the shared bus of sck_pin and copi_pin, called in the part PreProcess.
+     * While attached the bus calls io only when cs_pin is low and sets cipo_pin, so the part don't need to process the
+     * pins. Returns 1 if attached.
+     */
+    int AttachSPIBus(part* owner, const unsigned char sck_pin, const unsigned char copi_pin, const unsigned char cs_pin,
+                     const unsigned char cipo_pin,
+                     unsigned char (*io)(void* arg, const unsigned char sck, const unsigned char copi,
+                                         const unsigned char cs),
+                     void* Arg);
+
+    /**
+     * @brief  Return the SPI bus of sck_pin and copi_pin that a board controller can drive by transfers, or NULL to
+     * drive the pins. While linked sck, copi and cipo stay idle, so the link is only used when all parts wired to
+     * these pins are attached to the bus and the oscilloscope is off.
+     */
+    bus_spi_t* GetSPILink(const unsigned char sck_pin, const unsigned char copi_pin, const unsigned char cipo_pin);
+
+    /**
+     * @brief  Called by the board controller when a pin is written between transfers, ends the transfer of the linked
+     * SPI devices with the chip select inactive.
+     */
+    void UpdateSPILinkCS(void);
+
+    /**
+     * @brief  Return the virtual ethernet switch shared by the network parts of the simulation context
+     */
+    eth_vswitch_t* GetEthSwitch(void) { return &eth_switch; };
+
     void SetAPin(unsigned char pin, float value);
     void SetPinDOV(unsigned char pin, unsigned char ovalue);
     void SetPinDir(unsigned char pin, unsigned char dir);
@@ -121,6 +181,7 @@ public:
     lxString GetOldFilename(void) { return oldfname; };
 
 private:
+    int BusLink(part** owner, const int count, const unsigned char* pins, const int pinc);
     float scale;
     board* pboard;
     CWindow* Window;
@@ -136,13 +197,36 @@ private:
     part* parts[MAX_PARTS];
     int partsc_aup;              // aways update list
     part* parts_aup[MAX_PARTS];  // aways update list
+    int partsc_aio;              // any IO change update list
+    part* parts_aio[MAX_PARTS];  // any IO change update list
+    int watch_count;             // watched pins count
+    unsigned char watch_pins[256];
+    unsigned char watch_state[256];  // last value and direction of each pin
+    int watch_first[257];            // per pin subscribers in watch_list[watch_first[pin]..watch_first[pin+1]]
+    part* watch_list[MAX_WATCH];
+    unsigned int watch_mark[MAX_PARTS];
+    unsigned int watch_stamp;
     unsigned char pullup_bus[IOINIT];
     int pullup_bus_count;
     unsigned char pullup_bus_ptr[IOINIT];
+    int i2c_bus_count;  // i2c bus slots used, a slot is kept for the same pins
+    bus_i2c_t i2c_bus[MAX_I2C_BUS];
+    unsigned char i2c_bus_pins[MAX_I2C_BUS][2];  // scl and sda
+    part* i2c_bus_owner[MAX_I2C_BUS][BUS_I2C_MAX];
+    unsigned char i2c_bus_link[MAX_I2C_BUS];  // no other part wired to the bus pins
+    int spi_bus_count;  // spi bus slots used, a slot is kept for the same pins
+    bus_spi_t spi_bus[MAX_SPI_BUS];
+    unsigned char spi_bus_pins[MAX_SPI_BUS][2];  // sck and copi
+    unsigned char spi_bus_cipo[MAX_SPI_BUS][BUS_SPI_MAX];
+    part* spi_bus_owner[MAX_SPI_BUS][BUS_SPI_MAX];
+    unsigned char spi_bus_link[MAX_SPI_BUS];  // no other part wired to the bus pins
+    eth_vswitch_t eth_switch;
     int fdtype;
     lxString oldfname;
 };
 
-extern CSpareParts SpareParts;
+// SpareParts object of the simulation context of the calling thread, see simcontext.h
+extern __thread CSpareParts* SpareParts_ctx;
+#define SpareParts (*SpareParts_ctx)
 
 #endif  // SPAREPARTS
\ No newline at end of file
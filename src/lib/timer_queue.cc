@@ -0,0 +1,217 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "timer_queue.h"
+#include <stddef.h>
+
+// returns true if timer a expires before timer b
+static inline int TimerQueue_less(TimerQueue_t* tq, const uint32_t now, const int a, const int b) {
+    const uint32_t da = tq->Timers[a].Deadline - now;
+    const uint32_t db = tq->Timers[b].Deadline - now;
+    if (da != db) {
+        return da < db;
+    }
+    return a < b;
+}
+
+static inline void TimerQueue_swap(TimerQueue_t* tq, const int i, const int j) {
+    const int t = tq->Heap[i];
+    tq->Heap[i] = tq->Heap[j];
+    tq->Heap[j] = t;
+    tq->Timers[tq->Heap[i]].HeapPos = i;
+    tq->Timers[tq->Heap[j]].HeapPos = j;
+}
+
+static void TimerQueue_sift_up(TimerQueue_t* tq, const uint32_t now, int pos) {
+    while (pos > 0) {
+        const int parent = (pos - 1) >> 1;
+        if (!TimerQueue_less(tq, now, tq->Heap[pos], tq->Heap[parent])) {
+            break;
+        }
+        TimerQueue_swap(tq, pos, parent);
+        pos = parent;
+    }
+}
+
+static void TimerQueue_sift_down(TimerQueue_t* tq, const uint32_t now, int pos) {
+    while (1) {
+        const int left = (pos << 1) + 1;
+        const int right = left + 1;
+        int min = pos;
+        if ((left < tq->HeapCount) && TimerQueue_less(tq, now, tq->Heap[left], tq->Heap[min])) {
+            min = left;
+        }
+        if ((right < tq->HeapCount) && TimerQueue_less(tq, now, tq->Heap[right], tq->Heap[min])) {
+            min = right;
+        }
+        if (min == pos) {
+            break;
+        }
+        TimerQueue_swap(tq, pos, min);
+        pos = min;
+    }
+}
+
+static void TimerQueue_update_next(TimerQueue_t* tq, const uint32_t now) {
+    if (tq->HeapCount) {
+        tq->Next = tq->Timers[tq->Heap[0]].Deadline;
+    } else {
+        // no timer enabled, only reached again after counter wrap around
+        tq->Next = now;
+    }
+}
+
+// insert or reposition the timer in heap with a new deadline
+static void TimerQueue_schedule(TimerQueue_t* tq, const uint32_t now, const int t) {
+    Timers_t* tm = &tq->Timers[t];
+
+    tm->Deadline = now + tm->Reload;
+
+    if (tm->HeapPos < 0) {
+        tm->HeapPos = tq->HeapCount;
+        tq->Heap[tq->HeapCount] = t;
+        tq->HeapCount++;
+        TimerQueue_sift_up(tq, now, tm->HeapPos);
+    } else {
+        TimerQueue_sift_up(tq, now, tm->HeapPos);
+        TimerQueue_sift_down(tq, now, tm->HeapPos);
+    }
+}
+
+static void TimerQueue_remove(TimerQueue_t* tq, const uint32_t now, const int t) {
+    const int pos = tq->Timers[t].HeapPos;
+
+    if (pos < 0) {
+        return;
+    }
+
+    tq->HeapCount--;
+    if (pos != tq->HeapCount) {
+        TimerQueue_swap(tq, pos, tq->HeapCount);
+        TimerQueue_sift_up(tq, now, pos);
+        TimerQueue_sift_down(tq, now, pos);
+    }
+    tq->Timers[t].HeapPos = -1;
+}
+
+static inline int TimerQueue_valid(TimerQueue_t* tq, const int timer) {
+    return (timer > 0) && (timer <= MAX_TIMERS) && (tq->Timers[timer - 1].Callback != NULL);
+}
+
+void TimerQueue_init(TimerQueue_t* tq, const uint32_t now) {
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        tq->Timers[i].Deadline = 0;
+        tq->Timers[i].Reload = 1;
+        tq->Timers[i].Arg = NULL;
+        tq->Timers[i].Callback = NULL;
+        tq->Timers[i].Enabled = 0;
+        tq->Timers[i].HeapPos = -1;
+    }
+    tq->HeapCount = 0;
+    tq->Count = 0;
+    tq->Next = now;
+}
+
+int TimerQueue_register(TimerQueue_t* tq, const uint32_t now, const uint32_t reload, void (*Callback)(void* arg),
+                        void* arg) {
+    if ((tq->Count >= MAX_TIMERS) || (Callback == NULL)) {
+        return -1;
+    }
+
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        if (tq->Timers[i].Callback == NULL) {
+            tq->Timers[i].Callback = Callback;
+            tq->Timers[i].Arg = arg;
+            tq->Timers[i].Reload = reload ? reload : 1;
+            tq->Timers[i].Enabled = 1;
+            tq->Count++;
+            TimerQueue_schedule(tq, now, i);
+            TimerQueue_update_next(tq, now);
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+int TimerQueue_unregister(TimerQueue_t* tq, const uint32_t now, const int timer) {
+    if (!TimerQueue_valid(tq, timer)) {
+        return -1;
+    }
+
+    TimerQueue_remove(tq, now, timer - 1);
+    tq->Timers[timer - 1].Callback = NULL;  // free timer
+    tq->Timers[timer - 1].Arg = NULL;
+    tq->Timers[timer - 1].Enabled = 0;
+    tq->Count--;
+    TimerQueue_update_next(tq, now);
+    return 0;
+}
+
+int TimerQueue_change(TimerQueue_t* tq, const uint32_t now, const int timer, const uint32_t reload) {
+    if (!TimerQueue_valid(tq, timer)) {
+        return -1;
+    }
+
+    tq->Timers[timer - 1].Reload = reload ? reload : 1;
+    // the count restarts with the new value
+    if (tq->Timers[timer - 1].Enabled) {
+        TimerQueue_schedule(tq, now, timer - 1);
+        TimerQueue_update_next(tq, now);
+    }
+    return 0;
+}
+
+int TimerQueue_set_state(TimerQueue_t* tq, const uint32_t now, const int timer, const int enabled) {
+    if (!TimerQueue_valid(tq, timer)) {
+        return -1;
+    }
+
+    tq->Timers[timer - 1].Enabled = enabled;
+    if (enabled) {
+        TimerQueue_schedule(tq, now, timer - 1);
+    } else {
+        TimerQueue_remove(tq, now, timer - 1);
+    }
+    TimerQueue_update_next(tq, now);
+    return 0;
+}
+
+uint32_t TimerQueue_get_reload(TimerQueue_t* tq, const int timer) {
+    if ((timer > 0) && (timer <= MAX_TIMERS)) {
+        return tq->Timers[timer - 1].Reload;
+    }
+    return 0;
+}
+
+void TimerQueue_dispatch(TimerQueue_t* tq, const uint32_t now) {
+    while (tq->HeapCount && (tq->Timers[tq->Heap[0]].Deadline == now)) {
+        Timers_t* tm = &tq->Timers[tq->Heap[0]];
+        // reschedule before callback, the callback can change or disable the timer
+        tm->Deadline = now + tm->Reload;
+        TimerQueue_sift_down(tq, now, 0);
+        (*tm->Callback)(tm->Arg);
+    }
+    TimerQueue_update_next(tq, now);
+}
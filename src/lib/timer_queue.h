@@ -0,0 +1,72 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef TIMER_QUEUE_H
+#define TIMER_QUEUE_H
+
+#include <stdint.h>
+
+#define MAX_TIMERS 256
+
+/**
+ * @brief internal timer struct
+ *
+ */
+typedef struct {
+    uint32_t Deadline;  ///< instruction counter value of next expiration
+    uint32_t Reload;    ///< period in instructions
+    void* Arg;
+    void (*Callback)(void* arg);
+    int Enabled;
+    int HeapPos;  ///< position in the deadline heap, -1 if not queued
+} Timers_t;
+
+/**
+ * @brief deadline ordered timer queue
+ *
+ * Enabled timers are kept in a binary min-heap ordered by Deadline. Next holds
+ * the deadline of the heap top, so the caller only need to compare the
+ * instruction counter with Next on each step and call TimerQueue_dispatch on
+ * match. Deadlines are compared relative to the current instruction counter,
+ * so the 32 bits counter wrap around is handled.
+ */
+typedef struct {
+    Timers_t Timers[MAX_TIMERS];
+    int Heap[MAX_TIMERS];
+    int HeapCount;
+    int Count;
+    uint32_t Next;
+} TimerQueue_t;
+
+void TimerQueue_init(TimerQueue_t* tq, const uint32_t now);
+int TimerQueue_register(TimerQueue_t* tq, const uint32_t now, const uint32_t reload, void (*Callback)(void* arg),
+                        void* arg);
+int TimerQueue_unregister(TimerQueue_t* tq, const uint32_t now, const int timer);
+int TimerQueue_change(TimerQueue_t* tq, const uint32_t now, const int timer, const uint32_t reload);
+int TimerQueue_set_state(TimerQueue_t* tq, const uint32_t now, const int timer, const int enabled);
+uint32_t TimerQueue_get_reload(TimerQueue_t* tq, const int timer);
+void TimerQueue_dispatch(TimerQueue_t* tq, const uint32_t now);
+
+#endif  // TIMER_QUEUE_H
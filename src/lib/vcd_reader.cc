@@ -0,0 +1,456 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "vcd_reader.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN_
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define VCD_MAP_ALIGN (64 * 1024)
+
+static void vcd_map_release(vcd_map_t* m) {
+    if (m->base) {
+#ifdef _WIN_
+        UnmapViewOfFile((void*)m->base);
+#else
+        munmap((void*)m->base, m->len);
+#endif
+    }
+    m->base = NULL;
+    m->off = 0;
+    m->len = 0;
+}
+
+// returns a pointer to file offset off with at least need bytes mapped
+static const char* vcd_map_get(vcd_reader_t* vr, vcd_map_t* m, const uint64_t off, const size_t need) {
+    if (m->base && (off >= m->off) && ((off + need) <= (m->off + m->len))) {
+        return m->base + (off - m->off);
+    }
+
+    vcd_map_release(m);
+
+    const uint64_t moff = off & ~((uint64_t)VCD_MAP_ALIGN - 1);
+    uint64_t len = vr->fsize - moff;
+    if (len > VCD_READER_WINDOW) {
+        len = VCD_READER_WINDOW;
+    }
+
+#ifdef _WIN_
+    m->base = (const char*)MapViewOfFile(vr->mapping, FILE_MAP_READ, (DWORD)(moff >> 32), (DWORD)moff, len);
+#else
+    void* base = mmap(NULL, len, PROT_READ, MAP_SHARED, vr->file, moff);
+    if (base == MAP_FAILED) {
+        base = NULL;
+    } else {
+        madvise(base, len, MADV_SEQUENTIAL);
+    }
+    m->base = (const char*)base;
+#endif
+    if (!m->base) {
+        return NULL;
+    }
+    m->off = moff;
+    m->len = len;
+    return m->base + (off - moff);
+}
+
+// copy the line at pos to buff, returns the line size or -1 at end of file
+static int vcd_map_gets(vcd_reader_t* vr, vcd_map_t* m, uint64_t* pos, char* buff) {
+    if (*pos >= vr->fsize) {
+        return -1;
+    }
+
+    uint64_t avail = vr->fsize - *pos;
+    if (avail > (VCD_READER_LINE - 1)) {
+        avail = VCD_READER_LINE - 1;
+    }
+    const char* p = vcd_map_get(vr, m, *pos, avail);
+    if (!p) {
+        return -1;
+    }
+
+    int n = 0;
+    while ((n < (int)avail) && (p[n] != '\n')) {
+        n++;
+    }
+    memcpy(buff, p, n);
+    buff[n] = 0;
+    *pos += n;
+
+    // skip '\n' and the rest of too long lines
+    while (*pos < vr->fsize) {
+        p = vcd_map_get(vr, m, *pos, 1);
+        (*pos)++;
+        if ((!p) || (*p == '\n')) {
+            break;
+        }
+    }
+    return n;
+}
+
+static int vcd_reader_signal(vcd_reader_t* vr, const char* id) {
+    if (id[0] && (!id[1]) && ((unsigned char)id[0] < 128)) {
+        return vr->id1[(int)id[0]];
+    }
+    for (int i = 0; i < vr->signal_count; i++) {
+        if (!strcmp(vr->ids[i], id)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void vcd_reader_add_signal(vcd_reader_t* vr, const char* id) {
+    if ((vr->signal_count >= VCD_READER_SIGNALS) || (vcd_reader_signal(vr, id) >= 0)) {
+        return;
+    }
+    // the identifier is a token of a line read by vcd_map_gets, it is never truncated
+    strncpy(vr->ids[vr->signal_count], id, VCD_READER_ID_MAX - 1);
+    if (id[0] && (!id[1]) && ((unsigned char)id[0] < 128)) {
+        vr->id1[(int)id[0]] = vr->signal_count;
+    }
+    vr->signal_count++;
+}
+
+static float vcd_reader_unit(const char* unit) {
+    if (!strncmp(unit, "fs", 2))
+        return 1e-3;
+    if (!strncmp(unit, "ns", 2))
+        return 1e3;
+    if (!strncmp(unit, "us", 2))
+        return 1e6;
+    if (!strncmp(unit, "ms", 2))
+        return 1e9;
+    if (!strncmp(unit, "s", 1))
+        return 1e12;
+    return 1;  // ps
+}
+
+// read the declarations, returns 0 if the data section is found
+static int vcd_reader_header(vcd_reader_t* vr) {
+    vcd_map_t map = {NULL, 0, 0};
+    char buff[VCD_READER_LINE];
+    uint64_t pos = 0;
+    int section = 0;  // 1 $timescale, 2 $var
+    int field = 0;
+    float tvalue = 1;
+    int ret = -1;
+
+    vr->timescale = 1;
+
+    while (ret) {
+        const uint64_t start = pos;
+        if (vcd_map_gets(vr, &map, &pos, buff) < 0) {
+            break;
+        }
+        for (char* tk = strtok(buff, " \t\r"); tk; tk = strtok(NULL, " \t\r")) {
+            if (!strcmp(tk, "$end")) {
+                section = 0;
+            } else if (!strcmp(tk, "$enddefinitions")) {
+                vr->data = pos;
+                ret = 0;
+                break;
+            } else if ((tk[0] == '#') && (tk == buff)) {
+                // data without $enddefinitions
+                vr->data = start;
+                ret = 0;
+                break;
+            } else if (!strcmp(tk, "$timescale")) {
+                section = 1;
+            } else if (!strcmp(tk, "$var")) {
+                section = 2;
+                field = 0;
+            } else if (section == 1) {
+                char* unit;
+                if ((tk[0] >= '0') && (tk[0] <= '9')) {
+                    tvalue = strtod(tk, &unit);
+                } else {
+                    unit = tk;
+                }
+                if (*unit) {
+                    vr->timescale = tvalue * vcd_reader_unit(unit);
+                }
+            } else if (section == 2) {
+                field++;
+                if (field == 3) {  // type size id reference
+                    vcd_reader_add_signal(vr, tk);
+                }
+            }
+        }
+    }
+    vcd_map_release(&map);
+    return ret;
+}
+
+// read the next time block at cur->pos, returns 0 at the end of file
+static int vcd_cursor_next(vcd_reader_t* vr, vcd_cursor_t* cur) {
+    char buff[VCD_READER_LINE];
+    int block = 0;
+
+    cur->changed = 0;
+
+    while (1) {
+        const uint64_t start = cur->pos;
+        int n = vcd_map_gets(vr, &cur->map, &cur->pos, buff);
+        if (n < 0) {
+            break;
+        }
+        while (n && ((buff[n - 1] == '\r') || (buff[n - 1] == ' '))) {
+            buff[--n] = 0;
+        }
+        const char* p = buff;
+        while (*p == ' ') {
+            p++;
+        }
+        switch (*p) {
+            case '#':
+                if (block) {
+                    cur->pos = start;  // next block
+                    return 1;
+                }
+                cur->time = strtoull(p + 1, NULL, 10);
+                block = 1;
+                break;
+            case '0':
+            case '1':
+            case 'x':
+            case 'X':
+            case 'z':
+            case 'Z': {
+                // values before the first timestamp belong to the initial block
+                block = 1;
+                const int s = vcd_reader_signal(vr, p + 1);
+                if (s >= 0) {
+                    const uint64_t bit = ((uint64_t)1) << s;
+                    if (*p == '1') {
+                        cur->state |= bit;
+                    } else {
+                        cur->state &= ~bit;
+                    }
+                    cur->changed |= bit;
+                }
+            } break;
+            default:  // keywords, vectors and reals
+                break;
+        }
+    }
+    return block;
+}
+
+static void vcd_reader_lock(vcd_reader_t* vr) {
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_lock(&vr->lock);
+#endif
+}
+
+static void vcd_reader_unlock(vcd_reader_t* vr) {
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_unlock(&vr->lock);
+#endif
+}
+
+static void vcd_reader_index_add(vcd_reader_t* vr, const uint64_t offset, const uint64_t time, const uint64_t state) {
+    vcd_reader_lock(vr);
+    if (vr->index_count >= VCD_READER_INDEX) {
+        // keep memory bounded, drop every other entry
+        for (int i = 0; i < VCD_READER_INDEX / 2; i++) {
+            vr->index[i] = vr->index[2 * i];
+        }
+        vr->index_count = VCD_READER_INDEX / 2;
+        vr->index_stride *= 2;
+    }
+    vr->index[vr->index_count].offset = offset;
+    vr->index[vr->index_count].time = time;
+    vr->index[vr->index_count].state = state;
+    vr->index_count++;
+    vcd_reader_unlock(vr);
+}
+
+static void* vcd_reader_index_thread(void* arg) {
+    vcd_reader_t* vr = (vcd_reader_t*)arg;
+    vcd_cursor_t cur;
+    uint64_t mark = vr->data;
+
+    memset(&cur, 0, sizeof(cur));
+    cur.pos = vr->data;
+
+    while (!__atomic_load_n(&vr->stop, __ATOMIC_RELAXED)) {
+        const uint64_t offset = cur.pos;
+        const uint64_t state = cur.state;
+        if (!vcd_cursor_next(vr, &cur)) {
+            break;
+        }
+        if (offset >= mark) {
+            vcd_reader_index_add(vr, offset, cur.time, state);
+            mark = offset + vr->index_stride;
+        }
+    }
+    vcd_map_release(&cur.map);
+
+    vcd_reader_lock(vr);
+    vr->duration = cur.time;
+    vr->index_done = 1;
+    vcd_reader_unlock(vr);
+    return NULL;
+}
+
+static void vcd_reader_release(vcd_reader_t* vr) {
+    vcd_map_release(&vr->cur.map);
+#ifdef _WIN_
+    if (vr->mapping) {
+        CloseHandle(vr->mapping);
+    }
+    if (vr->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(vr->file);
+    }
+#else
+    if (vr->file >= 0) {
+        close(vr->file);
+    }
+#endif
+    vcd_reader_init(vr);
+}
+
+void vcd_reader_init(vcd_reader_t* vr) {
+    memset(vr, 0, sizeof(vcd_reader_t));
+#ifdef _WIN_
+    vr->file = INVALID_HANDLE_VALUE;
+    vr->mapping = NULL;
+#else
+    vr->file = -1;
+#endif
+    memset(vr->id1, -1, sizeof(vr->id1));
+    vr->index_stride = VCD_READER_STRIDE;
+    vr->timescale = 1;
+}
+
+int vcd_reader_open(vcd_reader_t* vr, const char* fname) {
+    vcd_reader_close(vr);
+    vcd_reader_init(vr);
+
+#ifdef _WIN_
+    LARGE_INTEGER size;
+    vr->file = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, NULL);
+    if ((vr->file == INVALID_HANDLE_VALUE) || (!GetFileSizeEx(vr->file, &size)) || (!size.QuadPart)) {
+        vcd_reader_release(vr);
+        return -1;
+    }
+    vr->fsize = size.QuadPart;
+    vr->mapping = CreateFileMapping(vr->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!vr->mapping) {
+        vcd_reader_release(vr);
+        return -1;
+    }
+#else
+    struct stat st;
+    vr->file = open(fname, O_RDONLY);
+    if ((vr->file < 0) || fstat(vr->file, &st) || (!st.st_size)) {
+        vcd_reader_release(vr);
+        return -1;
+    }
+    vr->fsize = st.st_size;
+#endif
+
+    if (vcd_reader_header(vr)) {
+        vcd_reader_release(vr);
+        return -1;
+    }
+
+#ifdef __EMSCRIPTEN__
+    vcd_reader_index_thread(vr);
+#else
+    pthread_mutex_init(&vr->lock, NULL);
+    if (pthread_create(&vr->thread, NULL, vcd_reader_index_thread, vr)) {
+        pthread_mutex_destroy(&vr->lock);
+        vcd_reader_release(vr);
+        return -1;
+    }
+#endif
+    vr->open = 1;
+
+    vcd_reader_seek(vr, 0);
+    return 0;
+}
+
+void vcd_reader_close(vcd_reader_t* vr) {
+    if (!vr->open) {
+        return;
+    }
+#ifndef __EMSCRIPTEN__
+    __atomic_store_n(&vr->stop, 1, __ATOMIC_RELAXED);
+    pthread_join(vr->thread, NULL);
+    pthread_mutex_destroy(&vr->lock);
+#endif
+    vcd_reader_release(vr);
+}
+
+int vcd_reader_is_open(vcd_reader_t* vr) {
+    return vr->open;
+}
+
+int vcd_reader_next(vcd_reader_t* vr) {
+    return vcd_cursor_next(vr, &vr->cur);
+}
+
+uint64_t vcd_reader_seek(vcd_reader_t* vr, const uint64_t time) {
+    uint64_t offset = vr->data;
+    uint64_t state = 0;
+
+    // last indexed block before time
+    vcd_reader_lock(vr);
+    int lo = 0;
+    int hi = vr->index_count - 1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) / 2;
+        if (vr->index[mid].time < time) {
+            offset = vr->index[mid].offset;
+            state = vr->index[mid].state;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    vcd_reader_unlock(vr);
+
+    vr->cur.pos = offset;
+    vr->cur.state = state;
+    vr->cur.time = 0;
+    while (1) {
+        state = vr->cur.state;
+        if (!vcd_cursor_next(vr, &vr->cur)) {
+            return vr->cur.state;  // end of file
+        }
+        if (vr->cur.time >= time) {
+            return state;
+        }
+    }
+}
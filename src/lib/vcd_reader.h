@@ -0,0 +1,129 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef VCD_READER_H
+#define VCD_READER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef _WIN_
+#include <windows.h>
+#endif
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#endif
+
+#define VCD_READER_SIGNALS 64                  ///< max number of signals
+#define VCD_READER_LINE 256                    ///< max size of a parsed line
+#define VCD_READER_ID_MAX VCD_READER_LINE      ///< max size of a signal identifier, any token of a line fits
+#define VCD_READER_WINDOW (16 * 1024 * 1024)   ///< size of the file mapping window
+#define VCD_READER_INDEX 4096                  ///< max number of index entries
+#define VCD_READER_STRIDE (256 * 1024)         ///< initial file distance between index entries
+
+/**
+ * @brief mapped window of the file
+ */
+typedef struct {
+    const char* base;
+    uint64_t off;  ///< file offset of base
+    size_t len;
+} vcd_map_t;
+
+/**
+ * @brief position in the data section and signals state
+ */
+typedef struct {
+    vcd_map_t map;
+    uint64_t pos;      ///< file offset of the next block
+    uint64_t time;     ///< time of the current block
+    uint64_t state;    ///< signals values after the current block, one bit per signal
+    uint64_t changed;  ///< signals changed in the current block
+} vcd_cursor_t;
+
+/**
+ * @brief sparse index entry, the block at offset and the state before it
+ */
+typedef struct {
+    uint64_t offset;
+    uint64_t time;
+    uint64_t state;
+} vcd_index_t;
+
+/**
+ * @brief streaming VCD file reader
+ *
+ * The file is read through a sliding memory mapped window and the value changes
+ * are parsed one time block at a time, so the memory used doesn't depend on the
+ * file size. A background thread builds a sparse timestamp index used to seek,
+ * when the index is full every other entry is dropped and the stride doubles.
+ */
+typedef struct {
+#ifdef _WIN_
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int file;
+#endif
+    uint64_t fsize;
+    uint64_t data;      ///< file offset of the data section
+    float timescale;    ///< time unit in ps
+    int signal_count;
+    char ids[VCD_READER_SIGNALS][VCD_READER_ID_MAX];
+    signed char id1[128];  ///< one character identifiers lookup
+    vcd_cursor_t cur;      ///< playback position
+    vcd_index_t index[VCD_READER_INDEX];
+    int index_count;
+    uint64_t index_stride;
+    uint64_t duration;  ///< last time of file, valid after index is done
+    int index_done;
+    int stop;
+    int open;
+#ifndef __EMSCRIPTEN__
+    pthread_t thread;
+    pthread_mutex_t lock;
+#endif
+} vcd_reader_t;
+
+void vcd_reader_init(vcd_reader_t* vr);
+
+/**
+ * @brief open the file, read the header and the first time block. Returns 0 on success
+ */
+int vcd_reader_open(vcd_reader_t* vr, const char* fname);
+void vcd_reader_close(vcd_reader_t* vr);
+int vcd_reader_is_open(vcd_reader_t* vr);
+
+/**
+ * @brief read the next time block, returns 0 at the end of file
+ */
+int vcd_reader_next(vcd_reader_t* vr);
+
+/**
+ * @brief move to the first time block at or after time using the index, returns the signals state before that block
+ */
+uint64_t vcd_reader_seek(vcd_reader_t* vr, const uint64_t time);
+
+#endif  // VCD_READER_H
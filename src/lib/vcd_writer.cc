@@ -0,0 +1,298 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "vcd_writer.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void vcd_writer_free(vcd_writer_t* vw) {
+    for (int i = 0; i < VCD_CHUNKS; i++) {
+        free(vw->chunks[i]);
+        vw->chunks[i] = NULL;
+    }
+    vw->buf = NULL;
+}
+
+#ifndef __EMSCRIPTEN__
+static void* vcd_writer_thread(void* arg) {
+    vcd_writer_t* vw = (vcd_writer_t*)arg;
+
+    pthread_mutex_lock(&vw->lock);
+    while (1) {
+        while ((vw->rd == vw->wr) && (!vw->stop)) {
+            pthread_cond_wait(&vw->cond, &vw->lock);
+        }
+        if (vw->rd == vw->wr) {
+            break;  // stop and queue empty
+        }
+        const int c = vw->rd % VCD_CHUNKS;
+        const int error = vw->error;
+        pthread_mutex_unlock(&vw->lock);
+
+        const int fail = (!error) && (fwrite(vw->chunks[c], 1, vw->size[c], vw->file) != vw->size[c]);
+
+        pthread_mutex_lock(&vw->lock);
+        if (fail) {
+            vw->error = 1;
+        }
+        if (vw->error) {
+            vw->dropped += vw->size[c];
+        }
+        vw->rd++;
+        pthread_cond_broadcast(&vw->cond);
+    }
+    pthread_mutex_unlock(&vw->lock);
+    return NULL;
+}
+#endif
+
+void vcd_writer_init(vcd_writer_t* vw) {
+    memset(vw, 0, sizeof(vcd_writer_t));
+}
+
+int vcd_writer_open(vcd_writer_t* vw, const char* fname) {
+    vcd_writer_init(vw);
+
+    for (int i = 0; i < VCD_CHUNKS; i++) {
+        vw->chunks[i] = (char*)malloc(VCD_CHUNK_SIZE);
+        if (!vw->chunks[i]) {
+            vcd_writer_free(vw);
+            return -1;
+        }
+    }
+
+    vw->file = fopen(fname, "w");
+    if (!vw->file) {
+        vcd_writer_free(vw);
+        return -1;
+    }
+    vw->buf = vw->chunks[0];
+
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_init(&vw->lock, NULL);
+    pthread_cond_init(&vw->cond, NULL);
+    if (pthread_create(&vw->thread, NULL, vcd_writer_thread, vw)) {
+        pthread_cond_destroy(&vw->cond);
+        pthread_mutex_destroy(&vw->lock);
+        fclose(vw->file);
+        vw->file = NULL;
+        vcd_writer_free(vw);
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+int vcd_writer_is_open(vcd_writer_t* vw) {
+    return vw->file != NULL;
+}
+
+static void vcd_writer_push(vcd_writer_t* vw) {
+    const int c = vw->wr % VCD_CHUNKS;
+
+    vw->size[c] = vw->pos;
+    vw->bytes += vw->pos;
+
+#ifdef __EMSCRIPTEN__
+    if ((!vw->error) && (fwrite(vw->buf, 1, vw->pos, vw->file) != vw->pos)) {
+        vw->error = 1;
+    }
+    if (vw->error) {
+        vw->dropped += vw->pos;
+    }
+#else
+    pthread_mutex_lock(&vw->lock);
+    if ((vw->wr + 1 - vw->rd) >= VCD_CHUNKS) {
+        vw->stalls++;
+        while (((vw->wr + 1 - vw->rd) >= VCD_CHUNKS) && (!vw->error)) {
+            pthread_cond_wait(&vw->cond, &vw->lock);
+        }
+    }
+    if (vw->error) {
+        // reuse the chunk, the file output is broken
+        vw->dropped += vw->pos;
+    } else {
+        vw->wr++;
+        pthread_cond_broadcast(&vw->cond);
+    }
+    pthread_mutex_unlock(&vw->lock);
+    vw->buf = vw->chunks[vw->wr % VCD_CHUNKS];
+#endif
+    vw->pos = 0;
+}
+
+// returns the write position with room for a record
+static inline char* vcd_writer_reserve(vcd_writer_t* vw) {
+    if (vw->pos > (VCD_CHUNK_SIZE - VCD_LINE_MAX)) {
+        vcd_writer_push(vw);
+    }
+    return vw->buf + vw->pos;
+}
+
+void vcd_writer_flush(vcd_writer_t* vw) {
+    if (vw->file && vw->pos) {
+        vcd_writer_push(vw);
+    }
+}
+
+void vcd_writer_close(vcd_writer_t* vw) {
+    if (!vw->file) {
+        return;
+    }
+
+    vcd_writer_flush(vw);
+
+#ifndef __EMSCRIPTEN__
+    pthread_mutex_lock(&vw->lock);
+    vw->stop = 1;
+    pthread_cond_broadcast(&vw->cond);
+    pthread_mutex_unlock(&vw->lock);
+    pthread_join(vw->thread, NULL);
+    pthread_cond_destroy(&vw->cond);
+    pthread_mutex_destroy(&vw->lock);
+#endif
+
+    if (fclose(vw->file)) {
+        vw->error = 1;
+    }
+    vw->file = NULL;
+    vcd_writer_free(vw);
+
+    if (vw->stalls || vw->dropped || vw->error) {
+        printf("PICSimLab: VCD writer %lu changes, %lu bytes, %lu stalls, %lu bytes dropped%s\n", vw->changes,
+               vw->bytes, vw->stalls, vw->dropped, vw->error ? " (write error)" : "");
+    }
+}
+
+void vcd_writer_printf(vcd_writer_t* vw, const char* fmt, ...) {
+    va_list ap;
+    char* p = vcd_writer_reserve(vw);
+
+    va_start(ap, fmt);
+    int n = vsnprintf(p, VCD_LINE_MAX, fmt, ap);
+    va_end(ap);
+
+    if (n < 0) {
+        return;
+    }
+    if (n >= VCD_LINE_MAX) {
+        n = VCD_LINE_MAX - 1;
+    }
+    vw->pos += n;
+}
+
+void vcd_writer_write(vcd_writer_t* vw, const void* data, unsigned int size) {
+    const char* d = (const char*)data;
+
+    while (size) {
+        vcd_writer_reserve(vw);
+        unsigned int n = VCD_CHUNK_SIZE - vw->pos;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(vw->buf + vw->pos, d, n);
+        vw->pos += n;
+        d += n;
+        size -= n;
+    }
+}
+
+void vcd_writer_time(vcd_writer_t* vw, const uint64_t time) {
+    char tmp[24];
+    int n = 0;
+    uint64_t t = time;
+    char* p = vcd_writer_reserve(vw);
+
+    do {
+        tmp[n++] = '0' + (t % 10);
+        t /= 10;
+    } while (t);
+
+    *p++ = '#';
+    while (n) {
+        *p++ = tmp[--n];
+    }
+    *p++ = '\n';
+    vw->pos = p - vw->buf;
+}
+
+void vcd_writer_bit(vcd_writer_t* vw, const int value, const char* id) {
+    char* p = vcd_writer_reserve(vw);
+
+    *p++ = '0' + value;
+    for (int i = 0; id[i] && (i < VCD_ID_MAX); i++) {
+        *p++ = id[i];
+    }
+    *p++ = '\n';
+    vw->pos = p - vw->buf;
+    vw->changes++;
+}
+
+void vcd_writer_real(vcd_writer_t* vw, const float value, const char* id) {
+    char* p = vcd_writer_reserve(vw);
+
+    const int n = snprintf(p, VCD_LINE_MAX, "r%f %.*s\n", value, VCD_ID_MAX, id);
+    if ((n > 0) && (n < VCD_LINE_MAX)) {
+        vw->pos += n;
+        vw->changes++;
+    }
+}
+
+void vcd_writer_id(unsigned int n, char* id) {
+    // printable characters from '!' to '~'
+    int i = 0;
+    do {
+        id[i++] = '!' + (n % 94);
+        n /= 94;
+    } while (n && (i < VCD_ID_MAX - 1));
+    id[i] = 0;
+}
+
+uint64_t vcd_writer_timescale(const double step_ps, char* str, const int size) {
+    static const char* units[6] = {"fs", "ps", "ns", "us", "ms", "s"};
+    const double step = step_ps * 1000.0;  // fs
+    double unit = 1;
+    int u = 0;
+
+    // largest unit of which the step is an integer multiple
+    while (u < 17) {
+        const double next = unit * 10;
+        const double mult = step / next;
+        if ((mult < 1) || (fabs(mult - floor(mult + 0.5)) > (mult * 1e-9))) {
+            break;
+        }
+        unit = next;
+        u++;
+    }
+
+    uint64_t mult = (uint64_t)floor(step / unit + 0.5);
+    if (!mult) {
+        mult = 1;
+    }
+    snprintf(str, size, "%i %s", (u % 3 == 0) ? 1 : ((u % 3 == 1) ? 10 : 100), units[u / 3]);
+    return mult;
+}
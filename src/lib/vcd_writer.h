@@ -0,0 +1,105 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef VCD_WRITER_H
+#define VCD_WRITER_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#endif
+
+#define VCD_CHUNK_SIZE (64 * 1024)  ///< size of each output chunk
+#define VCD_CHUNKS 32               ///< number of chunks in the queue
+#define VCD_LINE_MAX 256            ///< max size of one formatted record
+#define VCD_ID_MAX 8                ///< max size of a signal identifier
+
+/**
+ * @brief buffered VCD file writer
+ *
+ * Records are formatted in memory chunks by the simulation thread. Full chunks
+ * are queued to a writer thread that does the file output. When the queue is
+ * full the simulation waits for a free chunk (stall), after a file write error
+ * the next chunks are dropped. Both are reported when the file is closed.
+ */
+typedef struct {
+    FILE* file;
+    char* chunks[VCD_CHUNKS];
+    unsigned int size[VCD_CHUNKS];  ///< used size of each queued chunk
+    char* buf;                      ///< chunk being filled
+    unsigned int pos;               ///< used size of chunk being filled
+    unsigned long wr;               ///< chunks queued
+    unsigned long rd;               ///< chunks written to file
+    int stop;
+    int error;
+    unsigned long changes;  ///< value changes recorded
+    unsigned long bytes;    ///< bytes queued
+    unsigned long stalls;   ///< times the simulation waited for a free chunk
+    unsigned long dropped;  ///< bytes dropped after a write error
+#ifndef __EMSCRIPTEN__
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+} vcd_writer_t;
+
+void vcd_writer_init(vcd_writer_t* vw);
+int vcd_writer_open(vcd_writer_t* vw, const char* fname);
+void vcd_writer_close(vcd_writer_t* vw);
+int vcd_writer_is_open(vcd_writer_t* vw);
+
+/**
+ * @brief queue the chunk being filled, if not empty
+ */
+void vcd_writer_flush(vcd_writer_t* vw);
+
+/**
+ * @brief formatted output, used for header. Records bigger than VCD_LINE_MAX are truncated
+ */
+void vcd_writer_printf(vcd_writer_t* vw, const char* fmt, ...);
+
+/**
+ * @brief raw output of any size, used by binary formats
+ */
+void vcd_writer_write(vcd_writer_t* vw, const void* data, unsigned int size);
+
+void vcd_writer_time(vcd_writer_t* vw, const uint64_t time);
+void vcd_writer_bit(vcd_writer_t* vw, const int value, const char* id);
+void vcd_writer_real(vcd_writer_t* vw, const float value, const char* id);
+
+/**
+ * @brief build the identifier of signal n, ids are printable characters strings so there is no signals limit
+ */
+void vcd_writer_id(unsigned int n, char* id);
+
+/**
+ * @brief VCD timescale of a time step in ps. The VCD timescale is 1, 10 or 100 of an unit, so the step is written as
+ * a multiple of it. Writes the timescale text (e.g. "100 fs") to str and returns the step multiplier of the times
+ */
+uint64_t vcd_writer_timescale(const double step_ps, char* str, const int size);
+
+#endif  // VCD_WRITER_H
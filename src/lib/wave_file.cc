@@ -0,0 +1,777 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include "wave_file.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN_
+#define wave_fseek _fseeki64
+#define wave_ftell _ftelli64
+#else
+#define wave_fseek fseeko
+#define wave_ftell ftello
+#endif
+
+// values are stored in host order, all supported hosts are little endian
+
+static int wave_varint(unsigned char* p, uint64_t v) {
+    int n = 0;
+    while (v >= 0x80) {
+        p[n++] = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    p[n++] = v;
+    return n;
+}
+
+static int wave_varint_size(uint64_t v) {
+    int n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+static uint64_t wave_get_varint(const unsigned char** p, const unsigned char* end) {
+    uint64_t v = 0;
+    int shift = 0;
+    while ((*p < end) && (shift < 64)) {
+        const unsigned char b = *(*p)++;
+        v |= ((uint64_t)(b & 0x7F)) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    return v;
+}
+
+static uint64_t wave_read_varint(FILE* f) {
+    uint64_t v = 0;
+    int shift = 0;
+    int b;
+    while (((b = fgetc(f)) != EOF) && (shift < 64)) {
+        v |= ((uint64_t)(b & 0x7F)) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    return v;
+}
+
+static int wave_index_add(uint64_t** index, unsigned int* count, unsigned int* alloc, const uint64_t offset,
+                          const uint64_t time) {
+    if (*count >= *alloc) {
+        const unsigned int na = *alloc ? *alloc * 2 : 256;
+        uint64_t* ni = (uint64_t*)realloc(*index, na * 2 * sizeof(uint64_t));
+        if (!ni) {
+            return -1;
+        }
+        *index = ni;
+        *alloc = na;
+    }
+    (*index)[(*count) * 2] = offset;
+    (*index)[(*count) * 2 + 1] = time;
+    (*count)++;
+    return 0;
+}
+
+// writer
+
+void wave_writer_init(wave_writer_t* ww) {
+    memset(ww, 0, sizeof(wave_writer_t));
+    vcd_writer_init(&ww->out);
+}
+
+int wave_writer_open(wave_writer_t* ww, const char* fname, const double timescale) {
+    wave_writer_init(ww);
+    if (vcd_writer_open(&ww->out, fname)) {
+        return -1;
+    }
+    ww->timescale = timescale;
+    return 0;
+}
+
+int wave_writer_is_open(wave_writer_t* ww) {
+    return vcd_writer_is_open(&ww->out);
+}
+
+int wave_writer_add_signal(wave_writer_t* ww, const char* name, const int type) {
+    if (ww->started || (ww->signal_count >= WAVE_SIGNALS)) {
+        return -1;
+    }
+    strncpy(ww->name[ww->signal_count], name, WAVE_NAME_MAX - 1);
+    ww->type[ww->signal_count] = type;
+    return ww->signal_count++;
+}
+
+static void wave_writer_put(wave_writer_t* ww, const void* data, const unsigned int size) {
+    vcd_writer_write(&ww->out, data, size);
+    ww->offset += size;
+}
+
+static void wave_writer_put_varint(wave_writer_t* ww, const uint64_t v) {
+    unsigned char b[10];
+    wave_writer_put(ww, b, wave_varint(b, v));
+}
+
+static void wave_writer_start(wave_writer_t* ww) {
+    wave_writer_put(ww, "PWF1", 4);
+    wave_writer_put(ww, &ww->timescale, 8);
+    wave_writer_put_varint(ww, ww->signal_count);
+    for (int s = 0; s < ww->signal_count; s++) {
+        const unsigned int len = strlen(ww->name[s]);
+        wave_writer_put(ww, &ww->type[s], 1);
+        wave_writer_put_varint(ww, len);
+        wave_writer_put(ww, ww->name[s], len);
+    }
+    ww->started = 1;
+}
+
+static void wave_writer_block(wave_writer_t* ww) {
+    unsigned char state[WAVE_SIGNALS / 8 + WAVE_SIGNALS * 4];
+    unsigned int ssize = 0;
+    int nbits = 0;
+
+    if (!ww->block_open) {
+        return;
+    }
+
+    // state at block start
+    memset(state, 0, sizeof(state));
+    for (int s = 0; s < ww->signal_count; s++) {
+        if (ww->type[s] == WAVE_BIT) {
+            state[nbits >> 3] |= ww->sbits[s] << (nbits & 7);
+            nbits++;
+        }
+    }
+    ssize = (nbits + 7) >> 3;
+    for (int s = 0; s < ww->signal_count; s++) {
+        if (ww->type[s] == WAVE_REAL) {
+            memcpy(state + ssize, &ww->sreals[s], 4);
+            ssize += 4;
+        }
+    }
+
+    uint32_t size = wave_varint_size(ww->block_start) + wave_varint_size(ww->time - ww->block_start) + ssize;
+    for (int s = 0; s < ww->signal_count; s++) {
+        size += wave_varint_size(ww->changes[s].count) + wave_varint_size(ww->changes[s].size) + ww->changes[s].size;
+    }
+
+    wave_index_add(&ww->index, &ww->index_count, &ww->index_alloc, ww->offset, ww->block_start);
+
+    wave_writer_put(ww, "PWBK", 4);
+    wave_writer_put(ww, &size, 4);
+    wave_writer_put_varint(ww, ww->block_start);
+    wave_writer_put_varint(ww, ww->time - ww->block_start);
+    wave_writer_put(ww, state, ssize);
+    for (int s = 0; s < ww->signal_count; s++) {
+        wave_changes_t* c = &ww->changes[s];
+        wave_writer_put_varint(ww, c->count);
+        wave_writer_put_varint(ww, c->size);
+        wave_writer_put(ww, c->data, c->size);
+        c->size = 0;
+        c->count = 0;
+    }
+    ww->block_size = 0;
+    ww->block_open = 0;
+}
+
+// prepare signal s to record a change at time
+static wave_changes_t* wave_writer_change(wave_writer_t* ww, const uint64_t time, const int s, const unsigned int max) {
+    if (!ww->started) {
+        wave_writer_start(ww);
+    }
+    if ((ww->block_size >= WAVE_BLOCK_SIZE) && (time != ww->time)) {
+        wave_writer_block(ww);
+    }
+    if (!ww->block_open) {
+        memcpy(ww->sbits, ww->bits, ww->signal_count);
+        memcpy(ww->sreals, ww->reals, ww->signal_count * sizeof(float));
+        ww->block_start = time;
+        ww->block_open = 1;
+    }
+
+    wave_changes_t* c = &ww->changes[s];
+    if ((c->size + max) > c->alloc) {
+        const unsigned int na = c->alloc ? c->alloc * 2 : 256;
+        unsigned char* nd = (unsigned char*)realloc(c->data, na);
+        if (!nd) {
+            return NULL;
+        }
+        c->data = nd;
+        c->alloc = na;
+    }
+
+    const int n = wave_varint(c->data + c->size, time - (c->count ? c->last : ww->block_start));
+    c->size += n;
+    c->count++;
+    c->last = time;
+    ww->block_size += n;
+    ww->time = time;
+    ww->out.changes++;
+    return c;
+}
+
+void wave_writer_bit(wave_writer_t* ww, const uint64_t time, const int signal, const int value) {
+    const unsigned char v = value ? 1 : 0;
+
+    if ((signal < 0) || (signal >= ww->signal_count) || (ww->bits[signal] == v)) {
+        return;
+    }
+    if (wave_writer_change(ww, time, signal, 10)) {
+        ww->bits[signal] = v;
+    }
+}
+
+void wave_writer_real(wave_writer_t* ww, const uint64_t time, const int signal, const float value) {
+    if ((signal < 0) || (signal >= ww->signal_count) || (ww->reals[signal] == value)) {
+        return;
+    }
+    wave_changes_t* c = wave_writer_change(ww, time, signal, 14);
+    if (c) {
+        memcpy(c->data + c->size, &value, 4);
+        c->size += 4;
+        ww->block_size += 4;
+        ww->reals[signal] = value;
+    }
+}
+
+void wave_writer_flush(wave_writer_t* ww) {
+    if (!wave_writer_is_open(ww)) {
+        return;
+    }
+    wave_writer_block(ww);
+    vcd_writer_flush(&ww->out);
+}
+
+void wave_writer_close(wave_writer_t* ww) {
+    if (!wave_writer_is_open(ww)) {
+        return;
+    }
+
+    if (!ww->started) {
+        wave_writer_start(ww);
+    }
+    wave_writer_block(ww);
+
+    // seek index
+    const uint64_t footer = ww->offset;
+    uint64_t offset = 0;
+    uint64_t time = 0;
+    wave_writer_put(ww, "PWIX", 4);
+    wave_writer_put_varint(ww, ww->index_count);
+    for (unsigned int i = 0; i < ww->index_count; i++) {
+        wave_writer_put_varint(ww, ww->index[i * 2] - offset);
+        wave_writer_put_varint(ww, ww->index[i * 2 + 1] - time);
+        offset = ww->index[i * 2];
+        time = ww->index[i * 2 + 1];
+    }
+    wave_writer_put(ww, &footer, 8);
+    wave_writer_put(ww, "PWND", 4);
+
+    vcd_writer_close(&ww->out);
+
+    for (int s = 0; s < WAVE_SIGNALS; s++) {
+        free(ww->changes[s].data);
+    }
+    free(ww->index);
+    wave_writer_init(ww);
+}
+
+// reader
+
+void wave_reader_init(wave_reader_t* wr) {
+    memset(wr, 0, sizeof(wave_reader_t));
+}
+
+static int wave_reader_header(wave_reader_t* wr) {
+    char magic[4];
+
+    if ((fread(magic, 1, 4, wr->file) != 4) || memcmp(magic, "PWF1", 4) ||
+        (fread(&wr->timescale, 1, 8, wr->file) != 8)) {
+        return -1;
+    }
+    wr->signal_count = wave_read_varint(wr->file);
+    if (wr->signal_count > WAVE_SIGNALS) {
+        return -1;
+    }
+    for (int s = 0; s < wr->signal_count; s++) {
+        wr->type[s] = fgetc(wr->file);
+        unsigned int len = wave_read_varint(wr->file);
+        if (len >= WAVE_NAME_MAX) {
+            return -1;
+        }
+        if (fread(wr->name[s], 1, len, wr->file) != len) {
+            return -1;
+        }
+        wr->name[s][len] = 0;
+    }
+    return 0;
+}
+
+static int wave_reader_index(wave_reader_t* wr) {
+    unsigned int alloc = 0;
+    const uint64_t data = wave_ftell(wr->file);
+    uint64_t footer;
+    char magic[4];
+
+    // footer index
+    if ((!wave_fseek(wr->file, -12, SEEK_END)) && (fread(&footer, 1, 8, wr->file) == 8) &&
+        (fread(magic, 1, 4, wr->file) == 4) && (!memcmp(magic, "PWND", 4)) &&
+        (!wave_fseek(wr->file, footer, SEEK_SET)) && (fread(magic, 1, 4, wr->file) == 4) &&
+        (!memcmp(magic, "PWIX", 4))) {
+        const unsigned int count = wave_read_varint(wr->file);
+        uint64_t offset = 0;
+        uint64_t time = 0;
+        for (unsigned int i = 0; i < count; i++) {
+            offset += wave_read_varint(wr->file);
+            time += wave_read_varint(wr->file);
+            if (wave_index_add(&wr->index, &wr->index_count, &alloc, offset, time)) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    // file not closed, scan the blocks
+    uint64_t offset = data;
+    while (!wave_fseek(wr->file, offset, SEEK_SET)) {
+        unsigned char head[18];
+        const unsigned char* p = head + 8;
+        uint32_t size;
+        if ((fread(head, 1, 18, wr->file) < 9) || memcmp(head, "PWBK", 4)) {
+            break;
+        }
+        memcpy(&size, head + 4, 4);
+        if (wave_index_add(&wr->index, &wr->index_count, &alloc, offset, wave_get_varint(&p, head + 18))) {
+            return -1;
+        }
+        offset += 8 + size;
+    }
+    return 0;
+}
+
+// heap keys sort by time then signal, WAVE_SIGNALS fits in the low 8 bits
+#define WAVE_KEY(time, s) (((time) << 8) | (s))
+
+static void wave_reader_sift_down(wave_reader_t* wr, int pos) {
+    uint64_t* heap = wr->heap;
+    const uint64_t key = heap[pos];
+    while (1) {
+        int child = (pos << 1) + 1;
+        if (child >= wr->heap_count) {
+            break;
+        }
+        if (((child + 1) < wr->heap_count) && (heap[child + 1] < heap[child])) {
+            child++;
+        }
+        if (heap[child] >= key) {
+            break;
+        }
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    heap[pos] = key;
+}
+
+static void wave_reader_push(wave_reader_t* wr, const uint64_t key) {
+    int pos = wr->heap_count++;
+    while (pos > 0) {
+        const int parent = (pos - 1) >> 1;
+        if (wr->heap[parent] <= key) {
+            break;
+        }
+        wr->heap[pos] = wr->heap[parent];
+        pos = parent;
+    }
+    wr->heap[pos] = key;
+}
+
+static void wave_reader_state(wave_reader_t* wr, const int s) {
+    if (s < 64) {
+        const uint64_t bit = ((uint64_t)1) << s;
+        if (wr->values[s] != 0) {
+            wr->state |= bit;
+        } else {
+            wr->state &= ~bit;
+        }
+    }
+}
+
+// counting sort of the block changes by time offset, the signal order is kept for changes with the same time
+static int wave_reader_sort(wave_reader_t* wr, const uint32_t span, const unsigned int count) {
+    if ((span + 1) > wr->bucket_alloc) {
+        uint32_t* nb = (uint32_t*)realloc(wr->bucket, (span + 1) * sizeof(uint32_t));
+        if (!nb) {
+            return -1;
+        }
+        wr->bucket = nb;
+        wr->bucket_alloc = span + 1;
+    }
+    if (count > wr->ev_alloc) {
+        uint32_t* nt = (uint32_t*)realloc(wr->ev_time, count * sizeof(uint32_t));
+        if (nt) {
+            wr->ev_time = nt;
+        }
+        unsigned char* ns = (unsigned char*)realloc(wr->ev_signal, count);
+        if (ns) {
+            wr->ev_signal = ns;
+        }
+        float* nv = (float*)realloc(wr->ev_value, count * sizeof(float));
+        if (nv) {
+            wr->ev_value = nv;
+        }
+        if (!nt || !ns || !nv) {
+            return -1;
+        }
+        wr->ev_alloc = count;
+    }
+
+    memset(wr->bucket, 0, (span + 1) * sizeof(uint32_t));
+    for (int s = 0; s < wr->signal_count; s++) {
+        const wave_stream_t* st = &wr->stream[s];
+        const unsigned char* p = st->p;
+        const int step = (wr->type[s] == WAVE_BIT) ? 0 : 4;
+        uint64_t off = 0;
+        for (unsigned int k = 0; k < st->left; k++) {
+            off += wave_get_varint(&p, st->end);
+            p += step;
+            if ((off > span) || (p > st->end)) {
+                return -1;
+            }
+            wr->bucket[off]++;
+        }
+    }
+
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i <= span; i++) {
+        const uint32_t c = wr->bucket[i];
+        wr->bucket[i] = sum;
+        sum += c;
+    }
+
+    for (int s = 0; s < wr->signal_count; s++) {
+        const wave_stream_t* st = &wr->stream[s];
+        const unsigned char* p = st->p;
+        float v = wr->values[s];
+        uint32_t off = 0;
+        for (unsigned int k = 0; k < st->left; k++) {
+            off += wave_get_varint(&p, st->end);
+            if (wr->type[s] == WAVE_BIT) {
+                v = (v == 0);
+            } else {
+                memcpy(&v, p, 4);
+                p += 4;
+            }
+            const uint32_t pos = wr->bucket[off]++;
+            wr->ev_time[pos] = off;
+            wr->ev_signal[pos] = s;
+            wr->ev_value[pos] = v;
+        }
+    }
+    wr->ev_count = count;
+    return 0;
+}
+
+// load block n, the current time is the block start
+static int wave_reader_load(wave_reader_t* wr, const unsigned int n) {
+    char magic[4];
+    uint32_t size;
+
+    if ((n >= wr->index_count) || wave_fseek(wr->file, wr->index[n * 2], SEEK_SET) ||
+        (fread(magic, 1, 4, wr->file) != 4) || memcmp(magic, "PWBK", 4) || (fread(&size, 1, 4, wr->file) != 4)) {
+        return -1;
+    }
+    if (size > wr->buff_alloc) {
+        unsigned char* nb = (unsigned char*)realloc(wr->buff, size);
+        if (!nb) {
+            return -1;
+        }
+        wr->buff = nb;
+        wr->buff_alloc = size;
+    }
+    if (fread(wr->buff, 1, size, wr->file) != size) {
+        return -1;
+    }
+
+    const unsigned char* p = wr->buff;
+    const unsigned char* end = wr->buff + size;
+    const uint64_t start = wave_get_varint(&p, end);
+    const uint64_t span = wave_get_varint(&p, end);
+
+    int nbits = 0;
+    for (int s = 0; s < wr->signal_count; s++) {
+        if (wr->type[s] == WAVE_BIT) {
+            nbits++;
+        }
+    }
+    const unsigned char* bits = p;
+    p += (nbits + 7) >> 3;
+    nbits = 0;
+    for (int s = 0; s < wr->signal_count; s++) {
+        if (wr->type[s] == WAVE_BIT) {
+            wr->values[s] = (bits[nbits >> 3] >> (nbits & 7)) & 1;
+            nbits++;
+        } else {
+            memcpy(&wr->values[s], p, 4);
+            p += 4;
+        }
+        wave_reader_state(wr, s);
+    }
+
+    uint64_t count = 0;
+    memset(wr->stream, 0, sizeof(wr->stream));
+    for (int s = 0; (s < wr->signal_count) && (p < end); s++) {
+        wave_stream_t* st = &wr->stream[s];
+        st->left = wave_get_varint(&p, end);
+        const uint64_t len = wave_get_varint(&p, end);
+        if (len > (uint64_t)(end - p)) {
+            return -1;
+        }
+        st->end = p + len;
+        st->p = p;
+        p += len;
+        count += st->left;
+    }
+
+    wr->heap_count = 0;
+    wr->ev_count = 0;
+    wr->ev_pos = 0;
+    wr->ev_start = start;
+    if ((span > (count * 2 + 4096)) || (count > WAVE_BLOCK_SIZE * 2) || wave_reader_sort(wr, span, count)) {
+        wr->ev_count = 0;
+        for (int s = 0; s < wr->signal_count; s++) {
+            wave_stream_t* st = &wr->stream[s];
+            if (st->left) {
+                wave_reader_push(wr, WAVE_KEY(start + wave_get_varint(&st->p, st->end), s));
+            }
+        }
+    }
+
+    wr->time = start;
+    wr->changed_count = 0;
+    wr->block = n + 1;
+    return 0;
+}
+
+int wave_reader_open(wave_reader_t* wr, const char* fname) {
+    wave_reader_close(wr);
+    wave_reader_init(wr);
+
+    wr->file = fopen(fname, "rb");
+    if (!wr->file) {
+        return -1;
+    }
+    if (wave_reader_header(wr) || wave_reader_index(wr)) {
+        fclose(wr->file);
+        free(wr->index);
+        wave_reader_init(wr);
+        return -1;
+    }
+    wr->open = 1;
+    wave_reader_load(wr, 0);
+    return 0;
+}
+
+void wave_reader_close(wave_reader_t* wr) {
+    if (!wr->open) {
+        return;
+    }
+    fclose(wr->file);
+    free(wr->index);
+    free(wr->buff);
+    free(wr->bucket);
+    free(wr->ev_time);
+    free(wr->ev_signal);
+    free(wr->ev_value);
+    wave_reader_init(wr);
+}
+
+int wave_reader_is_open(wave_reader_t* wr) {
+    return wr->open;
+}
+
+int wave_reader_next(wave_reader_t* wr) {
+    while (!wr->heap_count && (wr->ev_pos >= wr->ev_count)) {
+        if (wave_reader_load(wr, wr->block)) {
+            return 0;
+        }
+    }
+
+    wr->changed_count = 0;
+    if (wr->ev_pos < wr->ev_count) {
+        const uint32_t off = wr->ev_time[wr->ev_pos];
+        wr->time = wr->ev_start + off;
+        while ((wr->ev_pos < wr->ev_count) && (wr->ev_time[wr->ev_pos] == off)) {
+            const int s = wr->ev_signal[wr->ev_pos];
+            wr->values[s] = wr->ev_value[wr->ev_pos];
+            wave_reader_state(wr, s);
+            wr->changed[wr->changed_count++] = s;
+            wr->ev_pos++;
+        }
+        return 1;
+    }
+
+    wr->time = wr->heap[0] >> 8;
+    while (wr->heap_count && ((wr->heap[0] >> 8) == wr->time)) {
+        const int s = wr->heap[0] & 0xFF;
+        wave_stream_t* st = &wr->stream[s];
+
+        if (wr->type[s] == WAVE_BIT) {
+            wr->values[s] = (wr->values[s] == 0);
+        } else if ((st->p + 4) <= st->end) {
+            memcpy(&wr->values[s], st->p, 4);
+            st->p += 4;
+        }
+        wave_reader_state(wr, s);
+        wr->changed[wr->changed_count++] = s;
+
+        // replace the heap top with the next change of the signal or remove it
+        st->left--;
+        if (st->left && (st->p < st->end)) {
+            wr->heap[0] = WAVE_KEY(wr->time + wave_get_varint(&st->p, st->end), (uint64_t)s);
+        } else {
+            wr->heap[0] = wr->heap[--wr->heap_count];
+        }
+        if (wr->heap_count) {
+            wave_reader_sift_down(wr, 0);
+        }
+    }
+    return 1;
+}
+
+uint64_t wave_reader_seek(wave_reader_t* wr, const uint64_t time) {
+    // last block starting before time
+    unsigned int n = 0;
+    int lo = 0;
+    int hi = wr->index_count - 1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) / 2;
+        if (wr->index[mid * 2 + 1] < time) {
+            n = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    if (wave_reader_load(wr, n)) {
+        return wr->state;
+    }
+    while (1) {
+        const uint64_t state = wr->state;
+        if (!wave_reader_next(wr)) {
+            return wr->state;  // end of file
+        }
+        if (wr->time >= time) {
+            return state;
+        }
+    }
+}
+
+// converter
+
+int wave_file_to_vcd(const char* in, const char* out) {
+    char ids[WAVE_SIGNALS][VCD_ID_MAX];
+    char tscale[32];
+
+    // the reader and the writer are too big for the stack
+    wave_reader_t* wr = (wave_reader_t*)malloc(sizeof(wave_reader_t));
+    vcd_writer_t* vw = (vcd_writer_t*)malloc(sizeof(vcd_writer_t));
+    if ((!wr) || (!vw)) {
+        free(wr);
+        free(vw);
+        return -1;
+    }
+    wave_reader_init(wr);
+    vcd_writer_init(vw);
+    if (wave_reader_open(wr, in)) {
+        free(wr);
+        free(vw);
+        return -1;
+    }
+    if (vcd_writer_open(vw, out)) {
+        wave_reader_close(wr);
+        free(wr);
+        free(vw);
+        return -1;
+    }
+
+    const uint64_t mult = vcd_writer_timescale(wr->timescale, tscale, 32);
+    vcd_writer_printf(vw, "$version Generated by PICSimLab $end\n$timescale %s $end\n", tscale);
+    vcd_writer_printf(vw, "$scope module logic $end\n");
+    for (int s = 0; s < wr->signal_count; s++) {
+        vcd_writer_id(s, ids[s]);
+        if (wr->type[s] == WAVE_BIT) {
+            vcd_writer_printf(vw, "$var wire 1 %s  %s $end\n", ids[s], wr->name[s]);
+        } else {
+            vcd_writer_printf(vw, "$var real 32 %s  %s $end\n", ids[s], wr->name[s]);
+        }
+    }
+    vcd_writer_printf(vw, "$upscope $end\n$enddefinitions $end\n");
+
+    // initial values
+    vcd_writer_printf(vw, "$dumpvars\n");
+    for (int s = 0; s < wr->signal_count; s++) {
+        if (wr->type[s] == WAVE_BIT) {
+            vcd_writer_bit(vw, wr->values[s] != 0, ids[s]);
+        } else {
+            vcd_writer_real(vw, wr->values[s], ids[s]);
+        }
+    }
+    vcd_writer_printf(vw, "$end\n");
+
+    while (wave_reader_next(wr)) {
+        vcd_writer_time(vw, wr->time * mult);
+        for (int i = 0; i < wr->changed_count; i++) {
+            const int s = wr->changed[i];
+            if (wr->type[s] == WAVE_BIT) {
+                vcd_writer_bit(vw, wr->values[s] != 0, ids[s]);
+            } else {
+                vcd_writer_real(vw, wr->values[s], ids[s]);
+            }
+        }
+    }
+
+    vcd_writer_close(vw);
+    wave_reader_close(wr);
+    const int ret = vw->error ? -1 : 0;
+    free(wr);
+    free(vw);
+    return ret;
+}
+
+int wave_file_name(const char* fname) {
+    const int len = strlen(fname);
+    if (len <= 4) {
+        return 0;
+    }
+    const char* ext = fname + len - 4;
+    return (ext[0] == '.') && ((ext[1] | 0x20) == 'p') && ((ext[2] | 0x20) == 'w') && ((ext[3] | 0x20) == 'f');
+}
@@ -0,0 +1,189 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#ifndef WAVE_FILE_H
+#define WAVE_FILE_H
+
+#include <stdint.h>
+#include "vcd_writer.h"
+
+/*
+ * PICSimLab waveform file (.pwf)
+ *
+ * All integers are little endian, varint are unsigned LEB128.
+ *
+ * header:
+ *   "PWF1"
+ *   f64      timescale in ps
+ *   varint   signal count
+ *   signals: u8 type (0 bit, 1 real), varint name size, name
+ *
+ * blocks, each one decodable alone:
+ *   "PWBK"
+ *   u32      payload size
+ *   varint   start time
+ *   varint   end time - start time
+ *   state at start time: bits of bit signals packed in bytes, f32 of each real signal
+ *   for each signal:
+ *     varint   change count
+ *     varint   changes size in bytes
+ *     changes: varint time delta (from start time, then from previous change), f32 value if real
+ *   bit signal changes toggle the value, so only the time is stored
+ *
+ * footer, the seek index:
+ *   "PWIX"
+ *   varint   block count
+ *   blocks:  varint offset delta, varint start time delta
+ *   u64      footer offset
+ *   "PWND"
+ *
+ * A block only ends when the time advances, so all changes of one time are in the same block.
+ * If the footer is missing (file not closed) the reader rebuilds the index scanning the blocks.
+ */
+
+#define WAVE_BIT 0
+#define WAVE_REAL 1
+
+#define WAVE_SIGNALS 256               ///< max number of signals
+#define WAVE_NAME_MAX 64               ///< max size of a signal name
+#define WAVE_BLOCK_SIZE (256 * 1024)   ///< max changes data size of one block
+
+typedef struct {
+    unsigned char* data;
+    unsigned int size;
+    unsigned int alloc;
+    unsigned int count;  ///< changes in block
+    uint64_t last;       ///< time of last change
+} wave_changes_t;
+
+/**
+ * @brief buffered binary waveform writer
+ *
+ * Changes are encoded in per signal buffers until the block size is reached, then the block is queued to the
+ * vcd_writer output thread.
+ */
+typedef struct {
+    vcd_writer_t out;
+    double timescale;
+    int signal_count;
+    unsigned char type[WAVE_SIGNALS];
+    char name[WAVE_SIGNALS][WAVE_NAME_MAX];
+    unsigned char bits[WAVE_SIGNALS];    ///< current bit values
+    float reals[WAVE_SIGNALS];           ///< current real values
+    unsigned char sbits[WAVE_SIGNALS];   ///< bit values at block start
+    float sreals[WAVE_SIGNALS];          ///< real values at block start
+    wave_changes_t changes[WAVE_SIGNALS];
+    unsigned int block_size;
+    uint64_t block_start;
+    int block_open;
+    uint64_t time;
+    int started;  ///< header written
+    uint64_t offset;
+    uint64_t* index;  ///< offset and start time of each block
+    unsigned int index_count;
+    unsigned int index_alloc;
+} wave_writer_t;
+
+/**
+ * @brief changes of one signal in the loaded block
+ */
+typedef struct {
+    const unsigned char* p;  ///< next value (real) or next time delta
+    const unsigned char* end;
+    unsigned int left;  ///< changes not read
+} wave_stream_t;
+
+/**
+ * @brief binary waveform reader
+ *
+ * One block is loaded at a time. The per signal change lists of dense blocks (time span near the number of changes)
+ * are sorted by time with a counting sort, the ones of sparse blocks are merged with a heap.
+ */
+typedef struct {
+    FILE* file;
+    double timescale;
+    int signal_count;
+    unsigned char type[WAVE_SIGNALS];
+    char name[WAVE_SIGNALS][WAVE_NAME_MAX];
+    uint64_t* index;  ///< offset and start time of each block
+    unsigned int index_count;
+    unsigned int block;  ///< next block to decode
+    unsigned char* buff;
+    unsigned int buff_alloc;
+    wave_stream_t stream[WAVE_SIGNALS];
+    uint64_t heap[WAVE_SIGNALS];  ///< next change time << 8 | signal, min-heap
+    int heap_count;
+    uint32_t* bucket;  ///< dense blocks: changes per time offset, then sort position
+    unsigned int bucket_alloc;
+    uint32_t* ev_time;  ///< dense blocks: changes sorted by time offset
+    unsigned char* ev_signal;
+    float* ev_value;
+    unsigned int ev_alloc;
+    unsigned int ev_count;
+    unsigned int ev_pos;
+    uint64_t ev_start;
+    int changed[WAVE_SIGNALS];  ///< signals changed at the current time
+    int changed_count;
+    float values[WAVE_SIGNALS];  ///< signal values after the current time
+    uint64_t time;               ///< current time
+    uint64_t state;              ///< first 64 bit signals values packed
+    int open;
+} wave_reader_t;
+
+void wave_writer_init(wave_writer_t* ww);
+int wave_writer_open(wave_writer_t* ww, const char* fname, const double timescale);
+int wave_writer_add_signal(wave_writer_t* ww, const char* name, const int type);
+void wave_writer_bit(wave_writer_t* ww, const uint64_t time, const int signal, const int value);
+void wave_writer_real(wave_writer_t* ww, const uint64_t time, const int signal, const float value);
+void wave_writer_flush(wave_writer_t* ww);
+void wave_writer_close(wave_writer_t* ww);
+int wave_writer_is_open(wave_writer_t* ww);
+
+void wave_reader_init(wave_reader_t* wr);
+int wave_reader_open(wave_reader_t* wr, const char* fname);
+void wave_reader_close(wave_reader_t* wr);
+int wave_reader_is_open(wave_reader_t* wr);
+
+/**
+ * @brief apply all changes of the next time, returns 0 at the end of file
+ */
+int wave_reader_next(wave_reader_t* wr);
+
+/**
+ * @brief move to the first time with changes at or after time, returns the bit signals state before that time
+ */
+uint64_t wave_reader_seek(wave_reader_t* wr, const uint64_t time);
+
+/**
+ * @brief convert a binary waveform file to VCD, returns 0 on success
+ */
+int wave_file_to_vcd(const char* in, const char* out);
+
+/**
+ * @brief returns 1 if the file name has the .pwf extension
+ */
+int wave_file_name(const char* fname);
+
+#endif  // WAVE_FILE_H
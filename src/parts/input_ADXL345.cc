@@ -47,6 +47,8 @@ cpart_ADXL345::cpart_ADXL345(const unsigned x, const unsigned y, const char* nam
       font_p(7, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     adxl345_init(&adxl);
     adxl345_rst(&adxl);
+    i2c_bus = 0;
+    spi_bus = 0;
 
     adxl_pins[0] = 0;
     adxl_pins[1] = 0;
@@ -214,6 +216,7 @@ void cpart_ADXL345::ReadPropertiesWindow(CPWindow* WProp) {
 void cpart_ADXL345::PreProcess(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
+    i2c_bus = 0;
     if ((adxl.i2c_mode) && (adxl_pins[0]) && (ppins[adxl_pins[0] - 1].value)) {
         unsigned char addr = 0x53;
 
@@ -227,17 +230,43 @@ void cpart_ADXL345::PreProcess(void) {
         if (adxl_pins[4]) {
             SpareParts.ResetPullupBus(adxl_pins[4] - 1);
         }
+
+        i2c_bus = SpareParts.AttachI2CBus(this, adxl_pins[5], adxl_pins[4], &adxl.bb_i2c, I2CProcess, this);
+    }
+
+    spi_bus = 0;
+    if (!adxl.i2c_mode) {
+        spi_bus = SpareParts.AttachSPIBus(this, adxl_pins[5], adxl_pins[4], adxl_pins[0], adxl_pins[3], SPIio, this);
+    }
+}
+
+// the SPI mode is selected at any time by the chip select, not only in PreProcess
+void cpart_ADXL345::I2CProcess(void* arg) {
+    cpart_ADXL345* part = (cpart_ADXL345*)arg;
+    const picpin* ppins = SpareParts.GetPinsValues();
+
+    if ((part->adxl.i2c_mode) && (ppins[part->adxl_pins[0] - 1].value)) {
+        adxl345_process_I2C(&part->adxl);
     }
 }
 
+unsigned char cpart_ADXL345::SPIio(void* arg, const unsigned char sck, const unsigned char copi,
+                                   const unsigned char cs) {
+    cpart_ADXL345* part = (cpart_ADXL345*)arg;
+
+    return adxl345_io_SPI(&part->adxl, copi, sck, cs);
+}
+
 void cpart_ADXL345::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
     if ((adxl_pins[5]) && (adxl_pins[4]) && (adxl_pins[0])) {
         if ((adxl.i2c_mode) && (ppins[adxl_pins[0] - 1].value)) {  // I2C mode
-            SpareParts.SetPullupBus(
-                adxl_pins[4] - 1, adxl345_io_I2C(&adxl, ppins[adxl_pins[5] - 1].value, ppins[adxl_pins[4] - 1].value));
-        } else {  // SPI mode
+            if (!i2c_bus) {
+                SpareParts.SetPullupBus(adxl_pins[4] - 1, adxl345_io_I2C(&adxl, ppins[adxl_pins[5] - 1].value,
+                                                                         ppins[adxl_pins[4] - 1].value));
+            }
+        } else if (!spi_bus) {  // SPI mode
             unsigned char ret = adxl345_io_SPI(&adxl, ppins[adxl_pins[4] - 1].value, ppins[adxl_pins[5] - 1].value,
                                                ppins[adxl_pins[0] - 1].value);
 
@@ -399,4 +428,9 @@ void cpart_ADXL345::OnMouseMove(uint inputId, uint button, uint x, uint y, uint
     }
 }
 
+void cpart_ADXL345::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, adxl);
+    SNAPSHOT_VAR(sn, ret_);
+}
+
 part_init(PART_ADXL345_Name, cpart_ADXL345, "Input");
@@ -43,6 +43,7 @@ public:
     void Process(void) override;
     void PostProcess(void) override;
     void Reset(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseButtonRelease(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseMove(uint inputId, uint button, uint x, uint y, uint state) override;
@@ -56,6 +57,8 @@ public:
     unsigned char getValues(unsigned char addr);
 
 private:
+    static void I2CProcess(void* arg);
+    static unsigned char SPIio(void* arg, const unsigned char sck, const unsigned char copi, const unsigned char cs);
     void RegisterRemoteControl(void) override;
     unsigned char adxl_pins[6];
     adxl345_t adxl;
@@ -65,6 +68,8 @@ private:
     double asens;
     double gsens;
     unsigned char ret_;
+    unsigned char i2c_bus;
+    unsigned char spi_bus;
 };
 
 #endif /* PART_ADXL345_H */
@@ -47,6 +47,7 @@ cpart_MPU6050::cpart_MPU6050(const unsigned x, const unsigned y, const char* nam
       font_p(7, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     mpu6050_init(&mpu);
     mpu6050_rst(&mpu);
+    i2c_bus = 0;
 
     mpu_pins[0] = 0;
     mpu_pins[1] = 0;
@@ -278,16 +279,22 @@ void cpart_MPU6050::PreProcess(void) {
     if (mpu_pins[1] > 0) {
         SpareParts.ResetPullupBus(mpu_pins[1] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2CBus(this, mpu_pins[0], mpu_pins[1], &mpu.bb_i2c, mpu6050_process_I2C, &mpu);
 }
 
 void cpart_MPU6050::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((mpu_pins[0] > 0) && (mpu_pins[1] > 0))
+    if ((mpu_pins[0] > 0) && (mpu_pins[1] > 0) && (!i2c_bus))
         SpareParts.SetPullupBus(mpu_pins[1] - 1,
                                 mpu6050_io_I2C(&mpu, ppins[mpu_pins[0] - 1].value, ppins[mpu_pins[1] - 1].value));
 }
 
+int cpart_MPU6050::GetWatchPins(unsigned char* wpins) {
+    return i2c_bus ? 0 : -1;  // processed by the I2C bus
+}
+
 void cpart_MPU6050::PostProcess(void) {
     if (mpu.update) {
         mpu.update = 0;
@@ -478,4 +485,8 @@ void cpart_MPU6050::OnMouseMove(uint inputId, uint button, uint x, uint y, uint
     }
 }
 
+void cpart_MPU6050::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, mpu);
+}
+
 part_init(PART_MPU6050_Name, cpart_MPU6050, "Input");
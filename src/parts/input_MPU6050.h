@@ -41,7 +41,9 @@ public:
     void DrawOutput(const unsigned int index) override;
     void PreProcess(void) override;
     void Process(void) override;
+    int GetWatchPins(unsigned char* wpins) override;
     void PostProcess(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseButtonRelease(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseMove(uint inputId, uint button, uint x, uint y, uint state) override;
@@ -63,6 +65,7 @@ private:
     unsigned char active[6];
     double asens;
     double gsens;
+    unsigned char i2c_bus;
 };
 
 #endif /* PART_MPU6050_H */
@@ -49,6 +49,7 @@ cpart_bmp180::cpart_bmp180(const unsigned x, const unsigned y, const char* name,
       font_p(6, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     sen_bmp180_init(&bmp180);
     sen_bmp180_rst(&bmp180);
+    i2c_bus = 0;
 
     input_pins[0] = 0;
     input_pins[1] = 0;
@@ -162,16 +163,23 @@ void cpart_bmp180::PreProcess(void) {
         sen_bmp180_setPressTemp(&bmp180, (4.0 * (200 - values[0]) + 300), (0.625 * (200 - values[1]) - 40));
         SpareParts.ResetPullupBus(input_pins[1] - 1);
     }
+
+    i2c_bus =
+        SpareParts.AttachI2CBus(this, input_pins[0], input_pins[1], &bmp180.bb_i2c, sen_bmp180_I2C_process, &bmp180);
 }
 
 void cpart_bmp180::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((input_pins[0] > 0) && (input_pins[1] > 0))
+    if ((input_pins[0] > 0) && (input_pins[1] > 0) && (!i2c_bus))
         SpareParts.SetPullupBus(input_pins[1] - 1, sen_bmp180_I2C_io(&bmp180, ppins[input_pins[0] - 1].value,
                                                                      ppins[input_pins[1] - 1].value));
 }
 
+int cpart_bmp180::GetWatchPins(unsigned char* wpins) {
+    return i2c_bus ? 0 : -1;  // processed by the I2C bus
+}
+
 void cpart_bmp180::OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) {
     switch (inputId) {
         case I_PO1:
@@ -229,4 +237,8 @@ void cpart_bmp180::OnMouseMove(uint inputId, uint button, uint x, uint y, uint s
     }
 }
 
+void cpart_bmp180::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, bmp180);
+}
+
 part_init(PART_BMP180_Name, cpart_bmp180, "Input");
@@ -47,6 +47,8 @@ cpart_bmp280::cpart_bmp280(const unsigned x, const unsigned y, const char* name,
       font_p(6, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     sen_bmp280_init(&bmp280);
     sen_bmp280_rst(&bmp280);
+    i2c_bus = 0;
+    spi_bus = 0;
 
     input_pins[0] = 0;
     input_pins[1] = 0;
@@ -177,6 +179,7 @@ void cpart_bmp280::ReadPropertiesWindow(CPWindow* WProp) {
 void cpart_bmp280::PreProcess(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
     sen_bmp280_setPressTemp(&bmp280, (4.0 * (200 - values[0]) + 300), (0.625 * (200 - values[1]) - 40));
+    i2c_bus = 0;
     if ((bmp280.i2c_mode) && (input_pins[2]) && (ppins[input_pins[2] - 1].value)) {
         unsigned char addr = 0x76;
 
@@ -190,17 +193,44 @@ void cpart_bmp280::PreProcess(void) {
         if (input_pins[1]) {
             SpareParts.ResetPullupBus(input_pins[1] - 1);
         }
+
+        i2c_bus = SpareParts.AttachI2CBus(this, input_pins[0], input_pins[1], &bmp280.bb_i2c, I2CProcess, this);
+    }
+
+    spi_bus = 0;
+    if (!bmp280.i2c_mode) {
+        spi_bus =
+            SpareParts.AttachSPIBus(this, input_pins[0], input_pins[1], input_pins[2], output_pins[0], SPIio, this);
+    }
+}
+
+// the SPI mode is selected at any time by the chip select, not only in PreProcess
+void cpart_bmp280::I2CProcess(void* arg) {
+    cpart_bmp280* part = (cpart_bmp280*)arg;
+    const picpin* ppins = SpareParts.GetPinsValues();
+
+    if ((part->bmp280.i2c_mode) && (ppins[part->input_pins[2] - 1].value)) {
+        sen_bmp280_I2C_process(&part->bmp280);
     }
 }
 
+unsigned char cpart_bmp280::SPIio(void* arg, const unsigned char sck, const unsigned char copi,
+                                  const unsigned char cs) {
+    cpart_bmp280* part = (cpart_bmp280*)arg;
+
+    return sen_bmp280_io_SPI(&part->bmp280, copi, sck, cs);
+}
+
 void cpart_bmp280::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
     if (input_pins[0] && input_pins[1] && (input_pins[2])) {
         if ((bmp280.i2c_mode) && (ppins[input_pins[2] - 1].value)) {  // I2C mode
-            SpareParts.SetPullupBus(input_pins[1] - 1, sen_bmp280_I2C_io(&bmp280, ppins[input_pins[0] - 1].value,
-                                                                         ppins[input_pins[1] - 1].value));
-        } else {  // SPI mode
+            if (!i2c_bus) {
+                SpareParts.SetPullupBus(input_pins[1] - 1, sen_bmp280_I2C_io(&bmp280, ppins[input_pins[0] - 1].value,
+                                                                             ppins[input_pins[1] - 1].value));
+            }
+        } else if (!spi_bus) {  // SPI mode
             unsigned char ret = sen_bmp280_io_SPI(&bmp280, ppins[input_pins[1] - 1].value,
                                                   ppins[input_pins[0] - 1].value, ppins[input_pins[2] - 1].value);
 
@@ -276,4 +306,9 @@ void cpart_bmp280::OnMouseMove(uint inputId, uint button, uint x, uint y, uint s
     }
 }
 
+void cpart_bmp280::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, bmp280);
+    SNAPSHOT_VAR(sn, ret_);
+}
+
 part_init(PART_BMP280_Name, cpart_bmp280, "Input");
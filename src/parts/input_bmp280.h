@@ -40,6 +40,7 @@ public:
     void DrawOutput(const unsigned int index) override;
     void PreProcess(void) override;
     void Process(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseButtonRelease(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseMove(uint inputId, uint button, uint x, uint y, uint state) override;
@@ -51,6 +52,8 @@ public:
     unsigned short GetOutputId(char* name) override;
 
 private:
+    static void I2CProcess(void* arg);
+    static unsigned char SPIio(void* arg, const unsigned char sck, const unsigned char copi, const unsigned char cs);
     unsigned char input_pins[3];
     unsigned char output_pins[1];
     sen_bmp280_t bmp280;
@@ -59,6 +62,8 @@ private:
     lxFont font;
     lxFont font_p;
     unsigned char ret_;
+    unsigned char i2c_bus;
+    unsigned char spi_bus;
 };
 
 #endif /* PART_v_H */
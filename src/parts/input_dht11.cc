@@ -242,4 +242,8 @@ void cpart_dht11::ReadPropertiesWindow(CPWindow* WProp) {
     output_pins[0] = GetPWCComboSelectedPin(WProp, "combo2");
 }
 
+void cpart_dht11::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, dht11);
+}
+
 part_init(PART_DHT11_Name, cpart_dht11, "Input");
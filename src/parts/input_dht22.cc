@@ -242,4 +242,8 @@ void cpart_dht22::ReadPropertiesWindow(CPWindow* WProp) {
     output_pins[0] = GetPWCComboSelectedPin(WProp, "combo2");
 }
 
+void cpart_dht22::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, dht22);
+}
+
 part_init(PART_DHT22_Name, cpart_dht22, "Input");
@@ -47,6 +47,7 @@ cpart_ds1621::cpart_ds1621(const unsigned x, const unsigned y, const char* name,
       font_p(6, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     sen_ds1621_init(&ds1621);
     sen_ds1621_rst(&ds1621);
+    i2c_bus = 0;
 
     input_pins[0] = 0;
     input_pins[1] = 0;
@@ -200,18 +201,25 @@ void cpart_ds1621::PreProcess(void) {
         // TODO set addr
         SpareParts.ResetPullupBus(input_pins[0] - 1);
     }
+
+    i2c_bus =
+        SpareParts.AttachI2CBus(this, input_pins[1], input_pins[0], &ds1621.bb_i2c, sen_ds1621_I2C_process, &ds1621);
 }
 
 void cpart_ds1621::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((input_pins[0] > 0) && (input_pins[1] > 0))
+    if ((input_pins[0] > 0) && (input_pins[1] > 0) && (!i2c_bus))
         SpareParts.SetPullupBus(input_pins[0] - 1, sen_ds1621_I2C_io(&ds1621, ppins[input_pins[1] - 1].value,
                                                                      ppins[input_pins[0] - 1].value));
 
     // TODO implement Tout output
 }
 
+int cpart_ds1621::GetWatchPins(unsigned char* wpins) {
+    return i2c_bus ? 0 : -1;  // processed by the I2C bus
+}
+
 void cpart_ds1621::OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) {
     switch (inputId) {
         case I_PO1:
@@ -249,4 +257,8 @@ void cpart_ds1621::OnMouseMove(uint inputId, uint button, uint x, uint y, uint s
     }
 }
 
+void cpart_ds1621::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, ds1621);
+}
+
 part_init(PART_DS1621_Name, cpart_ds1621, "Input");
@@ -40,6 +40,8 @@ public:
     void DrawOutput(const unsigned int index) override;
     void PreProcess(void) override;
     void Process(void) override;
+    int GetWatchPins(unsigned char* wpins) override;
+    void Snapshot(snapshot_t* sn) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseButtonRelease(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseMove(uint inputId, uint button, uint x, uint y, uint state) override;
@@ -57,6 +59,7 @@ private:
     unsigned char active;
     lxFont font;
     lxFont font_p;
+    unsigned char i2c_bus;
 };
 
 #endif /* PART_v_H */
@@ -211,4 +211,8 @@ void cpart_ds18b20::ReadPropertiesWindow(CPWindow* WProp) {
     output_pins[0] = GetPWCComboSelectedPin(WProp, "combo2");
 }
 
+void cpart_ds18b20::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, ds18b20);
+}
+
 part_init(PART_DHT22_Name, cpart_ds18b20, "Input");
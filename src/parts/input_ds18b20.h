@@ -39,6 +39,7 @@ public:
     ~cpart_ds18b20(void);
     void DrawOutput(const unsigned int index) override;
     void Reset(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void PreProcess(void) override;
     void Process(void) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
@@ -334,4 +334,14 @@ void cpart_encoder::ReadPropertiesWindow(CPWindow* WProp) {
     output_pins[2] = GetPWCComboSelectedPin(WProp, "combo5");
 }
 
+void cpart_encoder::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, value);
+    SNAPSHOT_VAR(sn, value_old);
+    SNAPSHOT_VAR(sn, p_BTN);
+    SNAPSHOT_VAR(sn, step);
+    SNAPSHOT_VAR(sn, count);
+    SNAPSHOT_VAR(sn, state);
+    SNAPSHOT_VAR(sn, dir);
+}
+
 part_init(PART_ENCODER_Name, cpart_encoder, "Input");
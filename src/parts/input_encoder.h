@@ -39,6 +39,7 @@ public:
     void DrawOutput(const unsigned int index) override;
     void PreProcess(void) override;
     void Process(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseButtonRelease(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseMove(uint inputId, uint button, uint x, uint y, uint state) override;
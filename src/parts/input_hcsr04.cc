@@ -222,4 +222,11 @@ void cpart_hcsr04::ReadPropertiesWindow(CPWindow* WProp) {
     pins[1] = GetPWCComboSelectedPin(WProp, "combo3");
 }
 
+void cpart_hcsr04::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, value);
+    SNAPSHOT_VAR(sn, count);
+    SNAPSHOT_VAR(sn, delay);
+    SNAPSHOT_VAR(sn, old_value);
+}
+
 part_init(PART_HCSR0404_Name, cpart_hcsr04, "Input");
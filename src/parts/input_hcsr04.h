@@ -38,6 +38,7 @@ public:
     ~cpart_hcsr04(void);
     void DrawOutput(const unsigned int index) override;
     void Process(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseButtonRelease(uint inputId, uint button, uint x, uint y, uint state) override;
     void OnMouseMove(uint inputId, uint button, uint x, uint y, uint state) override;
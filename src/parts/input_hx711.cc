@@ -148,6 +148,12 @@ void cpart_hx711::ReadPropertiesWindow(CPWindow* WProp) {
 
 void cpart_hx711::PreProcess(void) {
     sen_hx711_setWeight(&hx711, (0.5 * (200 - values[0])));
+
+    // DOUT goes low on the conversion ready without a clock edge
+    if (pins[0] && (ret_ != hx711.bb_spi.ret)) {
+        SpareParts.SetPin(pins[0], hx711.bb_spi.ret);
+        ret_ = hx711.bb_spi.ret;
+    }
 }
 
 void cpart_hx711::Process(void) {
@@ -163,6 +169,11 @@ void cpart_hx711::Process(void) {
     }
 }
 
+int cpart_hx711::GetWatchPins(unsigned char* wpins) {
+    wpins[0] = pins[1];
+    return 1;
+}
+
 void cpart_hx711::Reset(void) {
     sen_hx711_rst(&hx711);
 }
@@ -204,4 +215,9 @@ void cpart_hx711::OnMouseMove(uint inputId, uint button, uint x, uint y, uint st
     }
 }
 
+void cpart_hx711::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, hx711);
+    SNAPSHOT_VAR(sn, ret_);
+}
+
 part_init(PART_BMP280_Name, cpart_hx711, "Input");
@@ -511,4 +511,13 @@ void cpart_pbuttons::LoadImage(void) {
     }
 }
 
+void cpart_pbuttons::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, output_value);
+    snapshot_check(sn, &bounce.swcount, sizeof(bounce.swcount), "switches count");
+    unsigned char* bounce_data = bounce.bounce;
+    SNAPSHOT_VAR(sn, bounce);
+    bounce.bounce = bounce_data;
+    snapshot_data(sn, bounce.bounce, bounce.swcount);
+}
+
 part_init(PART_PUSH_BUTTONS_Name, cpart_pbuttons, "Input");
@@ -484,4 +484,13 @@ void cpart_switches::LoadImage(void) {
     }
 }
 
+void cpart_switches::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, output_value);
+    snapshot_check(sn, &bounce.swcount, sizeof(bounce.swcount), "switches count");
+    unsigned char* bounce_data = bounce.bounce;
+    SNAPSHOT_VAR(sn, bounce);
+    bounce.bounce = bounce_data;
+    snapshot_data(sn, bounce.bounce, bounce.swcount);
+}
+
 part_init(PART_SWITCHES_Name, cpart_switches, "Input");
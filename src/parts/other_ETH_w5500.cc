@@ -62,7 +62,7 @@ const char pin_values[10][10] = {
 };
  */
 
-static PCWProp pcwprop[11] = {{PCW_LABEL, "P1-V3.3       +3.3V"},
+static PCWProp pcwprop[12] = {{PCW_LABEL, "P1-V3.3       +3.3V"},
                               {PCW_LABEL, "P2-V5.0       +5V"},
                               {PCW_COMBO, "P3-MISO"},
                               {PCW_LABEL, "P4-GND ,GND"},
@@ -72,6 +72,7 @@ static PCWProp pcwprop[11] = {{PCW_LABEL, "P1-V3.3       +3.3V"},
                               {PCW_COMBO, "P8-INT"},
                               {PCW_COMBO, "P9-SCLK"},
                               {PCW_LABEL, "P10-NC"},
+                              {PCW_COMBO, "Network"},
                               {PCW_END, ""}};
 
 cpart_ETH_w5500::cpart_ETH_w5500(const unsigned x, const unsigned y, const char* name, const char* type)
@@ -87,17 +88,26 @@ cpart_ETH_w5500::cpart_ETH_w5500(const unsigned x, const unsigned y, const char*
     pins[5] = 0;
 
     _ret = -1;
+    _int = 0xFF;
+    spi_bus = 0;
 
     link = 1;
+    net = 0;
+    net_new = 0;
     SetPCWProperties(pcwprop);
 
     PinCount = 6;
     Pins = pins;
+
+    // sockets readiness and switch deliveries are served in simulated time
+    TimerID = PICSimLab.GetBoard()->TimerRegister_us(ETH_W5500_PROCESS_US, ProcessTimer, this);
 }
 
 cpart_ETH_w5500::~cpart_ETH_w5500(void) {
     delete Bitmap;
     canvas.Destroy();
+    PICSimLab.GetBoard()->TimerUnregister(TimerID);
+    SetNetwork(0);
     eth_w5500_end(&ethw);
 }
 
@@ -105,6 +115,41 @@ void cpart_ETH_w5500::Reset(void) {
     eth_w5500_rst(&ethw);
 }
 
+// all parts on the virtual switch share the same capture file
+void cpart_ETH_w5500::SetNetwork(const unsigned char mode) {
+    char fname[1024];
+
+    net_new = mode;
+    if (mode == net) {
+        return;
+    }
+
+    if (net == 2) {
+        eth_vswitch_capture_stop(SpareParts.GetEthSwitch());
+    }
+
+    net = mode;
+    if (eth_w5500_set_switch(&ethw, net ? SpareParts.GetEthSwitch() : NULL)) {
+        net = 0;
+        net_new = 0;
+        PICSimLab.RegisterError("ETH w5500: the virtual switch is full, using the host network");
+        return;
+    }
+
+    if (net == 2) {
+        if (PICSimLab.GetContextNumber()) {
+            snprintf(fname, 1023, "%s/picsimlab_vswitch_ctx%i.pcap", (const char*)lxGetTempDir("PICSimLab").c_str(),
+                     PICSimLab.GetContextNumber());
+        } else {
+            snprintf(fname, 1023, "%s/picsimlab_vswitch.pcap", (const char*)lxGetTempDir("PICSimLab").c_str());
+        }
+        if (eth_vswitch_capture_start(SpareParts.GetEthSwitch(), fname)) {
+            net = 1;
+            net_new = 1;
+        }
+    }
+}
+
 void cpart_ETH_w5500::DrawOutput(const unsigned int i) {
     int c;
     int n;
@@ -169,6 +214,10 @@ void cpart_ETH_w5500::DrawOutput(const unsigned int i) {
                         status[2] = 'E';
                         canvas.SetFgColor(255, 255, 255);
                         break;
+                    case SOCK_FIN_WAIT:
+                        status[2] = 'F';
+                        canvas.SetFgColor(255, 255, 255);
+                        break;
                     case SOCK_CLOSE_WAIT:
                         status[2] = 'W';
                         canvas.SetFgColor(255, 255, 255);
@@ -298,14 +347,18 @@ unsigned short cpart_ETH_w5500::GetOutputId(char* name) {
 lxString cpart_ETH_w5500::WritePreferences(void) {
     char prefs[256];
 
-    sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", pins[0], pins[1], pins[2], pins[3], pins[4], pins[5]);
+    sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", pins[0], pins[1], pins[2], pins[3], pins[4], pins[5], net_new);
 
     return prefs;
 }
 
 void cpart_ETH_w5500::ReadPreferences(lxString value) {
-    sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", &pins[0], &pins[1], &pins[2], &pins[3], &pins[4], &pins[5]);
+    unsigned char mode = 0;
 
+    sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", &pins[0], &pins[1], &pins[2], &pins[3], &pins[4],
+           &pins[5], &mode);
+
+    SetNetwork(mode);
     Reset();
 }
 
@@ -320,6 +373,19 @@ void cpart_ETH_w5500::ConfigurePropertiesWindow(CPWindow* WProp) {
     SetPCWComboWithPinNames(WProp, "combo7", pins[2]);
     SetPCWComboWithPinNames(WProp, "combo8", pins[5]);
     SetPCWComboWithPinNames(WProp, "combo9", pins[3]);
+
+    ((CCombo*)WProp->GetChildByName("combo11"))->SetItems("Host,Switch,Switch+pcap,");
+    switch (net_new) {
+        case 0:
+            ((CCombo*)WProp->GetChildByName("combo11"))->SetText("Host");
+            break;
+        case 1:
+            ((CCombo*)WProp->GetChildByName("combo11"))->SetText("Switch");
+            break;
+        case 2:
+            ((CCombo*)WProp->GetChildByName("combo11"))->SetText("Switch+pcap");
+            break;
+    }
 }
 
 void cpart_ETH_w5500::ReadPropertiesWindow(CPWindow* WProp) {
@@ -329,30 +395,78 @@ void cpart_ETH_w5500::ReadPropertiesWindow(CPWindow* WProp) {
     pins[2] = GetPWCComboSelectedPin(WProp, "combo7");
     pins[5] = GetPWCComboSelectedPin(WProp, "combo8");
     pins[3] = GetPWCComboSelectedPin(WProp, "combo9");
+
+    // the network is changed by PreProcess in the simulation thread
+    lxString mode = ((CCombo*)WProp->GetChildByName("combo11"))->GetText();
+    if (mode.compare("Switch") == 0) {
+        net_new = 1;
+    } else if (mode.compare("Switch+pcap") == 0) {
+        net_new = 2;
+    } else {
+        net_new = 0;
+    }
 }
 
 void cpart_ETH_w5500::PreProcess(void) {
-    eth_w5500_process(&ethw);
+    if (net_new != net) {
+        SetNetwork(net_new);
+    }
+    spi_bus = SpareParts.AttachSPIBus(this, pins[3], pins[0], pins[2], pins[4], SPIio, this);
+}
+
+unsigned char cpart_ETH_w5500::SPIio(void* arg, const unsigned char sck, const unsigned char copi,
+                                     const unsigned char cs) {
+    cpart_ETH_w5500* eth = (cpart_ETH_w5500*)arg;
+
+    return eth_w5500_io(&eth->ethw, copi, sck, cs, 1) & 0x01;
+}
+
+void cpart_ETH_w5500::ProcessTimer(void* arg) {
+    cpart_ETH_w5500* eth = (cpart_ETH_w5500*)arg;
+
+    eth_w5500_process(&eth->ethw);
+    eth->UpdateInt();  // Process runs only on the watched pins changes
+}
+
+void cpart_ETH_w5500::UpdateInt(void) {
+    // INT is active low, socket interrupts are raised by eth_w5500_process and cleared by the SPI writes
+    const unsigned char intp = !eth_w5500_get_int(&ethw);
+    if (pins[5] && (_int != intp)) {
+        SpareParts.SetPin(pins[5], intp);
+    }
+    _int = intp;
 }
 
 void cpart_ETH_w5500::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    unsigned short ret = 0;
+    if (!spi_bus) {
+        unsigned short ret = 0;
 
-    ret = eth_w5500_io(&ethw, ppins[pins[0] - 1].value, ppins[pins[3] - 1].value, ppins[pins[2] - 1].value,
-                       ppins[pins[1] - 1].value);
+        ret = eth_w5500_io(&ethw, ppins[pins[0] - 1].value, ppins[pins[3] - 1].value, ppins[pins[2] - 1].value,
+                           ppins[pins[1] - 1].value);
 
-    if (!ppins[pins[2] - 1].value)  // if CS is active, update output
-    {
-        if (_ret != ret) {
-            SpareParts.SetPin(pins[4], (ret & 0x01) > 0);
-            SpareParts.SetPin(pins[5], (ret & 0x02) > 0);
+        if (!ppins[pins[2] - 1].value)  // if CS is active, update output
+        {
+            if (_ret != ret) {
+                SpareParts.SetPin(pins[4], (ret & 0x01) > 0);
+            }
+            _ret = ret;
+        } else {
+            _ret = 0xFF;  // invalid value
         }
-        _ret = ret;
-    } else {
-        _ret = 0xFF;  // invalid value
     }
+    UpdateInt();
+}
+
+int cpart_ETH_w5500::GetWatchPins(unsigned char* wpins) {
+    if (spi_bus) {
+        // the SPI writes that clear the interrupts end with CS high
+        wpins[0] = pins[2];
+        return 1;
+    }
+    memcpy(wpins, pins, 4);
+    return 4;
 }
 
 void cpart_ETH_w5500::OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) {
@@ -40,6 +40,7 @@ public:
     void DrawOutput(const unsigned int index) override;
     void PreProcess(void) override;
     void Process(void) override;
+    int GetWatchPins(unsigned char* wpins) override;
     void PostProcess(void) override;
     void Reset(void) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
@@ -52,10 +53,19 @@ public:
 
 private:
     void RegisterRemoteControl(void) override;
+    void SetNetwork(const unsigned char mode);
+    void UpdateInt(void);
+    static unsigned char SPIio(void* arg, const unsigned char sck, const unsigned char copi, const unsigned char cs);
+    static void ProcessTimer(void* arg);
     unsigned char pins[6];
     eth_w5500_t ethw;
     unsigned char link;
+    unsigned char net;      // 0 host network, 1 virtual switch, 2 virtual switch with capture
+    unsigned char net_new;  // network selected in the properties window, applied by PreProcess
     unsigned short _ret;
+    unsigned char _int;
+    unsigned char spi_bus;
+    int TimerID;  // board timer of eth_w5500_process
     lxFont font;
     unsigned int sts[8][4];
 };
@@ -364,4 +364,11 @@ void cpart_IO_74xx573::PostProcess(void) {
                           (ppins[output_pins[7] - 1].oavalue + ((output_pins_alm[7] * 200.0) / NSTEPJ) + 55) / 2);
 }
 
+void cpart_IO_74xx573::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, lt8);
+    SNAPSHOT_VAR(sn, _ret);
+    SNAPSHOT_VAR(sn, output_pins_alm);
+    SNAPSHOT_VAR(sn, mcount);
+}
+
 part_init(PART_IO_74XX573_Name, cpart_IO_74xx573, "Other");
@@ -41,6 +41,7 @@ public:
     void PreProcess(void) override;
     void Process(void) override;
     void PostProcess(void) override;
+    void Snapshot(snapshot_t* sn) override;
     lxString GetPictureFileName(void) override { return lxT("../Common/IC20.svg"); };
     lxString GetMapFile(void) override { return lxT("../Common/IC20.map"); };
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
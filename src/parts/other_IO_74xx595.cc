@@ -326,4 +326,11 @@ void cpart_IO_74xx595::PostProcess(void) {
                           (ppins[output_pins[8] - 1].oavalue + ((output_pins_alm[8] * 200.0) / NSTEPJ) + 55) / 2);
 }
 
+void cpart_IO_74xx595::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, sr8);
+    SNAPSHOT_VAR(sn, _ret);
+    SNAPSHOT_VAR(sn, output_pins_alm);
+    SNAPSHOT_VAR(sn, mcount);
+}
+
 part_init(PART_IO_74XX595_Name, cpart_IO_74xx595, "Other");
@@ -112,6 +112,7 @@ cpart_IO_MCP23S17::cpart_IO_MCP23S17(const unsigned x, const unsigned y, const c
 
     io_MCP23X17_init(&mcp);
     io_MCP23X17_rst(&mcp);
+    spi_bus = 0;
 
     input_pins[0] = 0;
     input_pins[1] = 0;
@@ -358,6 +359,17 @@ void cpart_IO_MCP23S17::PreProcess(void) {
     memset(output_pins_alm, 0, 16 * sizeof(unsigned long));
     JUMPSTEPS_ = PICSimLab.GetJUMPSTEPS();
     mcount = JUMPSTEPS_;
+
+    // SO is not driven
+    spi_bus = SpareParts.AttachSPIBus(this, input_pins[1], input_pins[2], input_pins[0], 0, SPIio, this);
+}
+
+unsigned char cpart_IO_MCP23S17::SPIio(void* arg, const unsigned char sck, const unsigned char copi,
+                                       const unsigned char cs) {
+    cpart_IO_MCP23S17* mcp = (cpart_IO_MCP23S17*)arg;
+    const picpin* ppins = SpareParts.GetPinsValues();
+
+    return io_MCP23X17_SPI_io(&mcp->mcp, copi, sck, ppins[mcp->input_pins[7] - 1].value, cs);
 }
 
 void cpart_IO_MCP23S17::Process(void) {
@@ -377,8 +389,12 @@ void cpart_IO_MCP23S17::Process(void) {
      */
 
     // TODO only write support implemented
-    io_MCP23X17_SPI_io(&mcp, ppins[input_pins[2] - 1].value, ppins[input_pins[1] - 1].value,
-                       ppins[input_pins[7] - 1].value, ppins[input_pins[0] - 1].value);
+    if (!spi_bus) {
+        io_MCP23X17_SPI_io(&mcp, ppins[input_pins[2] - 1].value, ppins[input_pins[1] - 1].value,
+                           ppins[input_pins[7] - 1].value, ppins[input_pins[0] - 1].value);
+    } else if (!ppins[input_pins[7] - 1].value) {
+        io_MCP23X17_rst(&mcp);  // the reset don't depend on /CS
+    }
 
     if (_PA != mcp.regs[OLATA]) {
         SpareParts.WritePin(output_pins[0], (mcp.regs[OLATA] & 0x01) != 0);
@@ -480,4 +496,12 @@ void cpart_IO_MCP23S17::PostProcess(void) {
                           (ppins[output_pins[15] - 1].oavalue + ((output_pins_alm[15] * 200.0) / NSTEPJ) + 55) / 2);
 }
 
+void cpart_IO_MCP23S17::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, mcp);
+    SNAPSHOT_VAR(sn, _PA);
+    SNAPSHOT_VAR(sn, _PB);
+    SNAPSHOT_VAR(sn, output_pins_alm);
+    SNAPSHOT_VAR(sn, mcount);
+}
+
 part_init(PART_IO_MCP23S17_Name, cpart_IO_MCP23S17, "Other");
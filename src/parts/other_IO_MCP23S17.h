@@ -41,6 +41,7 @@ public:
     void PreProcess(void) override;
     void Process(void) override;
     void PostProcess(void) override;
+    void Snapshot(snapshot_t* sn) override;
     lxString GetPictureFileName(void) override { return lxT("../Common/IC28.svg"); };
     lxString GetMapFile(void) override { return lxT("../Common/IC28.map"); };
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
@@ -51,6 +52,7 @@ public:
     unsigned short GetOutputId(char* name) override;
 
 private:
+    static unsigned char SPIio(void* arg, const unsigned char sck, const unsigned char copi, const unsigned char cs);
     unsigned char input_pins[10];
     unsigned char output_pins[16];
     unsigned long output_pins_alm[16];
@@ -59,6 +61,7 @@ private:
     io_MCP23X17_t mcp;
     unsigned char _PA;
     unsigned char _PB;
+    unsigned char spi_bus;
     lxFont font;
 };
 
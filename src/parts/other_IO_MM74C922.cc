@@ -382,4 +382,11 @@ void cpart_IO_MM74C922::PostProcess(void) {
                           (ppins[input_pins[3] - 1].oavalue + ((pins_alm[7] * 200.0) / NSTEPJ) + 55) / 2);
 }
 
+void cpart_IO_MM74C922::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, kc);
+    SNAPSHOT_VAR(sn, _ret);
+    SNAPSHOT_VAR(sn, pins_alm);
+    SNAPSHOT_VAR(sn, mcount);
+}
+
 part_init(PART_IO_MM74C922_Name, cpart_IO_MM74C922, "Other");
@@ -67,6 +67,7 @@ cpart_IO_PCF8574::cpart_IO_PCF8574(const unsigned x, const unsigned y, const cha
 
     io_PCF8574_init(&ioe8);
     io_PCF8574_rst(&ioe8);
+    i2c_bus = 0;
 
     input_pins[0] = 0;
     input_pins[1] = 0;
@@ -286,26 +287,42 @@ void cpart_IO_PCF8574::PreProcess(void) {
     if (input_pins[1] > 0) {
         SpareParts.ResetPullupBus(input_pins[1] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2CBus(this, input_pins[0], input_pins[1], &ioe8.bb_i2c, I2CProcess, this);
+}
+
+// the bus event is delivered before the part Process, the input port is read from the pins here
+void cpart_IO_PCF8574::I2CProcess(void* arg) {
+    cpart_IO_PCF8574* pcf = (cpart_IO_PCF8574*)arg;
+
+    pcf->UpdateDataOut();
+    io_PCF8574_I2C_process(&pcf->ioe8);
+}
+
+void cpart_IO_PCF8574::UpdateDataOut(void) {
+    const picpin* ppins = SpareParts.GetPinsValues();
+
+    ioe8.dataOut = 0x00;
+    ioe8.dataOut |= ppins[output_pins[0] - 1].lsvalue;
+    ioe8.dataOut |= ppins[output_pins[1] - 1].lsvalue << 1;
+    ioe8.dataOut |= ppins[output_pins[2] - 1].lsvalue << 2;
+    ioe8.dataOut |= ppins[output_pins[3] - 1].lsvalue << 3;
+    ioe8.dataOut |= ppins[output_pins[4] - 1].lsvalue << 4;
+    ioe8.dataOut |= ppins[output_pins[5] - 1].lsvalue << 5;
+    ioe8.dataOut |= ppins[output_pins[6] - 1].lsvalue << 6;
+    ioe8.dataOut |= ppins[output_pins[7] - 1].lsvalue << 7;
+    ioe8.dataOut &= ioe8.dataIn;  // mask with input
 }
 
 void cpart_IO_PCF8574::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if (ioupdated) {
-        ioe8.dataOut = 0x00;
-        ioe8.dataOut |= ppins[output_pins[0] - 1].lsvalue;
-        ioe8.dataOut |= ppins[output_pins[1] - 1].lsvalue << 1;
-        ioe8.dataOut |= ppins[output_pins[2] - 1].lsvalue << 2;
-        ioe8.dataOut |= ppins[output_pins[3] - 1].lsvalue << 3;
-        ioe8.dataOut |= ppins[output_pins[4] - 1].lsvalue << 4;
-        ioe8.dataOut |= ppins[output_pins[5] - 1].lsvalue << 5;
-        ioe8.dataOut |= ppins[output_pins[6] - 1].lsvalue << 6;
-        ioe8.dataOut |= ppins[output_pins[7] - 1].lsvalue << 7;
-        ioe8.dataOut &= ioe8.dataIn;  // mask with input
-
-        if ((input_pins[0] > 0) && (input_pins[1] > 0))
+    if (PICSimLab.GetBoard()->GetIOUpdated()) {
+        if ((input_pins[0] > 0) && (input_pins[1] > 0) && (!i2c_bus)) {
+            UpdateDataOut();
             SpareParts.SetPullupBus(input_pins[1] - 1, io_PCF8574_I2C_io(&ioe8, ppins[input_pins[0] - 1].value,
                                                                          ppins[input_pins[1] - 1].value));
+        }
 
         if (_ret != ioe8.dataIn) {
             SpareParts.WritePin(output_pins[0], (ioe8.dataIn & 0x01) != 0);
@@ -370,4 +387,11 @@ void cpart_IO_PCF8574::PostProcess(void) {
                           (ppins[output_pins[8] - 1].oavalue + ((output_pins_alm[8] * 200.0) / NSTEPJ) + 55) / 2);
 }
 
+void cpart_IO_PCF8574::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, ioe8);
+    SNAPSHOT_VAR(sn, _ret);
+    SNAPSHOT_VAR(sn, output_pins_alm);
+    SNAPSHOT_VAR(sn, mcount);
+}
+
 part_init(PART_IO_PCF8574_Name, cpart_IO_PCF8574, "Other");
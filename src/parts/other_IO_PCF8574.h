@@ -41,6 +41,7 @@ public:
     void PreProcess(void) override;
     void Process(void) override;
     void PostProcess(void) override;
+    void Snapshot(snapshot_t* sn) override;
     lxString GetPictureFileName(void) override { return lxT("../Common/IC16.svg"); };
     lxString GetMapFile(void) override { return lxT("../Common/IC16.map"); };
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
@@ -52,6 +53,8 @@ public:
     const unsigned char* GetOutputPins(void);
 
 private:
+    static void I2CProcess(void* arg);
+    void UpdateDataOut(void);
     unsigned char input_pins[5];
     unsigned char output_pins[9];
     unsigned long output_pins_alm[9];
@@ -59,6 +62,7 @@ private:
     int JUMPSTEPS_;
     io_PCF8574_t ioe8;
     unsigned short _ret;
+    unsigned char i2c_bus;
 };
 
 #endif /* PART_IO_PCF8574_H */
@@ -58,6 +58,7 @@ cpart_MI2C_24CXXX::cpart_MI2C_24CXXX(const unsigned x, const unsigned y, const c
 
     mi2c_init(&mi2c, kbits);
     mi2c_rst(&mi2c);
+    i2c_bus = 0;
 
     input_pins[0] = 0;
     input_pins[1] = 0;
@@ -250,16 +251,22 @@ void cpart_MI2C_24CXXX::PreProcess(void) {
     if (input_pins[3] > 0) {
         SpareParts.ResetPullupBus(input_pins[3] - 1);
     }
+
+    i2c_bus = SpareParts.AttachI2CBus(this, input_pins[4], input_pins[3], &mi2c.bb_i2c, mi2c_process, &mi2c);
 }
 
 void cpart_MI2C_24CXXX::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((input_pins[3] > 0) && (input_pins[4] > 0))
+    if ((input_pins[3] > 0) && (input_pins[4] > 0) && (!i2c_bus))
         SpareParts.SetPullupBus(input_pins[3] - 1,
                                 mi2c_io(&mi2c, ppins[input_pins[4] - 1].value, ppins[input_pins[3] - 1].value));
 }
 
+int cpart_MI2C_24CXXX::GetWatchPins(unsigned char* wpins) {
+    return i2c_bus ? 0 : -1;  // processed by the I2C bus
+}
+
 void cpart_MI2C_24CXXX::OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) {
     switch (inputId) {
         case I_LOAD:
@@ -354,4 +361,12 @@ void cpart_MI2C_24CXXX::filedialog_EvOnClose(int retId) {
     }
 }
 
+void cpart_MI2C_24CXXX::Snapshot(snapshot_t* sn) {
+    snapshot_check(sn, &mi2c.SIZE, sizeof(mi2c.SIZE), "EEPROM size");
+    unsigned char* mi2c_data = mi2c.data;  // the memory can be reallocated after the save
+    SNAPSHOT_VAR(sn, mi2c);
+    mi2c.data = mi2c_data;
+    snapshot_data(sn, mi2c.data, mi2c.SIZE);
+}
+
 part_init(PART_MI2C_24CXXX_Name, cpart_MI2C_24CXXX, "Other");
@@ -41,6 +41,8 @@ public:
     void DrawOutput(const unsigned int index) override;
     void PreProcess(void) override;
     void Process(void) override;
+    int GetWatchPins(unsigned char* wpins) override;
+    void Snapshot(snapshot_t* sn) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
     void filedialog_EvOnClose(int retId) override;
@@ -57,6 +59,7 @@ private:
     char f_mi2c_name[200];
     char f_mi2c_tmp_name[200];
     FILE* f_mi2c;
+    unsigned char i2c_bus;
 };
 
 #endif /* PART_MI2C_24CXXX_H */
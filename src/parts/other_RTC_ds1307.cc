@@ -44,6 +44,7 @@ cpart_RTC_ds1307::cpart_RTC_ds1307(const unsigned x, const unsigned y, const cha
       font_p(6, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     rtc_ds1307_init(&rtc2);
     rtc_ds1307_rst(&rtc2);
+    i2c_bus = 0;
 
     input_pins[0] = 0;
     input_pins[1] = 0;
@@ -151,14 +152,24 @@ void cpart_RTC_ds1307::PreProcess(void) {
         SpareParts.ResetPullupBus(input_pins[0] - 1);
     }
     rtc_ds1307_update(&rtc2);
+
+    i2c_bus = SpareParts.AttachI2CBus(this, input_pins[1], input_pins[0], &rtc2.bb_i2c, rtc_ds1307_I2C_process, &rtc2);
 }
 
 void cpart_RTC_ds1307::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((input_pins[0] > 0) && (input_pins[1] > 0))
+    if ((input_pins[0] > 0) && (input_pins[1] > 0) && (!i2c_bus))
         SpareParts.SetPullupBus(input_pins[0] - 1, rtc_ds1307_I2C_io(&rtc2, ppins[input_pins[1] - 1].value,
                                                                      ppins[input_pins[0] - 1].value));
 }
 
+int cpart_RTC_ds1307::GetWatchPins(unsigned char* wpins) {
+    return i2c_bus ? 0 : -1;  // processed by the I2C bus
+}
+
+void cpart_RTC_ds1307::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, rtc2);
+}
+
 part_init(PART_RTC_DS1307_Name, cpart_RTC_ds1307, "Other");
@@ -40,6 +40,8 @@ public:
     void DrawOutput(const unsigned int index) override;
     void PreProcess(void) override;
     void Process(void) override;
+    int GetWatchPins(unsigned char* wpins) override;
+    void Snapshot(snapshot_t* sn) override;
     lxString GetPictureFileName(void) override { return lxT("../Common/IC8.svg"); };
     lxString GetMapFile(void) override { return lxT("../Common/IC8.map"); };
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
@@ -54,6 +56,7 @@ private:
     rtc_ds1307_t rtc2;
     lxFont font;
     lxFont font_p;
+    unsigned char i2c_bus;
 };
 
 #endif /* PART_v_H */
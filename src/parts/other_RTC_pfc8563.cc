@@ -42,6 +42,7 @@ cpart_RTC_pfc8563::cpart_RTC_pfc8563(const unsigned x, const unsigned y, const c
     : part(x, y, name, type, 8), font_p(6, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     rtc_pfc8563_init(&rtc);
     rtc_pfc8563_rst(&rtc);
+    i2c_bus = 0;
 
     input_pins[0] = 0;
     input_pins[1] = 0;
@@ -152,14 +153,24 @@ void cpart_RTC_pfc8563::PreProcess(void) {
         SpareParts.ResetPullupBus(input_pins[1] - 1);
     }
     rtc_pfc8563_update(&rtc);
+
+    i2c_bus = SpareParts.AttachI2CBus(this, input_pins[2], input_pins[1], &rtc.bb_i2c, rtc_pfc8563_I2C_process, &rtc);
 }
 
 void cpart_RTC_pfc8563::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
-    if ((input_pins[1] > 0) && (input_pins[2] > 0))
+    if ((input_pins[1] > 0) && (input_pins[2] > 0) && (!i2c_bus))
         SpareParts.SetPullupBus(input_pins[1] - 1, rtc_pfc8563_I2C_io(&rtc, ppins[input_pins[2] - 1].value,
                                                                       ppins[input_pins[1] - 1].value));
 }
 
+int cpart_RTC_pfc8563::GetWatchPins(unsigned char* wpins) {
+    return i2c_bus ? 0 : -1;  // processed by the I2C bus
+}
+
+void cpart_RTC_pfc8563::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, rtc);
+}
+
 part_init(PART_RTC_PFC8563_Name, cpart_RTC_pfc8563, "Other");
@@ -40,6 +40,8 @@ public:
     void DrawOutput(const unsigned int index) override;
     void PreProcess(void) override;
     void Process(void) override;
+    int GetWatchPins(unsigned char* wpins) override;
+    void Snapshot(snapshot_t* sn) override;
     lxString GetPictureFileName(void) override { return lxT("../Common/IC8.svg"); };
     lxString GetMapFile(void) override { return lxT("../Common/IC8.map"); };
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
@@ -53,6 +55,7 @@ private:
     unsigned char input_pins[4];
     rtc_pfc8563_t rtc;
     lxFont font_p;
+    unsigned char i2c_bus;
 };
 
 #endif /* PART_RTC_PFC8563_H */
@@ -249,4 +249,13 @@ void cpart_tempsys::ReadPropertiesWindow(CPWindow* WProp) {
     input_pins[3] = GetPWCComboSelectedPin(WProp, "combo4");
 }
 
+void cpart_tempsys::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, temp);
+    SNAPSHOT_VAR(sn, ref);
+    SNAPSHOT_VAR(sn, vtc);
+    SNAPSHOT_VAR(sn, vt);
+    SNAPSHOT_VAR(sn, rpmstp);
+    SNAPSHOT_VAR(sn, rpmc);
+}
+
 part_init(PART_TEMPSYS_Name, cpart_tempsys, "Other");
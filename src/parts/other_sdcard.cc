@@ -221,6 +221,11 @@ void cpart_SDCard::Process(void) {
     }
 }
 
+int cpart_SDCard::GetWatchPins(unsigned char* wpins) {
+    memcpy(wpins, pins, 3);
+    return 3;
+}
+
 void cpart_SDCard::OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) {
     switch (inputId) {
         case I_CONN:
@@ -252,4 +257,11 @@ void cpart_SDCard::filedialog_EvOnClose(int retId) {
     output_ids[O_FILE]->update = 1;
 }
 
+void cpart_SDCard::Snapshot(snapshot_t* sn) {
+    FILE* fd = sd.fd;  // the card file is kept, its contents are not part of the snapshot
+    SNAPSHOT_VAR(sn, sd);
+    sd.fd = fd;
+    SNAPSHOT_VAR(sn, _ret);
+}
+
 part_init(PART_SDCARD_Name, cpart_SDCard, "Other");
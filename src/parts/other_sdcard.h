@@ -39,7 +39,9 @@ public:
     ~cpart_SDCard(void);
     void DrawOutput(const unsigned int index) override;
     void Process(void) override;
+    int GetWatchPins(unsigned char* wpins) override;
     void Reset(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
     void ReadPropertiesWindow(CPWindow* WProp) override;
@@ -204,6 +204,7 @@ void cpart_UART::ReadPropertiesWindow(CPWindow* WProp) {
 }
 
 void cpart_UART::PreProcess(void) {
+    bitbang_uart_link(&sr.bb_uart, SpareParts.GetUARTLink(this, pins[0], pins[1]));
     Process();  // check for input updates
 }
 
@@ -844,4 +844,16 @@ void cpart_7s_display::ChangeType(unsigned char tp) {
     LoadImage();
 }
 
+void cpart_7s_display::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, lm1);
+    SNAPSHOT_VAR(sn, lm2);
+    SNAPSHOT_VAR(sn, lm3);
+    SNAPSHOT_VAR(sn, lm4);
+    SNAPSHOT_VAR(sn, alm1);
+    SNAPSHOT_VAR(sn, alm2);
+    SNAPSHOT_VAR(sn, alm3);
+    SNAPSHOT_VAR(sn, alm4);
+    SNAPSHOT_VAR(sn, mcount);
+}
+
 part_init(PART_7S_DISPLAY_Name, cpart_7s_display, "Output");
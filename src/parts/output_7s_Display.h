@@ -40,6 +40,7 @@ public:
     void PreProcess(void) override;
     void Process(void) override;
     void PostProcess(void) override;
+    void Snapshot(snapshot_t* sn) override;
     lxString GetPictureFileName(void) override;
     lxString GetMapFile(void) override;
     void ConfigurePropertiesWindow(CPWindow* wprop) override;
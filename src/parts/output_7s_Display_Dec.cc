@@ -745,4 +745,17 @@ void cpart_7s_display_dec::ChangeType(unsigned char tp) {
     LoadImage();
 }
 
+void cpart_7s_display_dec::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, lm1);
+    SNAPSHOT_VAR(sn, lm2);
+    SNAPSHOT_VAR(sn, lm3);
+    SNAPSHOT_VAR(sn, lm4);
+    SNAPSHOT_VAR(sn, alm1);
+    SNAPSHOT_VAR(sn, alm2);
+    SNAPSHOT_VAR(sn, alm3);
+    SNAPSHOT_VAR(sn, alm4);
+    SNAPSHOT_VAR(sn, mcount);
+    SNAPSHOT_VAR(sn, latchs);
+}
+
 part_init(PART_7S_DISPLAY_DEC_Name, cpart_7s_display_dec, "Output");
@@ -391,6 +391,11 @@ void cpart_LCD_hd44780::LoadImage(void) {
     lcd.update = 1;
 }
 
+void cpart_LCD_hd44780::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, lcd);
+    SNAPSHOT_VAR(sn, lcde);
+}
+
 part_init(PART_LCD_HD44780_Name, cpart_LCD_hd44780, "Output");
 
 // Combined hd44780 + IO PCF8574
@@ -50,6 +50,7 @@ public:
     lxString GetPictureFileName__(void) { return lxT("LCD hd44780/LCD_hd44780__.svg"); };
     lxString GetPictureFileName___(void) { return lxT("LCD hd44780/LCD_hd44780___.svg"); };
     void Reset(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
     void ReadPropertiesWindow(CPWindow* WProp) override;
     lxString WritePreferences(void) override;
@@ -783,4 +783,11 @@ void cpart_LCD_ili9341::LoadImage(void) {
     lcd_ili9341_update(&lcd);
 }
 
+void cpart_LCD_ili9341::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, lcd);
+    SNAPSHOT_VAR(sn, touch);
+    SNAPSHOT_VAR(sn, lret);
+    SNAPSHOT_VAR(sn, tret);
+}
+
 part_init(PART_LCD_iLI9341_Name, cpart_LCD_ili9341, "Output");
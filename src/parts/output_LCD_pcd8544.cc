@@ -188,6 +188,11 @@ void cpart_LCD_pcd8544::Process(void) {
     }
 }
 
+int cpart_LCD_pcd8544::GetWatchPins(unsigned char* wpins) {
+    memcpy(wpins, input_pins, 5);
+    return 5;
+}
+
 void cpart_LCD_pcd8544::PostProcess(void) {
     if (lcd.update)
         output_ids[O_LCD]->update = 1;
@@ -198,4 +203,8 @@ void cpart_LCD_pcd8544::LoadImage(void) {
     lcd_pcd8544_update(&lcd);
 }
 
+void cpart_LCD_pcd8544::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, lcd);
+}
+
 part_init(PART_LCD_PCD8544_Name, cpart_LCD_pcd8544, "Output");
@@ -39,7 +39,9 @@ public:
     ~cpart_LCD_pcd8544(void);
     void DrawOutput(const unsigned int index) override;
     void Process(void) override;
+    int GetWatchPins(unsigned char* wpins) override;
     void PostProcess(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
     void ReadPropertiesWindow(CPWindow* WProp) override;
     lxString WritePreferences(void) override;
@@ -196,6 +196,11 @@ void cpart_LCD_pcf8833::Process(void) {
     }
 }
 
+int cpart_LCD_pcf8833::GetWatchPins(unsigned char* wpins) {
+    memcpy(wpins, input_pins, 4);
+    return 4;
+}
+
 void cpart_LCD_pcf8833::PostProcess(void) {
     if (lcd.update)
         output_ids[O_LCD]->update = 1;
@@ -206,4 +211,8 @@ void cpart_LCD_pcf8833::LoadImage(void) {
     lcd_pcf8833_update(&lcd);
 }
 
+void cpart_LCD_pcf8833::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, lcd);
+}
+
 part_init(PART_LCD_PCF8833_Name, cpart_LCD_pcf8833, "Output");
@@ -46,6 +46,7 @@ cpart_LCD_ssd1306::cpart_LCD_ssd1306(const unsigned x, const unsigned y, const c
 
     lcd_ssd1306_init(&lcd);
     lcd_ssd1306_rst(&lcd);
+    i2c_bus = 0;
 
     input_pins[0] = 0;
     input_pins[1] = 0;
@@ -185,8 +186,13 @@ void cpart_LCD_ssd1306::ReadPropertiesWindow(CPWindow* WProp) {
 }
 
 void cpart_LCD_ssd1306::PreProcess(void) {
-    if ((type_com) && (input_pins[1] > 0)) {
-        SpareParts.ResetPullupBus(input_pins[1] - 1);
+    i2c_bus = 0;
+    if (type_com) {
+        if (input_pins[1] > 0) {
+            SpareParts.ResetPullupBus(input_pins[1] - 1);
+        }
+        i2c_bus =
+            SpareParts.AttachI2CBus(this, input_pins[0], input_pins[1], &lcd.bb_i2c, lcd_ssd1306_I2C_process, &lcd);
     }
 }
 
@@ -194,7 +200,7 @@ void cpart_LCD_ssd1306::Process(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
     if (type_com) {
-        if ((input_pins[0] > 0) && (input_pins[1] > 0))
+        if ((input_pins[0] > 0) && (input_pins[1] > 0) && (!i2c_bus))
             SpareParts.SetPullupBus(input_pins[1] - 1, lcd_ssd1306_I2C_io(&lcd, ppins[input_pins[1] - 1].value,
                                                                           ppins[input_pins[0] - 1].value));
 
@@ -210,6 +216,10 @@ void cpart_LCD_ssd1306::Process(void) {
     }
 }
 
+int cpart_LCD_ssd1306::GetWatchPins(unsigned char* wpins) {
+    return i2c_bus ? 0 : -1;  // processed by the I2C bus
+}
+
 void cpart_LCD_ssd1306::PostProcess(void) {
     if (lcd.update)
         output_ids[O_LCD]->update = 1;
@@ -220,4 +230,8 @@ void cpart_LCD_ssd1306::LoadImage(void) {
     lcd_ssd1306_update(&lcd);
 }
 
+void cpart_LCD_ssd1306::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, lcd);
+}
+
 part_init(PART_LCD_SSD1306_Name, cpart_LCD_ssd1306, "Output");
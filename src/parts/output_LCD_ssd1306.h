@@ -40,7 +40,9 @@ public:
     void DrawOutput(const unsigned int index) override;
     void PreProcess(void) override;
     void Process(void) override;
+    int GetWatchPins(unsigned char* wpins) override;
     void PostProcess(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
     void ReadPropertiesWindow(CPWindow* WProp) override;
     lxString WritePreferences(void) override;
@@ -54,6 +56,7 @@ private:
     lcd_ssd1306_t lcd;
     unsigned char type_com;
     lxFont font;
+    unsigned char i2c_bus;
 };
 
 #endif /* PART_LCD_SSD1306_H */
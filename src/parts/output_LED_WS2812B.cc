@@ -305,4 +305,12 @@ void cpart_led_ws2812b::PostProcess(void) {
         output_ids[O_LED]->update = 1;
 }
 
+void cpart_led_ws2812b::Snapshot(snapshot_t* sn) {
+    snapshot_check(sn, &led.nleds, sizeof(led.nleds), "LEDs count");
+    rgb_color* color = led.color;
+    SNAPSHOT_VAR(sn, led);
+    led.color = color;
+    snapshot_data(sn, led.color, led.nleds * sizeof(rgb_color));
+}
+
 part_init(PART_LED_WS2812B_Name, cpart_led_ws2812b, "Output");
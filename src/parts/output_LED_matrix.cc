@@ -203,9 +203,18 @@ void cpart_led_matrix::Process(void) {
     }
 }
 
+int cpart_led_matrix::GetWatchPins(unsigned char* wpins) {
+    memcpy(wpins, input_pins, 3);
+    return 3;
+}
+
 void cpart_led_matrix::PostProcess(void) {
     if (ldd.update)
         output_ids[O_LED]->update = 1;
 }
 
+void cpart_led_matrix::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, ldd);
+}
+
 part_init(PART_LED_MATRIX_Name, cpart_led_matrix, "Output");
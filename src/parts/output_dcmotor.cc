@@ -331,4 +331,14 @@ void cpart_dcmotor::ReadPropertiesWindow(CPWindow* WProp) {
     pins[4] = GetPWCComboSelectedPin(WProp, "combo5");
 }
 
+void cpart_dcmotor::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, value);
+    SNAPSHOT_VAR(sn, value_old);
+    SNAPSHOT_VAR(sn, step);
+    SNAPSHOT_VAR(sn, count);
+    SNAPSHOT_VAR(sn, state);
+    SNAPSHOT_VAR(sn, dir);
+    SNAPSHOT_VAR(sn, speed);
+}
+
 part_init(PART_DCMOTOR_Name, cpart_dcmotor, "Output");
@@ -193,4 +193,11 @@ void cpart_servo::LoadImage(void) {
 }
 
 // Register the part in PICSimLab spare parts list
+void cpart_servo::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, angle);
+    SNAPSHOT_VAR(sn, angle_);
+    SNAPSHOT_VAR(sn, in_);
+    SNAPSHOT_VAR(sn, time);
+}
+
 part_init(PART_SERVO_Name, cpart_servo, "Output");
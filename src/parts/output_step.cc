@@ -423,4 +423,11 @@ void cpart_step::ReadPropertiesWindow(CPWindow* WProp) {
     output_pins[0] = GetPWCComboSelectedPin(WProp, "combo5");
 }
 
+void cpart_step::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, steps);
+    SNAPSHOT_VAR(sn, angle);
+    SNAPSHOT_VAR(sn, input);
+    SNAPSHOT_VAR(sn, turns);
+}
+
 part_init(PART_STEP_Name, cpart_step, "Output");
@@ -382,4 +382,10 @@ void cpart_SignalGenerator::ReadPropertiesWindow(CPWindow* WProp) {
     input_pins[1] = GetPWCComboSelectedPin(WProp, "combo3");
 }
 
+void cpart_SignalGenerator::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, ts);
+    SNAPSHOT_VAR(sn, mcount);
+    SNAPSHOT_VAR(sn, lastd);
+}
+
 part_init(PART_SIGNALGENERATOR_Name, cpart_SignalGenerator, "Virtual");
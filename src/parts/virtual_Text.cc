@@ -81,15 +81,18 @@ void cpart_TEXT::LoadImage(void) {
 
     if (Bitmap) {
         delete Bitmap;
+        Bitmap = NULL;
     }
 
-    lxImage image(SpareParts.GetWindow());
+    if (SpareParts.GetWindow()) {
+        lxImage image(SpareParts.GetWindow());
 
-    image.CreateBlank(Width, Height, Orientation, Scale, Scale);
-    Bitmap = new lxBitmap(&image, SpareParts.GetWindow());
-    image.Destroy();
-    canvas.Destroy();
-    canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
+        image.CreateBlank(Width, Height, Orientation, Scale, Scale);
+        Bitmap = new lxBitmap(&image, SpareParts.GetWindow());
+        image.Destroy();
+        canvas.Destroy();
+        canvas.Create(SpareParts.GetWindow()->GetWWidget(), Bitmap);
+    }
 }
 
 void cpart_TEXT::DrawOutput(const unsigned int i) {
@@ -28,9 +28,13 @@
 
 #include <lxrad.h>
 #include "../lib/part.h"
+#include "../lib/vcd_writer.h"
+#include "../lib/wave_file.h"
 
 #define PART_VCD_DUMP_Name "VCD Dump"
 
+#define VCD_DUMP_PINS 64  // 8 pins on the part picture and the others set by list
+
 class cpart_VCD_Dump : public part {
 public:
     lxString GetAboutInfo(void) override { return lxT("L.C. Gamboa \n <lcgamboa@yahoo.com>"); };
@@ -39,6 +43,7 @@ public:
     void DrawOutput(const unsigned int index) override;
     void PreProcess(void) override;
     void Process(void) override;
+    int GetWatchPins(unsigned char* wpins) override;
     void PostProcess(void) override;
     void OnMouseButtonPress(uint inputId, uint button, uint x, uint y, uint state) override;
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
@@ -50,11 +55,19 @@ public:
 
 private:
     void RegisterRemoteControl(void) override;
-    unsigned char input_pins[8];
-    unsigned char old_value_pins[8];
+    void UpdateTime(void);
+    unsigned char input_pins[VCD_DUMP_PINS];
+    unsigned char old_value_pins[VCD_DUMP_PINS];
+    char ids[VCD_DUMP_PINS][VCD_ID_MAX];
     char f_vcd_name[200];
-    FILE* f_vcd;
+    char f_wave_name[200];
+    vcd_writer_t vcd;
+    wave_writer_t wave;
+    int wave_signals[VCD_DUMP_PINS];
+    unsigned char format;
     unsigned long vcd_count;
+    uint32_t vcd_ic;  // board instruction counter of vcd_count
+    uint64_t vcd_mult;  // VCD time units per step
     unsigned char rec;
     lxFont font;
     lxColor color1;
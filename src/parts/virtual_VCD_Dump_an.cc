@@ -32,56 +32,50 @@
 #include <emscripten.h>
 #endif
 
-static const char markers[] = "!$%&[()]";
-
 /* outputs */
 enum { O_P1, O_P2, O_P3, O_P4, O_P5, O_P6, O_P7, O_P8, O_L1, O_L2, O_L3, O_L4, O_L5, O_L6, O_L7, O_L8, O_NAME, O_REC };
 
 /*inputs*/
 enum { I_START, I_VIEW };
 
-static PCWProp pcwprop[9] = {{PCW_COMBO, "Pin 1"}, {PCW_COMBO, "Pin 2"}, {PCW_COMBO, "Pin 3"},
-                             {PCW_COMBO, "Pin 4"}, {PCW_COMBO, "Pin 5"}, {PCW_COMBO, "Pin 6"},
-                             {PCW_COMBO, "Pin 7"}, {PCW_COMBO, "Pin 8"}, {PCW_END, ""}};
+static PCWProp pcwprop[11] = {{PCW_COMBO, "Pin 1"}, {PCW_COMBO, "Pin 2"}, {PCW_COMBO, "Pin 3"},
+                              {PCW_COMBO, "Pin 4"}, {PCW_COMBO, "Pin 5"}, {PCW_COMBO, "Pin 6"},
+                              {PCW_COMBO, "Pin 7"}, {PCW_COMBO, "Pin 8"}, {PCW_COMBO, "Format"},
+                              {PCW_EDIT, "Pins 9-64"}, {PCW_END, ""}};
 
 cpart_VCD_Dump_an::cpart_VCD_Dump_an(const unsigned x, const unsigned y, const char* name, const char* type)
     : part(x, y, name, type), font(9, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     always_update = 1;
 
-    input_pins[0] = 0;
-    input_pins[1] = 0;
-    input_pins[2] = 0;
-    input_pins[3] = 0;
-    input_pins[4] = 0;
-    input_pins[5] = 0;
-    input_pins[6] = 0;
-    input_pins[7] = 0;
-
-    old_value_pins[0] = 2;
-    old_value_pins[1] = 2;
-    old_value_pins[2] = 2;
-    old_value_pins[3] = 2;
-    old_value_pins[4] = 2;
-    old_value_pins[5] = 2;
-    old_value_pins[6] = 2;
-    old_value_pins[7] = 2;
+    for (int i = 0; i < VCD_DUMP_AN_PINS; i++) {
+        input_pins[i] = 0;
+        old_value_pins[i] = 2;
+        vcd_writer_id(i, ids[i]);
+    }
 
     snprintf(f_vcd_name, 200, "%s/picsimlab-XXXXXX", (const char*)lxGetTempDir("PICSimLab").c_str());
     close(mkstemp(f_vcd_name));
     unlink(f_vcd_name);
 
+    strncpy(f_wave_name, f_vcd_name, 200);
     strncat(f_vcd_name, ".vcd", 200);
+    strncat(f_wave_name, ".pwf", 200);
 
-    f_vcd = fopen(f_vcd_name, "w");
-    fclose(f_vcd);
-    f_vcd = NULL;
+    FILE* f_vcd = fopen(f_vcd_name, "w");
+    if (f_vcd) {
+        fclose(f_vcd);
+    }
+    vcd_writer_init(&vcd);
+    wave_writer_init(&wave);
 
     rec = 0;
+    format = 0;
     vcd_count = 0;
+    vcd_mult = 1;
 
     SetPCWProperties(pcwprop);
 
-    PinCount = 8;
+    PinCount = VCD_DUMP_AN_PINS;
     Pins = input_pins;
 }
 
@@ -94,16 +88,16 @@ cpart_VCD_Dump_an::~cpart_VCD_Dump_an(void) {
     delete Bitmap;
     canvas.Destroy();
 
-    if (f_vcd) {
-        fclose(f_vcd);
-        f_vcd = NULL;
-    }
+    vcd_writer_close(&vcd);
+    wave_writer_close(&wave);
     unlink(f_vcd_name);
+    unlink(f_wave_name);
 }
 
 void cpart_VCD_Dump_an::DrawOutput(const unsigned int i) {
     int to;
     int r, g, b;
+    const char* fname;
 
     const picpin* ppins = SpareParts.GetPinsValues();
 
@@ -129,13 +123,14 @@ void cpart_VCD_Dump_an::DrawOutput(const unsigned int i) {
             canvas.SetColor(49, 61, 99);
             canvas.Rectangle(1, output[i].x1, output[i].y1, output[i].x2 - output[i].x1, output[i].y2 - output[i].y1);
             canvas.SetFgColor(255, 255, 255);
-            to = strlen(f_vcd_name) + 5;
+            fname = format ? f_wave_name : f_vcd_name;
+            to = strlen(fname) + 5;
             if (to < 48) {
                 to = 0;
             } else {
                 to = to - 48;
             }
-            canvas.RotatedText((f_vcd_name + to) + lxString(" (An)"), output[i].x1, output[i].y1, 0);
+            canvas.RotatedText((fname + to) + lxString(" (An)"), output[i].x1, output[i].y1, 0);
             break;
         case O_L1:
         case O_L2:
@@ -254,17 +249,36 @@ unsigned short cpart_VCD_Dump_an::GetOutputId(char* name) {
 }
 
 lxString cpart_VCD_Dump_an::WritePreferences(void) {
-    char prefs[256];
-
-    sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", input_pins[0], input_pins[1], input_pins[2],
-            input_pins[3], input_pins[4], input_pins[5], input_pins[6], input_pins[7], rec);
+    char prefs[512];
+    int len;
+
+    len = sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", input_pins[0], input_pins[1],
+                  input_pins[2], input_pins[3], input_pins[4], input_pins[5], input_pins[6], input_pins[7], rec, format);
+    // pins 9 and above after the format field
+    for (int i = 8; i < VCD_DUMP_AN_PINS; i++) {
+        len += sprintf(prefs + len, ",%hhu", input_pins[i]);
+    }
 
     return prefs;
 }
 
 void cpart_VCD_Dump_an::ReadPreferences(lxString value) {
-    sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu", &input_pins[0], &input_pins[1],
-           &input_pins[2], &input_pins[3], &input_pins[4], &input_pins[5], &input_pins[6], &input_pins[7], &rec);
+    int len = 0;
+
+    format = 0;  // old configurations don't have the format field
+    memset(input_pins + 8, 0, VCD_DUMP_AN_PINS - 8);
+    sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu%n", &input_pins[0], &input_pins[1],
+           &input_pins[2], &input_pins[3], &input_pins[4], &input_pins[5], &input_pins[6], &input_pins[7], &rec,
+           &format, &len);
+    // old configurations don't have the pins 9 and above
+    const char* ptr = value.c_str() + len;
+    for (int i = 8; (i < VCD_DUMP_AN_PINS) && len && (*ptr == ','); i++) {
+        int n = 0;
+        if (sscanf(ptr, ",%hhu%n", &input_pins[i], &n) != 1) {
+            break;
+        }
+        ptr += n;
+    }
 }
 
 void cpart_VCD_Dump_an::ConfigurePropertiesWindow(CPWindow* WProp) {
@@ -276,6 +290,15 @@ void cpart_VCD_Dump_an::ConfigurePropertiesWindow(CPWindow* WProp) {
     SetPCWComboWithPinNames(WProp, "combo6", input_pins[5]);
     SetPCWComboWithPinNames(WProp, "combo7", input_pins[6]);
     SetPCWComboWithPinNames(WProp, "combo8", input_pins[7]);
+
+    CCombo* combo = (CCombo*)WProp->GetChildByName("combo9");
+    combo->SetItems("VCD,PWF,");
+    if (format)
+        combo->SetText("PWF");
+    else
+        combo->SetText("VCD");
+
+    SetPCWEditWithPinList(WProp, "edit10", input_pins + 8, VCD_DUMP_AN_PINS - 8);
 }
 
 void cpart_VCD_Dump_an::ReadPropertiesWindow(CPWindow* WProp) {
@@ -287,78 +310,114 @@ void cpart_VCD_Dump_an::ReadPropertiesWindow(CPWindow* WProp) {
     input_pins[5] = GetPWCComboSelectedPin(WProp, "combo6");
     input_pins[6] = GetPWCComboSelectedPin(WProp, "combo7");
     input_pins[7] = GetPWCComboSelectedPin(WProp, "combo8");
+
+    format = (((CCombo*)WProp->GetChildByName("combo9"))->GetText().compare("PWF") == 0);
+
+    GetPWCEditPinList(WProp, "edit10", input_pins + 8, VCD_DUMP_AN_PINS - 8);
+    output_ids[O_NAME]->update = 1;
 }
 
 void cpart_VCD_Dump_an::PreProcess(void) {
-    if (rec && (f_vcd == NULL)) {
-        float tscale = 1.0e12 / PICSimLab.GetBoard()->MGetInstClockFreq();  // ns step
+    if (format) {
+        vcd_writer_close(&vcd);
+        if (rec && !wave_writer_is_open(&wave)) {
+            // ps step
+            if (wave_writer_open(&wave, f_wave_name, 1.0e12 / PICSimLab.GetBoard()->MGetInstClockFreq())) {
+                printf("PICSimLab: Error opening PWF file %s\n", f_wave_name);
+                rec = 0;
+                output_ids[O_REC]->update = 1;
+                return;
+            }
+            vcd_count = 0;
+
+            for (int i = 0; i < VCD_DUMP_AN_PINS; i++) {
+                wave_signals[i] = -1;
+                if (input_pins[i]) {
+                    char name[WAVE_NAME_MAX];
+                    snprintf(name, WAVE_NAME_MAX, "%i-%s", i + 1,
+                             (const char*)SpareParts.GetPinName(input_pins[i]).c_str());
+                    wave_signals[i] = wave_writer_add_signal(&wave, name, WAVE_REAL);
+                }
+            }
+        } else if (!rec) {
+            wave_writer_close(&wave);
+        }
+        return;
+    }
 
-        f_vcd = fopen(f_vcd_name, "w");
-        vcd_count = 0;
+    wave_writer_close(&wave);
+    if (rec && !vcd_writer_is_open(&vcd)) {
+        char tscale[32];
 
-        fprintf(f_vcd,
-                "$version Generated by PICSimLab $end\n"
-                "$timescale %ips $end\n"
-                "$scope module analogic $end\n",
-                (int)tscale);
-
-        if (input_pins[0])
-            fprintf(f_vcd, "$var real 32 !  1-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[0]).c_str());
-        if (input_pins[1])
-            fprintf(f_vcd, "$var real 32 $  2-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[1]).c_str());
-        if (input_pins[2])
-            fprintf(f_vcd, "$var real 32 %%  3-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[2]).c_str());
-        if (input_pins[3])
-            fprintf(f_vcd, "$var real 32 &  4-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[3]).c_str());
-        if (input_pins[4])
-            fprintf(f_vcd, "$var real 32 [  5-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[4]).c_str());
-        if (input_pins[5])
-            fprintf(f_vcd, "$var real 32 (  6-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[5]).c_str());
-        if (input_pins[6])
-            fprintf(f_vcd, "$var real 32 )  7-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[6]).c_str());
-        if (input_pins[7])
-            fprintf(f_vcd, "$var real 32 ]  8-%s $end\n", (const char*)SpareParts.GetPinName(input_pins[7]).c_str());
-
-        fprintf(f_vcd,
-                "$upscope $end\n"
-                "$enddefinitions $end\n");
-    } else if (!rec && (f_vcd != NULL)) {
-        if (f_vcd) {
-            fclose(f_vcd);
-            f_vcd = NULL;
+        if (vcd_writer_open(&vcd, f_vcd_name)) {
+            printf("PICSimLab: Error opening VCD file %s\n", f_vcd_name);
+            rec = 0;
+            output_ids[O_REC]->update = 1;
+            return;
+        }
+        vcd_count = 0;
+        // ps step
+        vcd_mult = vcd_writer_timescale(1.0e12 / PICSimLab.GetBoard()->MGetInstClockFreq(), tscale, 32);
+
+        vcd_writer_printf(&vcd,
+                          "$version Generated by PICSimLab $end\n"
+                          "$timescale %s $end\n"
+                          "$scope module analogic $end\n",
+                          tscale);
+
+        for (int i = 0; i < VCD_DUMP_AN_PINS; i++) {
+            if (input_pins[i]) {
+                vcd_writer_printf(&vcd, "$var real 32 %s  %i-%s $end\n", ids[i], i + 1,
+                                  (const char*)SpareParts.GetPinName(input_pins[i]).c_str());
+            }
         }
+
+        vcd_writer_printf(&vcd,
+                          "$upscope $end\n"
+                          "$enddefinitions $end\n");
+    } else if (!rec && vcd_writer_is_open(&vcd)) {
+        vcd_writer_close(&vcd);
     }
 }
 
 void cpart_VCD_Dump_an::Process(void) {
-    if (rec && f_vcd) {
+    if (rec && wave_writer_is_open(&wave)) {
+        const picpin* ppins = SpareParts.GetPinsValues();
+
+        vcd_count++;
+        for (int i = 0; i < VCD_DUMP_AN_PINS; i++) {
+            if (wave_signals[i] >= 0) {
+                const picpin* pin = &ppins[input_pins[i] - 1];
+                const float value = (pin->dir == PD_IN) ? pin->avalue : pin->oavalue / 51.0f;
+                wave_writer_real(&wave, vcd_count, wave_signals[i], value);
+            }
+        }
+    } else if (rec && vcd_writer_is_open(&vcd)) {
         const picpin* ppins = SpareParts.GetPinsValues();
 
         vcd_count++;
         int tprint = 0;
 
-        for (int i = 0; i < 8; i++) {
+        for (int i = 0; i < VCD_DUMP_AN_PINS; i++) {
             if (input_pins[i] != 0) {
                 if (ppins[input_pins[i] - 1].dir == PD_IN) {
                     if (ppins[input_pins[i] - 1].avalue != old_value_pins[i]) {
                         if (!tprint) {
                             tprint = 1;
-                            fprintf(f_vcd, "#%li\n", vcd_count);
+                            vcd_writer_time(&vcd, vcd_count * vcd_mult);
                         }
                         old_value_pins[i] = ppins[input_pins[i] - 1].avalue;
-                        fprintf(f_vcd, "r%f %c\n", old_value_pins[i], markers[i]);
-                        fflush(f_vcd);
+                        vcd_writer_real(&vcd, old_value_pins[i], ids[i]);
                     }
                 } else  // out
                 {
                     if (ppins[input_pins[i] - 1].oavalue != old_value_pins[i]) {
                         if (!tprint) {
                             tprint = 1;
-                            fprintf(f_vcd, "#%li\n", vcd_count);
+                            vcd_writer_time(&vcd, vcd_count * vcd_mult);
                         }
                         old_value_pins[i] = ppins[input_pins[i] - 1].oavalue;
-                        fprintf(f_vcd, "r%f %c\n", old_value_pins[i] / 51, markers[i]);
-                        fflush(f_vcd);
+                        vcd_writer_real(&vcd, old_value_pins[i] / 51, ids[i]);
                     }
                 }
             }
@@ -369,6 +428,10 @@ void cpart_VCD_Dump_an::Process(void) {
 void cpart_VCD_Dump_an::PostProcess(void) {
     const picpin* ppins = SpareParts.GetPinsValues();
 
+    // keep the file updated once per frame
+    vcd_writer_flush(&vcd);
+    wave_writer_flush(&wave);
+
     for (int i = 0; i < 8; i++) {
         if (input_pins[i] && (output_ids[O_L1 + i]->value != ppins[input_pins[i] - 1].oavalue)) {
             output_ids[O_L1 + i]->value = ppins[input_pins[i] - 1].oavalue;
@@ -384,6 +447,13 @@ void cpart_VCD_Dump_an::OnMouseButtonPress(uint inputId, uint button, uint x, ui
             output_ids[O_REC]->update = 1;
             break;
         case I_VIEW:
+            if (format) {
+                // waveform viewers only read VCD, the file is flushed on each frame
+                if (wave_file_to_vcd(f_wave_name, f_vcd_name)) {
+                    printf("PICSimLab: Error converting PWF file %s\n", f_wave_name);
+                    break;
+                }
+            }
 #ifdef __EMSCRIPTEN__
             EM_ASM_(
                 {
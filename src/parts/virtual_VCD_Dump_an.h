@@ -28,9 +28,13 @@
 
 #include <lxrad.h>
 #include "../lib/part.h"
+#include "../lib/vcd_writer.h"
+#include "../lib/wave_file.h"
 
 #define PART_VCD_DUMP_AN_Name "VCD Dump (Analogic)"
 
+#define VCD_DUMP_AN_PINS 64  // 8 pins on the part picture and the others set by list
+
 class cpart_VCD_Dump_an : public part {
 public:
     lxString GetAboutInfo(void) override { return lxT("L.C. Gamboa \n <lcgamboa@yahoo.com>"); };
@@ -53,11 +57,17 @@ public:
 
 private:
     void RegisterRemoteControl(void) override;
-    unsigned char input_pins[8];
-    float old_value_pins[8];
+    unsigned char input_pins[VCD_DUMP_AN_PINS];
+    float old_value_pins[VCD_DUMP_AN_PINS];
+    char ids[VCD_DUMP_AN_PINS][VCD_ID_MAX];
     char f_vcd_name[200];
-    FILE* f_vcd;
+    char f_wave_name[200];
+    vcd_writer_t vcd;
+    wave_writer_t wave;
+    int wave_signals[VCD_DUMP_AN_PINS];
+    unsigned char format;
     unsigned long vcd_count;
+    uint64_t vcd_mult;  // VCD time units per step
     unsigned char rec;
     lxFont font;
     lxColor color1;
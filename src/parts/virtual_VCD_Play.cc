@@ -38,37 +38,33 @@ enum { O_P1, O_P2, O_P3, O_P4, O_P5, O_P6, O_P7, O_P8, O_L1, O_L2, O_L3, O_L4, O
 /*inputs*/
 enum { I_PLAY, I_VIEW, I_LOAD };
 
-static PCWProp pcwprop[9] = {{PCW_COMBO, "Pin 1"}, {PCW_COMBO, "Pin 2"}, {PCW_COMBO, "Pin 3"},
-                             {PCW_COMBO, "Pin 4"}, {PCW_COMBO, "Pin 5"}, {PCW_COMBO, "Pin 6"},
-                             {PCW_COMBO, "Pin 7"}, {PCW_COMBO, "Pin 8"}, {PCW_END, ""}};
+static PCWProp pcwprop[11] = {{PCW_COMBO, "Pin 1"}, {PCW_COMBO, "Pin 2"},     {PCW_COMBO, "Pin 3"},
+                              {PCW_COMBO, "Pin 4"}, {PCW_COMBO, "Pin 5"},     {PCW_COMBO, "Pin 6"},
+                              {PCW_COMBO, "Pin 7"}, {PCW_COMBO, "Pin 8"},     {PCW_EDIT, "Pins 9-64"},
+                              {PCW_EDIT, "Start (ms)"}, {PCW_END, ""}};
 
 cpart_VCD_Play::cpart_VCD_Play(const unsigned x, const unsigned y, const char* name, const char* type)
     : part(x, y, name, type), font(9, lxFONTFAMILY_TELETYPE, lxFONTSTYLE_NORMAL, lxFONTWEIGHT_BOLD) {
     always_update = 1;
 
-    output_pins[0] = 0;
-    output_pins[1] = 0;
-    output_pins[2] = 0;
-    output_pins[3] = 0;
-    output_pins[4] = 0;
-    output_pins[5] = 0;
-    output_pins[6] = 0;
-    output_pins[7] = 0;
+    memset(output_pins, 0, VCD_PLAY_PINS);
 
     f_vcd_name[0] = '*';
     f_vcd_name[1] = 0;
 
     play = 0;
 
-    vcd_data = NULL;
-    vcd_data_count = 0;
+    vcd_reader_init(&vcd);
+    wave_reader_init(&wave);
     vcd_count = 0;
-    vcd_ptr = 0;
+    vcd_start = 0;
+    start = 0;
+    vcd_inc = 0;
     vcd_step = 0;
 
     SetPCWProperties(pcwprop);
 
-    PinCount = 8;
+    PinCount = VCD_PLAY_PINS;
     Pins = output_pins;
 }
 
@@ -80,10 +76,8 @@ void cpart_VCD_Play::RegisterRemoteControl(void) {
 cpart_VCD_Play::~cpart_VCD_Play(void) {
     delete Bitmap;
     canvas.Destroy();
-    if (vcd_data) {
-        free(vcd_data);
-        vcd_data = NULL;
-    }
+    vcd_reader_close(&vcd);
+    wave_reader_close(&wave);
 }
 
 void cpart_VCD_Play::DrawOutput(const unsigned int i) {
@@ -237,17 +231,46 @@ unsigned short cpart_VCD_Play::GetOutputId(char* name) {
 }
 
 lxString cpart_VCD_Play::WritePreferences(void) {
-    char prefs[256];
-    sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%s", output_pins[0], output_pins[1], output_pins[2],
-            output_pins[3], output_pins[4], output_pins[5], output_pins[6], output_pins[7], play, f_vcd_name);
+    char prefs[512];
+    int len;
+
+    len = sprintf(prefs, "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%f", output_pins[0], output_pins[1],
+                  output_pins[2], output_pins[3], output_pins[4], output_pins[5], output_pins[6], output_pins[7], play,
+                  start);
+    for (int i = 8; i < VCD_PLAY_PINS; i++) {
+        len += sprintf(prefs + len, ",%hhu", output_pins[i]);
+    }
+    snprintf(prefs + len, 512 - len, ",%s", f_vcd_name);
 
     return prefs;
 }
 
 void cpart_VCD_Play::ReadPreferences(lxString value) {
-    sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%s", &output_pins[0], &output_pins[1],
+    int len = 0;
+    int n = 0;
+
+    start = 0;
+    memset(output_pins + 8, 0, VCD_PLAY_PINS - 8);
+    sscanf(value.c_str(), "%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu,%hhu%n", &output_pins[0], &output_pins[1],
            &output_pins[2], &output_pins[3], &output_pins[4], &output_pins[5], &output_pins[6], &output_pins[7], &play,
-           f_vcd_name);
+           &len);
+    const char* ptr = value.c_str() + len;
+    // old configurations have the file name (absolute path or *) just after the play field
+    if (sscanf(ptr, ",%f%n", &start, &n) == 1) {
+        ptr += n;
+        for (int i = 8; i < VCD_PLAY_PINS; i++) {
+            n = 0;
+            if (sscanf(ptr, ",%hhu%n", &output_pins[i], &n) != 1) {
+                break;
+            }
+            ptr += n;
+        }
+    } else {
+        start = 0;
+    }
+    f_vcd_name[0] = '*';
+    f_vcd_name[1] = 0;
+    sscanf(ptr, ",%199s", f_vcd_name);
 
     if (f_vcd_name[0] != '*') {
 #ifdef _WIN_
@@ -282,6 +305,9 @@ void cpart_VCD_Play::ConfigurePropertiesWindow(CPWindow* WProp) {
     SetPCWComboWithPinNames(WProp, "combo6", output_pins[5]);
     SetPCWComboWithPinNames(WProp, "combo7", output_pins[6]);
     SetPCWComboWithPinNames(WProp, "combo8", output_pins[7]);
+
+    SetPCWEditWithPinList(WProp, "edit9", output_pins + 8, VCD_PLAY_PINS - 8);
+    ((CEdit*)WProp->GetChildByName("edit10"))->SetText(ftoa(start));
 }
 
 void cpart_VCD_Play::ReadPropertiesWindow(CPWindow* WProp) {
@@ -293,27 +319,75 @@ void cpart_VCD_Play::ReadPropertiesWindow(CPWindow* WProp) {
     output_pins[5] = GetPWCComboSelectedPin(WProp, "combo6");
     output_pins[6] = GetPWCComboSelectedPin(WProp, "combo7");
     output_pins[7] = GetPWCComboSelectedPin(WProp, "combo8");
+
+    GetPWCEditPinList(WProp, "edit9", output_pins + 8, VCD_PLAY_PINS - 8);
+    start = atof(((CEdit*)WProp->GetChildByName("edit10"))->GetText());
+    if (start < 0) {
+        start = 0;
+    }
+}
+
+void cpart_VCD_Play::SetPins(const uint64_t state) {
+    for (int i = 0; i < VCD_PLAY_PINS; i++) {
+        if (output_pins[i]) {
+            SpareParts.SetPin(output_pins[i], (state >> i) & 0x01);
+        }
+    }
 }
 
 void cpart_VCD_Play::PreProcess(void) {
+    const double timescale = wave_reader_is_open(&wave) ? wave.timescale : vcd.timescale;
     vcd_inc = 1.0 / ((timescale * 1e-12) * PICSimLab.GetBoard()->MGetInstClockFreq());
+    vcd_start = (timescale > 0) ? (start * 1e9) / timescale : 0;
 }
 
 void cpart_VCD_Play::Process(void) {
-    if (play) {
-        if (vcd_data[vcd_ptr].count <= vcd_count) {
-            SpareParts.SetPin(output_pins[0], (vcd_data[vcd_ptr].data & 0x01) > 0);
-            SpareParts.SetPin(output_pins[1], (vcd_data[vcd_ptr].data & 0x02) > 0);
-            SpareParts.SetPin(output_pins[2], (vcd_data[vcd_ptr].data & 0x04) > 0);
-            SpareParts.SetPin(output_pins[3], (vcd_data[vcd_ptr].data & 0x08) > 0);
-            SpareParts.SetPin(output_pins[4], (vcd_data[vcd_ptr].data & 0x10) > 0);
-            SpareParts.SetPin(output_pins[5], (vcd_data[vcd_ptr].data & 0x20) > 0);
-            SpareParts.SetPin(output_pins[6], (vcd_data[vcd_ptr].data & 0x40) > 0);
-            SpareParts.SetPin(output_pins[7], (vcd_data[vcd_ptr].data & 0x80) > 0);
-            vcd_ptr++;
-            if (vcd_ptr >= vcd_data_count) {
-                vcd_ptr = 0;
-                vcd_count = 0;
+    if (play && wave_reader_is_open(&wave)) {
+        if (vcd_count < vcd_start) {
+            // file loaded or start changed
+            SetPins(wave_reader_seek(&wave, vcd_start));
+            vcd_count = vcd_start;
+        }
+        if (wave.time <= vcd_count) {
+            SetPins(wave.state);
+            if (!wave_reader_next(&wave)) {
+                SetPins(wave_reader_seek(&wave, vcd_start));
+                vcd_count = vcd_start;
+            } else if (wave.time < vcd_count) {
+                // changes faster than the simulation steps, read forward to the current time, the index seek
+                // restarts up to a whole index stride back
+                uint64_t state;
+                do {
+                    state = wave.state;
+                } while (wave_reader_next(&wave) && (wave.time < vcd_count));
+                SetPins(state);
+            }
+        }
+
+        vcd_step += vcd_inc;
+        if (vcd_step >= 1) {
+            vcd_count += (int)(vcd_step + 0.5);
+            vcd_step = 0;
+        }
+    } else if (play && vcd_reader_is_open(&vcd)) {
+        if (vcd_count < vcd_start) {
+            // file loaded or start changed
+            SetPins(vcd_reader_seek(&vcd, vcd_start));
+            vcd_count = vcd_start;
+        }
+        if (vcd.cur.time <= vcd_count) {
+            SetPins(vcd.cur.state);
+            if (!vcd_reader_next(&vcd)) {
+                SetPins(vcd_reader_seek(&vcd, vcd_start));
+                vcd_count = vcd_start;
+            } else if (vcd.cur.time < vcd_count) {
+                // changes faster than the simulation steps, read forward to the current time, the index seek
+                // restarts up to a whole index stride back
+                uint64_t state;
+                do {
+                    state = vcd.cur.state;
+                } while (vcd_reader_next(&vcd) && (vcd.cur.time < vcd_count));
+                SetPins(state);
             }
         }
 
@@ -323,19 +397,18 @@ void cpart_VCD_Play::Process(void) {
             vcd_step = 0;
         }
     } else {
-        if (vcd_count) {
-            SpareParts.SetPin(output_pins[0], 0);
-            SpareParts.SetPin(output_pins[1], 0);
-            SpareParts.SetPin(output_pins[2], 0);
-            SpareParts.SetPin(output_pins[3], 0);
-            SpareParts.SetPin(output_pins[4], 0);
-            SpareParts.SetPin(output_pins[5], 0);
-            SpareParts.SetPin(output_pins[6], 0);
-            SpareParts.SetPin(output_pins[7], 0);
+        if (vcd_count != vcd_start) {
+            // stopped or start changed, the pins keep the file state at the start time
+            if (wave_reader_is_open(&wave)) {
+                SetPins(wave_reader_seek(&wave, vcd_start));
+            } else if (vcd_reader_is_open(&vcd)) {
+                SetPins(vcd_reader_seek(&vcd, vcd_start));
+            } else {
+                SetPins(0);
+            }
         }
 
-        vcd_count = 0;
-        vcd_ptr = 0;
+        vcd_count = vcd_start;
         vcd_step = 0;
     }
 }
@@ -355,7 +428,8 @@ void cpart_VCD_Play::OnMouseButtonPress(uint inputId, uint button, uint x, uint
     switch (inputId) {
         case I_LOAD:
             SpareParts.GetFileDialog()->SetType(lxFD_OPEN | lxFD_CHANGE_DIR);
-            SpareParts.GetFileDialog()->SetFilter(lxT("Value change dump (*.vcd)|*.vcd"));
+            SpareParts.GetFileDialog()->SetFilter(
+                lxT("Value change dump (*.vcd)|*.vcd|PICSimLab Waveform (*.pwf)|*.pwf"));
             if (f_vcd_name[0] == '*') {
                 SpareParts.GetFileDialog()->SetFileName(lxT("untitled.vcd"));
             } else {
@@ -370,9 +444,20 @@ void cpart_VCD_Play::OnMouseButtonPress(uint inputId, uint button, uint x, uint
             }
             output_ids[O_PLAY]->update = 1;
             break;
-        case I_VIEW:
+        case I_VIEW: {
             if (f_vcd_name[0] == '*')
                 break;
+            char fname[256];
+            strncpy(fname, f_vcd_name, 255);
+            fname[255] = 0;
+            if (wave_file_name(f_vcd_name)) {
+                // waveform viewers only read VCD
+                snprintf(fname, 256, "%s/picsimlab-play.vcd", (const char*)lxGetTempDir("PICSimLab").c_str());
+                if (wave_file_to_vcd(f_vcd_name, fname)) {
+                    printf("PICSimLab: Error converting PWF file %s\n", f_vcd_name);
+                    break;
+                }
+            }
 #ifdef __EMSCRIPTEN__
             EM_ASM_(
                 {
@@ -393,11 +478,11 @@ void cpart_VCD_Play::OnMouseButtonPress(uint inputId, uint button, uint x, uint
                     document.body.removeChild(element);
                     URL.revokeObjectURL(text);
                 },
-                f_vcd_name);
+                fname);
 #else
-            lxLaunchDefaultApplication(f_vcd_name);
+            lxLaunchDefaultApplication(fname);
 #endif
-            break;
+        } break;
     }
 }
 
@@ -412,98 +497,26 @@ void cpart_VCD_Play::filedialog_EvOnClose(int retId) {
 }
 
 int cpart_VCD_Play::LoadVCD(lxString fname) {
-    FILE* fvcd;
-    fvcd = fopen(fname.c_str(), "r");
-    char buff[256];
-    int data = 0;
-    char* id;
-    char* value;
-    char signal[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-    int signal_count = 0;
     unsigned char old_play = play;
 
     play = 0;
-    vcd_data_count = 0;
-
-    unsigned int vcd_count_ = -1;
-
-    if (vcd_data) {
-        free(vcd_data);
-        vcd_data = NULL;
-    }
-
-    if (fvcd) {
-        while (fgets(buff, 255, fvcd)) {
-            if (buff[0] == '#') {
-                vcd_data_count++;
-            }
-
-            if (!data)  // option read
-            {
-                id = strtok(buff, " \n\r");
-                if (!strcmp(id, "$timescale")) {
-                    int itimescale;
-                    value = strtok(NULL, " ");
-                    sscanf(value, "%ips", &itimescale);
-                    timescale = itimescale;
-                } else if (!strcmp(id, "$var")) {
-                    value = strtok(NULL, " ");  // wire
-                    value = strtok(NULL, " ");  // 1
-                    value = strtok(NULL, " ");  // const
-                    signal[signal_count++] = value[0];
-                } else if (!strcmp(id, "$end") || (id[0] == '#')) {
-                    data = 1;
-                }
-            }
-        }
-        vcd_data_count--;
 
-        vcd_data = (vcd_reg_t*)malloc((vcd_data_count + 1) * sizeof(vcd_reg_t));
+    vcd_reader_close(&vcd);
+    wave_reader_close(&wave);
 
-        if (!vcd_data) {
-            printf("vcd_play: malloc error \n");
-            fclose(fvcd);
+    if (wave_file_name(fname.c_str())) {
+        if (wave_reader_open(&wave, fname.c_str())) {
+            printf("vcd play: Error open file %s\n", (const char*)fname.c_str());
             return 0;
         }
-
-        rewind(fvcd);
-
-        data = 0;
-        while (fgets(buff, 255, fvcd)) {
-            if (!data)  // option read
-            {
-                id = strtok(buff, " \n\r");
-                if (!strcmp(id, "$end") || (id[0] == '#')) {
-                    data = 1;
-                }
-            } else  // data read
-            {
-                if (buff[0] == '#') {
-                    vcd_count_++;
-                    sscanf(buff + 1, "%lu", &vcd_data[vcd_count_].count);
-                } else {
-                    for (int i = 0; i < 8; i++) {
-                        if (signal[i] == buff[1]) {
-                            if (buff[0] == '1') {
-                                vcd_data[vcd_count_].data |= (1 << i);
-                                break;
-                            } else {
-                                vcd_data[vcd_count_].data &= ~(1 << i);
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        fclose(fvcd);
-        vcd_count = 0;
-        vcd_ptr = 0;
-        vcd_step = 0;
-        play = old_play;
-    } else {
+    } else if (vcd_reader_open(&vcd, fname.c_str())) {
         printf("vcd play: Error open file %s\n", (const char*)fname.c_str());
+        return 0;
     }
+
+    vcd_count = 0;
+    vcd_step = 0;
+    play = old_play;
     return 0;
 }
 
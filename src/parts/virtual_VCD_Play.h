@@ -28,13 +28,12 @@
 
 #include <lxrad.h>
 #include "../lib/part.h"
+#include "../lib/vcd_reader.h"
+#include "../lib/wave_file.h"
 
 #define PART_VCD_Play_Name "VCD Play"
 
-typedef struct {
-    unsigned long count;
-    unsigned char data;
-} vcd_reg_t;
+#define VCD_PLAY_PINS 64  // 8 pins on the part picture and the others set by list
 
 class cpart_VCD_Play : public part {
 public:
@@ -57,16 +56,17 @@ public:
 
 private:
     void RegisterRemoteControl(void) override;
-    unsigned char output_pins[8];
+    void SetPins(const uint64_t state);
+    unsigned char output_pins[VCD_PLAY_PINS];
     char f_vcd_name[200];
     unsigned char play;
-    float timescale;
     unsigned long vcd_count;
+    unsigned long vcd_start;  ///< play start in file time units
+    float start;              ///< play start in ms
     float vcd_inc;
     float vcd_step;
-    vcd_reg_t* vcd_data;
-    int vcd_data_count;
-    int vcd_ptr;
+    vcd_reader_t vcd;
+    wave_reader_t wave;  ///< used when a .pwf file is loaded
     lxFont font;
     lxColor color1;
     lxColor color2;
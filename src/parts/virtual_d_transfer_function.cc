@@ -358,4 +358,9 @@ void cpart_dtfunc::ReadPropertiesWindow(CPWindow* WProp) {
     Reset();
 }
 
+void cpart_dtfunc::Snapshot(snapshot_t* sn) {
+    SNAPSHOT_VAR(sn, v);
+    SNAPSHOT_VAR(sn, nsamples);
+}
+
 part_init(PART_DTRANSFERF_Name, cpart_dtfunc, "Virtual");
@@ -40,6 +40,7 @@ public:
     void PreProcess(void) override;
     void Process(void) override;
     void Reset(void) override;
+    void Snapshot(snapshot_t* sn) override;
     void EvKeyPress(uint key, uint mask) override;
     void EvKeyRelease(uint key, uint mask) override;
     void ConfigurePropertiesWindow(CPWindow* WProp) override;
@@ -366,6 +366,7 @@ void cpart_vterm::PreProcess(void) {
             }
         }
     }
+    bitbang_uart_link(&vt.bb_uart, SpareParts.GetUARTLink(this, pins[0], pins[1]));
     Process();  // check for input updates
 }
 
@@ -414,4 +415,10 @@ void cpart_vterm::PostProcess(void) {
     }
 }
 
+void cpart_vterm::Snapshot(snapshot_t* sn) {
+    vt.inMutex->Lock();
+    SNAPSHOT_VAR(sn, vt);
+    vt.inMutex->Unlock();
+}
+
 part_init(PART_vterm_Name, cpart_vterm, "Virtual");
@@ -47,7 +47,10 @@ CPWindow1 Window1;
 #include "lib/oscilloscope.h"
 #include "lib/spareparts.h"
 
+#include "lib/pinshm.h"
+#include "lib/profiler.h"
 #include "lib/rcontrol.h"
+#include "lib/simcontext.h"
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
@@ -98,6 +101,20 @@ void CPWindow1::timer1_EvOnTime(CControl* control) {
     PICSimLab.SetSync(1);
     PICSimLab.status.st[0] |= ST_T1;
 
+    // batch mode runs without wall-clock pacing
+    if (PICSimLab.GetBatch()) {
+#ifdef _NOTHREAD
+        // without the CPU thread the batch runs here, in slices of one timer period of processor time
+        const double t0 = cpuTime();
+        do {
+            BatchStep();
+        } while (PICSimLab.GetBatch() && ((cpuTime() - t0) * 1000 < timer1.GetTime()));
+#endif
+        DrawBoard();
+        PICSimLab.status.st[0] &= ~ST_T1;
+        return;
+    }
+
 #ifdef _NOTHREAD
     // printf ("overtimer = %i \n", timer1.GetOverTime ());
     if (timer1.GetOverTime() < 100)
@@ -152,7 +169,10 @@ void CPWindow1::timer1_EvOnTime(CControl* control) {
 }
 
 void CPWindow1::DrawBoard(void) {
+    int redraw = 0;
+
     if (PICSimLab.GetNeedResize()) {
+        redraw = 1;
         double scalex, scaley, scale_temp;
 
         scalex = ((Window1.GetClientWidth() - 175) * 1.0) / PICSimLab.plWidth;
@@ -208,23 +228,45 @@ void CPWindow1::DrawBoard(void) {
     }
 
     if (PICSimLab.GetBoard()) {
+        redraw += PICSimLab.GetBoard()->GetOutputsUpdate();
         PICSimLab.GetBoard()->Draw(&draw1);
     }
 #ifndef _WIN_
-    Draw();
+    // the window is repainted only when the board has changed outputs
+    if (redraw) {
+        Draw();
+    }
 #endif
 }
 
+void CPWindow1::BatchStep(void) {
+    if (PICSimLab.GetSimulationRun() && PICSimLab.BatchUpdate()) {
+        PICSimLab.status.st[1] |= ST_TH;
+        PROF_RUN_CPU(PICSimLab.GetBoard());
+        if (PICSimLab.GetDebugStatus())
+            PICSimLab.GetBoard()->DebugLoop();
+        PICSimLab.GetBoard()->PinTraceUpdate();
+        pinshm_publish(PICSimLab.GetBoard(), PICSimLab.GetCpuState());
+        PICSimLab.status.st[1] &= ~ST_TH;
+    }
+}
+
 void CPWindow1::thread1_EvThreadRun(CControl*) {
     double t0, t1, etime;
     do {
-        if (PICSimLab.tgo) {
+        if (PICSimLab.GetBatch() && PICSimLab.GetSimulationRun()) {
+#ifndef _NOTHREAD
+            BatchStep();
+#endif
+        } else if (PICSimLab.tgo) {
             t0 = cpuTime();
 
             PICSimLab.status.st[1] |= ST_TH;
-            PICSimLab.GetBoard()->Run_CPU();
+            PROF_RUN_CPU(PICSimLab.GetBoard());
             if (PICSimLab.GetDebugStatus())
                 PICSimLab.GetBoard()->DebugLoop();
+            PICSimLab.GetBoard()->PinTraceUpdate();
+            pinshm_publish(PICSimLab.GetBoard(), PICSimLab.GetCpuState());
             PICSimLab.tgo--;
             PICSimLab.status.st[1] &= ~ST_TH;
 
@@ -311,7 +353,11 @@ void CPWindow1::timer2_EvOnTime(CControl* control) {
 
     if (PICSimLab.GetErrorCount()) {
 #ifndef __EMSCRIPTEN__
-        Message_sz(PICSimLab.GetError(0), 600, 240);
+        if (PICSimLab.GetBatchExitCode() >= 0) {
+            printf("Error: %s\n", PICSimLab.GetError(0).c_str());
+        } else {
+            Message_sz(PICSimLab.GetError(0), 600, 240);
+        }
 #else
         printf("Error: %s\n", PICSimLab.GetError(0).c_str());
 #endif
@@ -491,6 +537,41 @@ void CPWindow1::_EvOnCreate(CControl* control) {
         PICSimLab.RegisterError(
             "Error closing PICSimLab in last time!\n Using default mode.\n Error log file: " + lxString(fname_error) +
             "\n If the problem persists, please consider opening an issue on github.\n ");
+    } else if ((Application->Aargc >= 4) && (Application->Aargv[1][0] == '-')) {
+        // batch mode: -batch_time seconds file.pzw [file2.pzw ...] or -batch_inst instructions file.pzw [...]
+        double btime = 0;
+        unsigned long long binsts = 0;
+
+        if (!strcmp(Application->Aargv[1], "-batch_time")) {
+            btime = atof(Application->Aargv[2]);
+        } else if (!strcmp(Application->Aargv[1], "-batch_inst")) {
+            binsts = strtoull(Application->Aargv[2], NULL, 10);
+        }
+
+        if ((btime <= 0) && (!binsts)) {
+            printf("PICSimLab: Invalid batch option %s %s !\n", Application->Aargv[1], Application->Aargv[2]);
+            printf("use: %s [-batch_time seconds | -batch_inst instructions] file.pzw [file2.pzw ...]\n",
+                   Application->Aargv[0]);
+            fflush(stdout);
+            exit(BATCH_ERROR);
+        }
+
+        if (Application->Aargc == 4) {
+            fn.Assign(Application->Aargv[3]);
+            fn.MakeAbsolute();
+            PICSimLab.Configure(home, 1, 1);
+            PICSimLab.SetBatch(btime, binsts);
+            PICSimLab.LoadWorkspace(fn.GetFullPath(), 0);
+            // don't save the workspace back on exit
+            PICSimLab.SetWorkspaceFileName("");
+        } else {
+            // several workspaces run in parallel, each one in its own headless simulation context
+            const int ret = simcontext_batch(Application->Aargc - 3, Application->Aargv + 3, btime, binsts, 0);
+            PICSimLab.Configure(home, 1, 1, NULL, 1);
+            PICSimLab.SetSimulationRun(0);
+            PICSimLab.SetBatchExitCode(ret);
+            PICSimLab.SetToDestroy();
+        }
     } else if (Application->Aargc == 2) {  // only .pzw file
         fn.Assign(Application->Aargv[1]);
         fn.MakeAbsolute();
@@ -589,7 +670,9 @@ void CPWindow1::combo1_EvOnComboChange(CControl* control) {
 }
 
 void CPWindow1::_EvOnDestroy(CControl* control) {
+    prof_print();
     rcontrol_server_end();
+    pinshm_end();
     PICSimLab.GetBoard()->EndServers();
     PICSimLab.SetNeedReboot(0);
     PICSimLab.EndSimulation();
@@ -634,6 +717,10 @@ void CPWindow1::_EvOnDestroy(CControl* control) {
     printf("PICSimLab: Finish Ok\n");
     fflush(stdout);
 #endif
+
+    if (PICSimLab.GetBatchExitCode() >= 0) {
+        exit(PICSimLab.GetBatchExitCode());
+    }
 }
 
 void CPWindow1::menu1_File_LoadHex_EvMenuActive(CControl* control) {
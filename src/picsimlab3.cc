@@ -76,6 +76,7 @@ void CPWindow3::button1_EvMouseButtonClick(CControl* control, uint button, uint
 #endif
 
     PICSimLab.SetUseDSRReset(checkbox1.GetCheck());
+    PICSimLab.SetUARTFastPath(checkbox2.GetCheck());
 
     PICSimLab.EndSimulation();
     PICSimLab.Configure(PICSimLab.GetHomePath());
@@ -133,6 +134,7 @@ void CPWindow3::_EvOnShow(CControl* control) {
     spin2.SetValue(PICSimLab.GetRemotecPort());
 
     checkbox1.SetCheck(PICSimLab.GetUseDSRReset());
+    checkbox2.SetCheck(PICSimLab.GetUARTFastPath());
 
     if (PICSimLab.GetInstanceNumber()) {
         spin1.SetEnable(0);
@@ -246,6 +246,22 @@ CPWindow3::CPWindow3(void) {
     checkbox1.SetText(lxT("DTR/RTS Reset"));
     checkbox1.SetCheck(0);
     CreateChild(&checkbox1);
+    // checkbox2
+    checkbox2.SetFOwner(this);
+    checkbox2.SetClass(lxT("CCheckBox"));
+    checkbox2.SetName(lxT("checkbox2"));
+    checkbox2.SetTag(0);
+    checkbox2.SetX(355);
+    checkbox2.SetY(77);
+    checkbox2.SetWidth(160);
+    checkbox2.SetHeight(32);
+    checkbox2.SetHint(lxT("AVR boards only: UART parts wired alone to the UART pins exchange whole bytes"));
+    checkbox2.SetEnable(1);
+    checkbox2.SetVisible(1);
+    checkbox2.SetPopupMenu(NULL);
+    checkbox2.SetText(lxT("UART Fast Path"));
+    checkbox2.SetCheck(1);
+    CreateChild(&checkbox2);
     /*#Others*/
     // lxrad automatic generated block end, don't edit above!
 };
\ No newline at end of file
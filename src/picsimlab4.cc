@@ -29,6 +29,7 @@
 #include "lib/oscilloscope.h"
 #include "lib/picsimlab.h"
 #include "lib/spareparts.h"
+#include "lib/wave_file.h"
 
 #include "picsimlab4_d.cc"
 
@@ -36,6 +37,23 @@ CPWindow4 Window4;
 
 // Implementation
 
+// draw the min/max decimated samples, one screen column each
+void CPWindow4::DrawColumns(const float* cmin, const float* cmax, const float gain, const float nivel) {
+    draw1.Canvas.SetLineWidth(2);
+    for (int x = 0; x < WMAX; x++) {
+        if (isnan(cmin[x])) {
+            continue;
+        }
+        const int y1 = nivel - gain * cmin[x];
+        const int y2 = nivel - gain * cmax[x];
+        if (y1 != y2) {
+            draw1.Canvas.Line(x, y1, x, y2);
+        } else {
+            draw1.Canvas.Line(x, y1, x + 1, y1);
+        }
+    }
+}
+
 void CPWindow4::DrawScreen(void) {
     draw1.Canvas.Init();
     draw1.Canvas.SetFont(*font);
@@ -61,6 +79,7 @@ void CPWindow4::DrawScreen(void) {
     draw1.Canvas.Line(WMAX / 2, 0, WMAX / 2, HMAX);
 
     float gain[3], nivel[3];
+    float cmin[WMAX], cmax[WMAX];
     lxPoint pts[3];
 
     // draw ch 0
@@ -79,12 +98,8 @@ void CPWindow4::DrawScreen(void) {
         pts[2].y = nivel[0] + 8;
         draw1.Canvas.Polygon(1, pts, 3);
 
-        draw1.Canvas.SetLineWidth(2);
-        for (int t = 0; t < (NPOINTS / 2) - 1; t++) {
-            draw1.Canvas.Line((t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[0] * Oscilloscope.GetChannel(0)[t] + nivel[0],
-                              ((t + 1) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[0] * Oscilloscope.GetChannel(0)[t + 1] + nivel[0]);
+        if (Oscilloscope.GetColumns(0, cmin, cmax, WMAX)) {
+            DrawColumns(cmin, cmax, gain[0], nivel[0]);
         }
     }
     draw1.Canvas.SetLineWidth(1);
@@ -105,12 +120,8 @@ void CPWindow4::DrawScreen(void) {
         pts[2].y = nivel[1] + 5;
         draw1.Canvas.Polygon(1, pts, 3);
 
-        draw1.Canvas.SetLineWidth(2);
-        for (int t = 0; t < (NPOINTS / 2) - 1; t++) {
-            draw1.Canvas.Line((t * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[1] * Oscilloscope.GetChannel(1)[t] + nivel[1],
-                              ((t + 1) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0),
-                              gain[1] * Oscilloscope.GetChannel(1)[t + 1] + nivel[1]);
+        if (Oscilloscope.GetColumns(1, cmin, cmax, WMAX)) {
+            DrawColumns(cmin, cmax, gain[1], nivel[1]);
         }
     }
     draw1.Canvas.SetLineWidth(1);
@@ -137,7 +148,7 @@ void CPWindow4::DrawScreen(void) {
     // draw toffset level
 
     draw1.Canvas.SetFgColor(255, 255, 0);
-    nivel[2] = ((WMAX - Oscilloscope.GetTimeOffset()) * xz + xz) - ((NPOINTS * (xz - 1.0)) / 4.0);
+    nivel[2] = WMAX - Oscilloscope.GetTimeOffset();
     pts[0].y = 1;
     pts[0].x = nivel[2] - 3;
     pts[1].y = 1 + 3;
@@ -288,16 +299,11 @@ void CPWindow4::spind5_EvOnChangeSpinDouble(CControl* control) {
 
     Oscilloscope.SetRT((spind5.GetValue() * 1e-3 * 10) / WMAX);
 
-    if ((Oscilloscope.GetRT() / Oscilloscope.GetDT()) < 1.0) {
-        xz = Oscilloscope.GetDT() / Oscilloscope.GetRT();
-    } else
-        xz = 1.0;
-
     spind6.SetMin(-5 * spind5.GetValue());
     spind6.SetMax(5 * spind5.GetValue());
 
     spind6_EvOnChangeSpinDouble(this);
-    // printf("Dt=%e Rt=%e  Rt/Dt=%f   xz=%f\n",Dt,Rt,Rt/Dt,xz);
+    // printf("Dt=%e Rt=%e  Rt/Dt=%f\n",Dt,Rt,Rt/Dt);
 }
 
 void CPWindow4::togglebutton5_EvOnToggleButton(CControl* control) {
@@ -311,9 +317,7 @@ void CPWindow4::spind7_EvOnChangeSpinDouble(CControl* control) {
 void CPWindow4::timer1_EvOnTime(CControl* control) {
     static int count = 0;
 
-    if (Oscilloscope.GetUpdate()) {
-        Oscilloscope.SetUpdate(0);
-
+    if (Oscilloscope.FetchFrame()) {
         count++;
         if (count >= 5)  // Update at 2Hz
         {
@@ -346,6 +350,8 @@ void CPWindow4::combo3_EvOnComboChange(CControl* control) {
     Oscilloscope.SetChannelPin(1, atoi(combo3.GetText()) - 1);
 }
 
+// TODO oscilloscope window: channels 3 and 4 (osc_ch3/osc_ch4, rcontrol osc) are saved to file but not drawn
+
 void CPWindow4::_EvOnDestroy(CControl* control) {
     if (font) {
         delete font;
@@ -440,7 +446,7 @@ void CPWindow4::togglebutton6_EvOnToggleButton(CControl* control) {
     combo3.SetEnable(Oscilloscope.GetRun());
 }
 
-// save PNG
+// save PNG or waveform
 
 void CPWindow4::button4_EvMouseButtonClick(CControl* control, uint button, uint x, uint y, uint state) {
     filedialog1.SetType(lxFD_SAVE | lxFD_CHANGE_DIR);
@@ -449,7 +455,13 @@ void CPWindow4::button4_EvMouseButtonClick(CControl* control, uint button, uint
 
 void CPWindow4::filedialog1_EvOnClose(int retId) {
     if (retId) {
-        draw1.WriteImgToFile(filedialog1.GetFileName());
+        if (wave_file_name(filedialog1.GetFileName().c_str())) {
+            if (Oscilloscope.SaveFrame(filedialog1.GetFileName().c_str())) {
+                printf("PICSimLab: Error saving waveform file %s\n", (const char*)filedialog1.GetFileName().c_str());
+            }
+        } else {
+            draw1.WriteImgToFile(filedialog1.GetFileName());
+        }
     }
 }
 
@@ -111,9 +111,9 @@ public:
     void DrawScreen(void);
 
 private:
+    void DrawColumns(const float* cmin, const float* cmax, const float gain, const float nivel);
     CButton* ctrl;
     lxFont* font;
-    double xz;
 };
 
 extern CPWindow4 Window4;
@@ -601,7 +601,7 @@ CPWindow4::CPWindow4(void) {
     filedialog1.SetName(lxT("filedialog1"));
     filedialog1.SetTag(0);
     filedialog1.SetFileName(lxT("untitled.png"));
-    filedialog1.SetFilter(lxT("PNG Files (*.png)|*.png"));
+    filedialog1.SetFilter(lxT("PNG Files (*.png)|*.png|PICSimLab Waveform (*.pwf)|*.pwf"));
     filedialog1.SetType(129);
     filedialog1.EvOnClose = EVONCLOSE & CPWindow4::filedialog1_EvOnClose;
     CreateChild(&filedialog1);
@@ -528,10 +528,10 @@ void CPWindow5::timer1_EvOnTime(CControl* control) {
         draw1.Canvas.End();
         draw1.Update();
         statusbar1.Draw();
-    }
 #ifndef _WIN_
-    Draw();
+        Draw();
 #endif
+    }
     tc++;
 
     if (tc > 3) {
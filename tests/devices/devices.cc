@@ -0,0 +1,98 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gamboa Lopes
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+// devices unit tests runner, the devices are linked without PICSimLab
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../tests.h"
+
+typedef struct {
+    char name[30];
+    test_run_func trun;
+    void* arg;
+    int result;
+} test_desc;
+
+static test_desc tests_list[MAX_TESTS];
+
+static int NUM_TESTS = 0;
+
+int main(int argc, char** argv) {
+    int FIRSTTEST = 0;
+    int ret = 0;
+
+    if (argc > 2) {
+        printf("use: %s [test number]\n", argv[0]);
+        for (int i = 0; i < NUM_TESTS; i++) {
+            printf("%02i: %-25s\n", i, tests_list[i].name);
+        }
+        return -1;
+    }
+
+    if (argc == 2) {
+        sscanf(argv[1], "%d", &FIRSTTEST);
+        NUM_TESTS = 1;
+    }
+
+    for (int i = FIRSTTEST; i < (FIRSTTEST + NUM_TESTS); i++) {
+        printf("======== test[%02i]: %-25s ==============\n", i, tests_list[i].name);
+        tests_list[i].result = tests_list[i].trun(tests_list[i].arg);
+        printf("Result: %s\n", (tests_list[i].result ? "\033[1;32m Success\033[0m" : "\033[1;31m Fail\033[0m"));
+    }
+
+    printf("\n\n======== Results ==============\n");
+    for (int i = FIRSTTEST; i < (FIRSTTEST + NUM_TESTS); i++) {
+        printf("test[%02i]: %-25s : %s\n", i, tests_list[i].name,
+               (tests_list[i].result ? "\033[1;32m Success\033[0m" : "\033[1;31m Fail\033[0m"));
+        if (!tests_list[i].result) {
+            ret = 1;
+        }
+    }
+
+    return ret;
+}
+
+void test_register(const char* name, test_run_func trun, void* arg) {
+    strncpy(tests_list[NUM_TESTS].name, name, 25);
+    tests_list[NUM_TESTS].trun = trun;
+    tests_list[NUM_TESTS].arg = arg;
+    tests_list[NUM_TESTS].result = 0;
+
+    NUM_TESTS++;
+}
+
+// the w5500 host sockets use the one of the remote control (src/lib/rcontrol.cc), not linked here
+void setnblock(int sock_descriptor) {
+    int flags;
+
+    if ((flags = fcntl(sock_descriptor, F_GETFL, 0)) < 0) {
+        return;
+    }
+    fcntl(sock_descriptor, F_SETFL, flags | O_NONBLOCK);
+}
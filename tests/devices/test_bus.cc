@@ -0,0 +1,394 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../src/devices/bus_i2c.h"
+#include "../../src/devices/bus_spi.h"
+#include "../../src/devices/eth_w5500.h"
+#include "../../src/devices/io_MCP23X17.h"
+#include "../../src/devices/mi2c_24CXXX.h"
+#include "../tests.h"
+
+// The shared buses run without PICSimLab, the test plays the role of the board: it drives the pins as a bit level
+// master (picsim and simavr boards) and calls the transactions (QEMU boards). The data must reach only the addressed
+// device and be the same seen by the device on its own pins.
+
+#define EEPROM_KBITS 32
+
+typedef struct {
+    mi2c_t mem;
+    int calls;
+} eeprom_t;
+
+static bus_i2c_t i2c_bus;
+static eeprom_t eeprom[2];  // 0x50 and 0x51
+static mi2c_t eeprom_ref;   // 0x50 on its own pins
+static int i2c_diff;
+
+static void eeprom_process(void* arg) {
+    eeprom_t* e = (eeprom_t*)arg;
+    e->calls++;
+    mi2c_process(&e->mem);
+}
+
+// the bus and the reference eeprom see the same pins, the returned sda must be the same when 0x50 is addressed
+static unsigned char i2c_pins(const unsigned char scl, const unsigned char sda, const unsigned char ref) {
+    const unsigned char ret = bus_i2c_io(&i2c_bus, scl, sda);
+    const unsigned char ret_ref = mi2c_io(&eeprom_ref, scl, sda);
+
+    if (ref && (ret != ret_ref)) {
+        i2c_diff++;
+    }
+    return sda & ret;
+}
+
+static void i2c_start(const unsigned char ref) {
+    i2c_pins(1, 1, ref);
+    i2c_pins(1, 0, ref);
+    i2c_pins(0, 0, ref);
+}
+
+static void i2c_stop(const unsigned char ref) {
+    i2c_pins(0, 0, ref);
+    i2c_pins(1, 0, ref);
+    i2c_pins(1, 1, ref);
+}
+
+// returns the ack bit
+static unsigned char i2c_write(const unsigned char data, const unsigned char ref) {
+    unsigned char ack;
+
+    for (int b = 7; b >= 0; b--) {
+        const unsigned char sda = (data >> b) & 0x01;
+        i2c_pins(0, sda, ref);
+        i2c_pins(1, sda, ref);
+        i2c_pins(0, sda, ref);
+    }
+    i2c_pins(0, 1, ref);
+    ack = i2c_pins(1, 1, ref);
+    i2c_pins(0, 1, ref);
+    return ack;
+}
+
+static unsigned char i2c_read(const unsigned char ack, const unsigned char ref) {
+    unsigned char data = 0;
+
+    for (int b = 7; b >= 0; b--) {
+        i2c_pins(0, 1, ref);
+        data = (data << 1) | i2c_pins(1, 1, ref);
+        i2c_pins(0, 1, ref);
+    }
+    i2c_pins(0, ack, ref);
+    i2c_pins(1, ack, ref);
+    i2c_pins(0, ack, ref);
+    return data;
+}
+
+// 24C32 random write and sequential read with a 2 bytes address, bit level
+static int eeprom_pins_write(const unsigned char addr, const unsigned short mem_addr, const unsigned char* data,
+                             const int len) {
+    const unsigned char ref = (addr == 0x50);
+    int ack;
+
+    i2c_start(ref);
+    ack = !i2c_write(addr << 1, ref);
+    if (ack) {
+        i2c_write(mem_addr >> 8, ref);
+        i2c_write(mem_addr & 0xFF, ref);
+        for (int i = 0; i < len; i++) {
+            ack &= !i2c_write(data[i], ref);
+        }
+    }
+    i2c_stop(ref);
+    return ack;
+}
+
+static int eeprom_pins_read(const unsigned char addr, const unsigned short mem_addr, unsigned char* data,
+                            const int len) {
+    const unsigned char ref = (addr == 0x50);
+
+    i2c_start(ref);
+    if (i2c_write(addr << 1, ref)) {
+        i2c_stop(ref);
+        return 0;
+    }
+    i2c_write(mem_addr >> 8, ref);
+    i2c_write(mem_addr & 0xFF, ref);
+    i2c_start(ref);  // restart
+    i2c_write((addr << 1) | 0x01, ref);
+    for (int i = 0; i < len; i++) {
+        data[i] = i2c_read(i == (len - 1), ref);
+    }
+    i2c_stop(ref);
+    return 1;
+}
+
+// the same frames with the transactions
+static int eeprom_bus_write(const unsigned char addr, const unsigned short mem_addr, const unsigned char* data,
+                            const int len) {
+    if (!bus_i2c_start(&i2c_bus, addr << 1)) {
+        bus_i2c_stop(&i2c_bus);
+        return 0;
+    }
+    bus_i2c_write(&i2c_bus, mem_addr >> 8);
+    bus_i2c_write(&i2c_bus, mem_addr & 0xFF);
+    for (int i = 0; i < len; i++) {
+        bus_i2c_write(&i2c_bus, data[i]);
+    }
+    bus_i2c_stop(&i2c_bus);
+    return 1;
+}
+
+static int eeprom_bus_read(const unsigned char addr, const unsigned short mem_addr, unsigned char* data,
+                           const int len) {
+    if (!bus_i2c_start(&i2c_bus, addr << 1)) {
+        bus_i2c_stop(&i2c_bus);
+        return 0;
+    }
+    bus_i2c_write(&i2c_bus, mem_addr >> 8);
+    bus_i2c_write(&i2c_bus, mem_addr & 0xFF);
+    bus_i2c_start(&i2c_bus, (addr << 1) | 0x01);  // restart
+    for (int i = 0; i < len; i++) {
+        data[i] = bus_i2c_read(&i2c_bus);
+    }
+    bus_i2c_stop(&i2c_bus);
+    return 1;
+}
+
+static int test_bus_i2c(void) {
+    const unsigned char data0[4] = {0x12, 0x34, 0x56, 0x78};
+    const unsigned char data1[4] = {0xCA, 0xFE, 0xBE, 0xEF};
+    unsigned char buff[4];
+
+    bus_i2c_init(&i2c_bus);
+    for (int i = 0; i < 2; i++) {
+        memset(&eeprom[i], 0, sizeof(eeprom_t));
+        mi2c_init(&eeprom[i].mem, EEPROM_KBITS);
+        mi2c_set_addr(&eeprom[i].mem, 0x50 + i);
+        if (bus_i2c_attach(&i2c_bus, &eeprom[i].mem.bb_i2c, eeprom_process, &eeprom[i]) != i) {
+            printf("Error attaching eeprom %i\n", i);
+            return 0;
+        }
+    }
+    mi2c_init(&eeprom_ref, EEPROM_KBITS);
+    mi2c_set_addr(&eeprom_ref, 0x50);
+    i2c_diff = 0;
+
+    // bit level
+    if (!eeprom_pins_write(0x50, 0x0100, data0, 4) || !eeprom_pins_write(0x51, 0x0100, data1, 4)) {
+        printf("Error eeprom write not acknowledged\n");
+        return 0;
+    }
+    if (memcmp(&eeprom[0].mem.data[0x0100], data0, 4) || memcmp(&eeprom[1].mem.data[0x0100], data1, 4) ||
+        memcmp(&eeprom_ref.data[0x0100], data0, 4)) {
+        printf("Error eeprom bit level write\n");
+        return 0;
+    }
+    if (!eeprom_pins_read(0x51, 0x0100, buff, 4) || memcmp(buff, data1, 4)) {
+        printf("Error eeprom bit level read\n");
+        return 0;
+    }
+    if (!eeprom_pins_read(0x50, 0x0100, buff, 4) || memcmp(buff, data0, 4)) {
+        printf("Error eeprom bit level read\n");
+        return 0;
+    }
+    if (i2c_diff) {
+        printf("Error bus sda differs from the device sda %i times\n", i2c_diff);
+        return 0;
+    }
+
+    // only the addressed device is processed
+    const int calls = eeprom[1].calls;
+    eeprom_pins_read(0x50, 0x0100, buff, 4);
+    if (eeprom[1].calls != calls) {
+        printf("Error eeprom 0x51 processed in a 0x50 transfer\n");
+        return 0;
+    }
+
+    // no device, not acknowledged
+    if (eeprom_pins_write(0x52, 0x0100, data0, 4) || eeprom_bus_write(0x52, 0x0100, data0, 4)) {
+        printf("Error missing device acknowledged\n");
+        return 0;
+    }
+
+    // transactions, read back on both levels
+    if (!eeprom_bus_write(0x51, 0x0200, data0, 4) || memcmp(&eeprom[1].mem.data[0x0200], data0, 4)) {
+        printf("Error eeprom transaction write\n");
+        return 0;
+    }
+    if (!eeprom_bus_read(0x51, 0x0100, buff, 4) || memcmp(buff, data1, 4)) {
+        printf("Error eeprom transaction read\n");
+        return 0;
+    }
+    if (!eeprom_pins_read(0x51, 0x0200, buff, 4) || memcmp(buff, data0, 4)) {
+        printf("Error eeprom bit level read after transaction\n");
+        return 0;
+    }
+    if (eeprom[0].mem.data[0x0200] != 0xFF) {  // erased
+        printf("Error eeprom 0x50 written in a 0x51 transfer\n");
+        return 0;
+    }
+    return 1;
+}
+
+#define SPI_CS_MCP 0
+#define SPI_CS_ETH 1
+
+typedef struct {
+    io_MCP23X17_t mcp;
+    int calls;
+} mcp_t;
+
+static bus_spi_t spi_bus;
+static unsigned char spi_cs[2];
+static mcp_t mcp[2];  // hardware address 0 and 1 sharing the chip select
+static eth_w5500_t eth;
+static int eth_calls;
+
+static unsigned char mcp_io(void* arg, const unsigned char sck, const unsigned char copi, const unsigned char cs) {
+    mcp_t* m = (mcp_t*)arg;
+    m->calls++;
+    return io_MCP23X17_SPI_io(&m->mcp, copi, sck, 1, cs);
+}
+
+static unsigned char eth_io(void* arg, const unsigned char sck, const unsigned char copi, const unsigned char cs) {
+    eth_calls++;
+    return eth_w5500_io((eth_w5500_t*)arg, copi, sck, cs, 1) & 0x01;
+}
+
+// full duplex byte, bit level: the selected devices driving cipo are wired and
+static unsigned char spi_pins(const unsigned char data) {
+    unsigned char in = 0;
+
+    for (int b = 7; b >= 0; b--) {
+        const unsigned char copi = (data >> b) & 0x01;
+        unsigned char cipo = 1;
+        bus_spi_io(&spi_bus, 0, copi);
+        for (int i = 0; i < spi_bus.count; i++) {
+            if (spi_bus.dev[i].selected && spi_bus.dev[i].cipo) {
+                cipo &= spi_bus.dev[i].ret;
+            }
+        }
+        in = (in << 1) | cipo;  // sampled by the rising edge
+        bus_spi_io(&spi_bus, 1, copi);
+        bus_spi_io(&spi_bus, 0, copi);
+    }
+    return in;
+}
+
+static void spi_frame(const int cs, const unsigned char* out, unsigned char* in, const int len, const int pins) {
+    spi_cs[cs] = 0;
+    for (int i = 0; i < len; i++) {
+        in[i] = pins ? spi_pins(out[i]) : bus_spi_transfer(&spi_bus, out[i]);
+    }
+    spi_cs[cs] = 1;
+    if (pins) {
+        bus_spi_io(&spi_bus, 0, 0);
+    } else {
+        bus_spi_cs(&spi_bus);  // chip select pin written by the board
+    }
+}
+
+static int test_bus_spi(void) {
+    const unsigned char mcp0_write[3] = {0x40, OLATA, 0x5A};
+    const unsigned char mcp1_write[3] = {0x42, OLATB, 0xA5};
+    const unsigned char eth_version[4] = {CR_VERSIONR >> 8, CR_VERSIONR & 0xFF, B_COMMON << 3, 0x00};
+    unsigned char in[4];
+
+    bus_spi_init(&spi_bus);
+    spi_cs[SPI_CS_MCP] = 1;
+    spi_cs[SPI_CS_ETH] = 1;
+    for (int i = 0; i < 2; i++) {
+        memset(&mcp[i], 0, sizeof(mcp_t));
+        io_MCP23X17_init(&mcp[i].mcp);
+        io_MCP23X17_rst(&mcp[i].mcp);
+        io_MCP23X17_set_addr(&mcp[i].mcp, 0x20 + i);
+        bus_spi_attach(&spi_bus, &spi_cs[SPI_CS_MCP], 0, mcp_io, &mcp[i]);
+    }
+    memset(&eth, 0, sizeof(eth));
+    eth_w5500_init(&eth);
+    eth_w5500_rst(&eth);
+    if (bus_spi_attach(&spi_bus, &spi_cs[SPI_CS_ETH], 1, eth_io, &eth) != 2) {
+        printf("Error attaching w5500\n");
+        eth_w5500_end(&eth);
+        return 0;
+    }
+    eth_calls = 0;
+
+    int ret = 1;
+    for (int pins = 1; ret && (pins >= 0); pins--) {
+        const char* level = pins ? "bit level" : "transaction";
+
+        // both mcp share the chip select, the hardware address selects the register write
+        memset(mcp[0].mcp.regs, 0, sizeof(mcp[0].mcp.regs));
+        memset(mcp[1].mcp.regs, 0, sizeof(mcp[1].mcp.regs));
+        spi_frame(SPI_CS_MCP, mcp0_write, in, 3, pins);
+        spi_frame(SPI_CS_MCP, mcp1_write, in, 3, pins);
+        if ((mcp[0].mcp.regs[OLATA] != 0x5A) || mcp[0].mcp.regs[OLATB] || (mcp[1].mcp.regs[OLATB] != 0xA5) ||
+            mcp[1].mcp.regs[OLATA]) {
+            printf("Error mcp %s write\n", level);
+            ret = 0;
+        }
+        if (eth_calls) {
+            printf("Error w5500 clocked without chip select\n");
+            ret = 0;
+        }
+
+        // the mcp don't drive cipo, the w5500 answer is read alone
+        const int calls = mcp[0].calls + mcp[1].calls;
+        spi_frame(SPI_CS_ETH, eth_version, in, 4, pins);
+        if (in[3] != 0x04) {
+            printf("Error w5500 %s version read 0x%02X\n", level, in[3]);
+            ret = 0;
+        }
+        if ((mcp[0].calls + mcp[1].calls) != calls) {
+            printf("Error mcp clocked without chip select\n");
+            ret = 0;
+        }
+        eth_calls = 0;
+    }
+
+    eth_w5500_end(&eth);
+    return ret;
+}
+
+static int test_bus(void* arg) {
+    int ret;
+
+    printf("test I2C and SPI shared buses\n");
+
+    ret = test_bus_i2c() && test_bus_spi();
+
+    for (int i = 0; i < 2; i++) {
+        mi2c_end(&eeprom[i].mem);
+    }
+    mi2c_end(&eeprom_ref);
+    return ret;
+}
+
+register_test("I2C and SPI shared buses", test_bus, NULL);
@@ -0,0 +1,260 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../src/devices/eth_vswitch.h"
+#include "../tests.h"
+
+// The virtual switch runs without PICSimLab, the test plays the role of the w5500 sockets of the nodes.
+
+#define VSW_PCAP_FILE "/tmp/picsimlab_test_vswitch.pcap"
+
+static eth_vswitch_t sw;
+static unsigned char ips[VSW_MAX_NODES + 1][4];
+
+// first due packet of the node, checked and removed
+static int vsw_expect(const int id, const unsigned char proto, const unsigned char flags, const unsigned short dst_port,
+                      const char* data) {
+    vsw_packet_t* p = eth_vswitch_peek(&sw, id, NULL);
+    const int len = data ? strlen(data) : 0;
+
+    if (!p) {
+        printf("Error node %i no packet received\n", id);
+        return 0;
+    }
+    if ((p->proto != proto) || (p->flags != flags) || (p->dst_port != dst_port) || (p->len != len) ||
+        (len && memcmp(p->data, data, len))) {
+        printf("Error node %i unexpected packet proto %i flags 0x%02X port %i len %i\n", id, p->proto, p->flags,
+               p->dst_port, p->len);
+        return 0;
+    }
+    eth_vswitch_remove(&sw, id, NULL);
+    return 1;
+}
+
+static void vsw_tick_all(void) {
+    for (int i = 0; i < VSW_MAX_NODES; i++) {
+        eth_vswitch_tick(&sw, i);
+    }
+}
+
+static int test_vswitch_nodes(void) {
+    memset(&sw, 0, sizeof(sw));
+
+    for (int i = 0; i <= VSW_MAX_NODES; i++) {
+        ips[i][0] = 192;
+        ips[i][1] = 168;
+        ips[i][2] = i >> 8;
+        ips[i][3] = 10 + i;
+    }
+
+    for (int i = 0; i < VSW_MAX_NODES; i++) {
+        if (eth_vswitch_attach(&sw, ips[i]) != i) {
+            printf("Error attaching node %i\n", i);
+            return 0;
+        }
+    }
+    if (eth_vswitch_attach(&sw, ips[VSW_MAX_NODES]) != -1) {
+        printf("Error switch full attach don't fail\n");
+        return 0;
+    }
+    return 1;
+}
+
+static int test_vswitch_tcp(void) {
+    // handshake between the node 1 (client port 50000) and the node 40 (server port 80)
+    if (eth_vswitch_send(&sw, 1, VSW_TCP, VSW_SYN, 50000, ips[40], 80, NULL, 0) != 1) {
+        printf("Error SYN not routed\n");
+        return 0;
+    }
+
+    // deterministic latency: the packet is due only after VSW_LATENCY ticks of the destination node
+    for (int t = 0; t < VSW_LATENCY; t++) {
+        if (eth_vswitch_peek(&sw, 40, NULL)) {
+            printf("Error packet delivered before the latency\n");
+            return 0;
+        }
+        vsw_tick_all();
+    }
+    if (!vsw_expect(40, VSW_TCP, VSW_SYN, 80, NULL)) {
+        return 0;
+    }
+
+    eth_vswitch_send(&sw, 40, VSW_TCP, VSW_SYN | VSW_ACK, 80, ips[1], 50000, NULL, 0);
+    vsw_tick_all();
+    if (!vsw_expect(1, VSW_TCP, VSW_SYN | VSW_ACK, 50000, NULL)) {
+        return 0;
+    }
+
+    // data in both directions, the order is kept
+    eth_vswitch_send(&sw, 1, VSW_TCP, VSW_PSH | VSW_ACK, 50000, ips[40], 80, (const unsigned char*)"GET /", 5);
+    eth_vswitch_send(&sw, 1, VSW_TCP, VSW_PSH | VSW_ACK, 50000, ips[40], 80, (const unsigned char*)" HTTP", 5);
+    vsw_tick_all();
+    if (!vsw_expect(40, VSW_TCP, VSW_PSH | VSW_ACK, 80, "GET /") ||
+        !vsw_expect(40, VSW_TCP, VSW_PSH | VSW_ACK, 80, " HTTP")) {
+        return 0;
+    }
+    eth_vswitch_send(&sw, 40, VSW_TCP, VSW_PSH | VSW_ACK, 80, ips[1], 50000, (const unsigned char*)"200 OK", 6);
+    eth_vswitch_send(&sw, 40, VSW_TCP, VSW_FIN | VSW_ACK, 80, ips[1], 50000, NULL, 0);
+    vsw_tick_all();
+    if (!vsw_expect(1, VSW_TCP, VSW_PSH | VSW_ACK, 50000, "200 OK") ||
+        !vsw_expect(1, VSW_TCP, VSW_FIN | VSW_ACK, 50000, NULL)) {
+        return 0;
+    }
+
+    // connection to a port without listener is answered with RST
+    eth_vswitch_send(&sw, 2, VSW_TCP, VSW_SYN, 50001, ips[40], 81, NULL, 0);
+    vsw_tick_all();
+    if (!vsw_expect(40, VSW_TCP, VSW_SYN, 81, NULL)) {
+        return 0;
+    }
+    eth_vswitch_send(&sw, 40, VSW_TCP, VSW_RST | VSW_ACK, 81, ips[2], 50001, NULL, 0);
+    vsw_tick_all();
+    if (!vsw_expect(2, VSW_TCP, VSW_RST | VSW_ACK, 50001, NULL)) {
+        return 0;
+    }
+
+    // no node with the destination address
+    if (eth_vswitch_send(&sw, 2, VSW_TCP, VSW_SYN, 50002, ips[VSW_MAX_NODES], 80, NULL, 0) != 0) {
+        printf("Error SYN to a missing node routed\n");
+        return 0;
+    }
+    return 1;
+}
+
+static int test_vswitch_broadcast(void) {
+    const unsigned char broadcast[4] = {255, 255, 255, 255};
+
+    if (eth_vswitch_send(&sw, 5, VSW_UDP, 0, 5000, broadcast, 5001, (const unsigned char*)"hello", 5) !=
+        (VSW_MAX_NODES - 1)) {
+        printf("Error broadcast don't reach all nodes\n");
+        return 0;
+    }
+    vsw_tick_all();
+    for (int i = 0; i < VSW_MAX_NODES; i++) {
+        if (i == 5) {
+            if (eth_vswitch_peek(&sw, i, NULL)) {
+                printf("Error broadcast received by the sender\n");
+                return 0;
+            }
+        } else if (!vsw_expect(i, VSW_UDP, 0, 5001, "hello")) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static unsigned short pcap_checksum(const unsigned char* data, const int len, unsigned int sum) {
+    for (int i = 0; i < len; i += 2) {
+        sum += (data[i] << 8) | ((i + 1) < len ? data[i + 1] : 0);
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return sum;
+}
+
+static int test_vswitch_pcap(void) {
+    unsigned int hdr[6];
+    unsigned int rec[4];
+    unsigned char pkt[128];
+    unsigned char pseudo[12];
+    int count = 0;
+    FILE* f;
+
+    if (eth_vswitch_capture_start(&sw, VSW_PCAP_FILE)) {
+        printf("Error opening capture file\n");
+        return 0;
+    }
+    eth_vswitch_send(&sw, 1, VSW_TCP, VSW_SYN, 50010, ips[40], 80, NULL, 0);
+    eth_vswitch_send(&sw, 40, VSW_TCP, VSW_SYN | VSW_ACK, 80, ips[1], 50010, NULL, 0);
+    eth_vswitch_send(&sw, 1, VSW_TCP, VSW_PSH | VSW_ACK, 50010, ips[40], 80, (const unsigned char*)"data", 4);
+    eth_vswitch_send(&sw, 3, VSW_UDP, 0, 6000, ips[4], 6001, (const unsigned char*)"udp", 3);
+    eth_vswitch_capture_stop(&sw);
+    for (int i = 0; i < VSW_MAX_NODES; i++) {
+        eth_vswitch_flush(&sw, i);
+    }
+
+    if ((f = fopen(VSW_PCAP_FILE, "rb")) == NULL) {
+        printf("Error capture file not found\n");
+        return 0;
+    }
+    if ((fread(hdr, 4, 6, f) != 6) || (hdr[0] != 0xa1b2c3d4) || (hdr[5] != 101)) {
+        printf("Error capture file header\n");
+        fclose(f);
+        return 0;
+    }
+    while (fread(rec, 4, 4, f) == 4) {
+        if ((rec[2] > sizeof(pkt)) || (fread(pkt, 1, rec[2], f) != rec[2])) {
+            printf("Error capture record %i truncated\n", count);
+            fclose(f);
+            return 0;
+        }
+        // valid IPv4 header and TCP/UDP checksums
+        const int l4len = rec[2] - 20;
+        memcpy(pseudo, &pkt[12], 8);
+        pseudo[8] = 0;
+        pseudo[9] = pkt[9];
+        pseudo[10] = l4len >> 8;
+        pseudo[11] = l4len & 0xFF;
+        if ((pkt[0] != 0x45) || (pcap_checksum(pkt, 20, 0) != 0xFFFF) ||
+            (pcap_checksum(&pkt[20], l4len, pcap_checksum(pseudo, 12, 0)) != 0xFFFF)) {
+            printf("Error capture record %i checksum\n", count);
+            fclose(f);
+            return 0;
+        }
+        count++;
+    }
+    fclose(f);
+    remove(VSW_PCAP_FILE);
+
+    if (count != 4) {
+        printf("Error capture has %i packets\n", count);
+        return 0;
+    }
+    return 1;
+}
+
+static int test_vswitch(void* arg) {
+    int ret;
+
+    printf("test virtual switch \n");
+
+    ret = test_vswitch_nodes() && test_vswitch_tcp() && test_vswitch_broadcast() && test_vswitch_pcap();
+
+    for (int i = 0; i < VSW_MAX_NODES; i++) {
+        eth_vswitch_detach(&sw, i);
+    }
+    if (ret && sw.count) {
+        printf("Error %i nodes after detach\n", sw.count);
+        ret = 0;
+    }
+    return ret;
+}
+
+register_test("Virtual ethernet switch", test_vswitch, NULL);
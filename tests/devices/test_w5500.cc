@@ -0,0 +1,294 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../src/devices/eth_w5500.h"
+#include "../tests.h"
+
+// The w5500 runs without PICSimLab on the host network, the test plays the role of a web server firmware driving
+// the chip over SPI and of the HTTP clients connecting to it.
+
+#define HTTP_PORT 18080
+#define HTTP_SOCKETS 4    // w5500 sockets listening on the port, as the Arduino EthernetServer
+#define HTTP_REQUESTS 400  // in rounds of HTTP_SOCKETS concurrent clients
+#define HTTP_TIMEOUT 2.0   // seconds to serve a round
+
+static const char http_request[] = "GET / HTTP/1.0\r\n\r\n";
+static const char http_response[] = "HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\n\r\nPICSimLab w5500\r\n";
+
+static eth_w5500_t eth;
+static unsigned long spi_bytes;
+
+static int open_fds(void) {
+    int count = 0;
+    for (int fd = 0; fd < 1024; fd++) {
+        count += (fcntl(fd, F_GETFD) != -1);
+    }
+    return count;
+}
+
+static double get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// full duplex SPI frame, mode 0 MSB first: address, control and data
+static void w5500_frame(const unsigned short addr, const unsigned char control, unsigned char* data, const int len) {
+    unsigned char out[3 + 2048];
+    unsigned char in;
+
+    out[0] = addr >> 8;
+    out[1] = addr & 0xFF;
+    out[2] = control;
+    memcpy(&out[3], data, len);
+
+    eth_w5500_io(&eth, 0, 0, 0, 1);
+    for (int i = 0; i < len + 3; i++) {
+        in = 0;
+        for (int b = 7; b >= 0; b--) {
+            const unsigned char mosi = (out[i] >> b) & 0x01;
+            in = (in << 1) | eth_w5500_io(&eth, mosi, 0, 0, 1);
+            eth_w5500_io(&eth, mosi, 1, 0, 1);
+        }
+        if (i >= 3) {
+            data[i - 3] = in;
+        }
+    }
+    eth_w5500_io(&eth, 0, 0, 1, 1);
+    spi_bytes += len + 3;
+}
+
+static void w5500_write(const unsigned char bsb, const unsigned short addr, const unsigned char* data, const int len) {
+    unsigned char buff[2048];
+    memcpy(buff, data, len);
+    w5500_frame(addr, (bsb << 3) | 0x04, buff, len);
+}
+
+static void w5500_read(const unsigned char bsb, const unsigned short addr, unsigned char* data, const int len) {
+    memset(data, 0, len);
+    w5500_frame(addr, bsb << 3, data, len);
+}
+
+static unsigned char w5500_read_reg(const int n, const unsigned short addr) {
+    unsigned char value;
+    w5500_read(B_SCK0RG + n * 4, addr, &value, 1);
+    return value;
+}
+
+static unsigned short w5500_read_word(const int n, const unsigned short addr) {
+    unsigned char value[2];
+    w5500_read(B_SCK0RG + n * 4, addr, value, 2);
+    return (value[0] << 8) | value[1];
+}
+
+static void w5500_write_reg(const int n, const unsigned short addr, const unsigned char value) {
+    w5500_write(B_SCK0RG + n * 4, addr, &value, 1);
+}
+
+static void w5500_write_word(const int n, const unsigned short addr, const unsigned short value) {
+    const unsigned char data[2] = {(unsigned char)(value >> 8), (unsigned char)(value & 0xFF)};
+    w5500_write(B_SCK0RG + n * 4, addr, data, 2);
+}
+
+// one pass of the web server firmware over the sockets, returns the number of requests answered
+static int http_server_loop(char req[][256], int* req_len) {
+    int served = 0;
+
+    for (int n = 0; n < HTTP_SOCKETS; n++) {
+        switch (w5500_read_reg(n, Sn_SR)) {
+            case SOCK_CLOSED:
+                req_len[n] = 0;
+                w5500_write_reg(n, Sn_MR, Sn_MR_TCP);
+                w5500_write_word(n, Sn_PORT0, HTTP_PORT);
+                w5500_write_reg(n, Sn_CR, OPEN);
+                w5500_write_reg(n, Sn_CR, LISTEN);
+                break;
+            case SOCK_ESTABLISHED: {
+                const unsigned short size = w5500_read_word(n, Sn_RX_RSR0);
+                if (!size) {
+                    break;
+                }
+                const unsigned short rd = w5500_read_word(n, Sn_RX_RD0);
+                int len = size;
+                if ((req_len[n] + len) > 255) {
+                    len = 255 - req_len[n];
+                }
+                w5500_read(B_SCK0RX + n * 4, rd, (unsigned char*)&req[n][req_len[n]], len);
+                req_len[n] += len;
+                req[n][req_len[n]] = 0;
+                w5500_write_word(n, Sn_RX_RD0, rd + size);
+                w5500_write_reg(n, Sn_CR, RECV);
+
+                if (strstr(req[n], "\r\n\r\n")) {
+                    if (strcmp(req[n], http_request)) {
+                        printf("Error socket %i unexpected request '%s'\n", n, req[n]);
+                        return -1;
+                    }
+                    const unsigned short wr = w5500_read_word(n, Sn_TX_WR0);
+                    w5500_write(B_SCK0TX + n * 4, wr, (const unsigned char*)http_response, strlen(http_response));
+                    w5500_write_word(n, Sn_TX_WR0, wr + strlen(http_response));
+                    w5500_write_reg(n, Sn_CR, SEND);
+                    w5500_write_reg(n, Sn_CR, DISCON);
+                    served++;
+                }
+            } break;
+            case SOCK_CLOSE_WAIT:
+                w5500_write_reg(n, Sn_CR, CLOSE);
+                break;
+        }
+    }
+    return served;
+}
+
+static int http_client_connect(void) {
+    struct sockaddr_in serv;
+    int fd;
+
+    if ((fd = socket(PF_INET, SOCK_STREAM, 0)) < 0) {
+        printf("Error client socket creation\n");
+        return -1;
+    }
+    memset(&serv, 0, sizeof(serv));
+    serv.sin_family = AF_INET;
+    serv.sin_addr.s_addr = inet_addr("127.0.0.1");
+    serv.sin_port = htons(HTTP_PORT);
+    // the host backlog completes the connection before the w5500 accepts it
+    if (connect(fd, (sockaddr*)&serv, sizeof(serv)) < 0) {
+        printf("Error client connect\n");
+        close(fd);
+        return -1;
+    }
+    if (send(fd, http_request, strlen(http_request), MSG_NOSIGNAL) != (int)strlen(http_request)) {
+        printf("Error client send\n");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int http_client_check(const int fd) {
+    char resp[256];
+    int len = 0;
+    int s;
+
+    while ((s = recv(fd, &resp[len], sizeof(resp) - 1 - len, 0)) > 0) {
+        len += s;
+    }
+    close(fd);
+    resp[len] = 0;
+    if (strcmp(resp, http_response)) {
+        printf("Error client unexpected response '%s'\n", resp);
+        return 0;
+    }
+    return 1;
+}
+
+static int test_w5500_http(void) {
+    char req[HTTP_SOCKETS][256];
+    int req_len[HTTP_SOCKETS];
+    int fd[HTTP_SOCKETS];
+    int served;
+    int ret = 1;
+
+    // common and buffers setup as the Ethernet library: 2k RX and TX for each socket
+    const unsigned char ip[4] = {127, 0, 0, 1};
+    w5500_write(B_COMMON, CR_SIPR0, ip, 4);
+    for (int n = 0; n < 8; n++) {
+        w5500_write_reg(n, Sn_RXBUF_SIZE, 2);
+        w5500_write_reg(n, Sn_TXBUF_SIZE, 2);
+    }
+
+    http_server_loop(req, req_len);  // listen
+
+    spi_bytes = 0;
+    for (int r = 0; ret && (r < HTTP_REQUESTS); r += HTTP_SOCKETS) {
+        for (int c = 0; c < HTTP_SOCKETS; c++) {
+            if ((fd[c] = http_client_connect()) < 0) {
+                return 0;
+            }
+        }
+
+        served = 0;
+        const double round = get_time();
+        while (served < HTTP_SOCKETS) {
+            eth_w5500_process(&eth);
+            const int s = http_server_loop(req, req_len);
+            if ((s < 0) || ((get_time() - round) > HTTP_TIMEOUT)) {
+                printf("Error round %i served %i of %i requests\n", r / HTTP_SOCKETS, served, HTTP_SOCKETS);
+                ret = 0;
+                break;
+            }
+            served += s;
+        }
+
+        for (int c = 0; c < HTTP_SOCKETS; c++) {
+            ret &= http_client_check(fd[c]);
+        }
+        http_server_loop(req, req_len);  // listen again
+    }
+
+    // the device is called in a tight loop, the speed of a simulated server is measured by the speedtest benchmark
+    if (ret) {
+        printf("HTTP: %i requests served, %lu SPI bytes per request\n", HTTP_REQUESTS, spi_bytes / HTTP_REQUESTS);
+    }
+    return ret;
+}
+
+static int test_w5500(void* arg) {
+    int ret;
+    int fds;
+
+    printf("test w5500 HTTP server\n");
+
+    fds = open_fds();
+
+    memset(&eth, 0, sizeof(eth));
+    eth_w5500_init(&eth);
+    eth_w5500_rst(&eth);
+    eth_w5500_set_link(&eth, 1);
+
+    ret = test_w5500_http();
+
+    eth_w5500_end(&eth);
+
+    // all host sockets closed
+    if (ret && (open_fds() != fds)) {
+        printf("Error %i host sockets leaked\n", open_fds() - fds);
+        ret = 0;
+    }
+    return ret;
+}
+
+register_test("ETH w5500 HTTP server", test_w5500, NULL);
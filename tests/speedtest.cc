@@ -23,7 +23,16 @@
    For e-mail suggestions :  lcgamboa@yahoo.com
    ######################################################################## */
 
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <termios.h>
 #include <unistd.h>
 
 #include "tests.h"
@@ -69,3 +78,268 @@ static int test_speedtest(void* arg) {
 }
 
 register_test("Speed Test", test_speedtest, NULL);
+
+// board level benchmarks: each workspace runs BENCH_RUNS times in batch mode and the median speedup is reported,
+// the min and max show the host noise
+#define BENCH_RUNS 5
+#define BENCH_ARGS "-batch_time 5"
+#define BENCH_DEBUG_PORT 1234  // picsimlab_debugp of the debugger workspaces
+#define BENCH_BP_ADDR 0x3000  // code breakpoints above the firmware, the simulation never stops
+#define BENCH_TTY "/tmp/picsimlab_bench_tty"  // serial port of the serial workspaces
+#define BENCH_HTTP_PORT 18080                 // port of the W5500 HTTP server firmware
+
+typedef struct {
+    const char* name;
+    const char* fname;
+    int breakpoints;  // set by a MPLABX debugger client, -1 without client
+    int serial;       // traffic sent to BENCH_TTY by a pseudo terminal of the test
+    int http;         // HTTP requests sent to BENCH_HTTP_PORT by a client of the test
+} bench_t;
+
+static const bench_t benchs[] = {
+    {"Uno blink", "blink/blink.pzw", -1, 0, 0},                               // Run_CPU loop without parts
+    {"PICGenios", "PICGenios/PICGenios.pzw", -1, 0, 0},                       // Run_CPU loop with parts
+    {"Breadboard PIC18F4620 BMP280", "i2c/pic18f_bmp280_i2c.pzw", -1, 0, 0},  // Breadboard PIC loop
+    {"Uno 4 serial terminals", "bench/uart_uno.pzw", -1, 0, 0},               // board timers of the bit bang UARTs
+    {"Uno Signal Generator", "bench/siggen_uno.pzw", -1, 0, 0},               // MSetAPin of the simavr backend
+    {"Uno VCD Dump", "bench/vcd_uno.pzw", -1, 0, 0},                          // 8 pins toggling recorded in VCD format
+    {"Uno VCD Dump PWF", "bench/pwf_uno.pzw", -1, 0, 0},                      // the same pins recorded in PWF format
+    {"Uno debugger", "bench/debug_uno.pzw", -1, 0, 0},                        // breakpoints test, no debugger client
+    {"Uno debugger 100 breakpoints", "bench/debug_uno.pzw", 100, 0, 0},       // breakpoints test with the bitmaps
+    {"Uno serial echo", "bench/echo_uno.pzw", -1, 1, 0},                      // IO UART on the serial stream rings
+    {"Uno W5500 HTTP server", "bench/http_uno.pzw", -1, 0, 1},                // ETH w5500 part on the host network
+    {NULL, NULL, 0, 0, 0}};
+
+static int cmp_double(const void* a, const void* b) {
+    const double da = *(const double*)a;
+    const double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// MPLABX debugger client, sets the code breakpoints and runs until PICSimLab closes the connection
+static void bench_debugger(const int count) {
+    struct sockaddr_in serv;
+    unsigned int bp[100];
+    unsigned short bpc = count;
+    unsigned char cmd;
+    unsigned char reply;
+    int fd = -1;
+
+    memset(&serv, 0, sizeof(serv));
+    serv.sin_family = AF_INET;
+    serv.sin_addr.s_addr = inet_addr("127.0.0.1");
+    serv.sin_port = htons(BENCH_DEBUG_PORT);
+
+    // wait the server start up to 10 s
+    for (int t = 0; (t < 1000) && (fd < 0); t++) {
+        fd = socket(PF_INET, SOCK_STREAM, 0);
+        if (connect(fd, (sockaddr*)&serv, sizeof(serv)) < 0) {
+            close(fd);
+            fd = -1;
+            usleep(10000);
+        }
+    }
+    if (fd < 0) {
+        _exit(1);
+    }
+
+    for (int i = 0; i < count; i++) {
+        bp[i] = BENCH_BP_ADDR + i * 4;
+    }
+    cmd = 0x30;  // SETBK
+    if ((send(fd, &cmd, 1, MSG_NOSIGNAL) != 1) || (send(fd, &bpc, 2, MSG_NOSIGNAL) != 2) ||
+        (send(fd, bp, count * 4, MSG_NOSIGNAL) != count * 4) || (recv(fd, &reply, 1, MSG_WAITALL) != 1) || reply) {
+        _exit(1);
+    }
+    cmd = 0x10;  // RUN
+    if ((send(fd, &cmd, 1, MSG_NOSIGNAL) != 1) || (recv(fd, &reply, 1, MSG_WAITALL) != 1) || reply) {
+        _exit(1);
+    }
+    while (recv(fd, &reply, 1, 0) > 0) {
+    }
+    close(fd);
+    _exit(0);
+}
+
+// remote side of the serial port, sends traffic without pause and counts the echoes until PICSimLab closes the port
+static void bench_serial(const int fd) {
+    unsigned char buff[256];
+    unsigned char echo[256];
+    unsigned long echoed = 0;
+
+    memset(buff, 'U', sizeof(buff));
+    // wait the port open up to 10 s
+    for (int t = 0; (t < 10000) || echoed; t++) {
+        if (write(fd, buff, sizeof(buff)) < 0) {
+            // buffer full or port not opened yet
+        }
+        const long n = read(fd, echo, sizeof(echo));
+        if (n > 0) {
+            echoed += n;
+        } else if ((n < 0) && (errno == EIO) && echoed) {
+            break;  // closed
+        }
+        usleep(1000);
+    }
+    close(fd);
+    _exit(echoed == 0);
+}
+
+// HTTP client of the W5500 firmware, sends requests one after the other and checks the responses until PICSimLab
+// closes the port, the number of requests served is written to the pipe
+static void bench_http(const int pfd) {
+    static const char request[] = "GET / HTTP/1.0\r\n\r\n";
+    static const char response[] = "HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\n\r\nPICSimLab w5500\r\n";
+    struct sockaddr_in serv;
+    char resp[256];
+    unsigned long served = 0;
+
+    memset(&serv, 0, sizeof(serv));
+    serv.sin_family = AF_INET;
+    serv.sin_addr.s_addr = inet_addr("127.0.0.1");
+    serv.sin_port = htons(BENCH_HTTP_PORT);
+
+    // wait the server start up to 10 s
+    for (int t = 0; (t < 1000) || served; t++) {
+        int len = 0;
+        int n;
+        const int fd = socket(PF_INET, SOCK_STREAM, 0);
+        if (connect(fd, (sockaddr*)&serv, sizeof(serv)) < 0) {
+            close(fd);
+            if (served) {
+                break;  // closed
+            }
+            usleep(10000);
+            continue;
+        }
+        if (send(fd, request, strlen(request), MSG_NOSIGNAL) != (int)strlen(request)) {
+            close(fd);
+            continue;
+        }
+        while ((n = recv(fd, &resp[len], sizeof(resp) - 1 - len, 0)) > 0) {
+            len += n;
+        }
+        close(fd);
+        resp[len] = 0;
+        if (!strcmp(resp, response)) {
+            served++;
+        } else if (len) {
+            _exit(1);
+        }
+    }
+    if (write(pfd, &served, sizeof(served)) != sizeof(served)) {
+        _exit(1);
+    }
+    _exit(served == 0);
+}
+
+// pseudo terminal linked to BENCH_TTY, returns the master side
+static int bench_pty(void) {
+    struct termios tio;
+    int fd;
+    int sfd;
+
+    if (((fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK)) < 0) || grantpt(fd) || unlockpt(fd)) {
+        return -1;
+    }
+    // raw mode, the line discipline must not echo the traffic before PICSimLab configures the port
+    if ((sfd = open(ptsname(fd), O_RDWR | O_NOCTTY)) >= 0) {
+        tcgetattr(sfd, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(sfd, TCSANOW, &tio);
+        close(sfd);
+    }
+    unlink(BENCH_TTY);
+    if (symlink(ptsname(fd), BENCH_TTY)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int test_batchbench(void* arg) {
+    char log[4096];
+    double speedup[BENCH_RUNS];
+    double reqs[BENCH_RUNS];
+
+    printf("test batch benchmarks \n");
+
+    for (int b = 0; benchs[b].name; b++) {
+        for (int r = 0; r < BENCH_RUNS; r++) {
+            const char* line;
+            pid_t client = -1;
+            int status = 0;
+            int pty = -1;
+            int pfd[2] = {-1, -1};
+            unsigned long served = 0;
+            double wall;
+
+            if (benchs[b].serial && ((pty = bench_pty()) < 0)) {
+                printf("Error batch %s pseudo terminal\n", benchs[b].name);
+                return 0;
+            }
+            if (benchs[b].http && pipe(pfd)) {
+                printf("Error batch %s pipe\n", benchs[b].name);
+                return 0;
+            }
+            if (((benchs[b].breakpoints >= 0) || (pty >= 0) || (pfd[1] >= 0)) && ((client = fork()) == 0)) {
+                if (pty >= 0) {
+                    bench_serial(pty);
+                } else if (pfd[1] >= 0) {
+                    bench_http(pfd[1]);
+                } else {
+                    bench_debugger(benchs[b].breakpoints);
+                }
+            }
+            if (pty >= 0) {
+                close(pty);
+            }
+            if (pfd[1] >= 0) {
+                close(pfd[1]);
+            }
+            const int ret = test_batch(benchs[b].fname, BENCH_ARGS, log, 4096);
+            if (client > 0) {
+                waitpid(client, &status, 0);
+            }
+            if (pfd[0] >= 0) {
+                if (read(pfd[0], &served, sizeof(served)) != sizeof(served)) {
+                    served = 0;
+                }
+                close(pfd[0]);
+            }
+            if (pty >= 0) {
+                unlink(BENCH_TTY);
+            }
+            if (ret != 0) {
+                printf("Error batch %s exit code\n%s", benchs[b].name, log);
+                return 0;
+            }
+            if (status) {
+                printf("Error batch %s %s client\n", benchs[b].name,
+                       benchs[b].serial ? "serial" : (benchs[b].http ? "HTTP" : "debugger"));
+                return 0;
+            }
+            if ((!(line = strstr(log, "speedup "))) || (sscanf(line + 8, "%lfx", &speedup[r]) != 1)) {
+                printf("Error batch %s speedup not found\n%s", benchs[b].name, log);
+                return 0;
+            }
+            // requests served by the firmware per wall second
+            if ((line = strstr(log, "wall ")) && (sscanf(line + 5, "%lf", &wall) == 1) && (wall > 0)) {
+                reqs[r] = served / wall;
+            } else {
+                reqs[r] = 0;
+            }
+        }
+        qsort(speedup, BENCH_RUNS, sizeof(double), cmp_double);
+        printf("%-32s speedup %7.2fx  (min %7.2fx max %7.2fx)", benchs[b].name, speedup[BENCH_RUNS / 2], speedup[0],
+               speedup[BENCH_RUNS - 1]);
+        if (benchs[b].http) {
+            qsort(reqs, BENCH_RUNS, sizeof(double), cmp_double);
+            printf("  %.0f requests/s", reqs[BENCH_RUNS / 2]);
+        }
+        printf("\n");
+    }
+    return 1;
+}
+
+register_test("Batch benchmarks", test_batchbench, NULL);
@@ -124,4 +124,49 @@ static int test_analogic_HR(void* arg) {
     return test_end();
 }
 
-register_test("Uno ADC and PWM HR", test_analogic_HR, NULL);
\ No newline at end of file
+register_test("Uno ADC and PWM HR", test_analogic_HR, NULL);
+//-----------------------------------------------------------------------------
+
+// The PWM outputs change only a few times per period, so the steps between the changes run in MStepUntil batches.
+// A 25% and a 75% duty must be read as is and not inverted.
+static int test_pwm_duty(void* arg) {
+    const float volts[2] = {1.25, 3.75};
+    char cmd[100];
+    int value;
+
+    printf("test PWM duty \n");
+
+    if (!test_load("analogic/analogic_uno.pzw")) {
+        return 0;
+    }
+
+    for (int v = 0; v < 2; v++) {
+        const int ival = volts[v] * 40;
+
+        sprintf(cmd, "set apin[23] %5.3f", volts[v]);
+        if (!test_send_rcmd(cmd)) {
+            printf("Error send rcmd \n");
+            test_end();
+            return 0;
+        }
+
+        // wait stabilization
+        usleep(500000);
+
+        if (!test_send_rcmd("get pinm[05]")) {
+            printf("Error send rcmd \n");
+            test_end();
+            return 0;
+        }
+        sscanf(test_get_cmd_resp() + 8, "%03d", &value);
+
+        if ((value < (ival - 4)) || (value > (ival + 4))) {
+            printf("Error PWM duty %i expected %i\n", value, ival);
+            test_end();
+            return 0;
+        }
+    }
+    return test_end();
+}
+
+register_test("Uno PWM duty", test_pwm_duty, NULL);
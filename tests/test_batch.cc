@@ -0,0 +1,136 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gamboa Lopes
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tests.h"
+
+static int batch_result(const char* log, double* simtime, unsigned long long* insts) {
+    const char* line = strstr(log, "Batch finished: simulated ");
+    if (!line) {
+        printf("Error batch summary not found\n");
+        return 0;
+    }
+    if (sscanf(line + 26, "%lf s, %llu instructions", simtime, insts) != 2) {
+        printf("Error batch summary format\n");
+        return 0;
+    }
+    return 1;
+}
+
+static int batch_speedup(const char* log, double* speedup) {
+    const char* line = strstr(log, "speedup ");
+    if ((!line) || (sscanf(line + 8, "%lfx", speedup) != 1)) {
+        printf("Error batch speedup not found\n");
+        return 0;
+    }
+    return 1;
+}
+
+static int test_batch_mode(void* arg) {
+    char log[4096];
+    double simtime;
+    unsigned long long insts;
+
+    printf("test batch mode \n");
+
+    // fixed simulated time, the Uno runs 16M instructions per second
+    if (test_batch("blink/blink.pzw", "-batch_time 2", log, 4096) != 0) {
+        printf("Error batch time exit code\n%s", log);
+        return 0;
+    }
+    if (!batch_result(log, &simtime, &insts)) {
+        return 0;
+    }
+    // printf("simulated %f s %llu instructions\n", simtime, insts);
+    if ((simtime < 2.0) || (simtime > 2.2) || (insts < 32000000ULL) || (insts > 35200000ULL)) {
+        printf("Error batch time simulated %f s %llu instructions\n", simtime, insts);
+        return 0;
+    }
+
+    // fixed instructions budget
+    if (test_batch("blink/blink.pzw", "-batch_inst 8000000", log, 4096) != 0) {
+        printf("Error batch instructions exit code\n%s", log);
+        return 0;
+    }
+    if (!batch_result(log, &simtime, &insts)) {
+        return 0;
+    }
+    // printf("simulated %f s %llu instructions\n", simtime, insts);
+    if ((insts < 8000000ULL) || (insts > 9600000ULL) || (simtime < 0.5) || (simtime > 0.6)) {
+        printf("Error batch instructions simulated %f s %llu instructions\n", simtime, insts);
+        return 0;
+    }
+
+    // invalid option
+    if (test_batch("blink/blink.pzw", "-batch_time 0", log, 4096) != 1) {
+        printf("Error batch option exit code\n%s", log);
+        return 0;
+    }
+
+    return 1;
+}
+
+register_test("Batch mode", test_batch_mode, NULL);
+
+static int test_batch_idle(void* arg) {
+    char log[4096];
+    double simtime;
+    unsigned long long insts;
+    double speedup_busy;
+    double speedup_idle;
+
+    printf("test idle fast-forward \n");
+
+    // the Arduino delay() polls the timer 0 counter and runs all the steps
+    if ((test_batch("blink/blink.pzw", "-batch_time 10", log, 4096) != 0) || !batch_speedup(log, &speedup_busy)) {
+        printf("Error batch busy\n%s", log);
+        return 0;
+    }
+
+    // the core sleeps until the timer 0 interrupt and waits in a loop the timer 2 flag, both are skipped
+    if (test_batch("idle/idle_uno.pzw", "-batch_time 10", log, 4096) != 0) {
+        printf("Error batch idle exit code\n%s", log);
+        return 0;
+    }
+    if (!batch_result(log, &simtime, &insts) || !batch_speedup(log, &speedup_idle)) {
+        return 0;
+    }
+    // the skipped steps are counted as executed
+    if ((simtime < 10.0) || (simtime > 10.2) || (insts < 160000000ULL) || (insts > 163200000ULL)) {
+        printf("Error batch idle simulated %f s %llu instructions\n", simtime, insts);
+        return 0;
+    }
+
+    printf("speedup: delay() %.1fx, sleep and wait loop %.1fx\n", speedup_busy, speedup_idle);
+    if (speedup_idle < (4 * speedup_busy)) {
+        printf("Error idle core not fast-forwarded\n");
+        return 0;
+    }
+    return 1;
+}
+
+register_test("Idle fast-forward", test_batch_idle, NULL);
@@ -0,0 +1,98 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gamboa Lopes
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../src/lib/rcontrol.h"
+#include "tests.h"
+
+static int test_rbin(void* arg) {
+    const int pwm_pins[6] = {5, 11, 12, 15, 16, 17};
+    unsigned char ops[64];
+    unsigned char* resp;
+    int value;
+
+    printf("test rcontrol binary frames \n");
+
+    if (!test_load("analogic/analogic_uno.pzw")) {
+        return 0;
+    }
+
+    for (float v = 0; v <= 5.0; v += 0.5) {
+        int ival = v * 40;
+        int size = 0;
+
+        // set all analog inputs in one binary frame
+        for (int i = 0; i < 6; i++) {
+            ops[size++] = RB_APIN_SET;
+            ops[size++] = i + 23;
+            memcpy(&ops[size], &v, 4);
+            size += 4;
+        }
+
+        if (test_send_rbin(ops, size) != 12) {
+            printf("Error send rbin \n");
+            test_end();
+            return 0;
+        }
+
+        // wait stabilization
+        usleep(500000);
+
+        size = 0;
+        for (int i = 0; i < 6; i++) {
+            ops[size++] = RB_PINM_GET;
+            ops[size++] = pwm_pins[i];
+        }
+
+        if (test_send_rbin(ops, size) != 24) {
+            printf("Error send rbin \n");
+            test_end();
+            return 0;
+        }
+
+        resp = test_get_bin_resp();
+        for (int i = 0; i < 6; i++) {
+            if (resp[i * 4 + 1] != RB_OK) {
+                printf("Error rbin status \n");
+                test_end();
+                return 0;
+            }
+            value = resp[i * 4 + 3];
+            // printf ("pwm[%02i] %i = %i\n", pwm_pins[i], ival, value);
+
+            if ((value < (ival - 4)) || (value > (ival + 4))) {
+                printf("Error value \n");
+                test_end();
+                return 0;
+            }
+        }
+    }
+    return test_end();
+}
+
+register_test("rcontrol binary frames", test_rbin, NULL);
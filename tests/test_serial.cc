@@ -24,6 +24,7 @@
    ######################################################################## */
 
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "tests.h"
@@ -75,3 +76,55 @@ static int test_serial(void* arg) {
 }
 
 register_test("Uno Serial", test_serial, NULL);
+
+//-----------------------------------------------------------------------------
+
+// The virtual terminal is the only part wired to the Uno UART pins, so the bytes are exchanged by the UART byte link.
+// The burst is sent without waiting each echo, the bytes must be received in order without loss.
+static int test_serial_burst(void* arg) {
+    const char* msg = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+    const int len = strlen(msg);
+    char ret;
+
+    printf("test serial burst \n");
+
+    if (!test_load("serial/serial_uno.pzw")) {
+        return 0;
+    }
+
+    if (!test_serial_vt_init(0)) {
+        printf("Error init vt \n");
+        test_end();
+        return 0;
+    }
+
+    char buff[256];
+    // clear serial console
+    while (test_serial_recv_str(buff, 256, 1000)) {
+    };
+
+    for (int i = 0; i < len; i++) {
+        if (!test_serial_send(msg[i])) {
+            printf("Error on send\n");
+            test_end();
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < len; i++) {
+        if (!test_serial_recv_wait(&ret, 1000)) {
+            printf("Error on recv %i\n", i);
+            test_end();
+            return 0;
+        }
+        if (ret != msg[i]) {
+            printf("Error on data value %i: %c expected %c\n", i, ret, msg[i]);
+            test_end();
+            return 0;
+        }
+    }
+
+    return test_end();
+}
+
+register_test("Uno Serial burst", test_serial_burst, NULL);
@@ -0,0 +1,112 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gamboa Lopes
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tests.h"
+
+#define SNAPSHOT_LOADS 1000
+
+static double get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int test_snapshot_cmd(const char* cmd) {
+    if (!test_send_rcmd(cmd)) {
+        printf("Error send rcmd \n");
+        return 0;
+    }
+    if (strstr(test_get_cmd_resp(), "ERROR")) {
+        printf("Error in '%s': %s\n", cmd, test_get_cmd_resp());
+        return 0;
+    }
+    return 1;
+}
+
+static int test_snapshot(void* arg) {
+    static char ram1[8192];
+    static char ram2[8192];
+
+    printf("test snapshot \n");
+
+    if (!test_load("PICGenios/PICGenios.pzw")) {
+        return 0;
+    }
+
+    // wait the firmware boot
+    usleep(500000);
+
+    if (!test_snapshot_cmd("sim stop") || !test_snapshot_cmd("snapshot save") || !test_snapshot_cmd("dumpr")) {
+        test_end();
+        return 0;
+    }
+    strncpy(ram1, test_get_cmd_resp(), sizeof(ram1) - 1);
+
+    // run and restore
+    if (!test_snapshot_cmd("sim start")) {
+        test_end();
+        return 0;
+    }
+    usleep(300000);
+    if (!test_snapshot_cmd("sim stop") || !test_snapshot_cmd("snapshot load") || !test_snapshot_cmd("dumpr")) {
+        test_end();
+        return 0;
+    }
+    strncpy(ram2, test_get_cmd_resp(), sizeof(ram2) - 1);
+
+    if (strcmp(ram1, ram2)) {
+        printf("Failed RAM after snapshot load don't match\n");
+        test_end();
+        return 0;
+    }
+
+    double start = get_time();
+    for (int i = 0; i < SNAPSHOT_LOADS; i++) {
+        if (!test_snapshot_cmd("snapshot load")) {
+            test_end();
+            return 0;
+        }
+    }
+    printf("snapshot load mean time %.3f ms\n", (get_time() - start) * 1e3 / SNAPSHOT_LOADS);
+
+    // invalid file
+    if (!test_send_rcmd("snapshot load /nonexistent/picsimlab.snp") || !strstr(test_get_cmd_resp(), "ERROR")) {
+        printf("Failed load of invalid snapshot file\n");
+        test_end();
+        return 0;
+    }
+
+    test_snapshot_cmd("sim start");
+
+    return test_end();
+}
+
+register_test("Snapshot save and load", test_snapshot, NULL);
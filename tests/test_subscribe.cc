@@ -0,0 +1,113 @@
+/* ########################################################################
+
+   PICsimLab - PIC laboratory simulator
+
+   ########################################################################
+
+   Copyright (c) : 2020-2023  Luis Claudio Gamboa Lopes
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tests.h"
+
+static int test_subscribe(void* arg) {
+    char line[2048];
+    char* ptr;
+    unsigned int ic;
+    unsigned int last_ic = 0;
+    unsigned int change_ic[5];
+    int value = -1;
+    int changes = 0;
+
+    printf("test subscribe \n");
+
+    if (!test_load("blink/blink.pzw")) {
+        return 0;
+    }
+
+    if (!test_send_rcmd("subscribe 10")) {
+        printf("Error send rcmd \n");
+        test_end();
+        return 0;
+    }
+
+    // the Uno led (pin 19) blinks at 1Hz
+    for (int i = 0; (i < 1000) && (changes < 5); i++) {
+        if (!test_recv_rline(line, 2048, 2000)) {
+            printf("Error no push received \n");
+            test_end();
+            return 0;
+        }
+
+        if (line[0] != '@') {
+            continue;
+        }
+
+        ic = strtoul(line + 1, NULL, 10);
+        if ((last_ic) && (ic < last_ic)) {
+            printf("Error push instruction counter out of order \n");
+            test_end();
+            return 0;
+        }
+        last_ic = ic;
+
+        if ((ptr = strstr(line, " pin[19]="))) {
+            int nvalue = ptr[9] - '0';
+            if (nvalue == value) {
+                printf("Error push of unchanged pin \n");
+                test_end();
+                return 0;
+            }
+            value = nvalue;
+            change_ic[changes] = ic;
+            changes++;
+        }
+    }
+
+    if (changes < 5) {
+        printf("Error led changes \n");
+        test_end();
+        return 0;
+    }
+
+    // the changes are recorded on the simulation step, the first is the initial state
+    for (int i = 2; i < 4; i++) {
+        unsigned int period = change_ic[i + 1] - change_ic[i];
+        unsigned int period0 = change_ic[2] - change_ic[1];
+        // printf("led period %u\n", period);
+        if ((period < (period0 - period0 / 1000)) || (period > (period0 + period0 / 1000))) {
+            printf("Error led change instruction counter \n");
+            test_end();
+            return 0;
+        }
+    }
+
+    if (!test_send_rcmd("unsubscribe")) {
+        printf("Error send rcmd \n");
+        test_end();
+        return 0;
+    }
+
+    return test_end();
+}
+
+register_test("Subscribe push", test_subscribe, NULL);
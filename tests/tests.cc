@@ -31,6 +31,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
+#include <sys/wait.h>
 #else
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -46,6 +47,7 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "../src/lib/rcontrol.h"
 #include "serial.h"
 #include "tests.h"
 
@@ -200,6 +202,45 @@ int test_end() {
     return 1;
 }
 
+int test_batch(const char* fname, const char* args, char* log, const int size) {
+    char cmd[512];
+
+    if (!test_file_exist(fname)) {
+        printf("File not found %s\n", fname);
+        return -1;
+    }
+
+    if (strstr(pexe, ".exe")) {
+        snprintf(cmd, 511, "wine %s %s %s 2>&1", pexe, args, fname);
+    } else {
+        snprintf(cmd, 511, "%s %s %s 2>&1", pexe, args, fname);
+    }
+
+    FILE* fp = popen(cmd, "r");
+    if (!fp) {
+        printf("popen error : %s \n", strerror(errno));
+        return -1;
+    }
+
+    // keep the last lines of the log
+    int len = 0;
+    log[0] = 0;
+    while (fgets(cmd, 511, fp)) {
+        const int n = strlen(cmd);
+        if (len + n >= size) {
+            len = 0;
+        }
+        memcpy(log + len, cmd, n + 1);
+        len += n;
+    }
+
+    const int status = pclose(fp);
+    if (status < 0) {
+        return -1;
+    }
+    return WEXITSTATUS(status);
+}
+
 // serial support
 
 #define VTBSIZE 400
@@ -362,6 +403,90 @@ char* test_get_cmd_resp(void) {
     return buff;
 }
 
+int test_recv_rline(char* data, const int size, const int timeout) {
+    int i = 0;
+    int t = 0;
+
+    while ((i < (size - 1)) && (t < timeout)) {
+        int n = recv(sockfd, data + i, 1, 0);
+        if (n > 0) {
+            if (data[i] == '\n') {
+                data[i] = 0;
+                return 1;
+            }
+            i++;
+        } else {
+            usleep(1000);
+            t++;
+        }
+    }
+    data[i] = 0;
+    return 0;
+}
+
+// rcontrol binary frames
+
+static unsigned char bin_id = 0;
+
+int test_send_rbin(const unsigned char* ops, const int size) {
+    unsigned char frame[1028];
+    int n;
+
+    if (size > 1024) {
+        return 0;
+    }
+
+    bin_id++;
+    frame[0] = RC_BIN_MAGIC;
+    frame[1] = bin_id;
+    frame[2] = size & 0xFF;
+    frame[3] = (size >> 8) & 0xFF;
+    memcpy(frame + 4, ops, size);
+
+    if (send(sockfd, (const char*)frame, size + 4, MSG_NOSIGNAL) != size + 4) {
+        printf("send error : %s \n", strerror(errno));
+        close(sockfd);
+        exit(-1);
+    }
+
+    int bp = 0;
+    int rsize = -1;
+    int timeout = 0;
+    do {
+        if ((n = recv(sockfd, buff + bp, sizeof(buff) - bp, 0)) > 0) {
+            bp += n;
+            if ((rsize < 0) && (bp >= 4)) {
+                rsize = (unsigned char)buff[2] | ((unsigned char)buff[3] << 8);
+            }
+        } else {
+            if (n < 0) {
+#ifndef _WIN32
+                if (errno != EAGAIN)
+#else
+                if (WSAGetLastError() != WSAEWOULDBLOCK)
+#endif
+                {
+                    printf("recv error : %s \n", strerror(errno));
+                    close(sockfd);
+                    exit(-1);
+                }
+            }
+            timeout++;
+            usleep(100);
+        }
+    } while (((rsize < 0) || (bp < (rsize + 4))) && (timeout < 20000));
+
+    if ((rsize < 0) || (bp < (rsize + 4)) || ((unsigned char)buff[0] != RC_BIN_MAGIC) ||
+        ((unsigned char)buff[1] != bin_id)) {
+        return 0;
+    }
+    return rsize;
+}
+
+unsigned char* test_get_bin_resp(void) {
+    return (unsigned char*)buff + 4;
+}
+
 #ifdef _WIN32
 WORD wVersionRequested = 2;
 WSADATA wsaData;
@@ -26,7 +26,7 @@
 #ifndef TESTS_H
 #define TESTS_H
 
-#define MAX_TESTS 20
+#define MAX_TESTS 40
 
 // extern int NUM_TESTS;
 
@@ -42,7 +42,12 @@ void test_register(const char* name, test_run_func trun, void* arg);
 int test_load(const char* fname);
 int test_send_rcmd(const char* message);
 char* test_get_cmd_resp(void);
+int test_recv_rline(char* data, const int size, const int timeout = 1000);
+int test_send_rbin(const unsigned char* ops, const int size);
+unsigned char* test_get_bin_resp(void);
 int test_end();
+// run a workspace in batch mode, returns the exit code and the end of the output in log
+int test_batch(const char* fname, const char* args, char* log, const int size);
 
 // serial
 int test_serial_send(const char data);
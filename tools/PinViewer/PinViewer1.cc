@@ -40,7 +40,10 @@ void CPWindow1::_EvOnHide(CControl *control) {
   }
 }
 
-void CPWindow1::_EvOnDestroy(CControl *control) { delete font; }
+void CPWindow1::_EvOnDestroy(CControl *control) {
+  shm_detach();
+  delete font;
+}
 
 int CPWindow1::PointInside(int i, int x_, int y_) {
 
@@ -263,22 +266,20 @@ void CPWindow1::timer1_EvOnTime(CControl *control) {
   draw1.Canvas.SetFgColor(50, 50, 50);
   draw1.Canvas.SetBgColor(50, 50, 50);
   draw1.Canvas.Rectangle(1, 0, 0, draw1.GetWidth(), draw1.GetHeight());
-  if (connected) {
-    char *str;
-    char *type;
-    char *dir;
-    char *dvalue;
-    char *mvalue;
-    char *avalue;
-    char *name;
-    if (send_cmd("pinsl") < 0)
-      return;
+  int pinsc = -1;
 
-    str = strtok(buff, "\r\n");
-    int i = 0;
-    int pinsc;
+  // pins state from shared memory if available, else polling with rcontrol
+  if (!shm) {
+    shm_attach();
+  }
+  if (shm) {
+    pinsc = read_pins_shm();
+  }
+  if ((pinsc < 0) && connected) {
+    pinsc = read_pins_rcontrol();
+  }
 
-    sscanf(str, "%i", &pinsc);
+  if (pinsc >= 0) {
     if (pinsc != pincount) {
       pincount = pinsc;
       int x = GetX();
@@ -303,11 +304,10 @@ void CPWindow1::timer1_EvOnTime(CControl *control) {
 
     draw1.Canvas.ChangeScale(scale, scale);
 
-    while (pinsc) {
+    for (int i = 0; i < pincount; i++) {
       int y = 0;
       int x = 0;
       int mv;
-      float av;
 
       if (pincount <= 8) {
         x = 0;
@@ -337,33 +337,22 @@ void CPWindow1::timer1_EvOnTime(CControl *control) {
         }
       }
 
-      strtok(NULL, " \"\r\n");
-      type = strtok(NULL, " \"\r\n");
-      dir = strtok(NULL, " \"\r\n");
-      dvalue = strtok(NULL, " \"\r\n");
-      mvalue = strtok(NULL, " \"\r\n");
-      avalue = strtok(NULL, " \"\r\n");
-      name = strtok(NULL, " \"\r\n");
-
-      pins[i].type = type[0];
-      pins[i].dir = dir[0];
-      pins[i].dvalue = dvalue[0];
-
-      switch (type[0]) {
+      switch (pins[i].type) {
       case 'D':
         draw1.Canvas.SetFgColor(0, 0, 0);
         draw1.Canvas.SetBgColor(0, 0, 100);
         draw1.Canvas.Rectangle(1, 8 + offsetx + x, y - 1 + offsety, 238, 14);
-        sprintf(line, "%2i %-8s %s %s %s ", i + 1, name, type, dir, dvalue);
+        sprintf(line, "%2i %-8s %c %c %c ", i + 1, pins[i].name, pins[i].type,
+                pins[i].dir, pins[i].dvalue);
 
-        if (dir[0] == 'I') {
+        if (pins[i].dir == 'I') {
           draw1.Canvas.SetColor(0x6a, 0x2c, 0x29);
         } else {
           draw1.Canvas.SetColor(0x66, 0x65, 0x28);
         }
         draw1.Canvas.Rectangle(1, 98 + offsetx + x, y + 1 + offsety, 142, 10);
 
-        if (dvalue[0] == '0') {
+        if (pins[i].dvalue == '0') {
           draw1.Canvas.SetColor(200, 0, 0);
           ;
         } else {
@@ -375,13 +364,13 @@ void CPWindow1::timer1_EvOnTime(CControl *control) {
         draw1.Canvas.Text(line, 10 + offsetx + x, y - 1 + offsety);
 
         // togle and mean
-        if (dir[0] == 'I') {
+        if (pins[i].dir == 'I') {
           draw1.Canvas.SetColor(200, 100, 30);
           draw1.Canvas.Rectangle(1, 185 + offsetx + x, y + 2 + offsety, 52, 8);
           draw1.Canvas.SetFgColor(255, 255, 255);
           draw1.Canvas.Text("Toggle", 187 + offsetx + x, y - 1 + offsety);
         } else {
-          sscanf(mvalue, "%3d", &mv);
+          mv = pins[i].mvalue;
           draw1.Canvas.SetColor(200, 200, 200);
           draw1.Canvas.Rectangle(1, 185 + offsetx + x, y + 2 + offsety, 52, 8);
           draw1.Canvas.SetColor(0, 0, 200);
@@ -391,7 +380,8 @@ void CPWindow1::timer1_EvOnTime(CControl *control) {
 
         break;
       case 'A':
-        sprintf(line, "%2i %-8s %s %s %s", i + 1, name, type, dir, avalue);
+        sprintf(line, "%2i %-8s %c %c %5.3f", i + 1, pins[i].name,
+                pins[i].type, pins[i].dir, pins[i].avalue);
         draw1.Canvas.SetFgColor(0, 0, 0);
         draw1.Canvas.SetBgColor(0, 100, 0);
         draw1.Canvas.Rectangle(1, 8 + offsetx + x, y - 1 + offsety, 238, 14);
@@ -399,27 +389,22 @@ void CPWindow1::timer1_EvOnTime(CControl *control) {
         draw1.Canvas.Text(line, 10 + offsetx + x, y - 1 + offsety);
 
         // draw gauge
-        sscanf(avalue, "%f", &av);
-        mv = av * 10;
+        mv = pins[i].avalue * 10;
         draw1.Canvas.SetColor(200, 200, 200);
         draw1.Canvas.Rectangle(1, 185 + offsetx + x, y + 2 + offsety, 52, 8);
         draw1.Canvas.SetColor(255, 255, 0);
         draw1.Canvas.Rectangle(1, 186 + offsetx + x, y + 3 + offsety, mv, 6);
-        pins[i].avalue = av;
         break;
 
       default:
         draw1.Canvas.SetFgColor(0, 0, 0);
         draw1.Canvas.SetBgColor(100, 100, 100);
         draw1.Canvas.Rectangle(1, 8 + offsetx + x, y - 1 + offsety, 238, 14);
-        sprintf(line, "%2i %-8s %s", i + 1, name, type);
+        sprintf(line, "%2i %-8s %c", i + 1, pins[i].name, pins[i].type);
         draw1.Canvas.SetFgColor(255, 255, 255);
         draw1.Canvas.Text(line, 10 + offsetx + x, y - 1 + offsety);
         break;
       }
-
-      pinsc--;
-      i++;
     }
   }
 
@@ -430,7 +415,9 @@ void CPWindow1::timer1_EvOnTime(CControl *control) {
   Draw();
 #endif  
 
-  if (connected) {
+  if (shm) {
+    statusbar1.SetField(0, "Shared memory: " + itoa(port));
+  } else if (connected) {
     statusbar1.SetField(0, "Connected on port: " + itoa(port));
   } else {
     statusbar1.SetField(0, "Not connected");
@@ -498,3 +485,114 @@ int CPWindow1::send_cmd(const char *message) {
 
   return bp;
 }
+
+// read pins state with rcontrol pinsl command, returns the number of pins or
+// -1 on error
+int CPWindow1::read_pins_rcontrol(void) {
+  char *str;
+  char *type;
+  char *dir;
+  char *dvalue;
+  char *mvalue;
+  char *avalue;
+  char *name;
+  int pinsc;
+
+  if (send_cmd("pinsl") < 0)
+    return -1;
+
+  str = strtok(buff, "\r\n");
+  sscanf(str, "%i", &pinsc);
+  if (pinsc > PINSHM_MAX_PINS) {
+    pinsc = PINSHM_MAX_PINS;
+  }
+
+  for (int i = 0; i < pinsc; i++) {
+    strtok(NULL, " \"\r\n");
+    type = strtok(NULL, " \"\r\n");
+    dir = strtok(NULL, " \"\r\n");
+    dvalue = strtok(NULL, " \"\r\n");
+    mvalue = strtok(NULL, " \"\r\n");
+    avalue = strtok(NULL, " \"\r\n");
+    name = strtok(NULL, " \"\r\n");
+
+    pins[i].type = type[0];
+    pins[i].dir = dir[0];
+    pins[i].dvalue = dvalue[0];
+    sscanf(mvalue, "%3d", &pins[i].mvalue);
+    sscanf(avalue, "%f", &pins[i].avalue);
+    strncpy(pins[i].name, name, 11);
+    pins[i].name[11] = 0;
+  }
+  return pinsc;
+}
+
+// read pins state from PICSimLab shared memory, returns the number of pins or
+// -1 on error
+int CPWindow1::read_pins_shm(void) {
+  if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != PINSHM_MAGIC) {
+    // PICSimLab closed
+    shm_detach();
+    return -1;
+  }
+
+  if (!pinshm_read(shm, &shm_copy)) {
+    return -1;
+  }
+
+  if (shm_copy.pincount > PINSHM_MAX_PINS) {
+    return -1;
+  }
+
+  for (unsigned int i = 0; i < shm_copy.pincount; i++) {
+    pins[i].type = shm_copy.pins[i].type;
+    pins[i].dir = shm_copy.pins[i].dir;
+    pins[i].dvalue = shm_copy.pins[i].value ? '1' : '0';
+    pins[i].mvalue = shm_copy.pins[i].mean;
+    pins[i].avalue = shm_copy.pins[i].avalue;
+    memcpy(pins[i].name, shm_copy.pins[i].name, 12);
+  }
+  return shm_copy.pincount;
+}
+
+void CPWindow1::shm_attach(void) {
+#ifndef _WIN_
+  char name[64];
+  snprintf(name, 63, PINSHM_NAME, port);
+
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) || (st.st_size < (off_t)sizeof(pinshm_t))) {
+    close(fd);
+    return;
+  }
+
+  void *ptr = mmap(NULL, sizeof(pinshm_t), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    return;
+  }
+
+  shm = (pinshm_t *)ptr;
+  if ((shm->magic != PINSHM_MAGIC) || (shm->version != PINSHM_VERSION)) {
+    shm_detach();
+    return;
+  }
+  // no syscall to read, refresh faster
+  timer1.SetTime(50);
+#endif
+}
+
+void CPWindow1::shm_detach(void) {
+#ifndef _WIN_
+  if (shm) {
+    munmap(shm, sizeof(pinshm_t));
+    shm = NULL;
+    timer1.SetTime(250);
+  }
+#endif
+}
@@ -5,7 +5,9 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/un.h>
 #else
@@ -24,11 +26,15 @@
 
 #include <lxrad.h>
 
+#include "../../src/lib/pinshm.h"
+
 typedef struct {
   unsigned char type;
   unsigned char dir;
   unsigned char dvalue;
+  int mvalue;
   float avalue;
+  char name[12];
 } pin_t;
 
 class CPWindow1 : public CPWindow {
@@ -71,9 +77,15 @@ public:
   char buff[4096];
   char line[200];
   int send_cmd(const char *message);
+  int read_pins_rcontrol(void);
+  int read_pins_shm(void);
+  void shm_attach(void);
+  void shm_detach(void);
   int PointInside(int i, int x, int y);
   int pincount;
-  pin_t pins[200];
+  pin_t pins[PINSHM_MAX_PINS];
+  pinshm_t *shm;
+  pinshm_t shm_copy;
   int mdx, mdy;
   float scale;
   int offsetx;
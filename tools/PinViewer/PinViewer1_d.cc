@@ -120,6 +120,7 @@ CPWindow1::CPWindow1(void) {
   sockfd = -1;
   connected = 0;
   pincount = 0;
+  shm = NULL;
   offsetx = 0;
   offsety = 0;
   scale = 1.0;
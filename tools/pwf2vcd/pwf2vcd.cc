@@ -0,0 +1,59 @@
+/* ########################################################################
+
+   PICSimLab - Programmable IC Simulator Laboratory
+
+   ########################################################################
+
+   Copyright (c) : 2010-2023  Luis Claudio Gambôa Lopes <lcgamboa@yahoo.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2, or (at your option)
+   any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+
+   For e-mail suggestions :  lcgamboa@yahoo.com
+   ######################################################################## */
+
+// converts a PICSimLab waveform file (.pwf) to VCD
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../../src/lib/wave_file.h"
+
+int main(int argc, char** argv) {
+    char out[1024];
+
+    if ((argc < 2) || (argc > 3)) {
+        printf("usage: %s file.pwf [file.vcd]\n", argv[0]);
+        return 1;
+    }
+
+    if (argc == 3) {
+        strncpy(out, argv[2], 1023);
+        out[1023] = 0;
+    } else {
+        // same name with .vcd extension
+        strncpy(out, argv[1], 1019);
+        out[1019] = 0;
+        if (wave_file_name(out)) {
+            out[strlen(out) - 4] = 0;
+        }
+        strcat(out, ".vcd");
+    }
+
+    if (wave_file_to_vcd(argv[1], out)) {
+        printf("pwf2vcd: Error converting %s to %s\n", argv[1], out);
+        return 1;
+    }
+    return 0;
+}